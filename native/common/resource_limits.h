@@ -0,0 +1,227 @@
+/**
+ * 容器资源限制
+ * 启动时读取 cgroup v2 的 cpu.max / memory.max（v1 的 cfs_quota / limit_in_bytes 作为后备）
+ * 以及 CPU 亲和性，据此确定解码线程数、拷贝线程数、预解码深度和缓存预算，
+ * 避免按宿主机核数创建线程而在 CPU 配额下被频繁节流
+ *
+ * 可用环境变量覆盖（测试用）: NATIVE_CPU_LIMIT=1.5, NATIVE_MEMORY_LIMIT_MB=2048
+ */
+#pragma once
+
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+struct ResourceLimits {
+    // 原始限制
+    int host_cpus = 1;
+    int affinity_cpus = 1;           // sched_getaffinity 允许的核数
+    double cpu_quota = 0;            // cpu.max 配额（核），0 表示不限
+    uint64_t host_memory = 0;
+    uint64_t memory_limit = 0;       // memory.max，0 表示不限
+    std::string source = "host";     // cgroup2 / cgroup1 / env / host
+
+    // 派生值
+    int cpus = 1;                    // 可用核数（向下取整，至少 1）
+    int work_pool_concurrency = 1;   // 共享线程池并发上限
+    int decode_threads = 1;          // FFmpeg 软解线程数
+    int encode_threads = 1;          // x264/x265 线程数
+    int copy_workers = 1;            // 帧拷贝/转换并行度
+    uint64_t effective_memory = 0;   // min(memory.max, 物理内存)
+    uint64_t cache_budget = 0;       // 帧缓存预算（字节）
+    uint64_t decode_ahead_budget = 0;
+
+    // 按帧大小计算预解码深度 (2-16 帧)
+    int decodeAheadFrames(uint64_t frame_bytes) const {
+        if (frame_bytes == 0) return 4;
+        uint64_t frames = decode_ahead_budget / frame_bytes;
+        return (int)std::max<uint64_t>(2, std::min<uint64_t>(16, frames));
+    }
+
+    // 进程内只读取一次
+    static const ResourceLimits& get() {
+        static const ResourceLimits limits = detect();
+        return limits;
+    }
+
+    static ResourceLimits detect() {
+        ResourceLimits l;
+        unsigned hw = std::thread::hardware_concurrency();
+        l.host_cpus = hw > 0 ? (int)hw : 1;
+        l.affinity_cpus = l.host_cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            l.affinity_cpus = std::max(1, CPU_COUNT(&set));
+        }
+#endif
+        long pages = sysconf(_SC_PHYS_PAGES);
+        long page_size = sysconf(_SC_PAGE_SIZE);
+        if (pages > 0 && page_size > 0) l.host_memory = (uint64_t)pages * (uint64_t)page_size;
+
+        if (!readCgroupV2(&l)) readCgroupV1(&l);
+
+        if (const char* env = getenv("NATIVE_CPU_LIMIT")) {
+            double v = atof(env);
+            if (v > 0) {
+                l.cpu_quota = v;
+                l.source = "env";
+            }
+        }
+        if (const char* env = getenv("NATIVE_MEMORY_LIMIT_MB")) {
+            double v = atof(env);
+            if (v > 0) {
+                l.memory_limit = (uint64_t)(v * 1024 * 1024);
+                l.source = "env";
+            }
+        }
+
+        l.derive();
+        return l;
+    }
+
+private:
+    void derive() {
+        double available = affinity_cpus;
+        if (cpu_quota > 0) available = std::min(available, cpu_quota);
+        // 向下取整：1.5 核按 1 个线程算，宁可少开也不要触发节流
+        cpus = std::max(1, (int)std::floor(available + 1e-6));
+
+        work_pool_concurrency = cpus;
+        decode_threads = std::min(cpus, 16);
+        encode_threads = std::max(1, std::min(cpus, 8));
+        copy_workers = std::max(1, cpus / 2);
+
+        effective_memory = host_memory;
+        if (memory_limit > 0 && (effective_memory == 0 || memory_limit < effective_memory)) {
+            effective_memory = memory_limit;
+        }
+        const uint64_t gib = 1024ull * 1024 * 1024;
+        uint64_t base = effective_memory > 0 ? effective_memory : 4 * gib;
+        cache_budget = std::min<uint64_t>(base / 4, 2 * gib);
+        decode_ahead_budget = std::min<uint64_t>(base / 16, 512ull * 1024 * 1024);
+    }
+
+    static bool readFile(const std::string& path, std::string* out) {
+        std::ifstream in(path);
+        if (!in) return false;
+        std::getline(in, *out);
+        return true;
+    }
+
+    // /proc/self/cgroup 中某个控制器（v2 为空串）对应的路径
+    static std::string cgroupPath(const std::string& controller) {
+        std::ifstream in("/proc/self/cgroup");
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t a = line.find(':');
+            size_t b = line.find(':', a + 1);
+            if (a == std::string::npos || b == std::string::npos) continue;
+            std::string controllers = line.substr(a + 1, b - a - 1);
+            std::string path = line.substr(b + 1);
+            if (controller.empty()) {
+                if (line.compare(0, a, "0") == 0 && controllers.empty()) return path;
+                continue;
+            }
+            std::stringstream ss(controllers);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                if (item == controller) return path;
+            }
+        }
+        return "";
+    }
+
+    static std::string parentPath(const std::string& path) {
+        size_t pos = path.find_last_of('/');
+        if (pos == std::string::npos || pos == 0) return "/";
+        return path.substr(0, pos);
+    }
+
+    // 从进程所在 cgroup 逐级向上，取最严格的限制
+    static bool readCgroupV2(ResourceLimits* l) {
+        const char* roots[] = {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"};
+        std::string root;
+        for (const char* r : roots) {
+            if (access((std::string(r) + "/cgroup.controllers").c_str(), F_OK) == 0) {
+                root = r;
+                break;
+            }
+        }
+        if (root.empty()) return false;
+
+        std::string path = cgroupPath("");
+        if (path.empty()) path = "/";
+        bool found = false;
+        while (true) {
+            std::string dir = root + (path == "/" ? "" : path);
+            std::string value;
+            if (readFile(dir + "/cpu.max", &value)) {
+                found = true;
+                char quota[32] = {0};
+                double period = 0;
+                if (sscanf(value.c_str(), "%31s %lf", quota, &period) == 2 &&
+                    std::string(quota) != "max" && period > 0) {
+                    double cores = atof(quota) / period;
+                    if (l->cpu_quota == 0 || cores < l->cpu_quota) l->cpu_quota = cores;
+                }
+            }
+            if (readFile(dir + "/memory.max", &value)) {
+                found = true;
+                if (value != "max") {
+                    uint64_t bytes = strtoull(value.c_str(), nullptr, 10);
+                    if (bytes > 0 && (l->memory_limit == 0 || bytes < l->memory_limit)) l->memory_limit = bytes;
+                }
+            }
+            if (path == "/") break;
+            path = parentPath(path);
+        }
+        if (found) l->source = "cgroup2";
+        return found;
+    }
+
+    static bool readCgroupV1(ResourceLimits* l) {
+        bool found = false;
+        std::string value;
+
+        std::string cpu_path = cgroupPath("cpu");
+        const char* cpu_roots[] = {"/sys/fs/cgroup/cpu,cpuacct", "/sys/fs/cgroup/cpu"};
+        for (const char* root : cpu_roots) {
+            std::string quota_str, period_str;
+            std::string dir = std::string(root) + (cpu_path == "/" ? "" : cpu_path);
+            // 容器内通常挂载在控制器根目录
+            if (!readFile(dir + "/cpu.cfs_quota_us", &quota_str)) {
+                dir = root;
+                if (!readFile(dir + "/cpu.cfs_quota_us", &quota_str)) continue;
+            }
+            if (!readFile(dir + "/cpu.cfs_period_us", &period_str)) continue;
+            found = true;
+            double quota = atof(quota_str.c_str());
+            double period = atof(period_str.c_str());
+            if (quota > 0 && period > 0) l->cpu_quota = quota / period;
+            break;
+        }
+
+        std::string mem_path = cgroupPath("memory");
+        std::string dir = "/sys/fs/cgroup/memory" + (mem_path == "/" ? std::string() : mem_path);
+        if (readFile(dir + "/memory.limit_in_bytes", &value) ||
+            readFile("/sys/fs/cgroup/memory/memory.limit_in_bytes", &value)) {
+            found = true;
+            uint64_t bytes = strtoull(value.c_str(), nullptr, 10);
+            // 未设置限制时为接近 2^63 的值
+            if (bytes > 0 && bytes < (1ull << 62)) l->memory_limit = bytes;
+        }
+        if (found) l->source = "cgroup1";
+        return found;
+    }
+};
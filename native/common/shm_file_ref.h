@@ -0,0 +1,141 @@
+/**
+ * 共享内存环中的文件引用
+ * 帧数据已经在磁盘文件中（如未压缩的 YUV 参考片）时，生产者只在槽里写入
+ * (路径, 偏移, 长度)，并置 SHM_FLAG_FILE_REF；读者自行只读映射该文件，从页缓存直接读取。
+ * 8K 帧也只需很小的槽，读者读取时仅有一次复制
+ *
+ * 槽数据布局: [ShmFileRef][path_length 字节路径，不含结尾 0]
+ */
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct ShmFileRef {
+    static constexpr uint32_t kMagic = 0x46455246; // "FREF"
+
+    uint32_t magic;
+    uint32_t path_length;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t file_size;   // 发布时的文件大小，读者据此发现文件被替换
+
+    static size_t encodedSize(const std::string& path) { return sizeof(ShmFileRef) + path.size(); }
+
+    // 写入 dst，容量不足返回 0
+    static size_t encode(uint8_t* dst, size_t capacity, const std::string& path,
+                         uint64_t offset, uint64_t size, uint64_t file_size) {
+        size_t total = encodedSize(path);
+        if (total > capacity) return 0;
+        ShmFileRef ref;
+        ref.magic = kMagic;
+        ref.path_length = (uint32_t)path.size();
+        ref.offset = offset;
+        ref.size = size;
+        ref.file_size = file_size;
+        memcpy(dst, &ref, sizeof(ref));
+        memcpy(dst + sizeof(ref), path.data(), path.size());
+        return total;
+    }
+
+    static bool decode(const uint8_t* data, size_t size, ShmFileRef* ref, std::string* path) {
+        if (size < sizeof(ShmFileRef)) return false;
+        memcpy(ref, data, sizeof(ShmFileRef));
+        if (ref->magic != kMagic || sizeof(ShmFileRef) + ref->path_length > size) return false;
+        path->assign(reinterpret_cast<const char*>(data) + sizeof(ShmFileRef), ref->path_length);
+        return true;
+    }
+};
+
+/**
+ * 读者端的文件映射缓存，按路径保留最近使用的几个只读映射
+ * 非线程安全，由调用者所在线程独占
+ */
+class ShmFileMapCache {
+public:
+    explicit ShmFileMapCache(size_t max_files = 4) : max_files_(max_files) {}
+    ~ShmFileMapCache() { clear(); }
+
+    ShmFileMapCache(const ShmFileMapCache&) = delete;
+    ShmFileMapCache& operator=(const ShmFileMapCache&) = delete;
+
+    // 解析槽中的文件引用，返回帧数据指针（在下一次 resolve/clear 之前有效）
+    const uint8_t* resolve(const uint8_t* slot, size_t slot_size, uint64_t* frame_size) {
+        ShmFileRef ref;
+        std::string path;
+        if (!ShmFileRef::decode(slot, slot_size, &ref, &path)) return nullptr;
+
+        Mapping* mapping = find(path, ref.file_size);
+        if (!mapping) mapping = add(path);
+        if (!mapping || ref.offset + ref.size > mapping->size) return nullptr;
+
+        mapping->last_use = ++use_counter_;
+        *frame_size = ref.size;
+        return mapping->data + ref.offset;
+    }
+
+    void clear() {
+        for (Mapping& m : mappings_) munmap(m.data, m.size);
+        mappings_.clear();
+    }
+
+private:
+    struct Mapping {
+        std::string path;
+        uint8_t* data = nullptr;
+        size_t size = 0;
+        uint64_t last_use = 0;
+    };
+
+    size_t max_files_;
+    std::vector<Mapping> mappings_;
+    uint64_t use_counter_ = 0;
+
+    Mapping* find(const std::string& path, uint64_t file_size) {
+        for (size_t i = 0; i < mappings_.size(); i++) {
+            if (mappings_[i].path != path) continue;
+            if (mappings_[i].size == file_size) return &mappings_[i];
+            // 文件被改写或替换，重新映射
+            munmap(mappings_[i].data, mappings_[i].size);
+            mappings_.erase(mappings_.begin() + i);
+            return nullptr;
+        }
+        return nullptr;
+    }
+
+    Mapping* add(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return nullptr;
+        struct stat st;
+        void* ptr = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (ptr == MAP_FAILED) return nullptr;
+        madvise(ptr, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+        if (mappings_.size() >= max_files_) {
+            size_t oldest = 0;
+            for (size_t i = 1; i < mappings_.size(); i++) {
+                if (mappings_[i].last_use < mappings_[oldest].last_use) oldest = i;
+            }
+            munmap(mappings_[oldest].data, mappings_[oldest].size);
+            mappings_.erase(mappings_.begin() + oldest);
+        }
+
+        Mapping m;
+        m.path = path;
+        m.data = static_cast<uint8_t*>(ptr);
+        m.size = (size_t)st.st_size;
+        mappings_.push_back(m);
+        return &mappings_.back();
+    }
+};
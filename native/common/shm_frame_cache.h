@@ -0,0 +1,493 @@
+/**
+ * 跨进程共享的已解码帧缓存
+ * 预览和主视图等多个窗口同时显示同一片段时，一个窗口解码过的帧可以直接给其他窗口使用。
+ * 键为 (内容 id, pts)，槽大小固定（一帧），槽数由预算决定。
+ *
+ * - 索引无锁：每个槽即一个哈希表项，按键哈希定位后在 kProbe 个相邻项内线性探测
+ * - 每项一个 64 位控制字 [代数:32 | 引用数:24 | 状态:8]，读者 CAS 增加引用数（pin）后复制数据，
+ *   写者只能在引用数为 0 时把状态切到 WRITING（代数加一），读取中的帧不会被覆盖
+ * - 淘汰：探测窗口内优先空项，否则取最久未用且未被引用的项
+ * - 持有者崩溃时留下的引用或写入状态在 kLeaseMs 后可被回收；回收改变代数，迟到的 unpin 不生效
+ *
+ * 布局: [CacheHeader][Entry x slot_count][数据区 x slot_count]
+ */
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+class ShmFrameCache {
+public:
+    static constexpr uint32_t kMagic = 0x48434346; // "FCCH"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kAlign = 64;
+    static constexpr uint32_t kProbe = 8;
+    static constexpr uint64_t kLeaseMs = 5000;
+
+    enum State : uint64_t {
+        STATE_EMPTY = 0,
+        STATE_WRITING = 1,
+        STATE_READY = 2,
+    };
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t slot_count;
+        uint32_t slot_size;
+        uint64_t slot_stride;
+        uint64_t data_offset;
+        std::atomic<uint64_t> clock;      // 逻辑时钟，用于 LRU
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> misses;
+        std::atomic<uint64_t> inserts;
+        std::atomic<uint64_t> evictions;
+        std::atomic<uint64_t> rejected;   // 探测窗口内全部被引用或正在写入
+        std::atomic<uint64_t> reclaimed;  // 回收的过期引用
+    };
+
+    struct Entry {
+        std::atomic<uint64_t> ctl;
+        std::atomic<uint64_t> content;    // 内容 id 哈希
+        std::atomic<int64_t> pts_us;
+        std::atomic<uint64_t> last_use;
+        std::atomic<uint64_t> stamp_ms;   // 最近一次 pin 或开始写入的时间（CLOCK_MONOTONIC，跨进程可比）
+        double pts;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;
+        uint32_t size;
+        uint32_t stride;
+        uint32_t reserved;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "需要无锁 64 位原子操作");
+
+    // 命中时的帧信息
+    struct FrameInfo {
+        double pts;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;
+        uint32_t size;
+        uint32_t stride;
+    };
+
+    struct Stats {
+        uint32_t slot_count = 0;
+        uint32_t slot_size = 0;
+        uint32_t used = 0;
+        uint32_t pinned = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t inserts = 0;
+        uint64_t evictions = 0;
+        uint64_t rejected = 0;
+        uint64_t reclaimed = 0;
+    };
+
+    enum PutResult {
+        PUT_OK = 0,
+        PUT_EXISTS,       // 其他进程已缓存同一帧
+        PUT_TOO_LARGE,
+        PUT_BUSY,         // 探测窗口内没有可替换的项
+    };
+
+    ShmFrameCache() = default;
+    ~ShmFrameCache() { close(); }
+
+    ShmFrameCache(const ShmFrameCache&) = delete;
+    ShmFrameCache& operator=(const ShmFrameCache&) = delete;
+
+    static size_t alignUp(size_t v) { return (v + kAlign - 1) & ~(kAlign - 1); }
+
+    static size_t totalSize(uint32_t slot_count, uint32_t slot_size) {
+        return dataOffset(slot_count) + (size_t)slot_count * alignUp(slot_size);
+    }
+
+    // 预算内能容纳的槽数，至少 kProbe 个
+    static uint32_t slotsForBudget(uint64_t budget, uint32_t slot_size) {
+        uint64_t n = budget / (alignUp(slot_size) + sizeof(Entry));
+        return (uint32_t)std::max<uint64_t>(kProbe, std::min<uint64_t>(n, 1u << 20));
+    }
+
+    static std::string normalizeName(const std::string& name) {
+        return (!name.empty() && name[0] == '/') ? name : "/" + name;
+    }
+
+    // 内容 id 的 64 位 FNV-1a 哈希
+    static uint64_t contentKey(const std::string& id) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : id) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    static int64_t ptsKey(double pts) { return (int64_t)std::llround(pts * 1e6); }
+
+    // 创建，创建者关闭时删除名称（已打开的进程不受影响）
+    // exclusive 时名称已存在则失败，errno 为 EEXIST
+    bool create(const std::string& name, uint32_t slot_count, uint32_t slot_size, bool exclusive = false) {
+        close();
+        name_ = normalizeName(name);
+        size_ = totalSize(slot_count, slot_size);
+
+        fd_ = shm_open(name_.c_str(), O_CREAT | O_RDWR | (exclusive ? O_EXCL : 0), 0666);
+        if (fd_ == -1) return false;
+        owner_ = true;   // 初始化失败时 close 删除名称
+        if (ftruncate(fd_, size_) == -1) {
+            close();
+            return false;
+        }
+        if (!map()) return false;
+
+        memset(base_, 0, dataOffset(slot_count));
+        CacheHeader* h = header();
+        h->slot_count = slot_count;
+        h->slot_size = slot_size;
+        h->slot_stride = alignUp(slot_size);
+        h->data_offset = dataOffset(slot_count);
+        h->version = kVersion;
+        std::atomic_thread_fence(std::memory_order_release);
+        h->magic = kMagic;
+        return true;
+    }
+
+    // 打开已存在的缓存（其他窗口）
+    bool open(const std::string& name) {
+        close();
+        name_ = normalizeName(name);
+        fd_ = shm_open(name_.c_str(), O_RDWR, 0666);
+        if (fd_ == -1) return false;
+
+        struct stat st;
+        if (fstat(fd_, &st) == -1 || (size_t)st.st_size < sizeof(CacheHeader)) {
+            close();
+            return false;
+        }
+        size_ = st.st_size;
+        if (!map()) return false;
+
+        CacheHeader* h = header();
+        if (h->magic != kMagic || h->version != kVersion ||
+            totalSize(h->slot_count, h->slot_size) > size_) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // 各窗口各自调用：已存在则打开，否则创建。两个进程同时创建时只有一个成功，另一个等待初始化完成后打开
+    bool openOrCreate(const std::string& name, uint32_t slot_count, uint32_t slot_size) {
+        for (int attempt = 0; attempt < 100; attempt++) {
+            if (open(name)) return true;
+            if (create(name, slot_count, slot_size, true)) return true;
+            if (errno != EEXIST) return false;
+            usleep(2000);
+        }
+        return false;
+    }
+
+    void close() {
+        if (base_) {
+            munmap(base_, size_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        if (owner_) {
+            shm_unlink(name_.c_str());
+            owner_ = false;
+        }
+        size_ = 0;
+    }
+
+    bool isOpen() const { return base_ != nullptr; }
+    const std::string& name() const { return name_; }
+    uint32_t slotSize() const { return header()->slot_size; }
+
+    /**
+     * 查找并复制一帧到 copy_to，未命中返回 false
+     * pin 期间复制，写者不会覆盖该项
+     */
+    bool get(uint64_t content, double pts, FrameInfo* info, uint8_t* copy_to, size_t capacity) {
+        return getWith(content, pts, info, [&](const uint8_t* src) {
+            if (copy_to) memcpy(copy_to, src, std::min<size_t>(info->size, capacity));
+        });
+    }
+
+    // 命中时在 pin 期间以帧数据调用 consume(src)，consume 不应长时间占用
+    template <typename Consume>
+    bool getWith(uint64_t content, double pts, FrameInfo* info, Consume&& consume) {
+        Pin pin = pinFrame(content, pts);
+        if (!pin.entry) return false;
+        *info = pin.info;
+        consume(static_cast<const uint8_t*>(data(pin.index)));
+        unpin(pin);
+        return true;
+    }
+
+    // 只检查是否存在，不计入命中统计
+    bool contains(uint64_t content, double pts) const {
+        return findReady(content, ptsKey(pts)) != nullptr;
+    }
+
+    /**
+     * 写入一帧。data 为空时由 fill(dst) 回调写入槽（如直接从解码帧转换）
+     */
+    template <typename Fill>
+    PutResult putWith(uint64_t content, double pts, uint32_t size, uint32_t width, uint32_t height,
+                      uint32_t format, uint32_t stride, Fill&& fill) {
+        CacheHeader* h = header();
+        if (size > h->slot_size) return PUT_TOO_LARGE;
+        int64_t key = ptsKey(pts);
+        if (findReady(content, key)) return PUT_EXISTS;
+
+        uint32_t index;
+        uint64_t gen;
+        if (!claim(content, key, &index, &gen)) {
+            h->rejected.fetch_add(1, std::memory_order_relaxed);
+            return PUT_BUSY;
+        }
+
+        Entry* e = entry(index);
+        e->content.store(content, std::memory_order_relaxed);
+        e->pts_us.store(key, std::memory_order_relaxed);
+        e->pts = pts;
+        e->width = width;
+        e->height = height;
+        e->format = format;
+        e->size = size;
+        e->stride = stride;
+        fill(data(index));
+        e->last_use.store(h->clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+        e->ctl.store(makeCtl(gen, 0, STATE_READY), std::memory_order_release);
+        h->inserts.fetch_add(1, std::memory_order_relaxed);
+        return PUT_OK;
+    }
+
+    PutResult put(uint64_t content, double pts, const uint8_t* src, uint32_t size, uint32_t width,
+                  uint32_t height, uint32_t format, uint32_t stride) {
+        return putWith(content, pts, size, width, height, format, stride,
+                       [&](uint8_t* dst) { memcpy(dst, src, size); });
+    }
+
+    // 删除某一内容的全部帧（如文件被替换），被引用的项跳过
+    uint32_t invalidate(uint64_t content) {
+        CacheHeader* h = header();
+        uint32_t removed = 0;
+        for (uint32_t i = 0; i < h->slot_count; i++) {
+            Entry* e = entry(i);
+            uint64_t c = e->ctl.load(std::memory_order_acquire);
+            if (state(c) != STATE_READY || refs(c) != 0) continue;
+            if (e->content.load(std::memory_order_relaxed) != content) continue;
+            if (e->ctl.compare_exchange_strong(c, makeCtl(gen(c) + 1, 0, STATE_EMPTY), std::memory_order_acq_rel)) {
+                removed++;
+            }
+        }
+        return removed;
+    }
+
+    Stats stats() const {
+        const CacheHeader* h = header();
+        Stats s;
+        s.slot_count = h->slot_count;
+        s.slot_size = h->slot_size;
+        for (uint32_t i = 0; i < h->slot_count; i++) {
+            uint64_t c = entry(i)->ctl.load(std::memory_order_relaxed);
+            if (state(c) == STATE_READY) s.used++;
+            if (refs(c) > 0) s.pinned++;
+        }
+        s.hits = h->hits.load(std::memory_order_relaxed);
+        s.misses = h->misses.load(std::memory_order_relaxed);
+        s.inserts = h->inserts.load(std::memory_order_relaxed);
+        s.evictions = h->evictions.load(std::memory_order_relaxed);
+        s.rejected = h->rejected.load(std::memory_order_relaxed);
+        s.reclaimed = h->reclaimed.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    // 已 pin 的项，供 get 内部使用
+    struct Pin {
+        Entry* entry = nullptr;
+        uint32_t index = 0;
+        uint64_t gen = 0;
+        FrameInfo info;
+    };
+
+    std::string name_;
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    bool owner_ = false;
+
+    static constexpr uint64_t kRefOne = 1ULL << 8;
+
+    static uint64_t makeCtl(uint64_t gen, uint64_t refs, uint64_t state) {
+        return (gen << 32) | ((refs & 0xFFFFFF) << 8) | state;
+    }
+    static uint64_t gen(uint64_t c) { return c >> 32; }
+    static uint64_t refs(uint64_t c) { return (c >> 8) & 0xFFFFFF; }
+    static uint64_t state(uint64_t c) { return c & 0xFF; }
+
+    static size_t dataOffset(uint32_t slot_count) {
+        return alignUp(sizeof(CacheHeader)) + alignUp((size_t)slot_count * sizeof(Entry));
+    }
+
+    static uint64_t nowMs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+    }
+
+    static uint64_t bucketHash(uint64_t content, int64_t pts_us) {
+        uint64_t x = content ^ ((uint64_t)pts_us * 0x9e3779b97f4a7c15ULL);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    bool map() {
+        void* ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (ptr == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base_ = static_cast<uint8_t*>(ptr);
+        return true;
+    }
+
+    CacheHeader* header() const { return reinterpret_cast<CacheHeader*>(base_); }
+
+    Entry* entry(uint32_t index) const {
+        return reinterpret_cast<Entry*>(base_ + alignUp(sizeof(CacheHeader))) + index;
+    }
+
+    uint8_t* data(uint32_t index) const {
+        return base_ + header()->data_offset + (size_t)index * header()->slot_stride;
+    }
+
+    const Entry* findReady(uint64_t content, int64_t key) const {
+        const CacheHeader* h = header();
+        uint64_t bucket = bucketHash(content, key);
+        for (uint32_t p = 0; p < kProbe && p < h->slot_count; p++) {
+            const Entry* e = entry((uint32_t)((bucket + p) % h->slot_count));
+            if (state(e->ctl.load(std::memory_order_acquire)) == STATE_READY &&
+                e->content.load(std::memory_order_relaxed) == content &&
+                e->pts_us.load(std::memory_order_relaxed) == key) {
+                return e;
+            }
+        }
+        return nullptr;
+    }
+
+    Pin pinFrame(uint64_t content, double pts) {
+        CacheHeader* h = header();
+        int64_t key = ptsKey(pts);
+        uint64_t bucket = bucketHash(content, key);
+        for (uint32_t p = 0; p < kProbe && p < h->slot_count; p++) {
+            uint32_t index = (uint32_t)((bucket + p) % h->slot_count);
+            Entry* e = entry(index);
+            uint64_t c = e->ctl.load(std::memory_order_acquire);
+            while (state(c) == STATE_READY && e->content.load(std::memory_order_relaxed) == content &&
+                   e->pts_us.load(std::memory_order_relaxed) == key) {
+                // 先更新时间戳再 CAS，其他进程看到引用数时也能看到新的时间戳，不会误判为过期
+                e->stamp_ms.store(nowMs(), std::memory_order_relaxed);
+                // 代数不变时 CAS 成功，说明上面读到的键属于这一版本
+                if (e->ctl.compare_exchange_weak(c, c + kRefOne, std::memory_order_acq_rel)) {
+                    e->last_use.store(h->clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+                    h->hits.fetch_add(1, std::memory_order_relaxed);
+                    Pin pin;
+                    pin.entry = e;
+                    pin.index = index;
+                    pin.gen = gen(c);
+                    pin.info.pts = e->pts;
+                    pin.info.width = e->width;
+                    pin.info.height = e->height;
+                    pin.info.format = e->format;
+                    pin.info.size = e->size;
+                    pin.info.stride = e->stride;
+                    return pin;
+                }
+            }
+        }
+        h->misses.fetch_add(1, std::memory_order_relaxed);
+        return Pin();
+    }
+
+    void unpin(const Pin& pin) {
+        uint64_t c = pin.entry->ctl.load(std::memory_order_relaxed);
+        // 已被当作过期引用回收时代数已变，不再修改
+        while (gen(c) == pin.gen && refs(c) > 0) {
+            if (pin.entry->ctl.compare_exchange_weak(c, c - kRefOne, std::memory_order_acq_rel)) return;
+        }
+    }
+
+    // 在探测窗口内取得一个可写项
+    bool claim(uint64_t content, int64_t key, uint32_t* out_index, uint64_t* out_gen) {
+        CacheHeader* h = header();
+        uint64_t bucket = bucketHash(content, key);
+        uint64_t now = nowMs();
+
+        for (int attempt = 0; attempt < 4; attempt++) {
+            int victim = -1;
+            uint64_t victim_ctl = 0;
+            uint64_t oldest = UINT64_MAX;
+            for (uint32_t p = 0; p < kProbe && p < h->slot_count; p++) {
+                uint32_t index = (uint32_t)((bucket + p) % h->slot_count);
+                Entry* e = entry(index);
+                uint64_t c = e->ctl.load(std::memory_order_acquire);
+                bool stale = state(c) != STATE_EMPTY && (refs(c) > 0 || state(c) == STATE_WRITING) &&
+                             e->stamp_ms.load(std::memory_order_relaxed) + kLeaseMs < now;
+                if (state(c) == STATE_EMPTY) {
+                    victim = (int)index;
+                    victim_ctl = c;
+                    break;
+                }
+                if ((state(c) == STATE_READY && refs(c) == 0) || stale) {
+                    uint64_t used = stale ? 0 : e->last_use.load(std::memory_order_relaxed);
+                    if (used < oldest) {
+                        oldest = used;
+                        victim = (int)index;
+                        victim_ctl = c;
+                    }
+                }
+            }
+            if (victim < 0) return false;
+
+            Entry* e = entry((uint32_t)victim);
+            uint64_t next_gen = gen(victim_ctl) + 1;
+            e->stamp_ms.store(now, std::memory_order_relaxed);
+            if (e->ctl.compare_exchange_strong(victim_ctl, makeCtl(next_gen, 0, STATE_WRITING),
+                                               std::memory_order_acq_rel)) {
+                if (state(victim_ctl) == STATE_READY && refs(victim_ctl) == 0) {
+                    h->evictions.fetch_add(1, std::memory_order_relaxed);
+                } else if (state(victim_ctl) != STATE_EMPTY) {
+                    h->reclaimed.fetch_add(1, std::memory_order_relaxed);
+                }
+                *out_index = (uint32_t)victim;
+                *out_gen = next_gen;
+                return true;
+            }
+            // 与其他写者或读者竞争失败，重新选择
+        }
+        return false;
+    }
+};
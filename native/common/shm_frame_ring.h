@@ -0,0 +1,381 @@
+/**
+ * 共享内存帧环形缓冲
+ * 单生产者、多消费者，跨进程使用。每个槽带序号（seqlock），读者可以检测被覆盖的帧
+ * 除原始帧外也可承载压缩数据包（format 为 SHM_PACKET_*，见 flags）
+ *
+ * 布局: [RingHeader][SlotHeader + 数据][SlotHeader + 数据]...
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+// 像素格式
+enum ShmPixelFormat : uint32_t {
+    SHM_PIXEL_NV12 = 0,
+    SHM_PIXEL_RGB24 = 1,
+    SHM_PIXEL_RGBA = 2,
+    SHM_PIXEL_I420 = 3,
+
+    // 压缩数据包，width/height 为编码尺寸
+    SHM_PACKET_H264_ANNEXB = 0x100,
+    SHM_PACKET_H264_AVCC = 0x101,
+    SHM_PACKET_HEVC_ANNEXB = 0x102,
+    SHM_PACKET_HEVC_HVCC = 0x103,
+};
+
+// 槽标志
+enum ShmSlotFlags : uint32_t {
+    SHM_FLAG_KEYFRAME = 1 << 0,
+    SHM_FLAG_CODEC_CONFIG = 1 << 1,   // 数据为 avcC/hvcC 解码器配置而非数据包
+    SHM_FLAG_DISCONTINUITY = 1 << 2,  // seek 之后的第一个包
+    SHM_FLAG_FILE_REF = 1 << 3,       // 数据为 ShmFileRef（见 shm_file_ref.h），帧在磁盘文件中
+    SHM_FLAG_FORMAT_CHANGE = 1 << 4,  // 宽高或格式与上一帧不同（endWrite 自动设置）
+};
+
+class ShmFrameRing {
+public:
+    static constexpr uint32_t kMagic = 0x474E5246; // "FRNG"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kAlign = 64;
+
+    struct RingHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t slot_count;
+        uint32_t slot_size;            // 每个槽的数据区大小
+        uint64_t slot_stride;          // 槽头 + 数据区（对齐后）
+        std::atomic<uint64_t> write_seq; // 已发布的帧数
+        std::atomic<uint32_t> notify;    // 每发布一帧加一，用于 futex 唤醒
+        uint32_t owner_pid;              // 生产者进程，用于回收崩溃遗留的名称
+    };
+
+    struct SlotHeader {
+        std::atomic<uint64_t> seq;     // 2n+1: 正在写入第 n 帧; 2n+2: 第 n 帧已就绪
+        double pts;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;
+        uint32_t size;
+        uint32_t stride;               // 行跨度（NV12 为 Y 平面跨度），数据包为 0
+        uint32_t flags;                // ShmSlotFlags
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "需要无锁 64 位原子操作");
+
+    // 读取到的帧信息
+    struct FrameInfo {
+        uint64_t seq;
+        double pts;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;
+        uint32_t size;
+        uint32_t stride;
+        uint32_t flags;
+    };
+
+    enum ReadResult {
+        READ_OK = 0,
+        READ_EMPTY,        // 没有新帧
+        READ_OVERWRITTEN,  // 读取过程中帧被覆盖
+    };
+
+    ShmFrameRing() = default;
+    ~ShmFrameRing() { close(); }
+
+    ShmFrameRing(const ShmFrameRing&) = delete;
+    ShmFrameRing& operator=(const ShmFrameRing&) = delete;
+
+    static size_t alignUp(size_t v) { return (v + kAlign - 1) & ~(kAlign - 1); }
+
+    static size_t totalSize(uint32_t slot_count, uint32_t slot_size) {
+        return alignUp(sizeof(RingHeader)) +
+               (size_t)slot_count * (alignUp(sizeof(SlotHeader)) + alignUp(slot_size));
+    }
+
+    static std::string normalizeName(const std::string& name) {
+        return (!name.empty() && name[0] == '/') ? name : "/" + name;
+    }
+
+    // 创建（生产者）。名称已被其他生产者使用时失败，errno 为 EEXIST：重新初始化会打乱正在读取的
+    // 消费者，关闭时还会删除对方的名称。生产者进程已不存在（崩溃遗留）的名称先删除再创建
+    bool create(const std::string& name, uint32_t slot_count, uint32_t slot_size) {
+        close();
+        name_ = normalizeName(name);
+        size_ = totalSize(slot_count, slot_size);
+
+        fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+        if (fd_ == -1 && errno == EEXIST && removeStale(name_)) {
+            fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+        }
+        if (fd_ == -1) return false;
+        owner_ = true;   // 初始化失败时 close 删除名称
+        if (ftruncate(fd_, size_) == -1) {
+            close();
+            return false;
+        }
+        if (!map()) return false;
+
+        memset(base_, 0, alignUp(sizeof(RingHeader)));
+        RingHeader* h = header();
+        h->slot_count = slot_count;
+        h->slot_size = slot_size;
+        h->slot_stride = alignUp(sizeof(SlotHeader)) + alignUp(slot_size);
+        h->write_seq.store(0);
+        h->notify.store(0);
+        h->owner_pid = (uint32_t)getpid();
+        for (uint32_t i = 0; i < slot_count; i++) {
+            slotHeader(i)->seq.store(0);
+        }
+        h->version = kVersion;
+        std::atomic_thread_fence(std::memory_order_release);
+        h->magic = kMagic;
+        last_width_ = last_height_ = 0;
+        last_format_ = 0;
+        return true;
+    }
+
+    // 打开已存在的环（消费者）
+    bool open(const std::string& name) {
+        close();
+        name_ = normalizeName(name);
+        fd_ = shm_open(name_.c_str(), O_RDWR, 0666);
+        if (fd_ == -1) return false;
+
+        struct stat st;
+        if (fstat(fd_, &st) == -1 || (size_t)st.st_size < sizeof(RingHeader)) {
+            close();
+            return false;
+        }
+        size_ = st.st_size;
+        if (!map()) return false;
+
+        RingHeader* h = header();
+        if (h->magic != kMagic || h->version != kVersion ||
+            totalSize(h->slot_count, h->slot_size) > size_) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base_) {
+            munmap(base_, size_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        if (owner_) {
+            shm_unlink(name_.c_str());
+            owner_ = false;
+        }
+        size_ = 0;
+    }
+
+    bool isOpen() const { return base_ != nullptr; }
+    bool isOwner() const { return owner_; }
+    const std::string& name() const { return name_; }
+    uint32_t slotCount() const { return header()->slot_count; }
+    uint32_t slotSize() const { return header()->slot_size; }
+    uint64_t writeSeq() const { return header()->write_seq.load(std::memory_order_acquire); }
+
+    // 取得下一个写入槽（生产者可以直接写入数据区，避免额外拷贝）
+    uint8_t* beginWrite() {
+        RingHeader* h = header();
+        uint64_t seq = h->write_seq.load(std::memory_order_relaxed);
+        SlotHeader* slot = slotHeader(seq % h->slot_count);
+        slot->seq.store(seq * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return slotData(seq % h->slot_count);
+    }
+
+    // 发布 beginWrite 写入的帧。与上一帧尺寸或格式不同时加上 SHM_FLAG_FORMAT_CHANGE，
+    // 消费者据此在处理该帧之前调整纹理和缓冲（环本身的槽大小不变）
+    void endWrite(uint32_t width, uint32_t height, uint32_t format, uint32_t size,
+                  uint32_t stride, double pts, uint32_t flags = 0) {
+        RingHeader* h = header();
+        uint64_t seq = h->write_seq.load(std::memory_order_relaxed);
+        if (!(flags & SHM_FLAG_CODEC_CONFIG)) {
+            if (last_width_ != 0 &&
+                (width != last_width_ || height != last_height_ || format != last_format_)) {
+                flags |= SHM_FLAG_FORMAT_CHANGE;
+            }
+            last_width_ = width;
+            last_height_ = height;
+            last_format_ = format;
+        }
+        SlotHeader* slot = slotHeader(seq % h->slot_count);
+        slot->pts = pts;
+        slot->width = width;
+        slot->height = height;
+        slot->format = format;
+        slot->size = size;
+        slot->stride = stride;
+        slot->flags = flags;
+        slot->seq.store(seq * 2 + 2, std::memory_order_release);
+        h->write_seq.store(seq + 1, std::memory_order_release);
+        h->notify.fetch_add(1, std::memory_order_release);
+        wake();
+    }
+
+    // 复制一帧到环中
+    bool write(const uint8_t* data, uint32_t size, uint32_t width, uint32_t height,
+               uint32_t format, uint32_t stride, double pts, uint32_t flags = 0) {
+        if (size > header()->slot_size) return false;
+        uint8_t* dst = beginWrite();
+        memcpy(dst, data, size);
+        endWrite(width, height, format, size, stride, pts, flags);
+        return true;
+    }
+
+    // 读取第 seq 帧。read_seq 落后超过槽数时调用者应跳到 oldestReadable()
+    // copy_to 为空时只取帧信息，数据指针通过 slotData 获得（调用者需再次 validate）
+    ReadResult read(uint64_t seq, FrameInfo* info, uint8_t* copy_to, size_t copy_capacity) {
+        RingHeader* h = header();
+        if (seq >= h->write_seq.load(std::memory_order_acquire)) return READ_EMPTY;
+
+        uint32_t index = seq % h->slot_count;
+        SlotHeader* slot = slotHeader(index);
+        uint64_t expected = seq * 2 + 2;
+        if (slot->seq.load(std::memory_order_acquire) != expected) return READ_OVERWRITTEN;
+
+        info->seq = seq;
+        info->pts = slot->pts;
+        info->width = slot->width;
+        info->height = slot->height;
+        info->format = slot->format;
+        info->size = slot->size;
+        info->stride = slot->stride;
+        info->flags = slot->flags;
+
+        if (copy_to) {
+            size_t n = info->size < copy_capacity ? info->size : copy_capacity;
+            memcpy(copy_to, slotData(index), n);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) != expected) return READ_OVERWRITTEN;
+        return READ_OK;
+    }
+
+    // 读取后确认槽未被覆盖（零拷贝读取时使用）
+    bool validate(uint64_t seq) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const SlotHeader* slot = slotHeader(seq % header()->slot_count);
+        return slot->seq.load(std::memory_order_relaxed) == seq * 2 + 2;
+    }
+
+    // 仍可读取的最旧帧序号
+    uint64_t oldestReadable() const {
+        uint64_t w = writeSeq();
+        uint32_t n = header()->slot_count;
+        // 留出一个槽给正在写入的帧
+        return w > n - 1 ? w - (n - 1) : 0;
+    }
+
+    // 等待新帧，超时返回 false
+    bool waitForFrame(uint64_t seq, int timeout_ms) {
+        RingHeader* h = header();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (h->write_seq.load(std::memory_order_acquire) <= seq) {
+            uint32_t observed = h->notify.load(std::memory_order_acquire);
+            if (h->write_seq.load(std::memory_order_acquire) > seq) break;
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) return false;
+            auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now);
+#ifdef __linux__
+            struct timespec ts;
+            ts.tv_sec = remaining.count() / 1000000;
+            ts.tv_nsec = (remaining.count() % 1000000) * 1000;
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&h->notify), FUTEX_WAIT, observed, &ts,
+                    nullptr, 0);
+#else
+            (void)observed;
+            std::this_thread::sleep_for(std::min(remaining, std::chrono::microseconds(1000)));
+#endif
+        }
+        return true;
+    }
+
+    uint8_t* slotData(uint32_t index) const {
+        return reinterpret_cast<uint8_t*>(slotHeader(index)) + alignUp(sizeof(SlotHeader));
+    }
+
+private:
+    std::string name_;
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    bool owner_ = false;
+
+    // 生产者最近发布的帧几何，用于设置 SHM_FLAG_FORMAT_CHANGE
+    uint32_t last_width_ = 0;
+    uint32_t last_height_ = 0;
+    uint32_t last_format_ = 0;
+
+    // 已初始化的环且生产者进程已退出时删除名称；正在初始化（magic 未写入）或无法判断时保留
+    static bool removeStale(const std::string& name) {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd == -1) return errno == ENOENT;
+        struct stat st;
+        bool stale = false;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(RingHeader)) {
+            void* ptr = mmap(nullptr, sizeof(RingHeader), PROT_READ, MAP_SHARED, fd, 0);
+            if (ptr != MAP_FAILED) {
+                const RingHeader* h = static_cast<const RingHeader*>(ptr);
+                stale = h->magic == kMagic && h->owner_pid != 0 &&
+                        kill((pid_t)h->owner_pid, 0) == -1 && errno == ESRCH;
+                munmap(ptr, sizeof(RingHeader));
+            }
+        }
+        ::close(fd);
+        if (stale) shm_unlink(name.c_str());
+        errno = EEXIST;
+        return stale;
+    }
+
+    bool map() {
+        void* ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (ptr == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base_ = static_cast<uint8_t*>(ptr);
+        return true;
+    }
+
+    RingHeader* header() const { return reinterpret_cast<RingHeader*>(base_); }
+
+    SlotHeader* slotHeader(uint32_t index) const {
+        return reinterpret_cast<SlotHeader*>(base_ + alignUp(sizeof(RingHeader)) +
+                                             (size_t)index * header()->slot_stride);
+    }
+
+    void wake() {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&header()->notify), FUTEX_WAKE, INT32_MAX,
+                nullptr, nullptr, 0);
+#endif
+    }
+};
@@ -0,0 +1,387 @@
+/**
+ * 进程级工作窃取线程池
+ * 每个工作线程有自己的分优先级双端队列：本线程从尾部取（LIFO，缓存友好），
+ * 空闲线程从其他队列头部窃取（FIFO）。优先级从高到低依次为实时呈现、解码、后台，
+ * 并发上限对所有任务生效，后台任务最多占用 (上限 - 1) 个线程，保证实时任务总有线程可用。
+ *
+ * 只适合放短任务（一帧的拷贝、分析、转换等），长期运行的循环仍使用独立线程
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "resource_limits.h"
+
+enum WorkPriority : int {
+    WORK_REALTIME = 0,    // 呈现路径：帧拷贝、上屏前的转换
+    WORK_DECODE = 1,      // 解码与解码后处理
+    WORK_BACKGROUND = 2,  // 缩略图、转码、分析
+    WORK_PRIORITY_COUNT = 3,
+};
+
+class WorkPool {
+public:
+    using Task = std::function<void()>;
+
+    struct ClassMetrics {
+        uint64_t queued = 0;
+        uint64_t running = 0;
+        uint64_t completed = 0;
+        double avg_wait_ms = 0;     // 入队到开始执行
+    };
+
+    struct Metrics {
+        int threads = 0;
+        int concurrency_limit = 0;
+        int active = 0;
+        uint64_t steals = 0;
+        double utilization = 0;     // 距上次采样的忙碌时间 / (时长 × 并发上限)
+        ClassMetrics classes[WORK_PRIORITY_COUNT];
+    };
+
+    explicit WorkPool(int threads) {
+        if (threads < 1) threads = 1;
+        limit_ = threads;
+        background_limit_ = std::max(1, threads - 1);
+        workers_.reserve(threads);
+        for (int i = 0; i < threads; i++) {
+            workers_.emplace_back(new Worker());
+        }
+        last_sample_ = std::chrono::steady_clock::now();
+        for (int i = 0; i < threads; i++) {
+            workers_[i]->thread = std::thread(&WorkPool::workerLoop, this, i);
+        }
+    }
+
+    ~WorkPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        sleep_cond_.notify_all();
+        for (auto& worker : workers_) {
+            if (worker->thread.joinable()) worker->thread.join();
+        }
+    }
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    // 进程内共享的线程池。两个 addon 各自编译了这份代码，由先加载的一方创建，
+    // 另一方通过 adopt() 使用同一个实例（见 work_pool_binding.h）
+    static WorkPool& shared() {
+        WorkPool* pool = sharedSlot().load(std::memory_order_acquire);
+        if (pool) return *pool;
+
+        static std::mutex create_mutex;
+        std::lock_guard<std::mutex> lock(create_mutex);
+        pool = sharedSlot().load(std::memory_order_acquire);
+        if (!pool) {
+            // 按容器配额而不是宿主机核数创建线程，避免被 CFS 节流
+            // 有意不释放：进程退出前可能仍有其他 addon 在使用
+            pool = new WorkPool(ResourceLimits::get().work_pool_concurrency);
+            sharedSlot().store(pool, std::memory_order_release);
+        }
+        return *pool;
+    }
+
+    // 使用其他 addon 创建的实例，须在本 addon 第一次调用 shared() 之前
+    static void adopt(WorkPool* pool) {
+        sharedSlot().store(pool, std::memory_order_release);
+    }
+
+    static bool hasShared() {
+        return sharedSlot().load(std::memory_order_acquire) != nullptr;
+    }
+
+    void submit(WorkPriority priority, Task task) {
+        int index = currentWorkerIndex();
+        if (index < 0) {
+            index = (int)(next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size());
+        }
+        Worker& worker = *workers_[index];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.queues[priority].push_back(Item{std::move(task), std::chrono::steady_clock::now()});
+        }
+        queued_[priority].fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            generation_++;
+        }
+        sleep_cond_.notify_one();
+    }
+
+    // 在工作线程中等待其他任务时调用，避免线程池任务互相等待造成死锁
+    bool helpOne() {
+        int index = currentWorkerIndex();
+        if (index < 0) return false;
+        Item item;
+        int priority;
+        if (!findWork(index, true, &item, &priority)) return false;
+        runItem(item, priority);
+        return true;
+    }
+
+    // 设置全局并发上限 (1 - 线程数)
+    void setConcurrencyLimit(int limit) {
+        limit = std::max(1, std::min(limit, (int)workers_.size()));
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            limit_ = limit;
+            background_limit_ = std::max(1, limit - 1);
+            generation_++;
+        }
+        sleep_cond_.notify_all();
+    }
+
+    int concurrencyLimit() const {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        return limit_;
+    }
+
+    int threadCount() const { return (int)workers_.size(); }
+
+    Metrics metrics() {
+        Metrics m;
+        m.threads = (int)workers_.size();
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            m.concurrency_limit = limit_;
+            m.active = active_;
+        }
+        m.steals = steals_.load(std::memory_order_relaxed);
+        for (int p = 0; p < WORK_PRIORITY_COUNT; p++) {
+            ClassMetrics& c = m.classes[p];
+            c.queued = queued_[p].load(std::memory_order_relaxed);
+            c.running = running_[p].load(std::memory_order_relaxed);
+            c.completed = completed_[p].load(std::memory_order_relaxed);
+            uint64_t started = started_[p].load(std::memory_order_relaxed);
+            if (started > 0) {
+                c.avg_wait_ms = wait_us_[p].load(std::memory_order_relaxed) / 1000.0 / started;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(sample_mutex_);
+        auto now = std::chrono::steady_clock::now();
+        uint64_t busy = busy_us_.load(std::memory_order_relaxed);
+        double window_us = std::chrono::duration<double, std::micro>(now - last_sample_).count();
+        if (window_us > 0) {
+            m.utilization = std::min(1.0, (busy - last_busy_us_) / (window_us * m.concurrency_limit));
+        }
+        last_sample_ = now;
+        last_busy_us_ = busy;
+        return m;
+    }
+
+private:
+    struct Item {
+        Task task;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Item> queues[WORK_PRIORITY_COUNT];
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<uint64_t> next_worker_{0};
+
+    mutable std::mutex sleep_mutex_;
+    std::condition_variable sleep_cond_;
+    uint64_t generation_ = 0;    // 入队、完成或修改上限时递增，空闲线程据此判断是否需要重新查找
+    int active_ = 0;
+    int limit_ = 1;
+    int background_limit_ = 1;
+    bool stopping_ = false;
+    std::atomic<int> running_background_{0};
+
+    std::atomic<uint64_t> queued_[WORK_PRIORITY_COUNT] = {};
+    std::atomic<uint64_t> running_[WORK_PRIORITY_COUNT] = {};
+    std::atomic<uint64_t> started_[WORK_PRIORITY_COUNT] = {};
+    std::atomic<uint64_t> completed_[WORK_PRIORITY_COUNT] = {};
+    std::atomic<uint64_t> wait_us_[WORK_PRIORITY_COUNT] = {};
+    std::atomic<uint64_t> busy_us_{0};
+    std::atomic<uint64_t> steals_{0};
+
+    std::mutex sample_mutex_;
+    std::chrono::steady_clock::time_point last_sample_;
+    uint64_t last_busy_us_ = 0;
+
+    static std::atomic<WorkPool*>& sharedSlot() {
+        static std::atomic<WorkPool*> slot{nullptr};
+        return slot;
+    }
+
+    // 当前线程在本线程池中的序号，不是工作线程时为 -1
+    int currentWorkerIndex() const {
+        return current_pool() == this ? current_index() : -1;
+    }
+
+    static const WorkPool*& current_pool() {
+        static thread_local const WorkPool* pool = nullptr;
+        return pool;
+    }
+
+    static int& current_index() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    bool tryPop(Worker& worker, int priority, bool steal, Item* item) {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        std::deque<Item>& queue = worker.queues[priority];
+        if (queue.empty()) return false;
+        if (steal) {
+            *item = std::move(queue.front());
+            queue.pop_front();
+        } else {
+            *item = std::move(queue.back());
+            queue.pop_back();
+        }
+        return true;
+    }
+
+    // 按优先级查找任务：先查本线程队列，再从其他线程窃取
+    bool findWork(int self, bool allow_background, Item* item, int* priority) {
+        int n = (int)workers_.size();
+        for (int p = 0; p < WORK_PRIORITY_COUNT; p++) {
+            if (p == WORK_BACKGROUND) {
+                if (!allow_background || !reserveBackground()) return false;
+            }
+            bool found = tryPop(*workers_[self], p, false, item);
+            for (int i = 1; !found && i < n; i++) {
+                if (tryPop(*workers_[(self + i) % n], p, true, item)) {
+                    found = true;
+                    steals_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            if (found) {
+                *priority = p;
+                queued_[p].fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            if (p == WORK_BACKGROUND) running_background_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    bool reserveBackground() {
+        int limit;
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            limit = background_limit_;
+        }
+        int current = running_background_.load(std::memory_order_relaxed);
+        while (current < limit) {
+            if (running_background_.compare_exchange_weak(current, current + 1)) return true;
+        }
+        return false;
+    }
+
+    void runItem(Item& item, int priority) {
+        auto start = std::chrono::steady_clock::now();
+        started_[priority].fetch_add(1, std::memory_order_relaxed);
+        wait_us_[priority].fetch_add(
+            std::chrono::duration_cast<std::chrono::microseconds>(start - item.enqueued).count(),
+            std::memory_order_relaxed);
+        running_[priority].fetch_add(1, std::memory_order_relaxed);
+
+        item.task();
+        item.task = nullptr;
+
+        running_[priority].fetch_sub(1, std::memory_order_relaxed);
+        completed_[priority].fetch_add(1, std::memory_order_relaxed);
+        busy_us_.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - start).count(),
+                           std::memory_order_relaxed);
+        if (priority == WORK_BACKGROUND) running_background_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void workerLoop(int index) {
+        current_pool() = this;
+        current_index() = index;
+
+        while (true) {
+            uint64_t seen;
+            {
+                std::unique_lock<std::mutex> lock(sleep_mutex_);
+                if (stopping_) return;
+                seen = generation_;
+                if (active_ >= limit_) {
+                    sleep_cond_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                    continue;
+                }
+                active_++;
+            }
+
+            Item item;
+            int priority;
+            bool found = findWork(index, true, &item, &priority);
+            if (found) runItem(item, priority);
+
+            {
+                std::unique_lock<std::mutex> lock(sleep_mutex_);
+                active_--;
+                if (found) {
+                    generation_++;
+                } else {
+                    sleep_cond_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                    continue;
+                }
+            }
+            // 释放了一个并发名额，唤醒可能因上限而等待的线程
+            sleep_cond_.notify_one();
+        }
+    }
+};
+
+/**
+ * 一组任务，wait() 等待全部完成。在工作线程中等待时会帮忙执行其他任务
+ */
+class WorkGroup {
+public:
+    explicit WorkGroup(WorkPool& pool = WorkPool::shared()) : pool_(pool) {}
+
+    ~WorkGroup() { wait(); }
+
+    void run(WorkPriority priority, WorkPool::Task task) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        pool_.submit(priority, [this, task = std::move(task)] {
+            task();
+            // 在锁内递减，wait() 返回前会再取一次锁，保证此处不再访问已销毁的对象
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                cond_.notify_all();
+            }
+        });
+    }
+
+    void wait() {
+        while (pending_.load(std::memory_order_acquire) > 0) {
+            if (pool_.helpOne()) continue;
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait_for(lock, std::chrono::milliseconds(1),
+                           [this] { return pending_.load(std::memory_order_acquire) == 0; });
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+
+private:
+    WorkPool& pool_;
+    std::atomic<int> pending_{0};
+    std::mutex mutex_;
+    std::condition_variable cond_;
+};
@@ -0,0 +1,98 @@
+/**
+ * 共享线程池的 N-API 绑定
+ * 两个 addon 是各自独立的动态库，静态变量互不可见。先加载的 addon 把线程池指针挂到
+ * JS 全局的 Symbol.for('native.workPool.v1') 上，后加载的 addon 在 Init 时取回并 adopt，
+ * 这样整个进程只有一组工作线程
+ */
+#pragma once
+
+#include <napi.h>
+
+#include "work_pool.h"
+
+// 布局或行为不兼容时修改版本号，不同版本的 addon 各自使用自己的线程池
+static const char* const kWorkPoolGlobalKey = "native.workPool.v1";
+
+inline void bindSharedWorkPool(Napi::Env env) {
+    Napi::Object global = env.Global();
+    Napi::Symbol key = Napi::Symbol::For(env, kWorkPoolGlobalKey);
+    Napi::Value existing = global.Get(key);
+
+    if (existing.IsExternal()) {
+        if (!WorkPool::hasShared()) {
+            WorkPool::adopt(existing.As<Napi::External<WorkPool>>().Data());
+        }
+        return;
+    }
+    global.Set(key, Napi::External<WorkPool>::New(env, &WorkPool::shared()));
+}
+
+// 线程池指标 => { threads, concurrencyLimit, active, steals, utilization, classes: { realtime, decode, background } }
+inline Napi::Value GetWorkPoolStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    WorkPool::Metrics metrics = WorkPool::shared().metrics();
+
+    static const char* const kClassNames[WORK_PRIORITY_COUNT] = {"realtime", "decode", "background"};
+    Napi::Object classes = Napi::Object::New(env);
+    for (int p = 0; p < WORK_PRIORITY_COUNT; p++) {
+        const WorkPool::ClassMetrics& c = metrics.classes[p];
+        Napi::Object item = Napi::Object::New(env);
+        item.Set("queued", Napi::Number::New(env, (double)c.queued));
+        item.Set("running", Napi::Number::New(env, (double)c.running));
+        item.Set("completed", Napi::Number::New(env, (double)c.completed));
+        item.Set("avgWaitMs", Napi::Number::New(env, c.avg_wait_ms));
+        classes.Set(kClassNames[p], item);
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("threads", Napi::Number::New(env, metrics.threads));
+    result.Set("concurrencyLimit", Napi::Number::New(env, metrics.concurrency_limit));
+    result.Set("active", Napi::Number::New(env, metrics.active));
+    result.Set("steals", Napi::Number::New(env, (double)metrics.steals));
+    result.Set("utilization", Napi::Number::New(env, metrics.utilization));
+    result.Set("classes", classes);
+    return result;
+}
+
+// 设置全局并发上限，返回实际生效的值
+inline Napi::Value SetWorkPoolConcurrency(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected concurrency number").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    WorkPool::shared().setConcurrencyLimit(info[0].As<Napi::Number>().Int32Value());
+    return Napi::Number::New(env, WorkPool::shared().concurrencyLimit());
+}
+
+// 容器资源限制及据此派生的线程数和内存预算（字节）
+inline Napi::Value GetResourceLimits(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const ResourceLimits& limits = ResourceLimits::get();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("source", Napi::String::New(env, limits.source));
+    result.Set("hostCpus", Napi::Number::New(env, limits.host_cpus));
+    result.Set("affinityCpus", Napi::Number::New(env, limits.affinity_cpus));
+    result.Set("cpuQuota", Napi::Number::New(env, limits.cpu_quota));
+    result.Set("hostMemory", Napi::Number::New(env, (double)limits.host_memory));
+    result.Set("memoryLimit", Napi::Number::New(env, (double)limits.memory_limit));
+    result.Set("cpus", Napi::Number::New(env, limits.cpus));
+    result.Set("workPoolConcurrency", Napi::Number::New(env, limits.work_pool_concurrency));
+    result.Set("decodeThreads", Napi::Number::New(env, limits.decode_threads));
+    result.Set("encodeThreads", Napi::Number::New(env, limits.encode_threads));
+    result.Set("copyWorkers", Napi::Number::New(env, limits.copy_workers));
+    result.Set("effectiveMemory", Napi::Number::New(env, (double)limits.effective_memory));
+    result.Set("cacheBudget", Napi::Number::New(env, (double)limits.cache_budget));
+    result.Set("decodeAheadBudget", Napi::Number::New(env, (double)limits.decode_ahead_budget));
+    return result;
+}
+
+// 在 addon 的 Init 中调用
+inline void exportWorkPool(Napi::Env env, Napi::Object exports) {
+    bindSharedWorkPool(env);
+    exports.Set("getWorkPoolStats", Napi::Function::New(env, GetWorkPoolStats));
+    exports.Set("setWorkPoolConcurrency", Napi::Function::New(env, SetWorkPoolConcurrency));
+    exports.Set("getResourceLimits", Napi::Function::New(env, GetResourceLimits));
+}
@@ -0,0 +1,263 @@
+/**
+ * NV12 / I420 -> RGBA 转换与缩放（一遍完成），用于没有可用 WebGL 时的 CPU 呈现
+ * 直接输出到目标尺寸（画布尺寸），开销只与显示尺寸有关，与源分辨率无关：
+ * - 双线性采样：每个目标像素先在两行源数据上做水平插值（标量查表），
+ *   再用 SSE2 一次 8 个像素做垂直插值、YUV->RGB 和打包
+ * - 目标按行条分给共享线程池（实时优先级）
+ * 与 WebGL 着色器一致默认 BT.601 有限范围，可选 BT.709
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "work_pool.h"
+
+class YuvRgbaScaler {
+public:
+    struct Source {
+        const uint8_t* y = nullptr;
+        const uint8_t* u = nullptr;    // NV12 时为交错 UV 平面
+        const uint8_t* v = nullptr;    // NV12 时为 u + 1
+        int width = 0;
+        int height = 0;
+        int y_stride = 0;
+        int uv_stride = 0;
+        int uv_step = 1;               // 一个色度样本的字节步长：NV12 为 2，I420 为 1
+
+        static Source nv12(const uint8_t* data, int width, int height, int stride) {
+            Source s;
+            s.y = data;
+            s.u = data + (size_t)stride * height;
+            s.v = s.u + 1;
+            s.width = width;
+            s.height = height;
+            s.y_stride = stride;
+            s.uv_stride = stride;
+            s.uv_step = 2;
+            return s;
+        }
+
+        static Source i420(const uint8_t* data, int width, int height, int stride) {
+            Source s;
+            int chroma_stride = (stride + 1) / 2;
+            s.y = data;
+            s.u = data + (size_t)stride * height;
+            s.v = s.u + (size_t)chroma_stride * ((height + 1) / 2);
+            s.width = width;
+            s.height = height;
+            s.y_stride = stride;
+            s.uv_stride = chroma_stride;
+            s.uv_step = 1;
+            return s;
+        }
+    };
+
+    struct Target {
+        uint8_t* rgba = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;                // 字节
+    };
+
+    enum Matrix {
+        BT601 = 0,
+        BT709,
+    };
+
+    // 源至少 4x4（色度平面至少 2x2）；目标任意尺寸
+    static bool convert(const Source& src, const Target& dst, Matrix matrix = BT601) {
+        if (src.width < 4 || src.height < 4 || dst.width <= 0 || dst.height <= 0) return false;
+
+        Plan plan;
+        plan.src = src;
+        plan.dst = dst;
+        plan.coeffs = matrix == BT709 ? Coeffs{9535, 14688, -1745, -4366, 17302}
+                                      : Coeffs{9535, 13074, -3203, -6660, 16531};
+        buildTable(src.width, src.width, dst.width, 1.0, &plan.x_luma);
+        buildTable(src.width, (src.width + 1) / 2, dst.width, 0.5, &plan.x_chroma);
+
+        int stripes = std::max(1, std::min(ResourceLimits::get().copy_workers, dst.height / 32));
+        if (stripes == 1) {
+            convertRows(plan, 0, dst.height);
+            return true;
+        }
+        WorkGroup group;
+        for (int i = 0; i < stripes; i++) {
+            int r0 = (int)((int64_t)dst.height * i / stripes);
+            int r1 = (int)((int64_t)dst.height * (i + 1) / stripes);
+            group.run(WORK_REALTIME, [&plan, r0, r1] { convertRows(plan, r0, r1); });
+        }
+        group.wait();
+        return true;
+    }
+
+private:
+    // 8192 倍的转换系数: Y 增益, V->R, U->G, V->G, U->B；与 16 倍精度的样本相乘后取高 16 位得到 2 倍精度结果
+    struct Coeffs {
+        int16_t y, vr, ug, vg, ub;
+    };
+
+    // 目标列在源中的位置: idx 与 idx + 1 两个样本，权重 0-128
+    struct Tap {
+        int32_t idx;
+        int32_t weight;
+    };
+
+    struct Plan {
+        Source src;
+        Target dst;
+        Coeffs coeffs;
+        std::vector<Tap> x_luma;
+        std::vector<Tap> x_chroma;
+    };
+
+    static Tap tapFor(double pos, int size) {
+        if (pos < 0) pos = 0;
+        int idx = (int)pos;
+        int weight = (int)((pos - idx) * 128 + 0.5);
+        if (weight == 128) {
+            idx++;
+            weight = 0;
+        }
+        if (idx >= size - 1) {
+            idx = size - 2;
+            weight = 128;
+        }
+        return Tap{idx, weight};
+    }
+
+    // scale: 平面相对亮度的比例；色度样本按 MPEG-2 方式与偶数亮度列对齐
+    static void buildTable(int luma_size, int plane_size, int dst_size, double scale, std::vector<Tap>* table) {
+        table->resize(dst_size);
+        double step = (double)luma_size / dst_size;
+        for (int x = 0; x < dst_size; x++) {
+            double luma_pos = (x + 0.5) * step - 0.5;
+            (*table)[x] = tapFor(luma_pos * scale, plane_size);
+        }
+    }
+
+    static void convertRows(const Plan& plan, int row0, int row1) {
+        const Source& src = plan.src;
+        const Target& dst = plan.dst;
+        int w = dst.width;
+        int ch = (src.height + 1) / 2;
+        // 每行 6 组水平插值结果（128 倍）
+        thread_local std::vector<int16_t> rows;
+        rows.resize((size_t)w * 6 + 8);
+        int16_t* y0 = rows.data();
+        int16_t* y1 = y0 + w;
+        int16_t* u0 = y1 + w;
+        int16_t* u1 = u0 + w;
+        int16_t* v0 = u1 + w;
+        int16_t* v1 = v0 + w;
+        double step_y = (double)src.height / dst.height;
+
+        for (int y = row0; y < row1; y++) {
+            double luma_pos = (y + 0.5) * step_y - 0.5;
+            Tap ty = tapFor(luma_pos, src.height);
+            Tap tc = tapFor(luma_pos * 0.5, ch);
+
+            const uint8_t* ry0 = src.y + (size_t)ty.idx * src.y_stride;
+            const uint8_t* ry1 = ry0 + src.y_stride;
+            const uint8_t* ru0 = src.u + (size_t)tc.idx * src.uv_stride;
+            const uint8_t* ru1 = ru0 + src.uv_stride;
+            const uint8_t* rv0 = src.v + (size_t)tc.idx * src.uv_stride;
+            const uint8_t* rv1 = rv0 + src.uv_stride;
+            int step = src.uv_step;
+
+            for (int x = 0; x < w; x++) {
+                Tap tl = plan.x_luma[x];
+                Tap tcx = plan.x_chroma[x];
+                int a = 128 - tl.weight, b = tl.weight;
+                y0[x] = (int16_t)(ry0[tl.idx] * a + ry0[tl.idx + 1] * b);
+                y1[x] = (int16_t)(ry1[tl.idx] * a + ry1[tl.idx + 1] * b);
+                int ci = tcx.idx * step;
+                a = 128 - tcx.weight;
+                b = tcx.weight;
+                u0[x] = (int16_t)(ru0[ci] * a + ru0[ci + step] * b);
+                u1[x] = (int16_t)(ru1[ci] * a + ru1[ci + step] * b);
+                v0[x] = (int16_t)(rv0[ci] * a + rv0[ci + step] * b);
+                v1[x] = (int16_t)(rv1[ci] * a + rv1[ci + step] * b);
+            }
+
+            uint8_t* out = dst.rgba + (size_t)y * dst.stride;
+            int x = 0;
+#if defined(__SSE2__)
+            x = verticalSse2(plan.coeffs, y0, y1, ty.weight, u0, u1, v0, v1, tc.weight, out, w);
+#endif
+            for (; x < w; x++) {
+                // 垂直插值后为 16 倍精度
+                int yy = ((y0[x] * (128 - ty.weight) + y1[x] * ty.weight + 512) >> 10) - 256;
+                int uu = ((u0[x] * (128 - tc.weight) + u1[x] * tc.weight + 512) >> 10) - 2048;
+                int vv = ((v0[x] * (128 - tc.weight) + v1[x] * tc.weight + 512) >> 10) - 2048;
+                int luma = (yy * plan.coeffs.y) >> 16;
+                out[x * 4 + 0] = clamp255((luma + ((vv * plan.coeffs.vr) >> 16) + 1) >> 1);
+                out[x * 4 + 1] = clamp255((luma + ((uu * plan.coeffs.ug) >> 16) + ((vv * plan.coeffs.vg) >> 16) + 1) >> 1);
+                out[x * 4 + 2] = clamp255((luma + ((uu * plan.coeffs.ub) >> 16) + 1) >> 1);
+                out[x * 4 + 3] = 255;
+            }
+        }
+    }
+
+    static uint8_t clamp255(int v) {
+        return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+
+#if defined(__SSE2__)
+    // 两行按权重混合: (a * (128 - w) + b * w + 512) >> 10，结果为 16 倍精度
+    static __m128i lerpRows(const int16_t* a, const int16_t* b, __m128i weights) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        const __m128i round = _mm_set1_epi32(512);
+        __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(va, vb), weights), round), 10);
+        __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(va, vb), weights), round), 10);
+        return _mm_packs_epi32(lo, hi);
+    }
+
+    static int verticalSse2(const Coeffs& c, const int16_t* y0, const int16_t* y1, int wy,
+                            const int16_t* u0, const int16_t* u1, const int16_t* v0, const int16_t* v1,
+                            int wc, uint8_t* out, int width) {
+        const __m128i luma_w = _mm_set1_epi32((wy << 16) | (128 - wy));
+        const __m128i chroma_w = _mm_set1_epi32((wc << 16) | (128 - wc));
+        const __m128i y_off = _mm_set1_epi16(256);
+        const __m128i c_off = _mm_set1_epi16(2048);
+        const __m128i k_y = _mm_set1_epi16(c.y);
+        const __m128i k_vr = _mm_set1_epi16(c.vr);
+        const __m128i k_ug = _mm_set1_epi16(c.ug);
+        const __m128i k_vg = _mm_set1_epi16(c.vg);
+        const __m128i k_ub = _mm_set1_epi16(c.ub);
+        const __m128i alpha = _mm_set1_epi16(255);
+        const __m128i one = _mm_set1_epi16(1);
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            __m128i yy = _mm_sub_epi16(lerpRows(y0 + x, y1 + x, luma_w), y_off);
+            __m128i uu = _mm_sub_epi16(lerpRows(u0 + x, u1 + x, chroma_w), c_off);
+            __m128i vv = _mm_sub_epi16(lerpRows(v0 + x, v1 + x, chroma_w), c_off);
+
+            __m128i luma = _mm_adds_epi16(_mm_mulhi_epi16(yy, k_y), one);
+            __m128i r = _mm_adds_epi16(luma, _mm_mulhi_epi16(vv, k_vr));
+            __m128i g = _mm_adds_epi16(luma, _mm_adds_epi16(_mm_mulhi_epi16(uu, k_ug), _mm_mulhi_epi16(vv, k_vg)));
+            __m128i b = _mm_adds_epi16(luma, _mm_mulhi_epi16(uu, k_ub));
+            r = _mm_srai_epi16(r, 1);
+            g = _mm_srai_epi16(g, 1);
+            b = _mm_srai_epi16(b, 1);
+
+            // R G B A 交错
+            __m128i rb = _mm_packus_epi16(r, b);          // r0..r7 b0..b7
+            __m128i ga = _mm_packus_epi16(g, alpha);      // g0..g7 255..
+            __m128i rg = _mm_unpacklo_epi8(rb, ga);       // r0 g0 r1 g1 ...
+            __m128i ba = _mm_unpackhi_epi8(rb, ga);       // b0 a  b1 a  ...
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_unpacklo_epi16(rg, ba));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+        }
+        return x;
+    }
+#endif
+};
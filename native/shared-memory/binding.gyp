@@ -2,9 +2,11 @@
   "targets": [
     {
       "target_name": "shared_memory",
+      "includes": [ "../common/optimize.gypi" ],
       "sources": [ "shared_memory.cpp" ],
       "include_dirs": [
-        "<!@(node -p \"require('node-addon-api').include\")"
+        "<!@(node -p \"require('node-addon-api').include\")",
+        "../common"
       ],
       "dependencies": [
         "<!(node -p \"require('node-addon-api').gyp\")"
@@ -7,8 +7,18 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <map>
+#include <memory>
+#include <vector>
+
+#include "shm_file_ref.h"
+#include "shm_frame_cache.h"
+#include "shm_frame_ring.h"
+#include "work_pool_binding.h"
+#include "yuv_rgba_scaler.h"
 
 // 共享内存管理器
 class SharedMemoryManager {
@@ -21,6 +31,15 @@ private:
     
     static std::map<std::string, SharedMemoryInfo> sharedMemories;
 
+    // 帧环形缓冲（本进程创建的生产者端和打开的消费者端）
+    static std::map<std::string, std::unique_ptr<ShmFrameRing>> frameRings;
+
+    // 带 FILE_REF 标志的帧所引用文件的只读映射
+    static ShmFileMapCache fileMaps;
+
+    // 跨窗口共享的已解码帧缓存
+    static std::map<std::string, std::unique_ptr<ShmFrameCache>> frameCaches;
+
     // 缓存的图像 Buffer 和颜色顺序状态
     static Napi::Reference<Napi::Buffer<uint8_t>> *cachedImageBuffer;
     static int currentColorOrder; // 0=RGB, 1=GBR, 2=BRG
@@ -463,10 +482,710 @@ private:
 
       return cachedImageBuffer->Value();
     }
+
+    // 创建帧环形缓冲 (name, slotCount, slotSize)
+    static Napi::Value CreateFrameRing(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 3 || !info[0].IsString() || !info[1].IsNumber() ||
+          !info[2].IsNumber()) {
+        Napi::TypeError::New(
+            env, "Expected (name: string, slotCount: number, slotSize: number)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      std::string name =
+          ShmFrameRing::normalizeName(info[0].As<Napi::String>().Utf8Value());
+      uint32_t slotCount = info[1].As<Napi::Number>().Uint32Value();
+      uint32_t slotSize = info[2].As<Napi::Number>().Uint32Value();
+      if (slotCount < 2) {
+        Napi::Error::New(env, "Frame ring needs at least 2 slots")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      // 本进程已是该环的生产者时不重建：替换会析构旧对象并删除名称，已打开的消费者失去该环
+      auto existing = frameRings.find(name);
+      if (existing != frameRings.end() && existing->second->isOwner()) {
+        Napi::Error::New(env, "Frame ring already exists")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      std::unique_ptr<ShmFrameRing> ring(new ShmFrameRing());
+      if (!ring->create(name, slotCount, slotSize)) {
+        Napi::Error::New(env, errno == EEXIST
+                                  ? "Frame ring already exists"
+                                  : "Failed to create frame ring")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      // 本进程之前以消费者身份打开过同名的环：换成生产者
+      frameRings[name] = std::move(ring);
+
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("name", name);
+      result.Set("slotCount", slotCount);
+      result.Set("slotSize", slotSize);
+      result.Set("success", true);
+      return result;
+    }
+
+    // 紧密排列时一行的字节数，压缩数据包沿用宽度
+    static uint32_t packedStride(uint32_t format, uint32_t width) {
+      switch (format) {
+      case SHM_PIXEL_RGB24:
+        return width * 3;
+      case SHM_PIXEL_RGBA:
+        return width * 4;
+      default:
+        return width;
+      }
+    }
+
+    // 原始帧按行跨度计算的最小字节数，I420 色度跨度为亮度的一半（与 FrameRecorder 一致）
+    // 行跨度小于一行像素时返回 false，压缩数据包不检查
+    static bool rawFrameSize(uint32_t format, uint32_t width, uint32_t height,
+                             uint32_t stride, size_t *needed) {
+      size_t chroma_h = (height + 1) / 2;
+      switch (format) {
+      case SHM_PIXEL_NV12:
+        *needed = (size_t)stride * (height + chroma_h);
+        return stride >= width;
+      case SHM_PIXEL_I420:
+        *needed = (size_t)stride * height + (size_t)((stride + 1) / 2) * chroma_h * 2;
+        return stride >= width;
+      case SHM_PIXEL_RGB24:
+        *needed = (size_t)stride * height;
+        return stride >= width * 3;
+      case SHM_PIXEL_RGBA:
+        *needed = (size_t)stride * height;
+        return stride >= width * 4;
+      default:
+        *needed = 0;
+        return true;
+      }
+    }
+
+    // 写入一帧 (name, data, width, height, pts?, format?, stride?)
+    static Napi::Value WriteFrame(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 4 || !info[0].IsString() || !info[1].IsBuffer() ||
+          !info[2].IsNumber() || !info[3].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (name: string, data: Buffer, "
+                                  "width: number, height: number, pts?: "
+                                  "number, format?: number, stride?: number)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      std::string name =
+          ShmFrameRing::normalizeName(info[0].As<Napi::String>().Utf8Value());
+      auto it = frameRings.find(name);
+      if (it == frameRings.end()) {
+        Napi::Error::New(env, "Frame ring not found")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      Napi::Buffer<uint8_t> buffer = info[1].As<Napi::Buffer<uint8_t>>();
+      uint32_t width = info[2].As<Napi::Number>().Uint32Value();
+      uint32_t height = info[3].As<Napi::Number>().Uint32Value();
+      double pts = info.Length() >= 5 && info[4].IsNumber()
+                       ? info[4].As<Napi::Number>().DoubleValue()
+                       : 0;
+      uint32_t format = info.Length() >= 6 && info[5].IsNumber()
+                            ? info[5].As<Napi::Number>().Uint32Value()
+                            : SHM_PIXEL_NV12;
+      // 行跨度以字节计，默认按格式紧密排列；读取端（如 FrameRecorder）按它定位每一行
+      uint32_t stride = info.Length() >= 7 && info[6].IsNumber()
+                            ? info[6].As<Napi::Number>().Uint32Value()
+                            : packedStride(format, width);
+
+      size_t needed = 0;
+      if (!rawFrameSize(format, width, height, stride, &needed)) {
+        Napi::Error::New(env, "Stride is smaller than a row of the frame")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      if (buffer.Length() < needed) {
+        Napi::Error::New(env, "Buffer is smaller than stride * height for the frame format")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      if (!it->second->write(buffer.Data(), buffer.Length(), width, height,
+                             format, stride, pts)) {
+        Napi::Error::New(env, "Frame size exceeds ring slot size")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      return Napi::Number::New(env, (double)(it->second->writeSeq() - 1));
+    }
+
+    // 打开已存在的帧环（消费者），如渲染进程读取主进程发布的数据包
+    static Napi::Value OpenFrameRing(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (name: string)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      std::string name =
+          ShmFrameRing::normalizeName(info[0].As<Napi::String>().Utf8Value());
+      // 已打开（或本进程就是生产者）时沿用现有对象，替换生产者会删除环的名称
+      auto it = frameRings.find(name);
+      if (it == frameRings.end()) {
+        std::unique_ptr<ShmFrameRing> ring(new ShmFrameRing());
+        if (!ring->open(name)) {
+          Napi::Error::New(env, "Failed to open frame ring")
+              .ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        it = frameRings.emplace(name, std::move(ring)).first;
+      }
+      ShmFrameRing *ring = it->second.get();
+
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("name", name);
+      result.Set("slotCount", ring->slotCount());
+      result.Set("slotSize", ring->slotSize());
+      result.Set("writeSeq", (double)ring->writeSeq());
+      result.Set("oldestSeq", (double)ring->oldestReadable());
+      return result;
+    }
+
+    // 读取第 seq 项 (name, seq, target?)
+    // 返回 { status: 'ok' | 'empty' | 'overwritten', ... }；传入 target 时数据复制到
+    // target 中而不分配新 Buffer，否则返回 data
+    static Napi::Value ReadFrame(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env,
+                             "Expected (name: string, seq: number, target?: Buffer)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      std::string name =
+          ShmFrameRing::normalizeName(info[0].As<Napi::String>().Utf8Value());
+      auto it = frameRings.find(name);
+      if (it == frameRings.end()) {
+        Napi::Error::New(env, "Frame ring not found")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      ShmFrameRing *ring = it->second.get();
+      uint64_t seq = (uint64_t)info[1].As<Napi::Number>().Int64Value();
+
+      Napi::Object result = Napi::Object::New(env);
+      if (seq < ring->oldestReadable()) {
+        result.Set("status", "overwritten");
+        result.Set("oldestSeq", (double)ring->oldestReadable());
+        return result;
+      }
+
+      ShmFrameRing::FrameInfo frame;
+      ShmFrameRing::ReadResult status = ring->read(seq, &frame, nullptr, 0);
+      const uint8_t *src = nullptr;
+      uint64_t size = frame.size;
+      bool fileRef = false;
+      if (status == ShmFrameRing::READ_OK) {
+        uint32_t index = (uint32_t)(seq % ring->slotCount());
+        src = ring->slotData(index);
+        fileRef = (frame.flags & SHM_FLAG_FILE_REF) != 0;
+        if (fileRef) {
+          // 槽中只有文件引用：先复制出来确认未被覆盖，再从映射的文件读取
+          std::vector<uint8_t> ref(src, src + std::min(frame.size, ring->slotSize()));
+          if (!ring->validate(seq)) {
+            status = ShmFrameRing::READ_OVERWRITTEN;
+          } else if (!(src = fileMaps.resolve(ref.data(), ref.size(), &size))) {
+            Napi::Error::New(env, "Failed to map referenced frame file")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+          }
+        }
+      }
+      if (status == ShmFrameRing::READ_OK) {
+        if (info.Length() >= 3 && info[2].IsBuffer()) {
+          Napi::Buffer<uint8_t> target = info[2].As<Napi::Buffer<uint8_t>>();
+          if (target.Length() < size) {
+            Napi::RangeError::New(env, "Target buffer too small")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+          }
+          memcpy(target.Data(), src, size);
+        } else {
+          Napi::Buffer<uint8_t> data =
+              Napi::Buffer<uint8_t>::Copy(env, src, size);
+          result.Set("data", data);
+        }
+        if (!fileRef && !ring->validate(seq)) {
+          status = ShmFrameRing::READ_OVERWRITTEN;
+        }
+      }
+
+      if (status == ShmFrameRing::READ_EMPTY) {
+        result.Set("status", "empty");
+        return result;
+      }
+      if (status == ShmFrameRing::READ_OVERWRITTEN) {
+        result.Delete("data");
+        result.Set("status", "overwritten");
+        result.Set("oldestSeq", (double)ring->oldestReadable());
+        return result;
+      }
+
+      result.Set("status", "ok");
+      result.Set("seq", (double)frame.seq);
+      result.Set("pts", frame.pts);
+      result.Set("width", frame.width);
+      result.Set("height", frame.height);
+      result.Set("format", frame.format);
+      result.Set("flags", frame.flags);
+      result.Set("size", (double)size);
+      result.Set("stride", frame.stride);
+      return result;
+    }
+
+    // 帧环状态 (name) => { writeSeq, oldestSeq, slotCount, slotSize }
+    static Napi::Value GetFrameRingState(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (name: string)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      std::string name =
+          ShmFrameRing::normalizeName(info[0].As<Napi::String>().Utf8Value());
+      auto it = frameRings.find(name);
+      if (it == frameRings.end()) {
+        return env.Null();
+      }
+
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("writeSeq", (double)it->second->writeSeq());
+      result.Set("oldestSeq", (double)it->second->oldestReadable());
+      result.Set("slotCount", it->second->slotCount());
+      result.Set("slotSize", it->second->slotSize());
+      return result;
+    }
+
+    // 关闭帧环形缓冲
+    static Napi::Value CloseFrameRing(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (name: string)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      std::string name =
+          ShmFrameRing::normalizeName(info[0].As<Napi::String>().Utf8Value());
+      frameRings.erase(name);
+      if (frameRings.empty()) {
+        fileMaps.clear();
+      }
+      return Napi::Boolean::New(env, true);
+    }
+
+    // 呈现目标: (target, dstWidth, dstHeight)，target 可以是 ImageData.data
+    static bool parsePresentTarget(Napi::Env env, const Napi::CallbackInfo &info,
+                                   size_t index, YuvRgbaScaler::Target *target) {
+      if (info.Length() < index + 3 || !info[index].IsTypedArray() ||
+          !info[index + 1].IsNumber() || !info[index + 2].IsNumber()) {
+        Napi::TypeError::New(env, "Expected target, dstWidth, dstHeight")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+      Napi::TypedArray array = info[index].As<Napi::TypedArray>();
+      target->rgba = static_cast<uint8_t *>(array.ArrayBuffer().Data()) +
+                     array.ByteOffset();
+      target->width = info[index + 1].As<Napi::Number>().Int32Value();
+      target->height = info[index + 2].As<Napi::Number>().Int32Value();
+      target->stride = target->width * 4;
+      if (target->width <= 0 || target->height <= 0 ||
+          array.ByteLength() < (size_t)target->stride * target->height) {
+        Napi::RangeError::New(env, "Target smaller than dstWidth * dstHeight * 4")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+      return true;
+    }
+
+    static YuvRgbaScaler::Matrix parseMatrix(const Napi::Value &options) {
+      if (options.IsObject()) {
+        Napi::Value matrix = options.As<Napi::Object>().Get("matrix");
+        if (matrix.IsString() && matrix.As<Napi::String>().Utf8Value() == "bt709") {
+          return YuvRgbaScaler::BT709;
+        }
+      }
+      return YuvRgbaScaler::BT601;
+    }
+
+    // NV12 / I420 帧转换为 RGBA 并缩放到目标尺寸
+    // (src, width, height, target, dstWidth, dstHeight, { format?, stride?, matrix? })
+    static Napi::Value ConvertToRgba(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 3 || !info[0].IsBuffer() || !info[1].IsNumber() ||
+          !info[2].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (src: Buffer, width, height, target, "
+                                  "dstWidth, dstHeight, options?)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      YuvRgbaScaler::Target target;
+      if (!parsePresentTarget(env, info, 3, &target)) {
+        return env.Null();
+      }
+
+      Napi::Buffer<uint8_t> src = info[0].As<Napi::Buffer<uint8_t>>();
+      int width = info[1].As<Napi::Number>().Int32Value();
+      int height = info[2].As<Napi::Number>().Int32Value();
+      uint32_t format = SHM_PIXEL_NV12;
+      int stride = width;
+      Napi::Value options = info.Length() >= 7 ? info[6] : env.Undefined();
+      if (options.IsObject()) {
+        Napi::Object opts = options.As<Napi::Object>();
+        if (opts.Get("format").IsNumber()) format = opts.Get("format").As<Napi::Number>().Uint32Value();
+        if (opts.Get("stride").IsNumber()) stride = opts.Get("stride").As<Napi::Number>().Int32Value();
+      }
+      if ((format != SHM_PIXEL_NV12 && format != SHM_PIXEL_I420) || stride < width ||
+          src.Length() < (size_t)stride * height * 3 / 2) {
+        Napi::Error::New(env, "Source must be an NV12 or I420 frame of the given size")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      YuvRgbaScaler::Source source =
+          format == SHM_PIXEL_I420
+              ? YuvRgbaScaler::Source::i420(src.Data(), width, height, stride)
+              : YuvRgbaScaler::Source::nv12(src.Data(), width, height, stride);
+      return Napi::Boolean::New(env, YuvRgbaScaler::convert(source, target, parseMatrix(options)));
+    }
+
+    // 直接从帧环的槽转换到 RGBA 目标，不复制 NV12 数据
+    // (name, seq, target, dstWidth, dstHeight, { matrix? })
+    // 返回 { status: 'ok' | 'empty' | 'overwritten' | 'unsupported', seq, pts, width, height }
+    static Napi::Value PresentFrame(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (name: string, seq: number, target, "
+                                  "dstWidth, dstHeight, options?)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      YuvRgbaScaler::Target target;
+      if (!parsePresentTarget(env, info, 2, &target)) {
+        return env.Null();
+      }
+
+      std::string name =
+          ShmFrameRing::normalizeName(info[0].As<Napi::String>().Utf8Value());
+      auto it = frameRings.find(name);
+      if (it == frameRings.end()) {
+        Napi::Error::New(env, "Frame ring not found")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      ShmFrameRing *ring = it->second.get();
+      uint64_t seq = (uint64_t)info[1].As<Napi::Number>().Int64Value();
+
+      Napi::Object result = Napi::Object::New(env);
+      if (seq < ring->oldestReadable()) {
+        result.Set("status", "overwritten");
+        result.Set("oldestSeq", (double)ring->oldestReadable());
+        return result;
+      }
+
+      ShmFrameRing::FrameInfo frame;
+      ShmFrameRing::ReadResult status = ring->read(seq, &frame, nullptr, 0);
+      if (status == ShmFrameRing::READ_EMPTY) {
+        result.Set("status", "empty");
+        return result;
+      }
+      if (status == ShmFrameRing::READ_OK) {
+        const uint8_t *src = ring->slotData((uint32_t)(seq % ring->slotCount()));
+        uint64_t size = frame.size;
+        bool fileRef = (frame.flags & SHM_FLAG_FILE_REF) != 0;
+        if (fileRef) {
+          std::vector<uint8_t> ref(src, src + std::min(frame.size, ring->slotSize()));
+          if (!ring->validate(seq)) {
+            status = ShmFrameRing::READ_OVERWRITTEN;
+          } else if (!(src = fileMaps.resolve(ref.data(), ref.size(), &size))) {
+            Napi::Error::New(env, "Failed to map referenced frame file")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+          }
+        }
+        if (status == ShmFrameRing::READ_OK) {
+          int stride = frame.stride > 0 ? (int)frame.stride : (int)frame.width;
+          if ((frame.format != SHM_PIXEL_NV12 && frame.format != SHM_PIXEL_I420) ||
+              size < (uint64_t)stride * frame.height * 3 / 2) {
+            result.Set("status", "unsupported");
+            result.Set("format", frame.format);
+            return result;
+          }
+          YuvRgbaScaler::Source source =
+              frame.format == SHM_PIXEL_I420
+                  ? YuvRgbaScaler::Source::i420(src, frame.width, frame.height, stride)
+                  : YuvRgbaScaler::Source::nv12(src, frame.width, frame.height, stride);
+          YuvRgbaScaler::convert(source, target, parseMatrix(info.Length() >= 6 ? info[5] : env.Undefined()));
+          // 转换期间被覆盖的帧可能是新旧混合，丢弃
+          if (!fileRef && !ring->validate(seq)) {
+            status = ShmFrameRing::READ_OVERWRITTEN;
+          }
+        }
+      }
+      if (status == ShmFrameRing::READ_OVERWRITTEN) {
+        result.Set("status", "overwritten");
+        result.Set("oldestSeq", (double)ring->oldestReadable());
+        return result;
+      }
+
+      result.Set("status", "ok");
+      result.Set("seq", (double)frame.seq);
+      result.Set("pts", frame.pts);
+      result.Set("width", frame.width);
+      result.Set("height", frame.height);
+      result.Set("flags", frame.flags);
+      return result;
+    }
+
+    static ShmFrameCache *findFrameCache(Napi::Env env, const Napi::Value &name) {
+      auto it = frameCaches.find(
+          ShmFrameCache::normalizeName(name.As<Napi::String>().Utf8Value()));
+      if (it == frameCaches.end()) {
+        Napi::Error::New(env, "Frame cache not found")
+            .ThrowAsJavaScriptException();
+        return nullptr;
+      }
+      return it->second.get();
+    }
+
+    // 打开帧缓存，不存在时创建 (name, slotSize, budgetBytes?)
+    // 预算默认取容器资源限制的 cacheBudget；已存在时沿用其槽大小和槽数
+    static Napi::Value OpenFrameCache(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+        Napi::TypeError::New(
+            env, "Expected (name: string, slotSize: number, budgetBytes?: number)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      std::string name =
+          ShmFrameCache::normalizeName(info[0].As<Napi::String>().Utf8Value());
+      uint32_t slotSize = info[1].As<Napi::Number>().Uint32Value();
+      uint64_t budget = info.Length() >= 3 && info[2].IsNumber()
+                            ? (uint64_t)info[2].As<Napi::Number>().Int64Value()
+                            : ResourceLimits::get().cache_budget;
+      if (slotSize == 0) {
+        Napi::Error::New(env, "Invalid slot size").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      auto it = frameCaches.find(name);
+      if (it == frameCaches.end()) {
+        std::unique_ptr<ShmFrameCache> cache(new ShmFrameCache());
+        if (!cache->openOrCreate(name,
+                                 ShmFrameCache::slotsForBudget(budget, slotSize),
+                                 slotSize)) {
+          Napi::Error::New(env, "Failed to open frame cache")
+              .ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        it = frameCaches.emplace(name, std::move(cache)).first;
+      }
+
+      ShmFrameCache::Stats stats = it->second->stats();
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("name", name);
+      result.Set("slotCount", stats.slot_count);
+      result.Set("slotSize", stats.slot_size);
+      return result;
+    }
+
+    // 查找缓存帧 (name, contentId, pts, target?)
+    // 未命中返回 null；传入 target 时数据复制到 target 中，否则返回 data
+    static Napi::Value GetCachedFrame(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 3 || !info[0].IsString() || !info[1].IsString() ||
+          !info[2].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (name: string, contentId: string, "
+                                  "pts: number, target?: Buffer)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      ShmFrameCache *cache = findFrameCache(env, info[0]);
+      if (!cache) {
+        return env.Null();
+      }
+
+      uint64_t content =
+          ShmFrameCache::contentKey(info[1].As<Napi::String>().Utf8Value());
+      double pts = info[2].As<Napi::Number>().DoubleValue();
+      bool hasTarget = info.Length() >= 4 && info[3].IsBuffer();
+
+      ShmFrameCache::FrameInfo frame;
+      Napi::Object result = Napi::Object::New(env);
+      if (hasTarget) {
+        Napi::Buffer<uint8_t> target = info[3].As<Napi::Buffer<uint8_t>>();
+        if (!cache->get(content, pts, &frame, target.Data(), target.Length())) {
+          return env.Null();
+        }
+        if (target.Length() < frame.size) {
+          Napi::RangeError::New(env, "Target buffer too small")
+              .ThrowAsJavaScriptException();
+          return env.Null();
+        }
+      } else {
+        bool hit = cache->getWith(content, pts, &frame, [&](const uint8_t *src) {
+          result.Set("data", Napi::Buffer<uint8_t>::Copy(env, src, frame.size));
+        });
+        if (!hit) {
+          return env.Null();
+        }
+      }
+
+      result.Set("pts", frame.pts);
+      result.Set("width", frame.width);
+      result.Set("height", frame.height);
+      result.Set("format", frame.format);
+      result.Set("size", frame.size);
+      result.Set("stride", frame.stride);
+      return result;
+    }
+
+    // 写入缓存帧 (name, contentId, pts, data, width, height, format?, stride?)
+    // 返回 'ok' | 'exists' | 'too-large' | 'busy'
+    static Napi::Value PutCachedFrame(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 6 || !info[0].IsString() || !info[1].IsString() ||
+          !info[2].IsNumber() || !info[3].IsBuffer() || !info[4].IsNumber() ||
+          !info[5].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (name: string, contentId: string, "
+                                  "pts: number, data: Buffer, width: number, "
+                                  "height: number, format?: number, stride?: number)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      ShmFrameCache *cache = findFrameCache(env, info[0]);
+      if (!cache) {
+        return env.Null();
+      }
+
+      Napi::Buffer<uint8_t> data = info[3].As<Napi::Buffer<uint8_t>>();
+      uint32_t width = info[4].As<Napi::Number>().Uint32Value();
+      uint32_t height = info[5].As<Napi::Number>().Uint32Value();
+      uint32_t format = info.Length() >= 7 && info[6].IsNumber()
+                            ? info[6].As<Napi::Number>().Uint32Value()
+                            : SHM_PIXEL_NV12;
+      uint32_t stride = info.Length() >= 8 && info[7].IsNumber()
+                            ? info[7].As<Napi::Number>().Uint32Value()
+                            : width;
+
+      ShmFrameCache::PutResult status = cache->put(
+          ShmFrameCache::contentKey(info[1].As<Napi::String>().Utf8Value()),
+          info[2].As<Napi::Number>().DoubleValue(), data.Data(),
+          (uint32_t)data.Length(), width, height, format, stride);
+      switch (status) {
+      case ShmFrameCache::PUT_OK:
+        return Napi::String::New(env, "ok");
+      case ShmFrameCache::PUT_EXISTS:
+        return Napi::String::New(env, "exists");
+      case ShmFrameCache::PUT_TOO_LARGE:
+        return Napi::String::New(env, "too-large");
+      default:
+        return Napi::String::New(env, "busy");
+      }
+    }
+
+    // 删除某一内容的全部缓存帧 (name, contentId) => 删除的帧数
+    static Napi::Value InvalidateCachedFrames(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        Napi::TypeError::New(env, "Expected (name: string, contentId: string)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      ShmFrameCache *cache = findFrameCache(env, info[0]);
+      if (!cache) {
+        return env.Null();
+      }
+      uint32_t removed = cache->invalidate(
+          ShmFrameCache::contentKey(info[1].As<Napi::String>().Utf8Value()));
+      return Napi::Number::New(env, removed);
+    }
+
+    // 缓存统计（所有进程合计）
+    static Napi::Value GetFrameCacheStats(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (name: string)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      ShmFrameCache *cache = findFrameCache(env, info[0]);
+      if (!cache) {
+        return env.Null();
+      }
+
+      ShmFrameCache::Stats stats = cache->stats();
+      uint64_t lookups = stats.hits + stats.misses;
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("slotCount", stats.slot_count);
+      result.Set("slotSize", stats.slot_size);
+      result.Set("used", stats.used);
+      result.Set("pinned", stats.pinned);
+      result.Set("hits", (double)stats.hits);
+      result.Set("misses", (double)stats.misses);
+      result.Set("hitRate", lookups > 0 ? (double)stats.hits / lookups : 0.0);
+      result.Set("inserts", (double)stats.inserts);
+      result.Set("evictions", (double)stats.evictions);
+      result.Set("rejected", (double)stats.rejected);
+      result.Set("reclaimed", (double)stats.reclaimed);
+      return result;
+    }
+
+    // 关闭帧缓存，创建者关闭后新窗口会重新创建
+    static Napi::Value CloseFrameCache(const Napi::CallbackInfo &info) {
+      Napi::Env env = info.Env();
+
+      if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (name: string)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      frameCaches.erase(
+          ShmFrameCache::normalizeName(info[0].As<Napi::String>().Utf8Value()));
+      return Napi::Boolean::New(env, true);
+    }
 };
 
 std::map<std::string, SharedMemoryManager::SharedMemoryInfo> 
     SharedMemoryManager::sharedMemories;
+std::map<std::string, std::unique_ptr<ShmFrameRing>>
+    SharedMemoryManager::frameRings;
+ShmFileMapCache SharedMemoryManager::fileMaps;
+std::map<std::string, std::unique_ptr<ShmFrameCache>>
+    SharedMemoryManager::frameCaches;
 
 // 初始化静态成员变量
 Napi::Reference<Napi::Buffer<uint8_t>> *SharedMemoryManager::cachedImageBuffer =
@@ -477,6 +1196,7 @@ int SharedMemoryManager::cachedHeight = 0;
 int SharedMemoryManager::m_nLine = 0;
 // 模块初始化
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    exportWorkPool(env, exports);
     exports.Set("create", Napi::Function::New(env, SharedMemoryManager::Create));
     exports.Set("write", Napi::Function::New(env, SharedMemoryManager::Write));
     exports.Set("read", Napi::Function::New(env, SharedMemoryManager::Read));
@@ -488,6 +1208,34 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
                 Napi::Function::New(env, SharedMemoryManager::MapSharedMemory));
     exports.Set("getMappedView",
                 Napi::Function::New(env, SharedMemoryManager::GetMappedView));
+    exports.Set("createFrameRing",
+                Napi::Function::New(env, SharedMemoryManager::CreateFrameRing));
+    exports.Set("writeFrame",
+                Napi::Function::New(env, SharedMemoryManager::WriteFrame));
+    exports.Set("openFrameRing",
+                Napi::Function::New(env, SharedMemoryManager::OpenFrameRing));
+    exports.Set("readFrame",
+                Napi::Function::New(env, SharedMemoryManager::ReadFrame));
+    exports.Set("getFrameRingState",
+                Napi::Function::New(env, SharedMemoryManager::GetFrameRingState));
+    exports.Set("closeFrameRing",
+                Napi::Function::New(env, SharedMemoryManager::CloseFrameRing));
+    exports.Set("convertToRgba",
+                Napi::Function::New(env, SharedMemoryManager::ConvertToRgba));
+    exports.Set("presentFrame",
+                Napi::Function::New(env, SharedMemoryManager::PresentFrame));
+    exports.Set("openFrameCache",
+                Napi::Function::New(env, SharedMemoryManager::OpenFrameCache));
+    exports.Set("getCachedFrame",
+                Napi::Function::New(env, SharedMemoryManager::GetCachedFrame));
+    exports.Set("putCachedFrame",
+                Napi::Function::New(env, SharedMemoryManager::PutCachedFrame));
+    exports.Set("invalidateCachedFrames",
+                Napi::Function::New(env, SharedMemoryManager::InvalidateCachedFrames));
+    exports.Set("getFrameCacheStats",
+                Napi::Function::New(env, SharedMemoryManager::GetFrameCacheStats));
+    exports.Set("closeFrameCache",
+                Napi::Function::New(env, SharedMemoryManager::CloseFrameCache));
     return exports;
 }
 
@@ -1,5 +1,52 @@
 {
   "targets": [
+    {
+      "target_name": "vaapi_decoder",
+      "includes": [ "../common/optimize.gypi" ],
+      "sources": [ "vaapi_decoder.cpp" ],
+      "include_dirs": [
+        "<!@(node -p \"require('node-addon-api').include\")",
+        "/usr/include/libdrm",
+        "../common"
+      ],
+      "dependencies": [
+        "<!(node -p \"require('node-addon-api').gyp\")"
+      ],
+      "libraries": [
+        "-lavformat",
+        "-lavcodec",
+        "-lavutil",
+        "-lswscale",
+        "-lva",
+        "-lva-drm",
+        "-lx264",
+        "-lx265",
+        "-lrt",
+        "-lpthread"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "cflags_cc": [ "-std=c++17", "-fexceptions" ],
+      "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ]
+    },
+    {
+      "target_name": "synthetic_decoder",
+      "includes": [ "../common/optimize.gypi" ],
+      "sources": [ "synthetic_decoder.cpp" ],
+      "include_dirs": [
+        "<!@(node -p \"require('node-addon-api').include\")"
+      ],
+      "dependencies": [
+        "<!(node -p \"require('node-addon-api').gyp\")"
+      ],
+      "libraries": [
+        "-lpthread"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "cflags_cc": [ "-std=c++17", "-fexceptions" ],
+      "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ]
+    },
     {
       "target_name": "pure_vaapi_decoder",
       "sources": [ "pure_vaapi_decoder.cpp" ],
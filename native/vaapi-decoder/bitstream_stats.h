@@ -0,0 +1,149 @@
+/**
+ * 逐帧码流统计
+ * 解码时顺带记录帧类型、压缩大小、平均 QP 和关键帧间隔，数据来自数据包和解码帧的 side data，
+ * 不额外解析码流。每攒够 N 帧输出一批紧凑的 double 数组，供码率/GOP 图表使用
+ *
+ * - 压缩大小：送入解码器前把数据包大小放进 AVPacket::opaque，由 AV_CODEC_FLAG_COPY_OPAQUE
+ *   带到对应的输出帧上（B 帧重排后仍然对应正确）
+ * - 平均 QP：AV_FRAME_DATA_VIDEO_ENC_PARAMS，按块面积加权。目前只有 H.264 软解导出，
+ *   硬解和 HEVC 为 -1
+ */
+#pragma once
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#if __has_include(<libavutil/video_enc_params.h>)
+#include <libavutil/video_enc_params.h>
+#define BITSTREAM_STATS_HAS_QP 1
+#endif
+}
+
+#include <cstdint>
+#include <vector>
+
+// 每帧一条记录，BSTAT_FIELD_COUNT 个 double
+enum BitstreamStatsField {
+    BSTAT_FRAME_INDEX = 0,
+    BSTAT_PTS = 1,
+    BSTAT_PICT_TYPE = 2,      // AVPictureType: 1=I 2=P 3=B，0 未知
+    BSTAT_KEYFRAME = 3,       // 1 为关键帧
+    BSTAT_PACKET_SIZE = 4,    // 压缩大小（字节），未知为 -1
+    BSTAT_AVG_QP = 5,         // 平均 QP，无法导出时为 -1
+    BSTAT_GOP_POSITION = 6,   // 距上一个关键帧的帧数，关键帧为 0，seek 后第一个关键帧之前为 -1
+    BSTAT_GOP_LENGTH = 7,     // 关键帧上记录上一个 GOP 的帧数，其他帧为 0
+    BSTAT_FIELD_COUNT = 8,
+};
+
+class BitstreamStats {
+public:
+    explicit BitstreamStats(int batch_frames)
+        : batch_frames_(batch_frames > 0 ? batch_frames : 60) {
+        records_.reserve((size_t)batch_frames_ * BSTAT_FIELD_COUNT);
+    }
+
+    // 在 avcodec_open2 之前或之后调用均可，两个开关都在每帧解码时读取
+    static void configureContext(AVCodecContext* ctx) {
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+        ctx->flags |= AV_CODEC_FLAG_COPY_OPAQUE;
+#endif
+#ifdef AV_CODEC_EXPORT_DATA_VIDEO_ENC_PARAMS
+        ctx->export_side_data |= AV_CODEC_EXPORT_DATA_VIDEO_ENC_PARAMS;
+#endif
+    }
+
+    // 关闭统计后不再导出 QP 表，避免每帧多一次分配
+    static void unconfigureContext(AVCodecContext* ctx) {
+#ifdef AV_CODEC_EXPORT_DATA_VIDEO_ENC_PARAMS
+        ctx->export_side_data &= ~AV_CODEC_EXPORT_DATA_VIDEO_ENC_PARAMS;
+#endif
+    }
+
+    // 送入解码器前调用
+    static void tagPacket(AVPacket* packet) {
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+        packet->opaque = (void*)(intptr_t)packet->size;
+#else
+        (void)packet;
+#endif
+    }
+
+    // frame 为解码器直接输出的帧（硬解时为 VAAPI 帧，side data 在它上面）
+    void add(const AVFrame* frame, double pts, int64_t frame_index) {
+#ifdef AV_FRAME_FLAG_KEY
+        bool key = (frame->flags & AV_FRAME_FLAG_KEY) != 0;
+#else
+        bool key = frame->key_frame != 0;
+#endif
+        double gop_position = -1;
+        double gop_length = 0;
+        if (key) {
+            if (last_key_index_ >= 0) gop_length = (double)(frame_index - last_key_index_);
+            last_key_index_ = frame_index;
+            gop_position = 0;
+        } else if (last_key_index_ >= 0) {
+            gop_position = (double)(frame_index - last_key_index_);
+        }
+
+        double record[BSTAT_FIELD_COUNT];
+        record[BSTAT_FRAME_INDEX] = (double)frame_index;
+        record[BSTAT_PTS] = pts;
+        record[BSTAT_PICT_TYPE] = (double)frame->pict_type;
+        record[BSTAT_KEYFRAME] = key ? 1 : 0;
+        record[BSTAT_PACKET_SIZE] = packetSize(frame);
+        record[BSTAT_AVG_QP] = averageQp(frame);
+        record[BSTAT_GOP_POSITION] = gop_position;
+        record[BSTAT_GOP_LENGTH] = gop_length;
+        records_.insert(records_.end(), record, record + BSTAT_FIELD_COUNT);
+    }
+
+    bool ready() const { return records_.size() >= (size_t)batch_frames_ * BSTAT_FIELD_COUNT; }
+    bool empty() const { return records_.empty(); }
+
+    // 取出已积累的记录（可能不足一批）
+    std::vector<double> take() {
+        std::vector<double> out;
+        out.reserve((size_t)batch_frames_ * BSTAT_FIELD_COUNT);
+        out.swap(records_);
+        return out;
+    }
+
+    // seek 或重新打开后帧序号不连续，GOP 从下一个关键帧重新计
+    void resetGop() { last_key_index_ = -1; }
+
+private:
+    int batch_frames_;
+    std::vector<double> records_;
+    int64_t last_key_index_ = -1;
+
+    static double packetSize(const AVFrame* frame) {
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+        intptr_t size = (intptr_t)frame->opaque;
+        return size > 0 ? (double)size : -1;
+#else
+        return frame->pkt_size > 0 ? (double)frame->pkt_size : -1;
+#endif
+    }
+
+    static double averageQp(const AVFrame* frame) {
+#ifdef BITSTREAM_STATS_HAS_QP
+        AVFrameSideData* sd = av_frame_get_side_data(frame, AV_FRAME_DATA_VIDEO_ENC_PARAMS);
+        if (!sd) return -1;
+        AVVideoEncParams* params = (AVVideoEncParams*)sd->data;
+        if (params->nb_blocks == 0) return params->qp;
+
+        double weighted = 0;
+        double area = 0;
+        for (unsigned i = 0; i < params->nb_blocks; i++) {
+            AVVideoBlockParams* block = av_video_enc_params_block(params, i);
+            double block_area = (double)block->w * block->h;
+            weighted += (params->qp + block->delta_qp) * block_area;
+            area += block_area;
+        }
+        return area > 0 ? weighted / area : params->qp;
+#else
+        (void)frame;
+        return -1;
+#endif
+    }
+};
@@ -0,0 +1,569 @@
+/**
+ * 无损片段导出
+ * 在后台线程中把输入的 [start, end) 区间按数据包原样复制到新的 MP4/MKV，不解码也不重新编码，
+ * 速度只受磁盘限制。起点对齐到不晚于 start 的关键帧：
+ *  - keyframe 模式：片段从该关键帧开始，时间戳从 0 开始
+ *  - exact 模式：同样复制该关键帧起的整个 GOP，但时间戳以 start 为零点，关键帧到 start 之间的帧
+ *    时间戳为负，由 MP4 编辑列表隐藏，播放器从 start 精确开始显示。
+ *    只有允许负时间戳的封装（MP4/MOV）支持，其他封装回退到 keyframe 模式
+ * 输入可以是本地 .m3u8 分段播放列表（见 segment_playlist.h）
+ */
+#pragma once
+
+#include <napi.h>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/mathematics.h>
+}
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "readahead_io.h"
+#include "segment_playlist.h"
+
+// 导出进度
+struct ClipProgress {
+    double progress = 0;        // 0-1
+    uint64_t packets = 0;
+    uint64_t bytes = 0;         // 已写入输出文件的字节数
+    double mb_per_sec = 0;
+    double actual_start = 0;    // 片段实际起点（秒，相对输入起始），keyframe 模式为关键帧时间
+    double preroll = 0;         // exact 模式下编辑列表隐藏的关键帧到 start 的时长
+    double actual_end = 0;      // 最后一个视频帧的时间
+    bool exact = false;         // 是否以 exact 模式导出
+    int streams = 0;            // 输出的流数
+    int skipped_streams = 0;    // 输出封装不支持而跳过的流
+    bool done = false;
+    bool cancelled = false;
+    std::string error;
+};
+
+class ClipExporter {
+public:
+    enum CutMode {
+        CUT_KEYFRAME = 0,
+        CUT_EXACT,
+    };
+
+    struct Options {
+        std::string input_path;
+        std::string output_path;   // 封装由扩展名决定（.mp4/.mov/.mkv），或由 format 指定
+        std::string format;
+        double start = 0;          // 秒，相对输入起始
+        double end = 0;            // <= start 表示到文件末尾
+        CutMode mode = CUT_KEYFRAME;
+        bool audio = true;         // 同时复制音频流
+        bool faststart = false;    // MP4 把 moov 移到文件头（需要把整个文件再写一遍）
+    };
+
+    using ProgressCallback = std::function<void(const ClipProgress&)>;
+
+    ClipExporter() = default;
+    ~ClipExporter() { cancel(); }
+
+    bool start(const Options& options, ProgressCallback callback, std::string& error) {
+        if (running_) {
+            error = "Export already running";
+            return false;
+        }
+        if (worker_.joinable()) worker_.join();
+
+        options_ = options;
+        callback_ = std::move(callback);
+        cancel_requested_ = false;
+        running_ = true;
+        worker_ = std::thread(&ClipExporter::run, this);
+        return true;
+    }
+
+    void cancel() {
+        cancel_requested_ = true;
+        if (worker_.joinable()) worker_.join();
+    }
+
+    bool isRunning() const { return running_; }
+
+private:
+    Options options_;
+    ProgressCallback callback_;
+    std::thread worker_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> cancel_requested_{false};
+
+    // 一次导出的输入输出状态，run() 结束时释放
+    struct Job {
+        AVFormatContext* ic = nullptr;
+        AVFormatContext* oc = nullptr;
+        std::unique_ptr<ReadAheadFile> io_file;
+        AVIOContext* io_ctx = nullptr;
+        std::unique_ptr<SegmentPlaylist> playlist;
+        std::vector<int> stream_map;       // 输入流 -> 输出流，-1 表示不输出
+        std::vector<bool> stream_done;     // 已越过 end
+        int video = -1;
+        bool output_opened = false;   // 输出文件由本次导出创建，失败时删除
+
+        ~Job() {
+            if (ic) avformat_close_input(&ic);
+            ReadAheadFile::freeAvio(&io_ctx);
+            if (oc) {
+                if (oc->pb) avio_closep(&oc->pb);
+                avformat_free_context(oc);
+            }
+        }
+    };
+
+    void report(const ClipProgress& progress) {
+        if (callback_) callback_(progress);
+    }
+
+    void finish(ClipProgress& progress, const std::string& error) {
+        progress.done = true;
+        progress.cancelled = cancel_requested_;
+        progress.error = error;
+        running_ = false;
+        report(progress);
+    }
+
+    static std::string avError(const std::string& message, int ret) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        return message + " - " + errbuf;
+    }
+
+    // 本地播放列表的分段拼接成一个输入（与 VaapiDecoder 相同），其他输入使用 FFmpeg 默认协议
+    bool openInput(Job& job, std::string& error) {
+        std::string input = options_.input_path;
+        if (SegmentPlaylist::isPlaylist(input) && input.find("://") == std::string::npos) {
+            job.playlist = std::make_unique<SegmentPlaylist>();
+            if (!job.playlist->load(input, error)) return false;
+            job.io_file = std::make_unique<ReadAheadFile>();
+            if (!job.io_file->openSegments(job.playlist->files(), ReadAheadFile::Config(), error)) return false;
+            job.io_ctx = job.io_file->createAvio();
+            job.ic = job.io_ctx ? avformat_alloc_context() : nullptr;
+            if (!job.ic) {
+                error = "Failed to allocate playlist input";
+                return false;
+            }
+            job.ic->pb = job.io_ctx;
+            job.ic->flags |= AVFMT_FLAG_CUSTOM_IO;
+            input = job.playlist->entries().front().path;
+        }
+        int ret = avformat_open_input(&job.ic, input.c_str(), nullptr, nullptr);
+        if (ret < 0) {
+            error = avError("Failed to open input: " + options_.input_path, ret);
+            return false;
+        }
+        if (avformat_find_stream_info(job.ic, nullptr) < 0) {
+            error = "Failed to find stream info";
+            return false;
+        }
+        job.video = av_find_best_stream(job.ic, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (job.video < 0) {
+            error = "No video stream found";
+            return false;
+        }
+        return true;
+    }
+
+    bool openOutput(Job& job, ClipProgress& progress, std::string& error) {
+        const char* format = options_.format.empty() ? nullptr : options_.format.c_str();
+        if (avformat_alloc_output_context2(&job.oc, nullptr, format, options_.output_path.c_str()) < 0 || !job.oc) {
+            error = "Unsupported output format: " + options_.output_path;
+            return false;
+        }
+
+        job.stream_map.assign(job.ic->nb_streams, -1);
+        job.stream_done.assign(job.ic->nb_streams, true);
+        for (unsigned i = 0; i < job.ic->nb_streams; i++) {
+            AVStream* in = job.ic->streams[i];
+            AVMediaType type = in->codecpar->codec_type;
+            bool wanted = (int)i == job.video || (options_.audio && type == AVMEDIA_TYPE_AUDIO);
+            if (!wanted) continue;
+            if (avformat_query_codec(job.oc->oformat, in->codecpar->codec_id, FF_COMPLIANCE_NORMAL) == 0) {
+                if ((int)i == job.video) {
+                    error = std::string("Output format cannot hold ") + avcodec_get_name(in->codecpar->codec_id);
+                    return false;
+                }
+                progress.skipped_streams++;
+                continue;
+            }
+            AVStream* out = avformat_new_stream(job.oc, nullptr);
+            if (!out || avcodec_parameters_copy(out->codecpar, in->codecpar) < 0) {
+                error = "Failed to create output stream";
+                return false;
+            }
+            out->codecpar->codec_tag = 0;
+            out->time_base = in->time_base;
+            out->avg_frame_rate = in->avg_frame_rate;
+            out->disposition = in->disposition;
+            av_dict_copy(&out->metadata, in->metadata, 0);
+            job.stream_map[i] = out->index;
+            job.stream_done[i] = false;
+        }
+        progress.streams = (int)job.oc->nb_streams;
+
+        if (!(job.oc->oformat->flags & AVFMT_NOFILE)) {
+            int ret = avio_open(&job.oc->pb, options_.output_path.c_str(), AVIO_FLAG_WRITE);
+            if (ret < 0) {
+                error = avError("Failed to open output file: " + options_.output_path, ret);
+                return false;
+            }
+            job.output_opened = true;
+        }
+        AVDictionary* mux_options = nullptr;
+        if (options_.faststart) av_dict_set(&mux_options, "movflags", "+faststart", 0);
+        int ret = avformat_write_header(job.oc, &mux_options);
+        av_dict_free(&mux_options);
+        if (ret < 0) {
+            error = avError("Failed to write header", ret);
+            return false;
+        }
+        return true;
+    }
+
+    // 定位到不晚于 start 的位置；TS 分段播放列表直接定位到所在分段的起始字节
+    void seekToStart(Job& job, int64_t start_us) {
+        if (options_.start <= 0) return;
+        if (job.playlist && strcmp(job.ic->iformat->name, "mpegts") == 0) {
+            size_t entry = job.playlist->entryAt(options_.start);
+            av_seek_frame(job.ic, -1, job.io_file->segmentOffset(entry), AVSEEK_FLAG_BYTE);
+            return;
+        }
+        AVStream* stream = job.ic->streams[job.video];
+        int64_t ts = av_rescale_q(start_us, AV_TIME_BASE_Q, stream->time_base);
+        if (av_seek_frame(job.ic, job.video, ts, AVSEEK_FLAG_BACKWARD) < 0) {
+            // 不能按时间定位的输入从头读，起点之前的数据包在下面丢弃
+            av_seek_frame(job.ic, -1, 0, AVSEEK_FLAG_BYTE);
+        }
+    }
+
+    static int64_t packetTimeUs(const AVPacket* pkt, AVRational tb, bool use_dts) {
+        int64_t ts = use_dts ? (pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts)
+                             : (pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts);
+        return ts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE : av_rescale_q(ts, tb, AV_TIME_BASE_Q);
+    }
+
+    bool writePacket(Job& job, AVPacket* pkt, int64_t offset_us, ClipProgress& progress) {
+        AVStream* in = job.ic->streams[pkt->stream_index];
+        AVStream* out = job.oc->streams[job.stream_map[pkt->stream_index]];
+        int64_t offset = av_rescale_q(offset_us, AV_TIME_BASE_Q, in->time_base);
+        if (pkt->pts != AV_NOPTS_VALUE) pkt->pts -= offset;
+        if (pkt->dts != AV_NOPTS_VALUE) pkt->dts -= offset;
+        av_packet_rescale_ts(pkt, in->time_base, out->time_base);
+        pkt->stream_index = out->index;
+        pkt->pos = -1;
+        progress.packets++;
+        return av_interleaved_write_frame(job.oc, pkt) >= 0;
+    }
+
+    void run() {
+        ClipProgress progress;
+        std::string error;
+        Job job;
+        if (!openInput(job, error) || !openOutput(job, progress, error)) {
+            if (job.output_opened) unlink(options_.output_path.c_str());
+            finish(progress, error);
+            return;
+        }
+
+        int64_t file_start = job.ic->start_time != AV_NOPTS_VALUE ? job.ic->start_time : 0;
+        int64_t start_us = file_start + (int64_t)(options_.start * AV_TIME_BASE);
+        bool to_end = options_.end <= options_.start;
+        int64_t end_us = to_end ? INT64_MAX : file_start + (int64_t)(options_.end * AV_TIME_BASE);
+        double span = to_end ? (job.ic->duration > 0 ? (double)job.ic->duration / AV_TIME_BASE - options_.start : 0)
+                             : options_.end - options_.start;
+        // 编辑列表依赖负时间戳，只有 MP4/MOV 这类封装支持
+        bool exact = options_.mode == CUT_EXACT && (job.oc->oformat->flags & AVFMT_TS_NEGATIVE);
+        progress.exact = exact;
+
+        seekToStart(job, start_us);
+
+        AVPacket* pkt = av_packet_alloc();
+        // 起点之前：缓存从最近一个不晚于 start 的关键帧开始的数据包，遇到更晚的关键帧时丢弃重来
+        std::deque<AVPacket*> pending;
+        bool committed = false;
+        int64_t cut_us = AV_NOPTS_VALUE;
+        int64_t offset_us = 0;
+        int64_t last_video_us = AV_NOPTS_VALUE;
+        auto clearPending = [&] {
+            for (AVPacket* p : pending) av_packet_free(&p);
+            pending.clear();
+        };
+        auto t0 = std::chrono::steady_clock::now();
+        auto last_report = t0;
+
+        while (!cancel_requested_ && error.empty()) {
+            int ret = av_read_frame(job.ic, pkt);
+            if (ret < 0) {
+                if (ret != AVERROR_EOF && !avio_feof(job.ic->pb)) error = avError("Read failed", ret);
+                break;
+            }
+            int index = pkt->stream_index;
+            if (index >= (int)job.stream_map.size() || job.stream_map[index] < 0 || job.stream_done[index]) {
+                av_packet_unref(pkt);
+                continue;
+            }
+            AVRational tb = job.ic->streams[index]->time_base;
+            bool is_video = index == job.video;
+            bool key = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+
+            if (!committed) {
+                int64_t pts_us = packetTimeUs(pkt, tb, false);
+                int64_t dts_us = packetTimeUs(pkt, tb, true);
+                if (pts_us == AV_NOPTS_VALUE) {
+                    av_packet_unref(pkt);  // 无时间戳的数据包无法判断是否在起点之后
+                    continue;
+                }
+                bool commit = false;
+                if (is_video) {
+                    if (key && pts_us <= start_us) {
+                        clearPending();
+                        cut_us = pts_us;
+                    } else if (key && cut_us == AV_NOPTS_VALUE) {
+                        // 起点在第一个关键帧之前（或定位越过了起点）：从这个关键帧开始
+                        clearPending();
+                        cut_us = pts_us;
+                        commit = true;
+                    } else if (cut_us == AV_NOPTS_VALUE) {
+                        av_packet_unref(pkt);  // 第一个关键帧之前的帧无法单独解码
+                        continue;
+                    } else if (key || (dts_us != AV_NOPTS_VALUE && dts_us > start_us)) {
+                        // 之后不会再有时间戳不晚于 start 的关键帧
+                        commit = true;
+                    }
+                }
+                if (!commit) {
+                    AVPacket* copy = av_packet_clone(pkt);
+                    if (copy) pending.push_back(copy);
+                    av_packet_unref(pkt);
+                    continue;
+                }
+
+                committed = true;
+                offset_us = exact && cut_us < start_us ? start_us : cut_us;
+                progress.actual_start = (double)(offset_us - file_start) / AV_TIME_BASE;
+                progress.preroll = (double)(offset_us - cut_us) / AV_TIME_BASE;
+                // 音频从画面开始显示的时刻开始
+                for (AVPacket* p : pending) {
+                    bool p_video = p->stream_index == job.video;
+                    int64_t p_us = packetTimeUs(p, job.ic->streams[p->stream_index]->time_base, false);
+                    if (!p_video && p_us < offset_us) continue;
+                    if (p_video) last_video_us = std::max(last_video_us, p_us);
+                    if (!writePacket(job, p, offset_us, progress)) {
+                        error = "Failed to write packet";
+                        break;
+                    }
+                }
+                clearPending();
+                if (!error.empty()) {
+                    av_packet_unref(pkt);
+                    break;
+                }
+            }
+
+            // 视频按解码时间截止，保证 end 之前显示的帧所参考的帧都在片段中
+            int64_t t_us = packetTimeUs(pkt, tb, is_video);
+            if (t_us != AV_NOPTS_VALUE && t_us >= end_us) {
+                job.stream_done[index] = true;
+                av_packet_unref(pkt);
+                if (std::all_of(job.stream_done.begin(), job.stream_done.end(), [](bool d) { return d; })) break;
+                continue;
+            }
+            if (!is_video && (t_us == AV_NOPTS_VALUE || t_us < offset_us)) {
+                av_packet_unref(pkt);
+                continue;
+            }
+            if (is_video) {
+                int64_t pts_us = packetTimeUs(pkt, tb, false);
+                if (pts_us != AV_NOPTS_VALUE) last_video_us = std::max(last_video_us, pts_us);
+            }
+            if (!writePacket(job, pkt, offset_us, progress)) {
+                error = "Failed to write packet";
+            }
+            av_packet_unref(pkt);
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_report >= std::chrono::milliseconds(250)) {
+                last_report = now;
+                double elapsed = std::chrono::duration<double>(now - t0).count();
+                progress.bytes = job.oc->pb ? (uint64_t)avio_tell(job.oc->pb) : 0;
+                progress.mb_per_sec = elapsed > 0 ? progress.bytes / elapsed / (1 << 20) : 0;
+                double written = last_video_us != AV_NOPTS_VALUE ? (double)(last_video_us - offset_us) / AV_TIME_BASE : 0;
+                progress.progress = span > 0 ? std::max(0.0, std::min(1.0, written / span)) : 0;
+                progress.actual_end = last_video_us != AV_NOPTS_VALUE ? (double)(last_video_us - file_start) / AV_TIME_BASE : 0;
+                report(progress);
+            }
+        }
+        clearPending();
+        av_packet_free(&pkt);
+
+        if (error.empty() && !cancel_requested_ && !committed) {
+            error = "No keyframe found in the requested range";
+        }
+        bool ok = error.empty() && !cancel_requested_;
+        if (ok && av_write_trailer(job.oc) < 0) {
+            error = "Failed to finalize output";
+            ok = false;
+        }
+        if (job.oc->pb) {
+            avio_flush(job.oc->pb);
+            progress.bytes = (uint64_t)avio_tell(job.oc->pb);
+            avio_closep(&job.oc->pb);
+        }
+        // 取消或失败时不留下不完整的文件
+        if (!ok) unlink(options_.output_path.c_str());
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        progress.mb_per_sec = elapsed > 0 ? progress.bytes / elapsed / (1 << 20) : 0;
+        if (last_video_us != AV_NOPTS_VALUE) {
+            progress.actual_end = (double)(last_video_us - file_start) / AV_TIME_BASE;
+        }
+        if (ok) progress.progress = 1;
+        finish(progress, error);
+    }
+};
+
+// ================ N-API 绑定 ================
+
+class ClipExporterWrapper : public Napi::ObjectWrap<ClipExporterWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "ClipExporter", {
+            InstanceMethod("start", &ClipExporterWrapper::Start),
+            InstanceMethod("cancel", &ClipExporterWrapper::Cancel),
+            InstanceMethod("isRunning", &ClipExporterWrapper::IsRunning),
+        });
+
+        exports.Set("ClipExporter", func);
+        return exports;
+    }
+
+    ClipExporterWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<ClipExporterWrapper>(info) {
+        exporter_ = std::make_unique<ClipExporter>();
+    }
+
+    ~ClipExporterWrapper() {
+        exporter_->cancel();
+        releaseCallback();
+    }
+
+private:
+    std::unique_ptr<ClipExporter> exporter_;
+    Napi::ThreadSafeFunction tsfn_;
+    bool has_tsfn_ = false;
+
+    void releaseCallback() {
+        if (has_tsfn_) {
+            tsfn_.Release();
+            has_tsfn_ = false;
+        }
+    }
+
+    // 开始导出: ({ input, output, start, end?, mode?: 'keyframe' | 'exact', format?, audio?, faststart? }, onProgress)
+    Napi::Value Start(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+            Napi::TypeError::New(env, "Expected (options, onProgress)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Object opts = info[0].As<Napi::Object>();
+        if (!opts.Get("input").IsString() || !opts.Get("output").IsString()) {
+            Napi::TypeError::New(env, "input and output are required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        ClipExporter::Options options;
+        options.input_path = opts.Get("input").As<Napi::String>().Utf8Value();
+        options.output_path = opts.Get("output").As<Napi::String>().Utf8Value();
+        if (opts.Get("format").IsString()) options.format = opts.Get("format").As<Napi::String>().Utf8Value();
+        if (opts.Get("start").IsNumber()) options.start = std::max(0.0, opts.Get("start").As<Napi::Number>().DoubleValue());
+        if (opts.Get("end").IsNumber()) options.end = opts.Get("end").As<Napi::Number>().DoubleValue();
+        if (opts.Get("mode").IsString()) {
+            std::string mode = opts.Get("mode").As<Napi::String>().Utf8Value();
+            if (mode == "exact") {
+                options.mode = ClipExporter::CUT_EXACT;
+            } else if (mode != "keyframe") {
+                Napi::TypeError::New(env, "mode must be 'keyframe' or 'exact'").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+        }
+        if (opts.Get("audio").IsBoolean()) options.audio = opts.Get("audio").As<Napi::Boolean>().Value();
+        if (opts.Get("faststart").IsBoolean()) options.faststart = opts.Get("faststart").As<Napi::Boolean>().Value();
+
+        if (exporter_->isRunning()) {
+            Napi::Error::New(env, "Export already running").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        exporter_->cancel();
+        releaseCallback();
+
+        tsfn_ = Napi::ThreadSafeFunction::New(env, info[1].As<Napi::Function>(), "ClipProgress", 0, 1);
+        tsfn_.Unref(env);
+        has_tsfn_ = true;
+
+        Napi::ThreadSafeFunction tsfn = tsfn_;
+        std::string error;
+        bool ok = exporter_->start(options, [tsfn](const ClipProgress& progress) mutable {
+            ClipProgress* data = new ClipProgress(progress);
+            // 最终结果不能丢，中间进度可以
+            napi_status status = data->done
+                ? tsfn.BlockingCall(data, &ClipExporterWrapper::deliver)
+                : tsfn.NonBlockingCall(data, &ClipExporterWrapper::deliver);
+            if (status != napi_ok) {
+                delete data;
+            }
+        }, error);
+
+        if (!ok) {
+            releaseCallback();
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
+
+    static void deliver(Napi::Env env, Napi::Function callback, ClipProgress* data) {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("progress", Napi::Number::New(env, data->progress));
+        result.Set("packets", Napi::Number::New(env, (double)data->packets));
+        result.Set("bytes", Napi::Number::New(env, (double)data->bytes));
+        result.Set("mbPerSec", Napi::Number::New(env, data->mb_per_sec));
+        result.Set("actualStart", Napi::Number::New(env, data->actual_start));
+        result.Set("preroll", Napi::Number::New(env, data->preroll));
+        result.Set("actualEnd", Napi::Number::New(env, data->actual_end));
+        result.Set("exact", Napi::Boolean::New(env, data->exact));
+        result.Set("streams", Napi::Number::New(env, data->streams));
+        result.Set("skippedStreams", Napi::Number::New(env, data->skipped_streams));
+        result.Set("done", Napi::Boolean::New(env, data->done));
+        result.Set("cancelled", Napi::Boolean::New(env, data->cancelled));
+        if (!data->error.empty()) {
+            result.Set("error", Napi::String::New(env, data->error));
+        }
+        delete data;
+        callback.Call({result});
+    }
+
+    Napi::Value Cancel(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        exporter_->cancel();
+        return env.Undefined();
+    }
+
+    Napi::Value IsRunning(const Napi::CallbackInfo& info) {
+        return Napi::Boolean::New(info.Env(), exporter_->isRunning());
+    }
+};
@@ -0,0 +1,551 @@
+/**
+ * 分片 MP4 重封装
+ * 解复用任意 FFmpeg 支持的容器，将视频流不重编码地封装为内存中的 fMP4 分片，
+ * 供渲染进程的 MediaSource 直接播放（由 Chromium 解码，省去原生解码和帧拷贝）
+ */
+#pragma once
+
+#include <napi.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// FFmpeg 7 起 AVIO 写回调的缓冲参数为 const
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+#define FMP4_AVIO_WRITE_BUF const uint8_t*
+#else
+#define FMP4_AVIO_WRITE_BUF uint8_t*
+#endif
+
+class Fmp4Remuxer {
+public:
+    struct StreamInfo {
+        std::string mime_type;   // 如 video/mp4; codecs="avc1.64001f"
+        std::string codec;
+        int width = 0;
+        int height = 0;
+        double duration = 0;
+    };
+
+    struct Segment {
+        std::vector<uint8_t> data;
+        double start = 0;        // 秒
+        double duration = 0;
+    };
+
+    Fmp4Remuxer() {
+        pkt_ = av_packet_alloc();
+    }
+
+    ~Fmp4Remuxer() {
+        close();
+        av_packet_free(&pkt_);
+    }
+
+    // 打开输入并生成初始化分片 (ftyp + moov)
+    bool open(const std::string& path, double segment_duration, StreamInfo* info,
+              std::vector<uint8_t>& init_segment) {
+        close();
+        segment_duration_ = segment_duration > 0 ? segment_duration : 2.0;
+
+        int ret = avformat_open_input(&in_ctx_, path.c_str(), nullptr, nullptr);
+        if (ret < 0) {
+            setError("Failed to open input: " + path, ret);
+            return false;
+        }
+        if (avformat_find_stream_info(in_ctx_, nullptr) < 0) {
+            last_error_ = "Failed to find stream info";
+            close();
+            return false;
+        }
+        stream_idx_ = av_find_best_stream(in_ctx_, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (stream_idx_ < 0) {
+            last_error_ = "No video stream found";
+            close();
+            return false;
+        }
+        AVStream* in_stream = in_ctx_->streams[stream_idx_];
+        AVCodecParameters* in_par = in_stream->codecpar;
+        if (in_par->codec_id != AV_CODEC_ID_H264 && in_par->codec_id != AV_CODEC_ID_HEVC) {
+            last_error_ = std::string("Codec not supported by MSE remux: ") + avcodec_get_name(in_par->codec_id);
+            close();
+            return false;
+        }
+
+        if (!openOutput(false)) {
+            close();
+            return false;
+        }
+        init_segment.swap(output_);
+        output_.clear();
+
+        start_time_ = in_stream->start_time != AV_NOPTS_VALUE ? in_stream->start_time : 0;
+        segment_start_ = -1;
+        pending_packets_ = 0;
+        eof_ = false;
+        failed_ = false;
+
+        info->codec = codecString(in_par);
+        info->mime_type = "video/mp4; codecs=\"" + info->codec + "\"";
+        info->width = in_par->width;
+        info->height = in_par->height;
+        info->duration = in_ctx_->duration != AV_NOPTS_VALUE ? (double)in_ctx_->duration / AV_TIME_BASE : 0;
+        return true;
+    }
+
+    // 读取下一个媒体分片 (moof + mdat)，文件结束或出错返回 false（出错时 failed() 为 true）
+    bool readSegment(Segment* segment) {
+        if (!in_ctx_ || eof_ || failed_) return false;
+        AVStream* in_stream = in_ctx_->streams[stream_idx_];
+
+        while (true) {
+            int ret = av_read_frame(in_ctx_, pkt_);
+            if (ret < 0) {
+                eof_ = true;
+                // 输出最后一个分片并写入结尾
+                if (pending_packets_ > 0) {
+                    return flushFragment(segment, last_end_);
+                }
+                return false;
+            }
+            if (pkt_->stream_index != stream_idx_) {
+                av_packet_unref(pkt_);
+                continue;
+            }
+
+            // 与 VaapiDecoder 一致，时间戳相对流起始时间
+            if (pkt_->pts != AV_NOPTS_VALUE) pkt_->pts -= start_time_;
+            if (pkt_->dts != AV_NOPTS_VALUE) pkt_->dts -= start_time_;
+            double pts = pkt_->pts != AV_NOPTS_VALUE ? pkt_->pts * av_q2d(in_stream->time_base) : last_end_;
+            bool keyframe = (pkt_->flags & AV_PKT_FLAG_KEY) != 0;
+
+            // 在关键帧处切分片
+            bool cut = keyframe && pending_packets_ > 0 && pts - segment_start_ >= segment_duration_;
+            if (cut) {
+                // 先把当前包保留下来，输出已累积的分片
+                AVPacket* held = av_packet_clone(pkt_);
+                av_packet_unref(pkt_);
+                bool ok = flushFragment(segment, pts);
+                if (held) {
+                    // 写入失败时先交出已完成的分片，下一次读取返回错误
+                    writeToMuxer(held, pts, in_stream);
+                    av_packet_free(&held);
+                }
+                return ok;
+            }
+
+            bool written = writeToMuxer(pkt_, pts, in_stream);
+            av_packet_unref(pkt_);
+            if (!written) return false;
+        }
+    }
+
+    // 跳转到指定时间之前的关键帧，之后的分片从该关键帧开始。
+    // 向后跳转时时间戳会回退，mp4 muxer 拒绝 DTS 不递增的包，因此重建 muxer：
+    // 新的初始化分片与原来相同直接丢弃，frag_discont 让第一个分片的 tfdt 取跳转后的时间戳
+    bool seek(double seconds) {
+        if (!in_ctx_) return false;
+        AVStream* stream = in_ctx_->streams[stream_idx_];
+        int64_t ts = (int64_t)(seconds / av_q2d(stream->time_base)) + start_time_;
+        int ret = av_seek_frame(in_ctx_, stream_idx_, ts, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            setError("Failed to seek", ret);
+            return false;
+        }
+        // 尚未输出的半个分片随旧 muxer 一起丢弃
+        closeOutput();
+        bool ok = openOutput(true);
+        output_.clear();
+        pending_packets_ = 0;
+        segment_start_ = -1;
+        eof_ = false;
+        failed_ = !ok;
+        return ok;
+    }
+
+    void close() {
+        closeOutput();
+        if (in_ctx_) {
+            avformat_close_input(&in_ctx_);
+        }
+        output_.clear();
+        stream_idx_ = -1;
+    }
+
+    const std::string& lastError() const { return last_error_; }
+    bool failed() const { return failed_; }
+
+    // 生成 RFC 6381 codecs 字符串
+    static std::string codecString(const AVCodecParameters* par) {
+        return codecString(par->codec_id, par->extradata, par->extradata_size, par->profile, par->level);
+    }
+
+    // extradata 可以是 avcC/hvcC 或 Annex-B 参数集
+    static std::string codecString(AVCodecID codec_id, const uint8_t* extra, int extra_size,
+                                   int profile, int level) {
+        char buf[64];
+
+        if (codec_id == AV_CODEC_ID_H264) {
+            const uint8_t* sps = nullptr;
+            if (extra_size >= 4 && extra[0] == 1) {
+                // avcC: profile / constraint / level 位于第 1-3 字节
+                sps = extra + 1;
+            } else {
+                // Annex-B: 查找 SPS NAL (type 7)
+                for (int i = 0; i + 4 < extra_size; i++) {
+                    if (extra[i] == 0 && extra[i + 1] == 0 && extra[i + 2] == 1 && (extra[i + 3] & 0x1F) == 7) {
+                        if (i + 7 <= extra_size) sps = extra + i + 4;
+                        break;
+                    }
+                }
+            }
+            if (sps) {
+                snprintf(buf, sizeof(buf), "avc1.%02X%02X%02X", sps[0], sps[1], sps[2]);
+            } else {
+                snprintf(buf, sizeof(buf), "avc1.%02X00%02X",
+                         profile > 0 ? profile & 0xFF : 0x64, level > 0 ? level : 0x28);
+            }
+            return buf;
+        }
+
+        // HEVC: hvc1.<profile>.<兼容标志>.<L|H><level>.<约束标志>
+        if (extra_size >= 13 && extra[0] == 1) {
+            int profile_space = extra[1] >> 6;
+            int tier = (extra[1] >> 5) & 1;
+            int profile_idc = extra[1] & 0x1F;
+            uint32_t compat = ((uint32_t)extra[2] << 24) | ((uint32_t)extra[3] << 16) |
+                              ((uint32_t)extra[4] << 8) | extra[5];
+            // 兼容标志按位反序输出
+            uint32_t reversed = 0;
+            for (int i = 0; i < 32; i++) {
+                if (compat & (1u << i)) reversed |= 1u << (31 - i);
+            }
+            std::string s = "hvc1.";
+            if (profile_space > 0) s += (char)('A' + profile_space - 1);
+            snprintf(buf, sizeof(buf), "%d.%X.%c%d", profile_idc, reversed, tier ? 'H' : 'L', extra[12]);
+            s += buf;
+            // 约束标志去掉末尾的 0 字节
+            int last = 11;
+            while (last >= 6 && extra[last] == 0) last--;
+            for (int i = 6; i <= last; i++) {
+                snprintf(buf, sizeof(buf), ".%02X", extra[i]);
+                s += buf;
+            }
+            return s;
+        }
+        if (profile <= 0) profile = 1;
+        snprintf(buf, sizeof(buf), "hvc1.%d.%X.L%d.B0", profile, profile == 2 ? 4 : 6,
+                 level > 0 ? level : 120);
+        return buf;
+    }
+
+private:
+    AVFormatContext* in_ctx_ = nullptr;
+    AVFormatContext* out_ctx_ = nullptr;
+    AVStream* out_stream_ = nullptr;
+    AVPacket* pkt_ = nullptr;
+    int stream_idx_ = -1;
+    int64_t start_time_ = 0;
+    double segment_duration_ = 2.0;
+    double segment_start_ = -1;
+    double last_end_ = 0;
+    int pending_packets_ = 0;
+    bool eof_ = false;
+    bool failed_ = false;
+    bool header_written_ = false;
+    std::vector<uint8_t> output_;
+    std::string last_error_;
+
+    static int writePacket(void* opaque, FMP4_AVIO_WRITE_BUF buf, int size) {
+        Fmp4Remuxer* self = static_cast<Fmp4Remuxer*>(opaque);
+        self->output_.insert(self->output_.end(), buf, buf + size);
+        return size;
+    }
+
+    // 创建 mp4 muxer 并写入初始化分片（留在 output_ 中）
+    bool openOutput(bool discontinuous) {
+        AVCodecParameters* in_par = in_ctx_->streams[stream_idx_]->codecpar;
+        if (avformat_alloc_output_context2(&out_ctx_, nullptr, "mp4", nullptr) < 0 || !out_ctx_) {
+            last_error_ = "Failed to create MP4 muxer";
+            return false;
+        }
+        out_stream_ = avformat_new_stream(out_ctx_, nullptr);
+        if (!out_stream_ || avcodec_parameters_copy(out_stream_->codecpar, in_par) < 0) {
+            last_error_ = "Failed to create output stream";
+            return false;
+        }
+        // MSE 要求 hvc1（参数集在 hvcC 中）
+        out_stream_->codecpar->codec_tag =
+            in_par->codec_id == AV_CODEC_ID_HEVC ? MKTAG('h', 'v', 'c', '1') : 0;
+        out_stream_->time_base = in_ctx_->streams[stream_idx_]->time_base;
+
+        const int io_buffer_size = 64 * 1024;
+        uint8_t* io_buffer = static_cast<uint8_t*>(av_malloc(io_buffer_size));
+        out_ctx_->pb = avio_alloc_context(io_buffer, io_buffer_size, 1, this, nullptr,
+                                          &Fmp4Remuxer::writePacket, nullptr);
+        if (!out_ctx_->pb) {
+            av_free(io_buffer);
+            last_error_ = "Failed to allocate output IO";
+            return false;
+        }
+
+        // 手动切分片：每个分片以关键帧开头，moof 使用自身作为基准偏移
+        AVDictionary* opts = nullptr;
+        av_dict_set(&opts, "movflags", discontinuous
+                    ? "frag_custom+empty_moov+default_base_moof+omit_tfhd_offset+frag_discont"
+                    : "frag_custom+empty_moov+default_base_moof+omit_tfhd_offset", 0);
+        output_.clear();
+        int ret = avformat_write_header(out_ctx_, &opts);
+        av_dict_free(&opts);
+        if (ret < 0) {
+            setError("Failed to write init segment", ret);
+            return false;
+        }
+        header_written_ = true;
+        avio_flush(out_ctx_->pb);
+        return true;
+    }
+
+    void closeOutput() {
+        if (!out_ctx_) return;
+        // 写入结尾以释放 muxer 内部状态，输出内容直接丢弃
+        if (header_written_) av_write_trailer(out_ctx_);
+        header_written_ = false;
+        if (out_ctx_->pb) {
+            av_freep(&out_ctx_->pb->buffer);
+            avio_context_free(&out_ctx_->pb);
+        }
+        avformat_free_context(out_ctx_);
+        out_ctx_ = nullptr;
+        out_stream_ = nullptr;
+    }
+
+    bool writeToMuxer(AVPacket* pkt, double pts, AVStream* in_stream) {
+        if (segment_start_ < 0) segment_start_ = pts;
+        if (pkt->duration > 0) {
+            last_end_ = pts + pkt->duration * av_q2d(in_stream->time_base);
+        } else {
+            last_end_ = pts;
+        }
+        pkt->stream_index = out_stream_->index;
+        av_packet_rescale_ts(pkt, in_stream->time_base, out_stream_->time_base);
+        pkt->pos = -1;
+        int ret = av_write_frame(out_ctx_, pkt);
+        if (ret < 0) {
+            setError("Failed to write packet", ret);
+            failed_ = true;
+            return false;
+        }
+        pending_packets_++;
+        return true;
+    }
+
+    // 结束当前分片，取出 moof + mdat
+    bool flushFragment(Segment* segment, double end) {
+        int ret = av_write_frame(out_ctx_, nullptr);
+        if (ret < 0) {
+            setError("Failed to flush fragment", ret);
+            failed_ = true;
+            return false;
+        }
+        avio_flush(out_ctx_->pb);
+        segment->data.swap(output_);
+        output_.clear();
+        segment->start = segment_start_;
+        segment->duration = end - segment_start_;
+        segment_start_ = -1;
+        pending_packets_ = 0;
+        return !segment->data.empty();
+    }
+
+    void setError(const std::string& message, int ret) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        last_error_ = message + " - " + errbuf;
+    }
+};
+
+// ================ N-API 绑定 ================
+
+class Fmp4RemuxerWrapper : public Napi::ObjectWrap<Fmp4RemuxerWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "Fmp4Remuxer", {
+            InstanceMethod("open", &Fmp4RemuxerWrapper::Open),
+            InstanceMethod("readSegment", &Fmp4RemuxerWrapper::ReadSegment),
+            InstanceMethod("seek", &Fmp4RemuxerWrapper::Seek),
+            InstanceMethod("close", &Fmp4RemuxerWrapper::Close),
+        });
+
+        exports.Set("Fmp4Remuxer", func);
+        return exports;
+    }
+
+    Fmp4RemuxerWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<Fmp4RemuxerWrapper>(info) {
+        remuxer_ = std::make_shared<Fmp4Remuxer>();
+    }
+
+private:
+    // 工作线程持有 shared_ptr，JS 对象先被回收也不会访问已释放的内存
+    std::shared_ptr<Fmp4Remuxer> remuxer_;
+    std::shared_ptr<std::atomic<bool>> busy_ = std::make_shared<std::atomic<bool>>(false);
+
+    class OpenWorker : public Napi::AsyncWorker {
+    public:
+        OpenWorker(Napi::Env env, std::shared_ptr<Fmp4Remuxer> remuxer,
+                   std::shared_ptr<std::atomic<bool>> busy, const std::string& path, double segment_duration)
+            : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)),
+              remuxer_(remuxer), busy_(busy), path_(path), segment_duration_(segment_duration) {}
+
+        Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    protected:
+        void Execute() override {
+            if (!remuxer_->open(path_, segment_duration_, &info_, init_segment_)) {
+                SetError(remuxer_->lastError());
+            }
+        }
+
+        void OnOK() override {
+            Napi::Env env = Env();
+            *busy_ = false;
+            Napi::Object result = Napi::Object::New(env);
+            result.Set("mimeType", Napi::String::New(env, info_.mime_type));
+            result.Set("codec", Napi::String::New(env, info_.codec));
+            result.Set("width", Napi::Number::New(env, info_.width));
+            result.Set("height", Napi::Number::New(env, info_.height));
+            result.Set("duration", Napi::Number::New(env, info_.duration));
+            result.Set("initSegment", Napi::Buffer<uint8_t>::Copy(env, init_segment_.data(), init_segment_.size()));
+            deferred_.Resolve(result);
+        }
+
+        void OnError(const Napi::Error& e) override {
+            *busy_ = false;
+            deferred_.Reject(e.Value());
+        }
+
+    private:
+        Napi::Promise::Deferred deferred_;
+        std::shared_ptr<Fmp4Remuxer> remuxer_;
+        std::shared_ptr<std::atomic<bool>> busy_;
+        std::string path_;
+        double segment_duration_;
+        Fmp4Remuxer::StreamInfo info_;
+        std::vector<uint8_t> init_segment_;
+    };
+
+    class SegmentWorker : public Napi::AsyncWorker {
+    public:
+        SegmentWorker(Napi::Env env, std::shared_ptr<Fmp4Remuxer> remuxer,
+                      std::shared_ptr<std::atomic<bool>> busy)
+            : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)),
+              remuxer_(remuxer), busy_(busy) {}
+
+        Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    protected:
+        void Execute() override {
+            has_segment_ = remuxer_->readSegment(&segment_);
+            if (!has_segment_ && remuxer_->failed()) {
+                SetError(remuxer_->lastError());
+            }
+        }
+
+        void OnOK() override {
+            Napi::Env env = Env();
+            *busy_ = false;
+            if (!has_segment_) {
+                deferred_.Resolve(env.Null());
+                return;
+            }
+            Napi::Object result = Napi::Object::New(env);
+            result.Set("data", Napi::Buffer<uint8_t>::Copy(env, segment_.data.data(), segment_.data.size()));
+            result.Set("start", Napi::Number::New(env, segment_.start));
+            result.Set("duration", Napi::Number::New(env, segment_.duration));
+            deferred_.Resolve(result);
+        }
+
+        void OnError(const Napi::Error& e) override {
+            *busy_ = false;
+            deferred_.Reject(e.Value());
+        }
+
+    private:
+        Napi::Promise::Deferred deferred_;
+        std::shared_ptr<Fmp4Remuxer> remuxer_;
+        std::shared_ptr<std::atomic<bool>> busy_;
+        Fmp4Remuxer::Segment segment_;
+        bool has_segment_ = false;
+    };
+
+    bool acquire(Napi::Env env) {
+        if (busy_->exchange(true)) {
+            Napi::Error::New(env, "Remuxer is busy").ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+
+    // 打开输入: (path, { segmentDuration? }) => Promise<{ mimeType, codec, width, height, duration, initSegment }>
+    Napi::Value Open(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected (path, options?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        double segment_duration = 2.0;
+        if (info.Length() >= 2 && info[1].IsObject()) {
+            Napi::Value value = info[1].As<Napi::Object>().Get("segmentDuration");
+            if (value.IsNumber()) segment_duration = value.As<Napi::Number>().DoubleValue();
+        }
+        if (!acquire(env)) return env.Null();
+
+        OpenWorker* worker = new OpenWorker(env, remuxer_, busy_,
+                                            info[0].As<Napi::String>().Utf8Value(), segment_duration);
+        Napi::Promise promise = worker->Promise();
+        worker->Queue();
+        return promise;
+    }
+
+    // 读取下一个分片 => Promise<{ data, start, duration } | null>
+    Napi::Value ReadSegment(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!acquire(env)) return env.Null();
+
+        SegmentWorker* worker = new SegmentWorker(env, remuxer_, busy_);
+        Napi::Promise promise = worker->Promise();
+        worker->Queue();
+        return promise;
+    }
+
+    Napi::Value Seek(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected seconds number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!acquire(env)) return env.Null();
+        bool ok = remuxer_->seek(info[0].As<Napi::Number>().DoubleValue());
+        *busy_ = false;
+        return Napi::Boolean::New(env, ok);
+    }
+
+    Napi::Value Close(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!acquire(env)) return env.Null();
+        remuxer_->close();
+        *busy_ = false;
+        return env.Undefined();
+    }
+};
@@ -0,0 +1,536 @@
+/**
+ * 共享内存帧录制
+ * 采集线程从帧环读取，编码线程用 x264/x265 编码并写入 Annex-B 文件
+ * NV12 以外的帧（I420、RGB24、RGBA）用 swscale 转换为 NV12 后编码
+ * 流中途分辨率变化（SHM_FLAG_FORMAT_CHANGE）时输出编码器缓存的帧并按新尺寸重新打开编码器，
+ * 新编码器的第一帧是带 SPS/PPS 的 IDR，裸流解码器据此切换分辨率
+ */
+#pragma once
+
+#include <napi.h>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+#include "shm_frame_ring.h"
+#include "x26x_encoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FrameRecorder {
+public:
+    struct Options {
+        std::string ring_name;
+        std::string output_path;
+        X26xEncoder::Config encoder;
+        int queue_depth = 8;   // 采集与编码之间的最大排队帧数
+    };
+
+    struct Stats {
+        uint64_t frames_captured = 0;
+        uint64_t frames_encoded = 0;
+        uint64_t frames_dropped = 0;   // 帧环覆盖 + 队列满 + 不支持的格式
+        uint64_t frames_duplicated = 0; // 生产者时间戳跳跃时重复上一帧补齐的帧数
+        uint64_t format_changes = 0;    // 分辨率变化后重新打开编码器的次数
+        uint64_t bytes_written = 0;
+        int queue_depth = 0;
+        int max_queue_depth = 0;
+        double encode_fps = 0;
+        double avg_encode_ms = 0;
+        double elapsed_sec = 0;
+        bool running = false;
+    };
+
+    FrameRecorder() = default;
+    ~FrameRecorder() { stop(); }
+
+    bool start(const Options& options, std::string& error) {
+        stop();
+        options_ = options;
+        if (options_.queue_depth < 1) options_.queue_depth = 1;
+
+        if (!ring_.open(options_.ring_name)) {
+            error = "Failed to open frame ring: " + options_.ring_name;
+            return false;
+        }
+        output_ = fopen(options_.output_path.c_str(), "wb");
+        if (!output_) {
+            ring_.close();
+            error = "Failed to open output file: " + options_.output_path;
+            return false;
+        }
+
+        resetStats();
+        read_seq_ = ring_.writeSeq();
+        running_ = true;
+        start_time_ = std::chrono::steady_clock::now();
+        capture_thread_ = std::thread(&FrameRecorder::captureLoop, this);
+        encode_thread_ = std::thread(&FrameRecorder::encodeLoop, this);
+        return true;
+    }
+
+    void stop() {
+        if (!running_.exchange(false)) return;
+
+        if (capture_thread_.joinable()) capture_thread_.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            draining_ = true;
+        }
+        cond_.notify_all();
+        if (encode_thread_.joinable()) encode_thread_.join();
+
+        if (encoder_.isOpen()) {
+            std::vector<uint8_t> tail;
+            encoder_.flush(tail);
+            writeOutput(tail);
+            encoder_.close();
+        }
+        if (output_) {
+            fclose(output_);
+            output_ = nullptr;
+        }
+        if (sws_) {
+            sws_freeContext(sws_);
+            sws_ = nullptr;
+        }
+        ring_.close();
+        elapsed_ = secondsSinceStart();
+    }
+
+    Stats getStats() {
+        Stats stats;
+        stats.frames_captured = frames_captured_.load();
+        stats.frames_encoded = frames_encoded_.load();
+        stats.frames_dropped = frames_dropped_.load();
+        stats.frames_duplicated = frames_duplicated_.load();
+        stats.format_changes = format_changes_.load();
+        stats.bytes_written = bytes_written_.load();
+        stats.running = running_.load();
+        stats.elapsed_sec = stats.running ? secondsSinceStart() : elapsed_;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats.queue_depth = (int)queue_.size();
+            stats.max_queue_depth = max_queue_depth_;
+        }
+        if (stats.elapsed_sec > 0) {
+            stats.encode_fps = stats.frames_encoded / stats.elapsed_sec;
+        }
+        if (stats.frames_encoded > 0) {
+            stats.avg_encode_ms = encode_time_us_.load() / 1000.0 / stats.frames_encoded;
+        }
+        return stats;
+    }
+
+private:
+    struct QueuedFrame {
+        std::vector<uint8_t> data;
+        ShmFrameRing::FrameInfo info;
+    };
+
+    Options options_;
+    ShmFrameRing ring_;
+    X26xEncoder encoder_;
+    FILE* output_ = nullptr;
+
+    std::thread capture_thread_;
+    std::thread encode_thread_;
+    std::atomic<bool> running_{false};
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<QueuedFrame> queue_;
+    std::vector<std::vector<uint8_t>> free_buffers_;
+    bool draining_ = false;
+    uint64_t read_seq_ = 0;
+    int max_queue_depth_ = 0;
+
+    std::atomic<uint64_t> frames_captured_{0};
+    std::atomic<uint64_t> frames_encoded_{0};
+    std::atomic<uint64_t> frames_dropped_{0};
+    std::atomic<uint64_t> frames_duplicated_{0};
+    std::atomic<uint64_t> format_changes_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> encode_time_us_{0};
+    std::chrono::steady_clock::time_point start_time_;
+    double elapsed_ = 0;
+
+    // 以下只由编码线程访问
+    SwsContext* sws_ = nullptr;
+    std::vector<uint8_t> converted_;   // 转换后的 NV12（宽度即行跨度）
+    std::vector<uint8_t> last_;        // 上一个编码的帧，时间戳跳跃时重复编码
+    int last_stride_ = 0;
+    bool has_last_ = false;
+    double first_pts_ = 0;             // 第一帧的帧环时间戳，编码器时间戳以它为零点
+    bool has_first_pts_ = false;
+    int64_t next_pts_ = 0;             // 下一帧的编码器时间戳（帧数）
+
+    // 时间戳跳跃超过该帧数时不再补齐（生产者暂停或 seek），只让时间戳跳过去
+    static constexpr int64_t kMaxFillFrames = 120;
+
+    void resetStats() {
+        frames_captured_ = 0;
+        frames_encoded_ = 0;
+        frames_dropped_ = 0;
+        frames_duplicated_ = 0;
+        format_changes_ = 0;
+        bytes_written_ = 0;
+        encode_time_us_ = 0;
+        max_queue_depth_ = 0;
+        draining_ = false;
+        queue_.clear();
+        elapsed_ = 0;
+        has_last_ = false;
+        has_first_pts_ = false;
+        next_pts_ = 0;
+    }
+
+    double secondsSinceStart() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    }
+
+    void captureLoop() {
+        while (running_) {
+            if (!ring_.waitForFrame(read_seq_, 50)) continue;
+
+            // 落后太多，跳过已被覆盖的帧
+            uint64_t oldest = ring_.oldestReadable();
+            if (read_seq_ < oldest) {
+                frames_dropped_ += oldest - read_seq_;
+                read_seq_ = oldest;
+            }
+
+            std::vector<uint8_t> buffer;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if ((int)queue_.size() >= options_.queue_depth) {
+                    // 编码跟不上，丢弃新帧而不是阻塞生产者
+                    frames_dropped_++;
+                    read_seq_++;
+                    continue;
+                }
+                if (!free_buffers_.empty()) {
+                    buffer = std::move(free_buffers_.back());
+                    free_buffers_.pop_back();
+                }
+            }
+            buffer.resize(ring_.slotSize());
+
+            QueuedFrame frame;
+            ShmFrameRing::ReadResult result = ring_.read(read_seq_, &frame.info, buffer.data(), buffer.size());
+            read_seq_++;
+            if (result != ShmFrameRing::READ_OK) {
+                frames_dropped_++;
+                std::lock_guard<std::mutex> lock(mutex_);
+                free_buffers_.push_back(std::move(buffer));
+                continue;
+            }
+            frames_captured_++;
+            frame.data = std::move(buffer);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_back(std::move(frame));
+                if ((int)queue_.size() > max_queue_depth_) {
+                    max_queue_depth_ = (int)queue_.size();
+                }
+            }
+            cond_.notify_one();
+        }
+    }
+
+    void encodeLoop() {
+        std::vector<uint8_t> bitstream;
+        while (true) {
+            QueuedFrame frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this] { return draining_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                frame = std::move(queue_.front());
+                queue_.pop_front();
+            }
+
+            const uint8_t* nv12 = nullptr;
+            int stride = 0;
+            if (ensureEncoder(frame.info) && prepareFrame(frame, &nv12, &stride)) {
+                auto t0 = std::chrono::steady_clock::now();
+                int64_t pts = encoderPts(frame.info.pts);
+
+                // 裸流没有容器时间戳，播放时间轴只由帧数决定：生产者丢帧或晚到造成的空档用上一帧补齐
+                if (has_last_ && pts > next_pts_) {
+                    int64_t fill = std::min(pts - next_pts_, kMaxFillFrames);
+                    for (int64_t i = 0; i < fill; i++) {
+                        bitstream.clear();
+                        if (!encoder_.encode(last_.data(), last_stride_, next_pts_++, bitstream)) break;
+                        writeOutput(bitstream);
+                        frames_duplicated_++;
+                    }
+                }
+                // 时间戳重复或倒退（生产者重启）时保持单调
+                pts = std::max(pts, next_pts_);
+
+                bitstream.clear();
+                if (encoder_.encode(nv12, stride, pts, bitstream)) {
+                    writeOutput(bitstream);
+                    frames_encoded_++;
+                    next_pts_ = pts + 1;
+                    // 保留本帧用于补齐，不复制：与转换缓冲或队列缓冲交换
+                    if (nv12 == converted_.data()) {
+                        converted_.swap(last_);
+                    } else {
+                        frame.data.swap(last_);
+                    }
+                    last_stride_ = stride;
+                    has_last_ = true;
+                } else {
+                    frames_dropped_++;
+                }
+                encode_time_us_ += std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - t0).count();
+            } else {
+                frames_dropped_++;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_buffers_.push_back(std::move(frame.data));
+        }
+    }
+
+    // 帧环时间戳（秒）换算为编码器时间基（1/fps）下的帧数，以第一帧为零点
+    int64_t encoderPts(double pts) {
+        if (!has_first_pts_) {
+            first_pts_ = pts;
+            has_first_pts_ = true;
+        }
+        const X26xEncoder::Config& config = encoder_.config();
+        return (int64_t)std::llround((pts - first_pts_) * config.fps_num / config.fps_den);
+    }
+
+    // 得到编码器尺寸的 NV12 数据：偶数尺寸的 NV12 直接使用帧环数据，其他格式和奇数尺寸用 swscale 转换
+    bool prepareFrame(const QueuedFrame& frame, const uint8_t** nv12, int* stride) {
+        const ShmFrameRing::FrameInfo& info = frame.info;
+        int width = (int)info.width;
+        int height = (int)info.height;
+        int src_stride = (int)info.stride;
+        const uint8_t* data = frame.data.data();
+        int chroma_h = (height + 1) / 2;
+
+        const uint8_t* planes[4] = {data, nullptr, nullptr, nullptr};
+        int linesizes[4] = {src_stride, 0, 0, 0};
+        AVPixelFormat src_format;
+        size_t needed;
+        switch (info.format) {
+            case SHM_PIXEL_NV12:
+                src_format = AV_PIX_FMT_NV12;
+                planes[1] = data + (size_t)src_stride * height;
+                linesizes[1] = src_stride;
+                needed = (size_t)src_stride * (height + chroma_h);
+                break;
+            case SHM_PIXEL_I420: {
+                // 与 OsdFrame::i420 相同的布局：色度行跨度为亮度的一半
+                int chroma_stride = (src_stride + 1) / 2;
+                src_format = AV_PIX_FMT_YUV420P;
+                planes[1] = data + (size_t)src_stride * height;
+                planes[2] = planes[1] + (size_t)chroma_stride * chroma_h;
+                linesizes[1] = chroma_stride;
+                linesizes[2] = chroma_stride;
+                needed = (size_t)src_stride * height + (size_t)chroma_stride * chroma_h * 2;
+                break;
+            }
+            case SHM_PIXEL_RGB24:
+                src_format = AV_PIX_FMT_RGB24;
+                needed = (size_t)src_stride * height;
+                break;
+            case SHM_PIXEL_RGBA:
+                src_format = AV_PIX_FMT_RGBA;
+                needed = (size_t)src_stride * height;
+                break;
+            default:
+                return false;   // 压缩数据包等
+        }
+        if (src_stride <= 0 || info.size < needed || frame.data.size() < needed) return false;
+
+        const X26xEncoder::Config& config = encoder_.config();
+        if (info.format == SHM_PIXEL_NV12 && width == config.width && height == config.height) {
+            *nv12 = data;
+            *stride = src_stride;
+            return true;
+        }
+
+        sws_ = sws_getCachedContext(sws_, width, height, src_format, config.width, config.height,
+                                    AV_PIX_FMT_NV12, SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!sws_) return false;
+        size_t luma = (size_t)config.width * config.height;
+        converted_.resize(luma * 3 / 2);
+        uint8_t* dst[4] = {converted_.data(), converted_.data() + luma, nullptr, nullptr};
+        int dst_linesizes[4] = {config.width, config.width, 0, 0};
+        sws_scale(sws_, planes, linesizes, 0, height, dst, dst_linesizes);
+        *nv12 = converted_.data();
+        *stride = config.width;
+        return true;
+    }
+
+    // 编码器尺寸取偶数（x264/x265 的 4:2:0 要求），奇数尺寸的帧经 swscale 缩放
+    static int encoderSize(uint32_t size) {
+        return (int)(size & ~1u);
+    }
+
+    // 首帧到达时按帧尺寸打开编码器；之后尺寸变化（帧带 SHM_FLAG_FORMAT_CHANGE）时
+    // 先输出旧编码器缓存的帧，再按新尺寸重新打开，码流在同一个文件中继续
+    bool ensureEncoder(const ShmFrameRing::FrameInfo& info) {
+        if (info.format >= SHM_PACKET_H264_ANNEXB || encoderSize(info.width) == 0 || encoderSize(info.height) == 0) {
+            return false;
+        }
+        if (encoder_.isOpen()) {
+            if (encoderSize(info.width) == encoder_.config().width &&
+                encoderSize(info.height) == encoder_.config().height) {
+                return true;
+            }
+            std::vector<uint8_t> tail;
+            encoder_.flush(tail);
+            writeOutput(tail);
+            encoder_.close();
+            // 上一帧尺寸不同，不能再用来补齐；时间戳接着旧编码器继续
+            has_last_ = false;
+            format_changes_++;
+        }
+        X26xEncoder::Config config = options_.encoder;
+        config.width = encoderSize(info.width);
+        config.height = encoderSize(info.height);
+        std::string error;
+        if (!encoder_.open(config, error)) {
+            fprintf(stderr, "FrameRecorder: %s\n", error.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void writeOutput(const std::vector<uint8_t>& data) {
+        if (data.empty() || !output_) return;
+        bytes_written_ += fwrite(data.data(), 1, data.size(), output_);
+    }
+};
+
+// ================ N-API 绑定 ================
+
+class FrameRecorderWrapper : public Napi::ObjectWrap<FrameRecorderWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "FrameRecorder", {
+            InstanceMethod("start", &FrameRecorderWrapper::Start),
+            InstanceMethod("stop", &FrameRecorderWrapper::Stop),
+            InstanceMethod("getStats", &FrameRecorderWrapper::GetStats),
+        });
+
+        exports.Set("FrameRecorder", func);
+        return exports;
+    }
+
+    FrameRecorderWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<FrameRecorderWrapper>(info) {
+        recorder_ = std::make_unique<FrameRecorder>();
+    }
+
+private:
+    std::unique_ptr<FrameRecorder> recorder_;
+
+    // 开始录制: { ringName, outputPath, codec?, preset?, bitrate?, fps?, keyint?, threads?, queueDepth? }
+    Napi::Value Start(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Object opts = info[0].As<Napi::Object>();
+        if (!opts.Get("ringName").IsString() || !opts.Get("outputPath").IsString()) {
+            Napi::TypeError::New(env, "ringName and outputPath are required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        FrameRecorder::Options options;
+        options.ring_name = opts.Get("ringName").As<Napi::String>().Utf8Value();
+        options.output_path = opts.Get("outputPath").As<Napi::String>().Utf8Value();
+        if (opts.Get("codec").IsString()) {
+            options.encoder.codec = opts.Get("codec").As<Napi::String>().Utf8Value();
+        }
+        if (opts.Get("preset").IsString()) {
+            options.encoder.latency = opts.Get("preset").As<Napi::String>().Utf8Value();
+        }
+        if (opts.Get("bitrate").IsNumber()) {
+            options.encoder.bitrate_kbps = opts.Get("bitrate").As<Napi::Number>().Int32Value();
+        }
+        if (opts.Get("fps").IsNumber()) {
+            parseFrameRate(opts.Get("fps").As<Napi::Number>().DoubleValue(),
+                           &options.encoder.fps_num, &options.encoder.fps_den);
+        }
+        if (opts.Get("keyint").IsNumber()) {
+            options.encoder.keyint = opts.Get("keyint").As<Napi::Number>().Int32Value();
+        }
+        if (opts.Get("threads").IsNumber()) {
+            options.encoder.threads = opts.Get("threads").As<Napi::Number>().Int32Value();
+        }
+        if (opts.Get("queueDepth").IsNumber()) {
+            options.queue_depth = opts.Get("queueDepth").As<Napi::Number>().Int32Value();
+        }
+
+        std::string error;
+        if (!recorder_->start(options, error)) {
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
+
+    // 小数帧率转为分数：NTSC 系列（29.97、59.94、23.976）为 n*1000/1001，其他按千分之一精度
+    static void parseFrameRate(double fps, int* num, int* den) {
+        if (!(fps > 0)) return;
+        double ntsc = std::round(fps * 1.001);
+        if (std::fabs(fps - std::round(fps)) < 1e-3) {
+            *num = (int)std::round(fps);
+            *den = 1;
+        } else if (std::fabs(fps - ntsc * 1000.0 / 1001.0) < 1e-3) {
+            *num = (int)ntsc * 1000;
+            *den = 1001;
+        } else {
+            *num = (int)std::round(fps * 1000);
+            *den = 1000;
+        }
+    }
+
+    Napi::Value Stop(const Napi::CallbackInfo& info) {
+        recorder_->stop();
+        return GetStats(info);
+    }
+
+    Napi::Value GetStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        FrameRecorder::Stats stats = recorder_->getStats();
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("running", Napi::Boolean::New(env, stats.running));
+        result.Set("framesCaptured", Napi::Number::New(env, (double)stats.frames_captured));
+        result.Set("framesEncoded", Napi::Number::New(env, (double)stats.frames_encoded));
+        result.Set("framesDropped", Napi::Number::New(env, (double)stats.frames_dropped));
+        result.Set("framesDuplicated", Napi::Number::New(env, (double)stats.frames_duplicated));
+        result.Set("formatChanges", Napi::Number::New(env, (double)stats.format_changes));
+        result.Set("bytesWritten", Napi::Number::New(env, (double)stats.bytes_written));
+        result.Set("queueDepth", Napi::Number::New(env, stats.queue_depth));
+        result.Set("maxQueueDepth", Napi::Number::New(env, stats.max_queue_depth));
+        result.Set("encodeFps", Napi::Number::New(env, stats.encode_fps));
+        result.Set("avgEncodeMs", Napi::Number::New(env, stats.avg_encode_ms));
+        result.Set("elapsed", Napi::Number::New(env, stats.elapsed_sec));
+        return result;
+    }
+};
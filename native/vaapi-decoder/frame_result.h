@@ -0,0 +1,148 @@
+/**
+ * 解码结果的 N-API 输出
+ * decodeFrame/decodePacket 仍然每帧返回新对象（调用方可能保留旧帧），但属性键和 "nv12"
+ * 字符串在解码器创建时缓存，不再每帧新建；
+ * decodeFrameInto/decodePacketInto 把像素复制到调用方复用的 Buffer，宽高/pts 等写入
+ * Float64Array 元数据块，返回值为小整数，每帧不分配任何 JS 对象
+ */
+#pragma once
+
+#include <napi.h>
+
+#include <cstdint>
+#include <cstring>
+
+// Float64Array 元数据块布局，长度至少 FRAME_META_COUNT
+enum FrameMetaIndex {
+    FRAME_META_WIDTH = 0,
+    FRAME_META_HEIGHT = 1,
+    FRAME_META_PTS = 2,
+    FRAME_META_SIZE = 3,       // 帧数据字节数
+    FRAME_META_FORMAT = 4,     // ShmPixelFormat，NV12 = 0
+    FRAME_META_SEQUENCE = 5,   // 本解码器输出的帧序号，从 0 开始
+    FRAME_META_FLAGS = 6,      // FrameMetaFlags 位组合
+    FRAME_META_COUNT = 8,
+};
+
+// FRAME_META_FLAGS 的各位
+enum FrameMetaFlags {
+    FRAME_FLAG_FORMAT_CHANGE = 1 << 0,   // 新分辨率的第一帧
+};
+
+// decodeFrameInto 的返回值（>= 0 为写入的字节数）
+enum FrameIntoResult {
+    FRAME_INTO_END = -1,         // 没有帧（文件结束或需要更多数据）
+    FRAME_INTO_TOO_SMALL = -2,   // 目标 Buffer 不够大，meta 中已写入所需大小，帧保留到下次调用
+};
+
+class FrameResultWriter {
+public:
+    struct Frame {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        int width = 0;
+        int height = 0;
+        double pts = 0;
+        bool format_changed = false;
+    };
+
+    explicit FrameResultWriter(Napi::Env env) {
+        key_data_ = Napi::Persistent(Napi::String::New(env, "data"));
+        key_width_ = Napi::Persistent(Napi::String::New(env, "width"));
+        key_height_ = Napi::Persistent(Napi::String::New(env, "height"));
+        key_format_ = Napi::Persistent(Napi::String::New(env, "format"));
+        key_pts_ = Napi::Persistent(Napi::String::New(env, "pts"));
+        key_format_changed_ = Napi::Persistent(Napi::String::New(env, "formatChanged"));
+        value_nv12_ = Napi::Persistent(Napi::String::New(env, "nv12"));
+    }
+
+    // 返回 { data, width, height, format, formatChanged, pts? }，数据复制到新 Buffer
+    Napi::Object toObject(Napi::Env env, const Frame& frame, bool with_pts) {
+        has_pending_ = false;
+        sequence_++;
+        Napi::Object result = Napi::Object::New(env);
+        result.Set(key_data_.Value(), Napi::Buffer<uint8_t>::Copy(env, frame.data, frame.size));
+        result.Set(key_width_.Value(), Napi::Number::New(env, frame.width));
+        result.Set(key_height_.Value(), Napi::Number::New(env, frame.height));
+        result.Set(key_format_.Value(), value_nv12_.Value());
+        result.Set(key_format_changed_.Value(), Napi::Boolean::New(env, frame.format_changed));
+        if (with_pts) {
+            result.Set(key_pts_.Value(), Napi::Number::New(env, frame.pts));
+        }
+        return result;
+    }
+
+    // 校验 (target: Buffer|Uint8Array, meta: Float64Array)，成功时返回 true
+    static bool parseTargets(const Napi::CallbackInfo& info, size_t first,
+                             Napi::Uint8Array* target, Napi::Float64Array* meta) {
+        Napi::Env env = info.Env();
+        if (info.Length() < first + 2 || !info[first].IsTypedArray() || !info[first + 1].IsTypedArray()) {
+            Napi::TypeError::New(env, "Expected (target: Uint8Array, meta: Float64Array)")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        Napi::TypedArray t = info[first].As<Napi::TypedArray>();
+        Napi::TypedArray m = info[first + 1].As<Napi::TypedArray>();
+        if (t.TypedArrayType() != napi_uint8_array) {
+            Napi::TypeError::New(env, "target must be a Buffer or Uint8Array").ThrowAsJavaScriptException();
+            return false;
+        }
+        if (m.TypedArrayType() != napi_float64_array || m.ElementLength() < FRAME_META_COUNT) {
+            Napi::TypeError::New(env, "meta must be a Float64Array of at least 8 elements")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        *target = t.As<Napi::Uint8Array>();
+        *meta = m.As<Napi::Float64Array>();
+        return true;
+    }
+
+    // 复制到 target 并填写 meta，返回写入字节数；target 太小时帧保留为 pending
+    int writeInto(const Frame& frame, Napi::Uint8Array target, Napi::Float64Array meta) {
+        double* m = meta.Data();
+        m[FRAME_META_WIDTH] = frame.width;
+        m[FRAME_META_HEIGHT] = frame.height;
+        m[FRAME_META_PTS] = frame.pts;
+        m[FRAME_META_SIZE] = (double)frame.size;
+        m[FRAME_META_FORMAT] = 0;
+        m[FRAME_META_SEQUENCE] = (double)sequence_;
+        m[FRAME_META_FLAGS] = frame.format_changed ? FRAME_FLAG_FORMAT_CHANGE : 0;
+
+        if (target.ByteLength() < frame.size) {
+            pending_ = frame;
+            has_pending_ = true;
+            return FRAME_INTO_TOO_SMALL;
+        }
+        memcpy(target.Data(), frame.data, frame.size);
+        has_pending_ = false;
+        sequence_++;
+        return (int)frame.size;
+    }
+
+    // 上一次因 target 太小未取走的帧；解码器的输出缓冲在下次解码前保持有效
+    bool takePending(Frame* frame) {
+        if (!has_pending_) return false;
+        *frame = pending_;
+        return true;
+    }
+
+    bool hasPending() const { return has_pending_; }
+
+    // seek/close/重新初始化后，旧的输出缓冲不再可用
+    void reset() {
+        has_pending_ = false;
+        sequence_ = 0;
+    }
+
+private:
+    Napi::Reference<Napi::String> key_data_;
+    Napi::Reference<Napi::String> key_width_;
+    Napi::Reference<Napi::String> key_height_;
+    Napi::Reference<Napi::String> key_format_;
+    Napi::Reference<Napi::String> key_pts_;
+    Napi::Reference<Napi::String> key_format_changed_;
+    Napi::Reference<Napi::String> value_nv12_;
+    Frame pending_;
+    bool has_pending_ = false;
+    uint64_t sequence_ = 0;
+};
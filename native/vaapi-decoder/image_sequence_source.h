@@ -0,0 +1,804 @@
+/**
+ * 图片序列视频源（frame_00001.png、shot.%04d.exr、一个只有图片的目录等）
+ * - ImageSequence: 列出并按自然顺序排序帧文件，首帧解码得到尺寸
+ * - ImageFrameDecoder: FFmpeg 图片解码器（PNG / JPEG / EXR / TIFF / DPX ...）解码一帧，
+ *   swscale 转换为 NV12 或 RGBA；每个工作线程一个实例，复用转换上下文
+ * - ImageSequencePublisher: 独立工作线程并行预解码，预取窗口按字节预算限制，
+ *   发布线程按帧序和帧率（或共享呈现时钟）写入共享内存环
+ * 单张 4K PNG 解码要几十毫秒，按顺序解码远低于实时，靠多帧并行追上帧率
+ */
+#pragma once
+
+#include <napi.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "presentation_clock.h"
+#include "resource_limits.h"
+#include "shm_frame_ring.h"
+
+class ImageSequence {
+public:
+    struct Options {
+        double fps = 25;
+        int start_number = -1;        // printf 模式的起始编号，-1 时依次尝试 0 和 1
+    };
+
+    struct Info {
+        int width = 0;
+        int height = 0;
+        double fps = 0;
+        int64_t frame_count = 0;
+        double duration = 0;
+        std::string codec;            // 首帧的解码器名
+        std::string pixel_format;     // 首帧解码出的像素格式
+    };
+
+    // path 可以是目录、printf 模式（%d / %04d）或序列中的任意一个文件
+    bool open(const std::string& path, const Options& options, std::string& error) {
+        files_.clear();
+        info_ = Info();
+
+        struct stat st;
+        if (path.find('%') != std::string::npos) {
+            if (!expandPattern(path, options.start_number)) {
+                error = "No files match pattern: " + path;
+                return false;
+            }
+        } else if (stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+            if (!listDirectory(path, "")) {
+                error = "No image files in directory: " + path;
+                return false;
+            }
+        } else if (stat(path.c_str(), &st) == 0) {
+            // 同目录下与该文件名除编号外相同的文件
+            size_t slash = path.find_last_of('/');
+            std::string dir = slash == std::string::npos ? "." : path.substr(0, slash);
+            std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+            if (!listDirectory(dir, stemOf(name))) {
+                error = "No image sequence around: " + path;
+                return false;
+            }
+        } else {
+            error = "Path not found: " + path;
+            return false;
+        }
+
+        info_.fps = options.fps > 0 ? options.fps : 25;
+        info_.frame_count = (int64_t)files_.size();
+        info_.duration = info_.frame_count / info_.fps;
+        return true;
+    }
+
+    void close() {
+        files_.clear();
+        info_ = Info();
+    }
+
+    bool isOpen() const { return !files_.empty(); }
+    Info& info() { return info_; }
+    const Info& info() const { return info_; }
+    const std::string& file(int64_t index) const { return files_[index]; }
+    double framePts(int64_t index) const { return index / info_.fps; }
+
+    static AVCodecID codecForPath(const std::string& path) {
+        std::string ext = extensionOf(path);
+        if (ext == "png") return AV_CODEC_ID_PNG;
+        if (ext == "jpg" || ext == "jpeg") return AV_CODEC_ID_MJPEG;
+        if (ext == "exr") return AV_CODEC_ID_EXR;
+        if (ext == "tif" || ext == "tiff") return AV_CODEC_ID_TIFF;
+        if (ext == "dpx") return AV_CODEC_ID_DPX;
+        if (ext == "bmp") return AV_CODEC_ID_BMP;
+        if (ext == "tga") return AV_CODEC_ID_TARGA;
+        if (ext == "webp") return AV_CODEC_ID_WEBP;
+        return AV_CODEC_ID_NONE;
+    }
+
+    // 数字按数值比较: frame2 < frame10
+    static bool naturalLess(const std::string& a, const std::string& b) {
+        size_t i = 0, j = 0;
+        while (i < a.size() && j < b.size()) {
+            if (isdigit((unsigned char)a[i]) && isdigit((unsigned char)b[j])) {
+                size_t i0 = i, j0 = j;
+                while (i < a.size() && a[i] == '0') i++;
+                while (j < b.size() && b[j] == '0') j++;
+                size_t ni = i, nj = j;
+                while (ni < a.size() && isdigit((unsigned char)a[ni])) ni++;
+                while (nj < b.size() && isdigit((unsigned char)b[nj])) nj++;
+                if (ni - i != nj - j) return ni - i < nj - j;
+                int c = a.compare(i, ni - i, b, j, nj - j);
+                if (c != 0) return c < 0;
+                if (ni - i0 != nj - j0) return ni - i0 < nj - j0;
+                i = ni;
+                j = nj;
+            } else {
+                if (a[i] != b[j]) return a[i] < b[j];
+                i++;
+                j++;
+            }
+        }
+        return a.size() - i < b.size() - j;
+    }
+
+private:
+    std::vector<std::string> files_;
+    Info info_;
+
+    static std::string extensionOf(const std::string& path) {
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos || path.find('/', dot) != std::string::npos) return "";
+        std::string ext = path.substr(dot + 1);
+        for (char& c : ext) c = (char)tolower((unsigned char)c);
+        return ext;
+    }
+
+    // 去掉扩展名和末尾编号: shot_0012.exr -> shot_ + .exr
+    static std::string stemOf(const std::string& name) {
+        size_t dot = name.find_last_of('.');
+        std::string base = dot == std::string::npos ? name : name.substr(0, dot);
+        size_t end = base.size();
+        while (end > 0 && isdigit((unsigned char)base[end - 1])) end--;
+        return base.substr(0, end) + "/" + (dot == std::string::npos ? "" : name.substr(dot));
+    }
+
+    bool listDirectory(const std::string& dir, const std::string& stem) {
+        DIR* d = opendir(dir.c_str());
+        if (!d) return false;
+        std::vector<std::string> names;
+        while (struct dirent* entry = readdir(d)) {
+            std::string name = entry->d_name;
+            if (name[0] == '.' || codecForPath(name) == AV_CODEC_ID_NONE) continue;
+            if (!stem.empty() && stemOf(name) != stem) continue;
+            names.push_back(name);
+        }
+        closedir(d);
+        std::sort(names.begin(), names.end(), naturalLess);
+        for (const std::string& name : names) files_.push_back(dir + "/" + name);
+        return !files_.empty();
+    }
+
+    // 只接受一个 %d / %0Nd，避免把任意格式串交给 snprintf
+    static bool validPattern(const std::string& pattern) {
+        int conversions = 0;
+        for (size_t i = 0; i < pattern.size(); i++) {
+            if (pattern[i] != '%') continue;
+            if (i + 1 < pattern.size() && pattern[i + 1] == '%') {
+                i++;
+                continue;
+            }
+            size_t j = i + 1;
+            while (j < pattern.size() && isdigit((unsigned char)pattern[j])) j++;
+            if (j >= pattern.size() || pattern[j] != 'd' || j - i > 4) return false;
+            conversions++;
+            i = j;
+        }
+        return conversions == 1;
+    }
+
+    bool expandPattern(const std::string& pattern, int start_number) {
+        if (!validPattern(pattern)) return false;
+        auto exists = [](const std::string& path) {
+            struct stat st;
+            return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+        };
+        auto format = [&](int n) {
+            char buf[4096];
+            snprintf(buf, sizeof(buf), pattern.c_str(), n);
+            return std::string(buf);
+        };
+        int n = start_number;
+        if (n < 0) n = exists(format(0)) ? 0 : 1;
+        for (std::string path = format(n); exists(path); path = format(++n)) {
+            files_.push_back(path);
+        }
+        return !files_.empty();
+    }
+};
+
+class ImageFrameDecoder {
+public:
+    ImageFrameDecoder() {
+        frame_ = av_frame_alloc();
+        packet_ = av_packet_alloc();
+    }
+
+    ~ImageFrameDecoder() {
+        if (sws_) sws_freeContext(sws_);
+        av_frame_free(&frame_);
+        av_packet_free(&packet_);
+    }
+
+    ImageFrameDecoder(const ImageFrameDecoder&) = delete;
+    ImageFrameDecoder& operator=(const ImageFrameDecoder&) = delete;
+
+    // 只解码，结果保留在内部帧中
+    bool decode(const std::string& path, std::string& error) {
+        AVCodecID codec_id = ImageSequence::codecForPath(path);
+        const AVCodec* codec = avcodec_find_decoder(codec_id);
+        if (!codec) {
+            error = "No image decoder for " + path;
+            return false;
+        }
+        if (!readFile(path, error)) return false;
+
+        AVCodecContext* ctx = avcodec_alloc_context3(codec);
+        bool ok = false;
+        do {
+            if (!ctx) {
+                error = "Out of memory";
+                break;
+            }
+            ctx->thread_count = 1;   // 并行在帧之间
+            if (avcodec_open2(ctx, codec, nullptr) < 0) {
+                error = "Failed to open image decoder";
+                break;
+            }
+            av_frame_unref(frame_);
+            if (avcodec_send_packet(ctx, packet_) < 0 || avcodec_send_packet(ctx, nullptr) < 0 ||
+                avcodec_receive_frame(ctx, frame_) < 0) {
+                error = "Failed to decode " + path;
+                break;
+            }
+            codec_name_ = codec->name;
+            ok = true;
+        } while (false);
+        avcodec_free_context(&ctx);
+        av_packet_unref(packet_);
+        return ok;
+    }
+
+    int width() const { return frame_->width; }
+    int height() const { return frame_->height; }
+    const char* codecName() const { return codec_name_; }
+    const char* pixelFormatName() const {
+        const char* name = av_get_pix_fmt_name((AVPixelFormat)frame_->format);
+        return name ? name : "unknown";
+    }
+
+    // 解码并转换为 out_format（NV12 / RGBA），尺寸不同时缩放到 width x height
+    bool decodeTo(const std::string& path, uint32_t out_format, int width, int height,
+                  uint8_t* dst, std::string& error) {
+        if (!decode(path, error)) return false;
+
+        AVPixelFormat src_fmt = (AVPixelFormat)frame_->format;
+        bool full_range = frame_->color_range == AVCOL_RANGE_JPEG;
+        // JPEG 的 yuvj 格式在 swscale 中已弃用，换成普通格式并标记全范围
+        switch (src_fmt) {
+            case AV_PIX_FMT_YUVJ420P: src_fmt = AV_PIX_FMT_YUV420P; full_range = true; break;
+            case AV_PIX_FMT_YUVJ422P: src_fmt = AV_PIX_FMT_YUV422P; full_range = true; break;
+            case AV_PIX_FMT_YUVJ444P: src_fmt = AV_PIX_FMT_YUV444P; full_range = true; break;
+            case AV_PIX_FMT_YUVJ440P: src_fmt = AV_PIX_FMT_YUV440P; full_range = true; break;
+            default: break;
+        }
+        AVPixelFormat dst_fmt = out_format == SHM_PIXEL_RGBA ? AV_PIX_FMT_RGBA : AV_PIX_FMT_NV12;
+        sws_ = sws_getCachedContext(sws_, frame_->width, frame_->height, src_fmt, width, height, dst_fmt,
+                                    SWS_BICUBIC, nullptr, nullptr, nullptr);
+        if (!sws_) {
+            error = "Failed to create scaler for " + std::string(pixelFormatName());
+            return false;
+        }
+        if (full_range) {
+            int *inv_table, *table, src_range, dst_range, brightness, contrast, saturation;
+            if (sws_getColorspaceDetails(sws_, &inv_table, &src_range, &table, &dst_range,
+                                         &brightness, &contrast, &saturation) >= 0) {
+                sws_setColorspaceDetails(sws_, inv_table, 1, table, dst_range, brightness, contrast, saturation);
+            }
+        }
+
+        uint8_t* dst_data[4] = { dst, nullptr, nullptr, nullptr };
+        int dst_linesize[4] = { 0, 0, 0, 0 };
+        if (dst_fmt == AV_PIX_FMT_RGBA) {
+            dst_linesize[0] = width * 4;
+        } else {
+            dst_data[1] = dst + (size_t)width * height;
+            dst_linesize[0] = width;
+            dst_linesize[1] = width;
+        }
+        sws_scale(sws_, frame_->data, frame_->linesize, 0, frame_->height, dst_data, dst_linesize);
+        return true;
+    }
+
+private:
+    AVFrame* frame_ = nullptr;
+    AVPacket* packet_ = nullptr;
+    SwsContext* sws_ = nullptr;
+    const char* codec_name_ = "";
+
+    // 整个文件读入带填充的数据包
+    bool readFile(const std::string& path, std::string& error) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = "Failed to open " + path;
+            return false;
+        }
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0 && st.st_size > 0 && st.st_size < INT32_MAX &&
+                  av_new_packet(packet_, (int)st.st_size) == 0;
+        if (ok) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            size_t done = 0;
+            while (done < (size_t)st.st_size) {
+                ssize_t n = ::read(fd, packet_->data + done, (size_t)st.st_size - done);
+                if (n <= 0) {
+                    ok = false;
+                    break;
+                }
+                done += (size_t)n;
+            }
+        }
+        ::close(fd);
+        if (!ok) {
+            av_packet_unref(packet_);
+            error = "Failed to read " + path;
+        }
+        return ok;
+    }
+};
+
+/**
+ * 预解码并按序发布到共享内存环
+ */
+class ImageSequencePublisher {
+public:
+    struct Options {
+        std::string ring_name;
+        uint32_t out_format = SHM_PIXEL_NV12;   // NV12 或 RGBA
+        uint32_t slot_count = 4;
+        bool realtime = true;
+        bool loop = false;
+        int64_t start_frame = 0;
+        uint64_t prefetch_bytes = 0;  // 预取窗口内存上限，0 时按资源限制（2-16 帧）
+        int workers = 0;              // 0 时为 FFmpeg 软解线程数
+        std::shared_ptr<PresentationClock> clock;
+    };
+
+    struct Stats {
+        bool running = false;
+        uint64_t frames = 0;
+        uint64_t late_frames = 0;
+        uint64_t failed_frames = 0;   // 解码失败而跳过的帧
+        uint64_t underruns = 0;       // 发布时该帧尚未解码完成
+        uint64_t decoded = 0;
+        double avg_decode_ms = 0;
+        int window = 0;               // 预取窗口帧数
+        int buffered = 0;             // 已解码待发布的帧
+        int workers = 0;
+        double fps = 0;
+        double elapsed_sec = 0;
+        uint64_t write_seq = 0;
+    };
+
+    ~ImageSequencePublisher() { stop(); }
+
+    static size_t frameSize(uint32_t format, int width, int height) {
+        return format == SHM_PIXEL_RGBA ? (size_t)width * height * 4 : (size_t)width * height * 3 / 2;
+    }
+
+    // NV12 输出的宽高取偶数
+    static void outputSize(uint32_t format, int width, int height, int* out_w, int* out_h) {
+        *out_w = format == SHM_PIXEL_RGBA ? width : (width + 1) & ~1;
+        *out_h = format == SHM_PIXEL_RGBA ? height : (height + 1) & ~1;
+    }
+
+    bool start(const ImageSequence* sequence, const Options& options, std::string& error) {
+        stop();
+        options_ = options;
+        sequence_ = sequence;
+        const ImageSequence::Info& info = sequence->info();
+        outputSize(options_.out_format, info.width, info.height, &width_, &height_);
+        frame_size_ = frameSize(options_.out_format, width_, height_);
+        if (!ring_.create(options_.ring_name, options_.slot_count, (uint32_t)frame_size_)) {
+            error = "Failed to create frame ring " + options_.ring_name;
+            return false;
+        }
+
+        int window = options_.prefetch_bytes > 0
+                         ? (int)std::max<uint64_t>(2, std::min<uint64_t>(64, options_.prefetch_bytes / frame_size_))
+                         : ResourceLimits::get().decodeAheadFrames(frame_size_);
+        int workers = options_.workers > 0 ? options_.workers : ResourceLimits::get().decode_threads;
+        workers = std::max(1, std::min(workers, window));
+
+        slots_.clear();
+        slots_.resize(window);
+        for (Slot& slot : slots_) slot.data.resize(frame_size_);
+
+        start_index_ = std::max<int64_t>(0, std::min(options_.start_frame, info.frame_count - 1));
+        end_seq_ = options_.loop ? INT64_MAX : info.frame_count - start_index_;
+        next_decode_ = 0;
+        published_ = 0;
+        frames_ = 0;
+        late_frames_ = 0;
+        failed_frames_ = 0;
+        underruns_ = 0;
+        decoded_ = 0;
+        decode_us_ = 0;
+        elapsed_ = 0;
+        start_time_ = std::chrono::steady_clock::now();
+        running_ = true;
+
+        for (int i = 0; i < workers; i++) workers_.emplace_back(&ImageSequencePublisher::decodeLoop, this);
+        thread_ = std::thread(&ImageSequencePublisher::publishLoop, this);
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cond_.notify_all();
+        if (thread_.joinable()) thread_.join();
+        for (std::thread& t : workers_) t.join();
+        workers_.clear();
+        slots_.clear();
+        ring_.close();
+        sequence_ = nullptr;
+    }
+
+    bool isRunning() const { return running_; }
+
+    Stats stats() {
+        Stats s;
+        s.running = running_;
+        s.frames = frames_;
+        s.late_frames = late_frames_;
+        s.failed_frames = failed_frames_;
+        s.underruns = underruns_;
+        s.decoded = decoded_;
+        s.avg_decode_ms = s.decoded > 0 ? decode_us_ / 1000.0 / s.decoded : 0;
+        s.workers = (int)workers_.size();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            s.window = (int)slots_.size();
+            for (const Slot& slot : slots_) {
+                if (slot.state == SLOT_READY) s.buffered++;
+            }
+        }
+        s.elapsed_sec = running_ ? secondsSinceStart() : elapsed_.load();
+        if (s.elapsed_sec > 0) s.fps = s.frames / s.elapsed_sec;
+        s.write_seq = ring_.isOpen() ? ring_.writeSeq() : 0;
+        return s;
+    }
+
+private:
+    enum SlotState {
+        SLOT_EMPTY = 0,
+        SLOT_READY,
+        SLOT_FAILED,
+    };
+
+    // 预取窗口中的一帧，序号 seq 的帧放在 seq % window
+    struct Slot {
+        int64_t seq = -1;
+        SlotState state = SLOT_EMPTY;
+        std::vector<uint8_t> data;
+    };
+
+    Options options_;
+    const ImageSequence* sequence_ = nullptr;
+    ShmFrameRing ring_;
+    int width_ = 0;
+    int height_ = 0;
+    size_t frame_size_ = 0;
+    int64_t start_index_ = 0;
+    int64_t end_seq_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<Slot> slots_;
+    int64_t next_decode_ = 0;     // 下一个待领取的序号
+    int64_t published_ = 0;       // 已发布（释放槽）的帧数
+
+    std::thread thread_;
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> late_frames_{0};
+    std::atomic<uint64_t> failed_frames_{0};
+    std::atomic<uint64_t> underruns_{0};
+    std::atomic<uint64_t> decoded_{0};
+    std::atomic<uint64_t> decode_us_{0};   // 多个解码线程累加，用整数才能 fetch_add
+    std::atomic<double> elapsed_{0};
+    std::chrono::steady_clock::time_point start_time_;
+
+    double secondsSinceStart() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    }
+
+    int64_t frameIndex(int64_t seq) const {
+        return (start_index_ + seq) % sequence_->info().frame_count;
+    }
+
+    void decodeLoop() {
+        ImageFrameDecoder decoder;
+        int64_t window = (int64_t)slots_.size();
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            // 领取的序号不超过窗口：其槽位中的上一帧已发布
+            cond_.wait(lock, [&] {
+                return !running_ || (next_decode_ < end_seq_ && next_decode_ < published_ + window);
+            });
+            if (!running_) break;
+            int64_t seq = next_decode_++;
+            Slot& slot = slots_[seq % window];
+            lock.unlock();
+
+            auto t0 = std::chrono::steady_clock::now();
+            std::string error;
+            bool ok = decoder.decodeTo(sequence_->file(frameIndex(seq)), options_.out_format,
+                                       width_, height_, slot.data.data(), error);
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+            if (ok) {
+                decode_us_ += (uint64_t)us;
+                decoded_++;
+            } else {
+                fprintf(stderr, "Image sequence: %s\n", error.c_str());
+            }
+
+            lock.lock();
+            slot.seq = seq;
+            slot.state = ok ? SLOT_READY : SLOT_FAILED;
+            cond_.notify_all();
+        }
+    }
+
+    void publishLoop() {
+        const ImageSequence::Info& info = sequence_->info();
+        double frame_duration = 1.0 / info.fps;
+        int64_t window = (int64_t)slots_.size();
+        int clock_id = options_.clock ? options_.clock->subscribe(sequence_->file(start_index_)) : 0;
+        double start_pts = (double)start_index_ / info.fps;
+        uint32_t flags = SHM_FLAG_KEYFRAME | SHM_FLAG_DISCONTINUITY;
+        uint32_t stride = options_.out_format == SHM_PIXEL_RGBA ? (uint32_t)width_ * 4 : (uint32_t)width_;
+
+        for (int64_t seq = 0; running_ && seq < end_seq_; seq++) {
+            Slot& slot = slots_[seq % window];
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                auto ready = [&] { return !running_ || (slot.seq == seq && slot.state != SLOT_EMPTY); };
+                if (!ready()) {
+                    underruns_++;
+                    cond_.wait(lock, ready);
+                }
+            }
+            if (!running_) break;
+
+            // 循环播放时 pts 连续增长
+            double pts = (double)(start_index_ + seq) / info.fps;
+            bool publish = slot.state == SLOT_READY;
+            if (!publish) failed_frames_++;
+
+            if (publish && options_.clock) {
+                PresentationClock::Decision decision = options_.clock->waitForPresentation(clock_id, pts, running_);
+                if (!running_) break;
+                if (decision == PresentationClock::DROP) {
+                    late_frames_++;
+                    publish = false;
+                }
+            } else if (publish && options_.realtime) {
+                double due = pts - start_pts;
+                double now = secondsSinceStart();
+                if (now > due + frame_duration) late_frames_++;
+                while (running_ && (now = secondsSinceStart()) < due) {
+                    std::this_thread::sleep_for(std::chrono::duration<double>(std::min(due - now, 0.02)));
+                }
+                if (!running_) break;
+            }
+
+            if (publish) {
+                uint8_t* dst = ring_.beginWrite();
+                memcpy(dst, slot.data.data(), frame_size_);
+                ring_.endWrite(width_, height_, options_.out_format, (uint32_t)frame_size_, stride, pts, flags);
+                flags = SHM_FLAG_KEYFRAME;
+                frames_++;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                slot.state = SLOT_EMPTY;
+                published_ = seq + 1;
+            }
+            cond_.notify_all();
+        }
+
+        if (options_.clock) options_.clock->unsubscribe(clock_id);
+        elapsed_ = secondsSinceStart();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cond_.notify_all();
+    }
+};
+
+// ================ N-API 绑定 ================
+
+class ImageSequenceSourceWrapper : public Napi::ObjectWrap<ImageSequenceSourceWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "ImageSequenceSource", {
+            InstanceMethod("open", &ImageSequenceSourceWrapper::Open),
+            InstanceMethod("getInfo", &ImageSequenceSourceWrapper::GetInfo),
+            InstanceMethod("startPublishing", &ImageSequenceSourceWrapper::StartPublishing),
+            InstanceMethod("stopPublishing", &ImageSequenceSourceWrapper::StopPublishing),
+            InstanceMethod("getPublishStats", &ImageSequenceSourceWrapper::GetPublishStats),
+            InstanceMethod("close", &ImageSequenceSourceWrapper::Close),
+        });
+
+        exports.Set("ImageSequenceSource", func);
+        return exports;
+    }
+
+    ImageSequenceSourceWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<ImageSequenceSourceWrapper>(info) {}
+
+    ~ImageSequenceSourceWrapper() {
+        publisher_.stop();
+    }
+
+private:
+    ImageSequence sequence_;
+    ImageSequencePublisher publisher_;
+
+    bool checkIdle(Napi::Env env) {
+        if (publisher_.isRunning()) {
+            Napi::Error::New(env, "Source is publishing to a frame ring").ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+
+    // 打开: (path, { fps?, startNumber? })，path 为目录、printf 模式或序列中的一个文件
+    // 同步解码首帧以得到尺寸
+    Napi::Value Open(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected (path, options?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!checkIdle(env)) return env.Null();
+
+        ImageSequence::Options options;
+        if (info.Length() >= 2 && info[1].IsObject()) {
+            Napi::Object opts = info[1].As<Napi::Object>();
+            if (opts.Get("fps").IsNumber()) options.fps = opts.Get("fps").As<Napi::Number>().DoubleValue();
+            if (opts.Get("startNumber").IsNumber()) options.start_number = opts.Get("startNumber").As<Napi::Number>().Int32Value();
+        }
+
+        std::string error;
+        if (!sequence_.open(info[0].As<Napi::String>().Utf8Value(), options, error)) {
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        ImageFrameDecoder decoder;
+        if (!decoder.decode(sequence_.file(0), error)) {
+            sequence_.close();
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        ImageSequence::Info& seq = sequence_.info();
+        seq.width = decoder.width();
+        seq.height = decoder.height();
+        seq.codec = decoder.codecName();
+        seq.pixel_format = decoder.pixelFormatName();
+        return GetInfo(info);
+    }
+
+    // { width, height, fps, frameCount, duration, codec, pixelFormat, firstFile }
+    Napi::Value GetInfo(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!sequence_.isOpen()) return env.Null();
+
+        const ImageSequence::Info& seq = sequence_.info();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("width", Napi::Number::New(env, seq.width));
+        result.Set("height", Napi::Number::New(env, seq.height));
+        result.Set("fps", Napi::Number::New(env, seq.fps));
+        result.Set("frameCount", Napi::Number::New(env, (double)seq.frame_count));
+        result.Set("duration", Napi::Number::New(env, seq.duration));
+        result.Set("codec", Napi::String::New(env, seq.codec));
+        result.Set("pixelFormat", Napi::String::New(env, seq.pixel_format));
+        result.Set("firstFile", Napi::String::New(env, sequence_.file(0)));
+        return result;
+    }
+
+    // 开始发布: (ringName, { format?: 'nv12' | 'rgba', slotCount?, realtime?, loop?, startFrame?,
+    //                        prefetchBytes?, workers?, clock? })
+    Napi::Value StartPublishing(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected (ringName, options?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!sequence_.isOpen()) {
+            Napi::Error::New(env, "Source not opened").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!checkIdle(env)) return env.Null();
+
+        ImageSequencePublisher::Options options;
+        options.ring_name = info[0].As<Napi::String>().Utf8Value();
+        if (info.Length() >= 2 && info[1].IsObject()) {
+            Napi::Object opts = info[1].As<Napi::Object>();
+            if (opts.Get("format").IsString() && opts.Get("format").As<Napi::String>().Utf8Value() == "rgba") {
+                options.out_format = SHM_PIXEL_RGBA;
+            }
+            if (opts.Get("slotCount").IsNumber()) options.slot_count = opts.Get("slotCount").As<Napi::Number>().Uint32Value();
+            if (opts.Get("realtime").IsBoolean()) options.realtime = opts.Get("realtime").As<Napi::Boolean>().Value();
+            if (opts.Get("loop").IsBoolean()) options.loop = opts.Get("loop").As<Napi::Boolean>().Value();
+            if (opts.Get("startFrame").IsNumber()) options.start_frame = opts.Get("startFrame").As<Napi::Number>().Int64Value();
+            if (opts.Get("prefetchBytes").IsNumber()) {
+                options.prefetch_bytes = (uint64_t)std::max<int64_t>(0, opts.Get("prefetchBytes").As<Napi::Number>().Int64Value());
+            }
+            if (opts.Get("workers").IsNumber()) options.workers = opts.Get("workers").As<Napi::Number>().Int32Value();
+            options.clock = PresentationClockWrapper::FromValue(opts.Get("clock"));
+        }
+        if (options.slot_count < 2) options.slot_count = 2;
+
+        std::string error;
+        if (!publisher_.start(&sequence_, options, error)) {
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
+
+    Napi::Value StopPublishing(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        publisher_.stop();
+        return env.Undefined();
+    }
+
+    Napi::Value GetPublishStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        ImageSequencePublisher::Stats stats = publisher_.stats();
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("running", Napi::Boolean::New(env, stats.running));
+        result.Set("frames", Napi::Number::New(env, (double)stats.frames));
+        result.Set("lateFrames", Napi::Number::New(env, (double)stats.late_frames));
+        result.Set("failedFrames", Napi::Number::New(env, (double)stats.failed_frames));
+        result.Set("underruns", Napi::Number::New(env, (double)stats.underruns));
+        result.Set("decoded", Napi::Number::New(env, (double)stats.decoded));
+        result.Set("avgDecodeMs", Napi::Number::New(env, stats.avg_decode_ms));
+        result.Set("window", Napi::Number::New(env, stats.window));
+        result.Set("buffered", Napi::Number::New(env, stats.buffered));
+        result.Set("workers", Napi::Number::New(env, stats.workers));
+        result.Set("fps", Napi::Number::New(env, stats.fps));
+        result.Set("elapsed", Napi::Number::New(env, stats.elapsed_sec));
+        result.Set("writeSeq", Napi::Number::New(env, (double)stats.write_seq));
+        return result;
+    }
+
+    Napi::Value Close(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        publisher_.stop();
+        sequence_.close();
+        return env.Undefined();
+    }
+};
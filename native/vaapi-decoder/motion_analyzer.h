@@ -0,0 +1,247 @@
+/**
+ * 基于运动矢量的运动检测
+ * 软解时让解码器导出运动矢量（AV_FRAME_DATA_MOTION_VECTORS），按宏块网格聚合成运动能量图，
+ * 判定出紧凑的运动开始/持续/结束事件。不读取像素，比在解码帧上做帧差便宜一个数量级，
+ * 多路监控画面可以只为显示中的通道输出像素
+ *
+ * - 只有 H.264、MPEG-1/2/4、H.263 软解导出运动矢量；硬解和 HEVC 没有，此时 vectorsAvailable 为 false
+ * - 帧内编码帧（I 帧）没有运动矢量，不更新能量图，运动状态保持
+ * - 能量：每个格子内矢量长度（像素）按块面积加权的平均值，再做指数平滑
+ */
+#pragma once
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libavutil/motion_vector.h>
+}
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// 运动事件
+struct MotionEvent {
+    enum Type {
+        START = 0,
+        UPDATE,
+        END,
+    };
+    Type type;
+    double pts;
+    int64_t frame_index;
+    double energy;       // 活动格子的平均平滑能量（像素/帧）
+    double area;         // 活动格子占比 (0-1)
+    double x, y, w, h;   // 活动格子的外接矩形，归一化到 0-1
+};
+
+class MotionAnalyzer {
+public:
+    struct Options {
+        int cell_size = 32;          // 格子边长（像素），按 16 对齐到宏块
+        double threshold = 1.0;      // 格子平滑能量达到该值视为活动（像素/帧）
+        double min_vector = 0.5;     // 短于该长度的矢量视为编码噪声（像素）
+        double min_area = 0.002;     // 活动格子占比达到该值视为有运动
+        double smoothing = 0.5;      // 指数平滑系数，越大越平滑
+        int start_frames = 3;        // 连续多少帧有运动才发出 START
+        int hold_frames = 25;        // 连续多少帧无运动才发出 END
+        int update_frames = 15;      // 运动期间每隔多少帧发出一次 UPDATE，0 不发
+    };
+
+    struct Stats {
+        uint64_t frames = 0;            // 分析的帧数
+        uint64_t frames_with_vectors = 0;
+        uint64_t vectors = 0;           // 最近一帧的矢量数
+        uint64_t events = 0;
+        bool motion = false;
+        double area = 0;                // 最近一帧的活动格子占比
+        double energy = 0;
+    };
+
+    explicit MotionAnalyzer(const Options& options) : options_(options) {
+        options_.cell_size = std::max(16, (options_.cell_size + 15) / 16 * 16);
+        options_.smoothing = std::max(0.0, std::min(0.95, options_.smoothing));
+        options_.start_frames = std::max(1, options_.start_frames);
+        options_.hold_frames = std::max(1, options_.hold_frames);
+    }
+
+    // 软解时在 avcodec_open2 之前或之后调用均可，每帧解码时读取（帧多线程也会同步到各线程）
+    static void configureContext(AVCodecContext* ctx) {
+#ifdef AV_CODEC_EXPORT_DATA_MVS
+        ctx->export_side_data |= AV_CODEC_EXPORT_DATA_MVS;
+#else
+        ctx->flags2 |= AV_CODEC_FLAG2_EXPORT_MVS;
+#endif
+    }
+
+    static void unconfigureContext(AVCodecContext* ctx) {
+#ifdef AV_CODEC_EXPORT_DATA_MVS
+        ctx->export_side_data &= ~AV_CODEC_EXPORT_DATA_MVS;
+#else
+        ctx->flags2 &= ~AV_CODEC_FLAG2_EXPORT_MVS;
+#endif
+    }
+
+    // frame 为解码器直接输出的帧，width/height 取帧本身（lowres 时矢量坐标也是缩小后的）
+    void add(const AVFrame* frame, double pts, int64_t frame_index) {
+        stats_.frames++;
+        AVFrameSideData* sd = av_frame_get_side_data(frame, AV_FRAME_DATA_MOTION_VECTORS);
+        if (!sd || frame->width <= 0 || frame->height <= 0) {
+            // I 帧或不导出矢量的解码器：保持上一帧的状态
+            return;
+        }
+        stats_.frames_with_vectors++;
+        resize(frame->width, frame->height);
+
+        const AVMotionVector* mvs = (const AVMotionVector*)sd->data;
+        size_t count = sd->size / sizeof(AVMotionVector);
+        stats_.vectors = count;
+
+        std::fill(current_.begin(), current_.end(), 0.0f);
+        std::fill(coverage_.begin(), coverage_.end(), 0.0f);
+        for (size_t i = 0; i < count; i++) {
+            const AVMotionVector& mv = mvs[i];
+            double dx, dy;
+            if (mv.motion_scale > 0) {
+                dx = (double)mv.motion_x / mv.motion_scale;
+                dy = (double)mv.motion_y / mv.motion_scale;
+            } else {
+                dx = mv.dst_x - mv.src_x;
+                dy = mv.dst_y - mv.src_y;
+            }
+            double length = std::sqrt(dx * dx + dy * dy);
+            int cx = std::min(cols_ - 1, std::max(0, (int)mv.dst_x / options_.cell_size));
+            int cy = std::min(rows_ - 1, std::max(0, (int)mv.dst_y / options_.cell_size));
+            float block_area = (float)(mv.w * mv.h);
+            coverage_[cy * cols_ + cx] += block_area;
+            if (length >= options_.min_vector) {
+                current_[cy * cols_ + cx] += (float)length * block_area;
+            }
+        }
+
+        // 双向预测的块每个方向各有一个矢量，按覆盖面积平均；帧内块没有矢量，按 0 计入
+        float cell_area = (float)options_.cell_size * options_.cell_size;
+        float keep = (float)options_.smoothing;
+        int active = 0;
+        double active_energy = 0;
+        int min_x = cols_, min_y = rows_, max_x = -1, max_y = -1;
+        for (int y = 0; y < rows_; y++) {
+            for (int x = 0; x < cols_; x++) {
+                int i = y * cols_ + x;
+                float energy = current_[i] / std::max(coverage_[i], cell_area);
+                map_[i] = map_[i] * keep + energy * (1.0f - keep);
+                if (map_[i] < options_.threshold) continue;
+                active++;
+                active_energy += map_[i];
+                min_x = std::min(min_x, x);
+                min_y = std::min(min_y, y);
+                max_x = std::max(max_x, x);
+                max_y = std::max(max_y, y);
+            }
+        }
+
+        double area = (double)active / (cols_ * rows_);
+        stats_.area = area;
+        stats_.energy = active > 0 ? active_energy / active : 0;
+
+        MotionEvent event;
+        event.pts = pts;
+        event.frame_index = frame_index;
+        event.energy = stats_.energy;
+        event.area = area;
+        if (active > 0) {
+            event.x = (double)min_x / cols_;
+            event.y = (double)min_y / rows_;
+            event.w = (double)(max_x - min_x + 1) / cols_;
+            event.h = (double)(max_y - min_y + 1) / rows_;
+        } else {
+            event.x = event.y = event.w = event.h = 0;
+        }
+
+        if (area >= options_.min_area) {
+            quiet_frames_ = 0;
+            if (!stats_.motion) {
+                if (++busy_frames_ >= options_.start_frames) {
+                    stats_.motion = true;
+                    since_update_ = 0;
+                    push(event, MotionEvent::START);
+                }
+            } else if (options_.update_frames > 0 && ++since_update_ >= options_.update_frames) {
+                since_update_ = 0;
+                push(event, MotionEvent::UPDATE);
+            }
+        } else {
+            busy_frames_ = 0;
+            if (stats_.motion && ++quiet_frames_ >= options_.hold_frames) {
+                stats_.motion = false;
+                quiet_frames_ = 0;
+                push(event, MotionEvent::END);
+            }
+        }
+    }
+
+    bool hasEvents() const { return !events_.empty(); }
+
+    std::vector<MotionEvent> takeEvents() {
+        std::vector<MotionEvent> out;
+        out.swap(events_);
+        return out;
+    }
+
+    // 平滑后的能量图，按行排列 cols x rows
+    const std::vector<float>& map() const { return map_; }
+    int cols() const { return cols_; }
+    int rows() const { return rows_; }
+
+    const Stats& stats() const { return stats_; }
+
+    // seek 或重新打开后画面不连续，清空能量图；正在进行的运动以 END 结束
+    void reset(double pts, int64_t frame_index) {
+        if (stats_.motion) {
+            MotionEvent event = {};
+            event.pts = pts;
+            event.frame_index = frame_index;
+            push(event, MotionEvent::END);
+        }
+        std::fill(map_.begin(), map_.end(), 0.0f);
+        stats_.motion = false;
+        stats_.area = 0;
+        stats_.energy = 0;
+        busy_frames_ = 0;
+        quiet_frames_ = 0;
+        since_update_ = 0;
+    }
+
+private:
+    Options options_;
+    Stats stats_;
+    int width_ = 0;
+    int height_ = 0;
+    int cols_ = 0;
+    int rows_ = 0;
+    std::vector<float> current_;
+    std::vector<float> coverage_;
+    std::vector<float> map_;
+    std::vector<MotionEvent> events_;
+    int busy_frames_ = 0;
+    int quiet_frames_ = 0;
+    int since_update_ = 0;
+
+    void resize(int width, int height) {
+        if (width == width_ && height == height_) return;
+        width_ = width;
+        height_ = height;
+        cols_ = (width + options_.cell_size - 1) / options_.cell_size;
+        rows_ = (height + options_.cell_size - 1) / options_.cell_size;
+        current_.assign((size_t)cols_ * rows_, 0.0f);
+        coverage_.assign((size_t)cols_ * rows_, 0.0f);
+        map_.assign((size_t)cols_ * rows_, 0.0f);
+    }
+
+    void push(MotionEvent event, MotionEvent::Type type) {
+        event.type = type;
+        events_.push_back(event);
+        stats_.events++;
+    }
+};
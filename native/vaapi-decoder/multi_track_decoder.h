@@ -0,0 +1,741 @@
+/**
+ * 多轨解码
+ * 同一文件中的多路视频流（如多机位 MKV）只解复用一次：解复用线程按 stream_index
+ * 把数据包分发到各轨的有界队列，每轨一个解码上下文和独立的解码线程，
+ * 输出 NV12 帧到各自的共享内存环。硬解时各轨共用同一个 VA-API 设备。
+ * 传入 PresentationClock 时各轨作为时钟的订阅者按 tick 对齐发布。
+ * 流中途分辨率变化时不重建环：槽按 maxWidth/maxHeight 预留（tmpfs 页面按需提交，
+ * 预留不使用的部分不占内存），新尺寸的第一帧带 SHM_FLAG_FORMAT_CHANGE，
+ * 超过槽大小的帧按比例缩小后发布
+ */
+#pragma once
+
+#include <napi.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/hwcontext.h>
+#include <libswscale/swscale.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "osd_overlay.h"
+#include "presentation_clock.h"
+#include "resource_limits.h"
+#include "shm_frame_ring.h"
+
+class MultiTrackDecoder {
+public:
+    struct StreamInfo {
+        int index = -1;
+        std::string codec;
+        int width = 0;
+        int height = 0;
+        double fps = 0;
+        double duration = 0;
+    };
+
+    struct Options {
+        std::vector<int> streams;          // 要解码的流，空表示全部视频流
+        std::vector<std::string> ring_names;
+        uint32_t slot_count = 4;
+        bool hw_accel = true;
+        bool realtime = true;              // 各轨按同一起点的时间戳节奏输出
+        int queue_packets = 64;            // 每轨数据包队列上限，满时解复用等待
+        std::shared_ptr<PresentationClock> clock;  // 设置后忽略 realtime，由时钟决定发布时刻
+        std::vector<std::shared_ptr<OsdOverlay>> overlays;  // 与 ring_names 对应，可为空
+        int max_width = 0;                 // 环的槽按此尺寸预留，0 表示流的初始尺寸
+        int max_height = 0;
+    };
+
+    struct TrackStats {
+        int stream = -1;
+        std::string ring_name;
+        bool hw_accel = false;
+        bool finished = false;
+        uint64_t packets = 0;
+        uint64_t frames = 0;
+        uint64_t dropped = 0;              // 格式不支持或下载失败的帧
+        uint64_t late_dropped = 0;         // 共享时钟判定迟到而丢弃的帧
+        uint64_t scaled = 0;               // 超过槽大小而缩小发布的帧
+        uint64_t resolution_changes = 0;
+        int width = 0;                     // 最近发布的帧尺寸
+        int height = 0;
+        size_t queued = 0;
+        double avg_decode_ms = 0;
+        double last_pts = 0;
+    };
+
+    struct Stats {
+        bool running = false;
+        uint64_t packets_read = 0;
+        uint64_t packets_discarded = 0;    // 未选择的流
+        double demux_wait_ms = 0;          // 因某轨队列已满而等待的时间
+        double elapsed_sec = 0;
+        std::vector<TrackStats> tracks;
+    };
+
+    ~MultiTrackDecoder() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+        int ret = avformat_open_input(&fmt_ctx_, path.c_str(), nullptr, nullptr);
+        if (ret < 0) {
+            setError("Failed to open input: " + path, ret);
+            return false;
+        }
+        if (avformat_find_stream_info(fmt_ctx_, nullptr) < 0) {
+            last_error_ = "Failed to find stream info";
+            close();
+            return false;
+        }
+
+        streams_.clear();
+        for (unsigned i = 0; i < fmt_ctx_->nb_streams; i++) {
+            AVStream* stream = fmt_ctx_->streams[i];
+            if (stream->codecpar->codec_type != AVMEDIA_TYPE_VIDEO) continue;
+            if (stream->disposition & AV_DISPOSITION_ATTACHED_PIC) continue;
+            StreamInfo info;
+            info.index = (int)i;
+            info.codec = avcodec_get_name(stream->codecpar->codec_id);
+            info.width = stream->codecpar->width;
+            info.height = stream->codecpar->height;
+            info.fps = stream->avg_frame_rate.den > 0 ? av_q2d(stream->avg_frame_rate) : 0;
+            info.duration = stream->duration != AV_NOPTS_VALUE
+                                ? stream->duration * av_q2d(stream->time_base)
+                                : (fmt_ctx_->duration != AV_NOPTS_VALUE ? (double)fmt_ctx_->duration / AV_TIME_BASE : 0);
+            streams_.push_back(info);
+        }
+        if (streams_.empty()) {
+            last_error_ = "No video stream found";
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool start(const Options& options) {
+        stop();
+        if (!fmt_ctx_) {
+            last_error_ = "Decoder not opened";
+            return false;
+        }
+        options_ = options;
+        if (options_.streams.empty()) {
+            for (const StreamInfo& info : streams_) options_.streams.push_back(info.index);
+        }
+        if (options_.ring_names.size() != options_.streams.size()) {
+            last_error_ = "Need one ring name per track";
+            return false;
+        }
+
+        if (options_.hw_accel && !hw_device_ctx_) {
+            if (av_hwdevice_ctx_create(&hw_device_ctx_, AV_HWDEVICE_TYPE_VAAPI, nullptr, nullptr, 0) < 0) {
+                fprintf(stderr, "Multi-track: VA-API unavailable, using software decoding\n");
+                hw_device_ctx_ = nullptr;
+            }
+        }
+
+        // 软解时各轨平分容器允许的解码线程
+        int sw_threads = std::max(1, ResourceLimits::get().decode_threads / (int)options_.streams.size());
+        track_of_stream_.assign(fmt_ctx_->nb_streams, -1);
+        for (size_t i = 0; i < options_.streams.size(); i++) {
+            int index = options_.streams[i];
+            if (index < 0 || index >= (int)fmt_ctx_->nb_streams ||
+                fmt_ctx_->streams[index]->codecpar->codec_type != AVMEDIA_TYPE_VIDEO ||
+                track_of_stream_[index] >= 0) {
+                last_error_ = "Invalid or duplicate video stream index " + std::to_string(index);
+                releaseTracks();
+                return false;
+            }
+            std::unique_ptr<Track> track(new Track());
+            track->stream = index;
+            track->ring_name = options_.ring_names[i];
+            if (i < options_.overlays.size()) track->overlay = options_.overlays[i];
+            if (!openTrack(track.get(), sw_threads)) {
+                releaseTracks();
+                return false;
+            }
+            track_of_stream_[index] = (int)tracks_.size();
+            tracks_.push_back(std::move(track));
+        }
+        if (options_.clock) {
+            for (auto& track : tracks_) {
+                track->clock_id = options_.clock->subscribe("stream " + std::to_string(track->stream));
+            }
+        }
+
+        packets_read_ = 0;
+        packets_discarded_ = 0;
+        demux_wait_ms_ = 0;
+        elapsed_ = 0;
+        start_time_ = std::chrono::steady_clock::now();
+        running_ = true;
+        for (auto& track : tracks_) {
+            track->thread = std::thread(&MultiTrackDecoder::decodeLoop, this, track.get());
+        }
+        demux_thread_ = std::thread(&MultiTrackDecoder::demuxLoop, this);
+        return true;
+    }
+
+    void stop() {
+        running_ = false;
+        for (auto& track : tracks_) {
+            std::lock_guard<std::mutex> lock(track->mutex);
+            track->cond.notify_all();
+        }
+        if (demux_thread_.joinable()) demux_thread_.join();
+        releaseTracks();
+        // 下一次 start 从头开始
+        if (fmt_ctx_) av_seek_frame(fmt_ctx_, -1, fmt_ctx_->start_time != AV_NOPTS_VALUE ? fmt_ctx_->start_time : 0,
+                                    AVSEEK_FLAG_BACKWARD);
+    }
+
+    void close() {
+        stop();
+        if (fmt_ctx_) avformat_close_input(&fmt_ctx_);
+        if (hw_device_ctx_) av_buffer_unref(&hw_device_ctx_);
+        streams_.clear();
+    }
+
+    bool isOpen() const { return fmt_ctx_ != nullptr; }
+    bool isRunning() const { return running_; }
+    const std::vector<StreamInfo>& streams() const { return streams_; }
+    const std::string& lastError() const { return last_error_; }
+
+    Stats stats() const {
+        Stats s;
+        s.running = running_;
+        s.packets_read = packets_read_;
+        s.packets_discarded = packets_discarded_;
+        s.demux_wait_ms = demux_wait_ms_;
+        s.elapsed_sec = running_ ? secondsSinceStart() : elapsed_.load();
+        for (const auto& track : tracks_) {
+            TrackStats t;
+            t.stream = track->stream;
+            t.ring_name = track->ring_name;
+            t.hw_accel = track->hw_accel;
+            t.finished = track->finished;
+            t.packets = track->packets;
+            t.frames = track->frames;
+            t.dropped = track->dropped;
+            t.late_dropped = track->late_dropped;
+            t.scaled = track->scaled;
+            t.resolution_changes = track->resolution_changes;
+            t.width = track->width;
+            t.height = track->height;
+            t.avg_decode_ms = t.packets > 0 ? track->decode_ms / t.packets : 0;
+            t.last_pts = track->last_pts;
+            {
+                std::lock_guard<std::mutex> lock(track->mutex);
+                t.queued = track->queue.size();
+            }
+            s.tracks.push_back(t);
+        }
+        return s;
+    }
+
+private:
+    struct Track {
+        int stream = -1;
+        std::string ring_name;
+        AVCodecContext* codec_ctx = nullptr;
+        bool hw_accel = false;
+        double time_base = 0;
+        double fps = 0;
+        int64_t start_pts = 0;
+        int clock_id = 0;
+        std::shared_ptr<OsdOverlay> overlay;
+        ShmFrameRing ring;
+        SwsContext* scaler = nullptr;      // 只在解码线程中使用
+        std::thread thread;
+
+        // 解复用线程写入，解码线程读取；nullptr 表示输入结束
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<AVPacket*> queue;
+
+        std::atomic<bool> finished{false};
+        std::atomic<uint64_t> packets{0};
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> late_dropped{0};
+        std::atomic<uint64_t> scaled{0};
+        std::atomic<uint64_t> resolution_changes{0};
+        std::atomic<int> width{0};
+        std::atomic<int> height{0};
+        std::atomic<double> decode_ms{0};
+        std::atomic<double> last_pts{0};
+    };
+
+    AVFormatContext* fmt_ctx_ = nullptr;
+    AVBufferRef* hw_device_ctx_ = nullptr;
+    std::vector<StreamInfo> streams_;
+    Options options_;
+    std::vector<std::unique_ptr<Track>> tracks_;
+    std::vector<int> track_of_stream_;
+    std::thread demux_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> packets_read_{0};
+    std::atomic<uint64_t> packets_discarded_{0};
+    std::atomic<double> demux_wait_ms_{0};
+    std::atomic<double> elapsed_{0};
+    std::chrono::steady_clock::time_point start_time_;
+    std::string last_error_;
+
+    void setError(const std::string& message, int ret) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        last_error_ = message + " - " + errbuf;
+    }
+
+    double secondsSinceStart() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    }
+
+    static enum AVPixelFormat getHwFormat(AVCodecContext*, const enum AVPixelFormat* pix_fmts) {
+        for (const enum AVPixelFormat* p = pix_fmts; *p != AV_PIX_FMT_NONE; p++) {
+            if (*p == AV_PIX_FMT_VAAPI) return *p;
+        }
+        return AV_PIX_FMT_NONE;
+    }
+
+    bool openTrack(Track* track, int sw_threads) {
+        AVStream* stream = fmt_ctx_->streams[track->stream];
+        const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!codec) {
+            last_error_ = "No decoder for stream " + std::to_string(track->stream);
+            return false;
+        }
+        track->codec_ctx = avcodec_alloc_context3(codec);
+        if (!track->codec_ctx || avcodec_parameters_to_context(track->codec_ctx, stream->codecpar) < 0) {
+            last_error_ = "Failed to set up decoder for stream " + std::to_string(track->stream);
+            return false;
+        }
+        track->hw_accel = options_.hw_accel && hw_device_ctx_ != nullptr;
+        if (track->hw_accel) {
+            track->codec_ctx->hw_device_ctx = av_buffer_ref(hw_device_ctx_);
+            track->codec_ctx->get_format = getHwFormat;
+        } else {
+            track->codec_ctx->thread_count = sw_threads;
+        }
+        if (avcodec_open2(track->codec_ctx, codec, nullptr) < 0) {
+            last_error_ = "Failed to open decoder for stream " + std::to_string(track->stream);
+            return false;
+        }
+
+        // 所有轨以文件起始时间为零点，时间戳可直接比较
+        track->time_base = av_q2d(stream->time_base);
+        track->fps = stream->avg_frame_rate.den > 0 ? av_q2d(stream->avg_frame_rate) : 0;
+        track->start_pts = fmt_ctx_->start_time != AV_NOPTS_VALUE
+                               ? av_rescale_q(fmt_ctx_->start_time, AV_TIME_BASE_Q, stream->time_base)
+                               : 0;
+
+        // 槽按最大尺寸预留，分辨率变大时不必重建环（消费者也不必重新打开）
+        int width = std::max(stream->codecpar->width, options_.max_width);
+        int height = std::max(stream->codecpar->height, options_.max_height);
+        uint32_t slot_size = (uint32_t)((size_t)width * height * 3 / 2);
+        if (slot_size == 0 || !track->ring.create(track->ring_name, std::max<uint32_t>(2, options_.slot_count), slot_size)) {
+            last_error_ = "Failed to create frame ring " + track->ring_name;
+            return false;
+        }
+        return true;
+    }
+
+    void releaseTracks() {
+        for (auto& track : tracks_) {
+            {
+                std::lock_guard<std::mutex> lock(track->mutex);
+                track->cond.notify_all();
+            }
+            if (track->thread.joinable()) track->thread.join();
+            for (AVPacket* pkt : track->queue) av_packet_free(&pkt);
+            track->queue.clear();
+            if (track->codec_ctx) avcodec_free_context(&track->codec_ctx);
+            if (track->scaler) {
+                sws_freeContext(track->scaler);
+                track->scaler = nullptr;
+            }
+            if (options_.clock) options_.clock->unsubscribe(track->clock_id);
+            track->ring.close();
+        }
+        tracks_.clear();
+    }
+
+    // 入队，队列已满时等待（持有一个引用，调用者不再使用 pkt）
+    void push(Track* track, AVPacket* pkt) {
+        std::unique_lock<std::mutex> lock(track->mutex);
+        if ((int)track->queue.size() >= options_.queue_packets) {
+            auto t0 = std::chrono::steady_clock::now();
+            track->cond.wait(lock, [&] {
+                return !running_ || track->finished || (int)track->queue.size() < options_.queue_packets;
+            });
+            demux_wait_ms_ = demux_wait_ms_ + std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - t0).count();
+        }
+        if (!running_ || track->finished) {
+            av_packet_free(&pkt);
+            return;
+        }
+        track->queue.push_back(pkt);
+        track->cond.notify_all();
+    }
+
+    void demuxLoop() {
+        AVPacket* pkt = av_packet_alloc();
+        while (running_) {
+            if (av_read_frame(fmt_ctx_, pkt) < 0) break;
+            packets_read_++;
+            int track_index = pkt->stream_index < (int)track_of_stream_.size() ? track_of_stream_[pkt->stream_index] : -1;
+            if (track_index < 0) {
+                packets_discarded_++;
+                av_packet_unref(pkt);
+                continue;
+            }
+            AVPacket* item = av_packet_alloc();
+            av_packet_move_ref(item, pkt);
+            push(tracks_[track_index].get(), item);
+        }
+        av_packet_free(&pkt);
+
+        // 输入结束：通知各轨冲刷解码器
+        for (auto& track : tracks_) {
+            std::lock_guard<std::mutex> lock(track->mutex);
+            track->queue.push_back(nullptr);
+            track->cond.notify_all();
+        }
+        for (auto& track : tracks_) {
+            if (track->thread.joinable()) track->thread.join();
+        }
+        elapsed_ = secondsSinceStart();
+        running_ = false;
+    }
+
+    void decodeLoop(Track* track) {
+        AVFrame* frame = av_frame_alloc();
+        AVFrame* sw_frame = av_frame_alloc();
+        bool eof = false;
+
+        while (running_ && !eof) {
+            AVPacket* pkt = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(track->mutex);
+                track->cond.wait(lock, [&] { return !running_ || !track->queue.empty(); });
+                if (!running_) break;
+                pkt = track->queue.front();
+                track->queue.pop_front();
+                track->cond.notify_all();
+            }
+            eof = pkt == nullptr;
+
+            auto t0 = std::chrono::steady_clock::now();
+            int ret = avcodec_send_packet(track->codec_ctx, pkt);
+            if (pkt) {
+                av_packet_free(&pkt);
+                track->packets++;
+            }
+            if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) continue;
+
+            while (running_ && avcodec_receive_frame(track->codec_ctx, frame) == 0) {
+                track->decode_ms = track->decode_ms + std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - t0).count();
+                publish(track, frame, sw_frame);
+                av_frame_unref(frame);
+                t0 = std::chrono::steady_clock::now();
+            }
+        }
+
+        av_frame_free(&frame);
+        av_frame_free(&sw_frame);
+        // 结束的轨不再拖住其他订阅者
+        if (options_.clock) options_.clock->unsubscribe(track->clock_id);
+        std::lock_guard<std::mutex> lock(track->mutex);
+        track->finished = true;
+        track->cond.notify_all();
+    }
+
+    void publish(Track* track, AVFrame* frame, AVFrame* sw_frame) {
+        AVFrame* src = frame;
+        if (frame->format == AV_PIX_FMT_VAAPI) {
+            av_frame_unref(sw_frame);
+            if (av_hwframe_transfer_data(sw_frame, frame, 0) < 0) {
+                track->dropped++;
+                return;
+            }
+            src = sw_frame;
+        }
+        if (src->format != AV_PIX_FMT_NV12 && src->format != AV_PIX_FMT_YUV420P) {
+            track->dropped++;
+            return;
+        }
+        int width = src->width;
+        int height = src->height;
+        uint32_t size = (uint32_t)((size_t)width * height * 3 / 2);
+        bool scale = size > track->ring.slotSize();
+        if (scale) {
+            // 超过预留大小：保持宽高比缩小到放得下，比丢帧或重建环代价小
+            double factor = std::sqrt((double)track->ring.slotSize() / size);
+            width = std::max(2, (int)(width * factor) & ~1);
+            height = std::max(2, (int)(height * factor) & ~1);
+            size = (uint32_t)((size_t)width * height * 3 / 2);
+            track->scaler = sws_getCachedContext(track->scaler, src->width, src->height,
+                                                 (AVPixelFormat)src->format, width, height, AV_PIX_FMT_NV12,
+                                                 SWS_BILINEAR, nullptr, nullptr, nullptr);
+            if (!track->scaler) {
+                track->dropped++;
+                return;
+            }
+        }
+
+        int64_t ts = frame->best_effort_timestamp;
+        double pts = ts != AV_NOPTS_VALUE ? (ts - track->start_pts) * track->time_base : track->last_pts.load();
+        if (options_.clock) {
+            if (options_.clock->waitForPresentation(track->clock_id, pts, running_) != PresentationClock::PRESENT) {
+                if (running_) track->late_dropped++;
+                return;
+            }
+        } else if (options_.realtime) {
+            double now;
+            while (running_ && (now = secondsSinceStart()) < pts) {
+                std::this_thread::sleep_for(std::chrono::duration<double>(std::min(pts - now, 0.02)));
+            }
+            if (!running_) return;
+        }
+
+        // 直接写入环的槽，不经过中间缓冲
+        uint8_t* dst = track->ring.beginWrite();
+        uint8_t* dst_uv = dst + (size_t)width * height;
+        if (scale) {
+            uint8_t* planes[4] = {dst, dst_uv, nullptr, nullptr};
+            int strides[4] = {width, width, 0, 0};
+            sws_scale(track->scaler, src->data, src->linesize, 0, src->height, planes, strides);
+            track->scaled++;
+        } else {
+            copyNV12(src, dst, dst_uv, width, height);
+        }
+        if (track->overlay) {
+            OsdOverlay::Context ctx;
+            ctx.pts = pts;
+            ctx.frame_index = (int64_t)track->frames.load();
+            ctx.fps = track->fps;
+            track->overlay->render(OsdFrame::nv12(dst, width, height, width), ctx);
+        }
+        // 尺寸变化时 endWrite 会加上 SHM_FLAG_FORMAT_CHANGE
+        uint32_t flags = track->frames == 0 ? SHM_FLAG_DISCONTINUITY : 0;
+        if (track->frames > 0 && (width != track->width || height != track->height)) {
+            track->resolution_changes++;
+        }
+        track->ring.endWrite(width, height, SHM_PIXEL_NV12, size, width, pts, flags);
+        track->width = width;
+        track->height = height;
+        track->frames++;
+        track->last_pts = pts;
+    }
+
+    static void copyNV12(const AVFrame* src, uint8_t* dst, uint8_t* dst_uv, int width, int height) {
+        for (int y = 0; y < height; y++) {
+            memcpy(dst + (size_t)y * width, src->data[0] + (size_t)y * src->linesize[0], width);
+        }
+        if (src->format == AV_PIX_FMT_NV12) {
+            for (int y = 0; y < height / 2; y++) {
+                memcpy(dst_uv + (size_t)y * width, src->data[1] + (size_t)y * src->linesize[1], width);
+            }
+        } else {
+            for (int y = 0; y < height / 2; y++) {
+                const uint8_t* u = src->data[1] + (size_t)y * src->linesize[1];
+                const uint8_t* v = src->data[2] + (size_t)y * src->linesize[2];
+                uint8_t* row = dst_uv + (size_t)y * width;
+                for (int x = 0; x < width / 2; x++) {
+                    row[x * 2] = u[x];
+                    row[x * 2 + 1] = v[x];
+                }
+            }
+        }
+    }
+};
+
+// ================ N-API 绑定 ================
+
+class MultiTrackDecoderWrapper : public Napi::ObjectWrap<MultiTrackDecoderWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "MultiTrackDecoder", {
+            InstanceMethod("open", &MultiTrackDecoderWrapper::Open),
+            InstanceMethod("getStreams", &MultiTrackDecoderWrapper::GetStreams),
+            InstanceMethod("start", &MultiTrackDecoderWrapper::Start),
+            InstanceMethod("stop", &MultiTrackDecoderWrapper::Stop),
+            InstanceMethod("getStats", &MultiTrackDecoderWrapper::GetStats),
+            InstanceMethod("close", &MultiTrackDecoderWrapper::Close),
+        });
+
+        exports.Set("MultiTrackDecoder", func);
+        return exports;
+    }
+
+    MultiTrackDecoderWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<MultiTrackDecoderWrapper>(info) {}
+
+    ~MultiTrackDecoderWrapper() {
+        decoder_.close();
+    }
+
+private:
+    MultiTrackDecoder decoder_;
+
+    bool checkIdle(Napi::Env env) {
+        if (decoder_.isRunning()) {
+            Napi::Error::New(env, "Multi-track decoder is running").ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+
+    // 打开输入: (path) => 视频流列表
+    Napi::Value Open(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected path string").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!checkIdle(env)) return env.Null();
+
+        if (!decoder_.open(info[0].As<Napi::String>().Utf8Value())) {
+            Napi::Error::New(env, decoder_.lastError()).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return GetStreams(info);
+    }
+
+    // [{ index, codec, width, height, fps, duration }]
+    Napi::Value GetStreams(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        const std::vector<MultiTrackDecoder::StreamInfo>& streams = decoder_.streams();
+        Napi::Array result = Napi::Array::New(env, streams.size());
+        for (size_t i = 0; i < streams.size(); i++) {
+            Napi::Object item = Napi::Object::New(env);
+            item.Set("index", Napi::Number::New(env, streams[i].index));
+            item.Set("codec", Napi::String::New(env, streams[i].codec));
+            item.Set("width", Napi::Number::New(env, streams[i].width));
+            item.Set("height", Napi::Number::New(env, streams[i].height));
+            item.Set("fps", Napi::Number::New(env, streams[i].fps));
+            item.Set("duration", Napi::Number::New(env, streams[i].duration));
+            result.Set((uint32_t)i, item);
+        }
+        return result;
+    }
+
+    // 开始解码: ({ rings: string[], streams?: number[], slotCount?, hwAccel?, realtime?, queuePackets?, clock?,
+    //            overlays?: (OsdOverlay | null)[], maxWidth?, maxHeight? })
+    Napi::Value Start(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsObject() || !info[0].As<Napi::Object>().Get("rings").IsArray()) {
+            Napi::TypeError::New(env, "Expected ({ rings: string[], streams?: number[] })").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!checkIdle(env)) return env.Null();
+
+        Napi::Object opts = info[0].As<Napi::Object>();
+        MultiTrackDecoder::Options options;
+        Napi::Array rings = opts.Get("rings").As<Napi::Array>();
+        for (uint32_t i = 0; i < rings.Length(); i++) {
+            options.ring_names.push_back(rings.Get(i).ToString().Utf8Value());
+        }
+        if (opts.Get("streams").IsArray()) {
+            Napi::Array streams = opts.Get("streams").As<Napi::Array>();
+            for (uint32_t i = 0; i < streams.Length(); i++) {
+                options.streams.push_back(streams.Get(i).ToNumber().Int32Value());
+            }
+        } else {
+            // 未指定时按顺序取前 rings.length 路视频流
+            const auto& streams = decoder_.streams();
+            for (size_t i = 0; i < streams.size() && i < options.ring_names.size(); i++) {
+                options.streams.push_back(streams[i].index);
+            }
+        }
+        if (opts.Get("slotCount").IsNumber()) options.slot_count = opts.Get("slotCount").As<Napi::Number>().Uint32Value();
+        if (opts.Get("hwAccel").IsBoolean()) options.hw_accel = opts.Get("hwAccel").As<Napi::Boolean>().Value();
+        if (opts.Get("realtime").IsBoolean()) options.realtime = opts.Get("realtime").As<Napi::Boolean>().Value();
+        options.clock = PresentationClockWrapper::FromValue(opts.Get("clock"));
+        if (opts.Get("overlays").IsArray()) {
+            Napi::Array overlays = opts.Get("overlays").As<Napi::Array>();
+            for (uint32_t i = 0; i < overlays.Length(); i++) {
+                options.overlays.push_back(OsdOverlayWrapper::FromValue(overlays.Get(i)));
+            }
+        }
+        if (opts.Get("maxWidth").IsNumber()) options.max_width = std::max(0, opts.Get("maxWidth").As<Napi::Number>().Int32Value());
+        if (opts.Get("maxHeight").IsNumber()) options.max_height = std::max(0, opts.Get("maxHeight").As<Napi::Number>().Int32Value());
+        if (opts.Get("queuePackets").IsNumber()) {
+            options.queue_packets = std::max(1, opts.Get("queuePackets").As<Napi::Number>().Int32Value());
+        }
+
+        if (!decoder_.start(options)) {
+            Napi::Error::New(env, decoder_.lastError()).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
+
+    Napi::Value Stop(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        decoder_.stop();
+        return env.Undefined();
+    }
+
+    Napi::Value GetStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        MultiTrackDecoder::Stats stats = decoder_.stats();
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("running", Napi::Boolean::New(env, stats.running));
+        result.Set("packetsRead", Napi::Number::New(env, (double)stats.packets_read));
+        result.Set("packetsDiscarded", Napi::Number::New(env, (double)stats.packets_discarded));
+        result.Set("demuxWaitMs", Napi::Number::New(env, stats.demux_wait_ms));
+        result.Set("elapsed", Napi::Number::New(env, stats.elapsed_sec));
+
+        Napi::Array tracks = Napi::Array::New(env, stats.tracks.size());
+        for (size_t i = 0; i < stats.tracks.size(); i++) {
+            const MultiTrackDecoder::TrackStats& t = stats.tracks[i];
+            Napi::Object item = Napi::Object::New(env);
+            item.Set("stream", Napi::Number::New(env, t.stream));
+            item.Set("ring", Napi::String::New(env, t.ring_name));
+            item.Set("hwAccel", Napi::Boolean::New(env, t.hw_accel));
+            item.Set("finished", Napi::Boolean::New(env, t.finished));
+            item.Set("packets", Napi::Number::New(env, (double)t.packets));
+            item.Set("frames", Napi::Number::New(env, (double)t.frames));
+            item.Set("dropped", Napi::Number::New(env, (double)t.dropped));
+            item.Set("lateDropped", Napi::Number::New(env, (double)t.late_dropped));
+            item.Set("scaled", Napi::Number::New(env, (double)t.scaled));
+            item.Set("resolutionChanges", Napi::Number::New(env, (double)t.resolution_changes));
+            item.Set("width", Napi::Number::New(env, t.width));
+            item.Set("height", Napi::Number::New(env, t.height));
+            item.Set("queued", Napi::Number::New(env, (double)t.queued));
+            item.Set("avgDecodeMs", Napi::Number::New(env, t.avg_decode_ms));
+            item.Set("lastPts", Napi::Number::New(env, t.last_pts));
+            tracks.Set((uint32_t)i, item);
+        }
+        result.Set("tracks", tracks);
+        return result;
+    }
+
+    Napi::Value Close(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        decoder_.close();
+        return env.Undefined();
+    }
+};
@@ -0,0 +1,683 @@
+/**
+ * OSD 叠加（烧录时间码、摄像机名称、帧序号等）
+ * 直接在 NV12 / I420 平面上做 alpha 混合，录像和快照中也带有叠加内容（渲染进程叠加做不到）：
+ * - 字形来自调用者预先栅格化的 alpha 图集，加载时把每个字形复制成紧凑的亮度 alpha 块，
+ *   并预先算好 2x2 降采样的色度 alpha 块，逐帧只做混合
+ * - 混合: dst = (dst * (256 - a) + c * a) >> 8，SSE2 每次 16 个像素
+ * - 文本支持 {time} {pts} {timecode} {frame} 占位符，每帧展开
+ * 一行 40 个字符的时间码 + 背景框在 4K 帧上约几微秒，耗时与分辨率无关
+ */
+#pragma once
+
+#include <napi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 待叠加的一帧，NV12 时 v 为空
+struct OsdFrame {
+    uint8_t* y = nullptr;
+    uint8_t* u = nullptr;
+    uint8_t* v = nullptr;
+    int y_stride = 0;
+    int uv_stride = 0;
+    int width = 0;
+    int height = 0;
+
+    static OsdFrame nv12(uint8_t* data, int width, int height, int stride) {
+        OsdFrame f;
+        f.y = data;
+        f.u = data + (size_t)stride * height;
+        f.y_stride = stride;
+        f.uv_stride = stride;
+        f.width = width;
+        f.height = height;
+        return f;
+    }
+
+    static OsdFrame i420(uint8_t* data, int width, int height, int stride) {
+        OsdFrame f;
+        int chroma_stride = (stride + 1) / 2;
+        f.y = data;
+        f.u = data + (size_t)stride * height;
+        f.v = f.u + (size_t)chroma_stride * ((height + 1) / 2);
+        f.y_stride = stride;
+        f.uv_stride = chroma_stride;
+        f.width = width;
+        f.height = height;
+        return f;
+    }
+};
+
+class OsdOverlay {
+public:
+    struct Color {
+        uint8_t y = 235;
+        uint8_t u = 128;
+        uint8_t v = 128;
+        int opacity = 256;   // 0-256
+
+        // BT.601 有限范围
+        static Color fromRgb(int r, int g, int b, double opacity) {
+            Color c;
+            c.y = (uint8_t)std::clamp((int)std::lround(16 + 0.257 * r + 0.504 * g + 0.098 * b), 16, 235);
+            c.u = (uint8_t)std::clamp((int)std::lround(128 - 0.148 * r - 0.291 * g + 0.439 * b), 16, 240);
+            c.v = (uint8_t)std::clamp((int)std::lround(128 + 0.439 * r - 0.368 * g - 0.071 * b), 16, 240);
+            c.opacity = (int)std::lround(std::clamp(opacity, 0.0, 1.0) * 256);
+            return c;
+        }
+    };
+
+    // 图集中的一个字形
+    struct GlyphSpec {
+        uint32_t code = 0;
+        int x = 0, y = 0, w = 0, h = 0;   // 在图集中的位置
+        int advance = 0;                  // 0 表示 w
+        int offset_x = 0, offset_y = 0;   // 相对笔位置和行顶的偏移
+    };
+
+    struct TextItem {
+        std::string text;                 // 可含 {time} {pts} {timecode} {frame}
+        int x = 16, y = 16;
+        Color color;
+        bool background = true;
+        Color background_color = Color::fromRgb(0, 0, 0, 0.5);
+        int padding = 4;
+    };
+
+    struct BoxItem {
+        int x = 0, y = 0, w = 0, h = 0;
+        Color color;
+        int thickness = 0;                // 0 为实心，否则为边框宽度
+    };
+
+    // 逐帧变量
+    struct Context {
+        double pts = 0;
+        int64_t frame_index = 0;
+        double fps = 0;
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        double avg_us = 0;
+        double max_us = 0;
+        bool has_atlas = false;
+        int glyphs = 0;
+    };
+
+    bool setAtlas(const uint8_t* alpha, int width, int height, const std::vector<GlyphSpec>& specs,
+                  int line_height, std::string& error) {
+        if (!alpha || width <= 0 || height <= 0) {
+            error = "Invalid atlas image";
+            return false;
+        }
+        std::vector<Glyph> glyphs;
+        glyphs.reserve(specs.size());
+        int max_h = 0;
+        for (const GlyphSpec& spec : specs) {
+            if (spec.x < 0 || spec.y < 0 || spec.w < 0 || spec.h < 0 ||
+                spec.x + spec.w > width || spec.y + spec.h > height) {
+                error = "Glyph outside atlas: " + std::to_string(spec.code);
+                return false;
+            }
+            glyphs.push_back(buildGlyph(alpha, width, spec));
+            max_h = std::max(max_h, spec.offset_y + spec.h);
+        }
+        std::sort(glyphs.begin(), glyphs.end(), [](const Glyph& a, const Glyph& b) { return a.code < b.code; });
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        glyphs_.swap(glyphs);
+        line_height_ = line_height > 0 ? line_height : max_h;
+        return true;
+    }
+
+    void setItems(std::vector<TextItem> texts, std::vector<BoxItem> boxes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        texts_.swap(texts);
+        boxes_.swap(boxes);
+    }
+
+    void setEnabled(bool enabled) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enabled_ = enabled;
+    }
+
+    // 在解码或发布线程中调用
+    void render(const OsdFrame& frame, const Context& ctx) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!enabled_ || (texts_.empty() && boxes_.empty())) return;
+        auto t0 = std::chrono::steady_clock::now();
+
+        for (const BoxItem& box : boxes_) {
+            if (box.thickness <= 0) {
+                fillRect(frame, box.x, box.y, box.w, box.h, box.color);
+            } else {
+                int t = box.thickness;
+                fillRect(frame, box.x, box.y, box.w, t, box.color);
+                fillRect(frame, box.x, box.y + box.h - t, box.w, t, box.color);
+                fillRect(frame, box.x, box.y + t, t, box.h - 2 * t, box.color);
+                fillRect(frame, box.x + box.w - t, box.y + t, t, box.h - 2 * t, box.color);
+            }
+        }
+        if (!glyphs_.empty()) {
+            for (const TextItem& item : texts_) {
+                expand(item.text, ctx, text_buffer_);
+                drawText(frame, item, text_buffer_);
+            }
+        }
+
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        frames_++;
+        total_us_ += us;
+        max_us_ = std::max(max_us_, us);
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats s;
+        s.frames = frames_;
+        s.avg_us = frames_ > 0 ? total_us_ / frames_ : 0;
+        s.max_us = max_us_;
+        s.has_atlas = !glyphs_.empty();
+        s.glyphs = (int)glyphs_.size();
+        return s;
+    }
+
+private:
+    struct Glyph {
+        uint32_t code = 0;
+        int w = 0, h = 0, cw = 0, ch = 0;
+        int advance = 0;
+        int offset_x = 0, offset_y = 0;
+        std::vector<uint8_t> luma;        // w x h
+        std::vector<uint8_t> chroma;      // cw x ch，2x2 平均
+        std::vector<uint8_t> chroma2;     // 2cw x ch，每个值重复两次，用于 NV12 交错的 UV
+    };
+
+    mutable std::mutex mutex_;
+    bool enabled_ = true;
+    std::vector<Glyph> glyphs_;
+    int line_height_ = 0;
+    std::vector<TextItem> texts_;
+    std::vector<BoxItem> boxes_;
+    std::string text_buffer_;
+    uint64_t frames_ = 0;
+    double total_us_ = 0;
+    double max_us_ = 0;
+
+    static Glyph buildGlyph(const uint8_t* atlas, int atlas_width, const GlyphSpec& spec) {
+        Glyph g;
+        g.code = spec.code;
+        g.w = spec.w;
+        g.h = spec.h;
+        // 笔位置、偏移保持偶数，色度块与亮度块对齐
+        g.advance = ((spec.advance > 0 ? spec.advance : spec.w) + 1) & ~1;
+        g.offset_x = spec.offset_x & ~1;
+        g.offset_y = spec.offset_y & ~1;
+        g.cw = (g.w + 1) / 2;
+        g.ch = (g.h + 1) / 2;
+        g.luma.resize((size_t)g.w * g.h);
+        for (int y = 0; y < g.h; y++) {
+            memcpy(&g.luma[(size_t)y * g.w], atlas + (size_t)(spec.y + y) * atlas_width + spec.x, g.w);
+        }
+        g.chroma.resize((size_t)g.cw * g.ch);
+        g.chroma2.resize((size_t)g.cw * 2 * g.ch);
+        for (int y = 0; y < g.ch; y++) {
+            for (int x = 0; x < g.cw; x++) {
+                int sum = 0, n = 0;
+                for (int dy = 0; dy < 2; dy++) {
+                    for (int dx = 0; dx < 2; dx++) {
+                        int sx = x * 2 + dx, sy = y * 2 + dy;
+                        if (sx < g.w && sy < g.h) {
+                            sum += g.luma[(size_t)sy * g.w + sx];
+                            n++;
+                        }
+                    }
+                }
+                uint8_t a = (uint8_t)(n > 0 ? (sum + n / 2) / n : 0);
+                g.chroma[(size_t)y * g.cw + x] = a;
+                g.chroma2[(size_t)y * g.cw * 2 + x * 2] = a;
+                g.chroma2[(size_t)y * g.cw * 2 + x * 2 + 1] = a;
+            }
+        }
+        return g;
+    }
+
+    const Glyph* findGlyph(uint32_t code) const {
+        auto it = std::lower_bound(glyphs_.begin(), glyphs_.end(), code,
+                                   [](const Glyph& g, uint32_t c) { return g.code < c; });
+        return it != glyphs_.end() && it->code == code ? &*it : nullptr;
+    }
+
+    // ---- 混合内核 ----
+
+    // alpha 为空时使用常量 alpha（opacity）；c0/c1 交替用于 NV12 的 UV，平面时两者相同
+    // n 个字节，dst 起点在交错数据中须为偶数偏移
+    static void blendRow(uint8_t* dst, const uint8_t* alpha, int n, uint8_t c0, uint8_t c1, int opacity) {
+        int i = 0;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i color = _mm_set_epi16(c1, c0, c1, c0, c1, c0, c1, c0);
+        const __m128i full = _mm_set1_epi16(256);
+        const __m128i op = _mm_set1_epi16((short)opacity);
+        for (; i + 16 <= n; i += 16) {
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            __m128i d_lo = _mm_unpacklo_epi8(d, zero);
+            __m128i d_hi = _mm_unpackhi_epi8(d, zero);
+            __m128i a_lo, a_hi;
+            if (alpha) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(alpha + i));
+                a_lo = _mm_unpacklo_epi8(a, zero);
+                a_hi = _mm_unpackhi_epi8(a, zero);
+                // 0-255 映射到 0-256，再乘不透明度
+                a_lo = _mm_add_epi16(a_lo, _mm_srli_epi16(a_lo, 7));
+                a_hi = _mm_add_epi16(a_hi, _mm_srli_epi16(a_hi, 7));
+                if (opacity < 256) {
+                    a_lo = _mm_srli_epi16(_mm_mullo_epi16(a_lo, op), 8);
+                    a_hi = _mm_srli_epi16(_mm_mullo_epi16(a_hi, op), 8);
+                }
+            } else {
+                a_lo = a_hi = op;
+            }
+            __m128i r_lo = _mm_add_epi16(_mm_mullo_epi16(d_lo, _mm_sub_epi16(full, a_lo)), _mm_mullo_epi16(color, a_lo));
+            __m128i r_hi = _mm_add_epi16(_mm_mullo_epi16(d_hi, _mm_sub_epi16(full, a_hi)), _mm_mullo_epi16(color, a_hi));
+            r_lo = _mm_srli_epi16(r_lo, 8);
+            r_hi = _mm_srli_epi16(r_hi, 8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(r_lo, r_hi));
+        }
+#endif
+        for (; i < n; i++) {
+            int a = opacity;
+            if (alpha) {
+                a = alpha[i] + (alpha[i] >> 7);
+                if (opacity < 256) a = (a * opacity) >> 8;
+            }
+            int c = (i & 1) ? c1 : c0;
+            dst[i] = (uint8_t)((dst[i] * (256 - a) + c * a) >> 8);
+        }
+    }
+
+    static void fillRect(const OsdFrame& f, int x, int y, int w, int h, const Color& color) {
+        // 裁剪并对齐到偶数，保证色度与亮度覆盖同一区域
+        int x0 = std::max(0, x) & ~1, y0 = std::max(0, y) & ~1;
+        int x1 = std::min(f.width, x + w), y1 = std::min(f.height, y + h);
+        if (x1 <= x0 || y1 <= y0 || color.opacity <= 0) return;
+
+        for (int row = y0; row < y1; row++) {
+            blendRow(f.y + (size_t)row * f.y_stride + x0, nullptr, x1 - x0, color.y, color.y, color.opacity);
+        }
+        int cx0 = x0 / 2, cx1 = (x1 + 1) / 2;
+        for (int row = y0 / 2; row < (y1 + 1) / 2; row++) {
+            if (f.v) {
+                blendRow(f.u + (size_t)row * f.uv_stride + cx0, nullptr, cx1 - cx0, color.u, color.u, color.opacity);
+                blendRow(f.v + (size_t)row * f.uv_stride + cx0, nullptr, cx1 - cx0, color.v, color.v, color.opacity);
+            } else {
+                blendRow(f.u + (size_t)row * f.uv_stride + cx0 * 2, nullptr, (cx1 - cx0) * 2, color.u, color.v, color.opacity);
+            }
+        }
+    }
+
+    static void drawGlyph(const OsdFrame& f, const Glyph& g, int x, int y, const Color& color) {
+        // x、y 为偶数；按帧边界裁剪
+        int gx0 = std::max(0, -x), gy0 = std::max(0, -y);
+        int gx1 = std::min(g.w, f.width - x), gy1 = std::min(g.h, f.height - y);
+        if (gx1 <= gx0 || gy1 <= gy0) return;
+        gx0 = (gx0 + 1) & ~1;
+        gy0 = (gy0 + 1) & ~1;
+
+        for (int row = gy0; row < gy1; row++) {
+            blendRow(f.y + (size_t)(y + row) * f.y_stride + x + gx0, &g.luma[(size_t)row * g.w + gx0],
+                     gx1 - gx0, color.y, color.y, color.opacity);
+        }
+        int cx0 = gx0 / 2, cx1 = (gx1 + 1) / 2;
+        int cy0 = gy0 / 2, cy1 = (gy1 + 1) / 2;
+        for (int row = cy0; row < cy1; row++) {
+            size_t line = (size_t)(y / 2 + row) * f.uv_stride;
+            if (f.v) {
+                const uint8_t* a = &g.chroma[(size_t)row * g.cw + cx0];
+                blendRow(f.u + line + x / 2 + cx0, a, cx1 - cx0, color.u, color.u, color.opacity);
+                blendRow(f.v + line + x / 2 + cx0, a, cx1 - cx0, color.v, color.v, color.opacity);
+            } else {
+                const uint8_t* a = &g.chroma2[(size_t)row * g.cw * 2 + cx0 * 2];
+                blendRow(f.u + line + x + cx0 * 2, a, (cx1 - cx0) * 2, color.u, color.v, color.opacity);
+            }
+        }
+    }
+
+    // UTF-8 解码为码点，非法字节按单字节处理
+    static uint32_t nextCodepoint(const std::string& s, size_t* i) {
+        unsigned char c = s[(*i)++];
+        int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+        uint32_t cp = extra == 0 ? c : (c & (0x3F >> extra));
+        for (int k = 0; k < extra && *i < s.size(); k++) {
+            cp = (cp << 6) | (s[(*i)++] & 0x3F);
+        }
+        return cp;
+    }
+
+    int measureLine(const std::string& text, size_t begin, size_t end) const {
+        int width = 0;
+        for (size_t i = begin; i < end;) {
+            const Glyph* g = findGlyph(nextCodepoint(text, &i));
+            if (g) width += g->advance;
+        }
+        return width;
+    }
+
+    void drawText(const OsdFrame& f, const TextItem& item, const std::string& text) {
+        int x = item.x & ~1;
+        int y = item.y & ~1;
+
+        if (item.background) {
+            int lines = 1, max_width = 0;
+            size_t start = 0;
+            for (size_t i = 0; i <= text.size(); i++) {
+                if (i == text.size() || text[i] == '\n') {
+                    max_width = std::max(max_width, measureLine(text, start, i));
+                    if (i < text.size()) lines++;
+                    start = i + 1;
+                }
+            }
+            fillRect(f, x - item.padding, y - item.padding, max_width + item.padding * 2,
+                     lines * line_height_ + item.padding * 2, item.background_color);
+        }
+
+        int pen_x = x, pen_y = y;
+        for (size_t i = 0; i < text.size();) {
+            uint32_t cp = nextCodepoint(text, &i);
+            if (cp == '\n') {
+                pen_x = x;
+                pen_y += (line_height_ + 1) & ~1;
+                continue;
+            }
+            const Glyph* g = findGlyph(cp);
+            if (!g) continue;
+            if (g->w > 0 && g->h > 0) drawGlyph(f, *g, pen_x + g->offset_x, pen_y + g->offset_y, item.color);
+            pen_x += g->advance;
+        }
+    }
+
+    // 展开占位符
+    static void expand(const std::string& tmpl, const Context& ctx, std::string& out) {
+        out.clear();
+        char buf[64];
+        for (size_t i = 0; i < tmpl.size();) {
+            if (tmpl[i] == '{') {
+                size_t end = tmpl.find('}', i);
+                if (end != std::string::npos) {
+                    std::string key = tmpl.substr(i + 1, end - i - 1);
+                    bool known = true;
+                    if (key == "time") {
+                        time_t now = time(nullptr);
+                        struct tm local;
+                        localtime_r(&now, &local);
+                        strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &local);
+                    } else if (key == "pts") {
+                        formatClock(ctx.pts, buf, sizeof(buf));
+                    } else if (key == "timecode") {
+                        formatTimecode(ctx.pts, ctx.fps, buf, sizeof(buf));
+                    } else if (key == "frame") {
+                        snprintf(buf, sizeof(buf), "%lld", (long long)ctx.frame_index);
+                    } else {
+                        known = false;
+                    }
+                    if (known) {
+                        out += buf;
+                        i = end + 1;
+                        continue;
+                    }
+                }
+            }
+            out += tmpl[i++];
+        }
+    }
+
+    // HH:MM:SS.mmm
+    static void formatClock(double seconds, char* buf, size_t size) {
+        int64_t ms = (int64_t)std::llround(std::max(0.0, seconds) * 1000);
+        snprintf(buf, size, "%02lld:%02lld:%02lld.%03lld", (long long)(ms / 3600000), (long long)(ms / 60000 % 60),
+                 (long long)(ms / 1000 % 60), (long long)(ms % 1000));
+    }
+
+    // HH:MM:SS:FF，帧率未知时退回 formatClock
+    static void formatTimecode(double seconds, double fps, char* buf, size_t size) {
+        if (fps <= 0) {
+            formatClock(seconds, buf, size);
+            return;
+        }
+        int rounded_fps = (int)std::lround(fps);
+        int64_t frames = (int64_t)std::floor(std::max(0.0, seconds) * fps + 1e-6);
+        int64_t total_seconds = frames / rounded_fps;
+        snprintf(buf, size, "%02lld:%02lld:%02lld:%02lld", (long long)(total_seconds / 3600),
+                 (long long)(total_seconds / 60 % 60), (long long)(total_seconds % 60),
+                 (long long)(frames % rounded_fps));
+    }
+};
+
+// ================ N-API 绑定 ================
+
+class OsdOverlayWrapper : public Napi::ObjectWrap<OsdOverlayWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "OsdOverlay", {
+            InstanceMethod("setAtlas", &OsdOverlayWrapper::SetAtlas),
+            InstanceMethod("setItems", &OsdOverlayWrapper::SetItems),
+            InstanceMethod("setEnabled", &OsdOverlayWrapper::SetEnabled),
+            InstanceMethod("renderInto", &OsdOverlayWrapper::RenderInto),
+            InstanceMethod("getStats", &OsdOverlayWrapper::GetStats),
+        });
+
+        exports.Set("OsdOverlay", func);
+        return exports;
+    }
+
+    OsdOverlayWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<OsdOverlayWrapper>(info) {
+        overlay_ = std::make_shared<OsdOverlay>();
+        info.This().As<Napi::Object>().TypeTag(&kTypeTag);
+    }
+
+    // 其他原生对象的选项中传入的叠加层，不是 OsdOverlay 时返回空
+    static std::shared_ptr<OsdOverlay> FromValue(Napi::Value value) {
+        if (!value.IsObject()) return nullptr;
+        Napi::Object obj = value.As<Napi::Object>();
+        if (!obj.CheckTypeTag(&kTypeTag)) return nullptr;
+        return Unwrap(obj)->overlay_;
+    }
+
+private:
+    static constexpr napi_type_tag kTypeTag = {0x5f0c2e9a7b3d4c18ULL, 0xa4e61b8f0d2c7395ULL};
+    std::shared_ptr<OsdOverlay> overlay_;
+
+    static int intOr(Napi::Object obj, const char* key, int fallback) {
+        Napi::Value v = obj.Get(key);
+        return v.IsNumber() ? v.As<Napi::Number>().Int32Value() : fallback;
+    }
+
+    // color: [r, g, b]，opacity: 0-1
+    static OsdOverlay::Color parseColor(Napi::Object obj, const char* color_key, const char* opacity_key,
+                                        const OsdOverlay::Color& fallback, int r, int g, int b, double opacity) {
+        Napi::Value c = obj.Get(color_key);
+        Napi::Value o = obj.Get(opacity_key);
+        if (!c.IsArray() && !o.IsNumber()) return fallback;
+        if (c.IsArray()) {
+            Napi::Array rgb = c.As<Napi::Array>();
+            r = rgb.Get((uint32_t)0).ToNumber().Int32Value();
+            g = rgb.Get((uint32_t)1).ToNumber().Int32Value();
+            b = rgb.Get((uint32_t)2).ToNumber().Int32Value();
+        }
+        if (o.IsNumber()) opacity = o.As<Napi::Number>().DoubleValue();
+        return OsdOverlay::Color::fromRgb(r, g, b, opacity);
+    }
+
+    // ({ image: Buffer (A8), width, height, glyphs: [{ code, x, y, w, h, advance?, offsetX?, offsetY? }], lineHeight? })
+    Napi::Value SetAtlas(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected atlas object").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Object atlas = info[0].As<Napi::Object>();
+        if (!atlas.Get("image").IsBuffer() || !atlas.Get("glyphs").IsArray()) {
+            Napi::TypeError::New(env, "Atlas needs image Buffer and glyphs array").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Buffer<uint8_t> image = atlas.Get("image").As<Napi::Buffer<uint8_t>>();
+        int width = intOr(atlas, "width", 0);
+        int height = intOr(atlas, "height", 0);
+        if (width <= 0 || height <= 0 || image.Length() < (size_t)width * height) {
+            Napi::Error::New(env, "Atlas image smaller than width x height").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        std::vector<OsdOverlay::GlyphSpec> specs;
+        Napi::Array glyphs = atlas.Get("glyphs").As<Napi::Array>();
+        for (uint32_t i = 0; i < glyphs.Length(); i++) {
+            if (!glyphs.Get(i).IsObject()) continue;
+            Napi::Object g = glyphs.Get(i).As<Napi::Object>();
+            OsdOverlay::GlyphSpec spec;
+            Napi::Value code = g.Get("code");
+            spec.code = code.IsString() ? firstCodepoint(code.As<Napi::String>().Utf8Value())
+                                        : (uint32_t)code.ToNumber().Uint32Value();
+            spec.x = intOr(g, "x", 0);
+            spec.y = intOr(g, "y", 0);
+            spec.w = intOr(g, "w", 0);
+            spec.h = intOr(g, "h", 0);
+            spec.advance = intOr(g, "advance", 0);
+            spec.offset_x = intOr(g, "offsetX", 0);
+            spec.offset_y = intOr(g, "offsetY", 0);
+            specs.push_back(spec);
+        }
+
+        std::string error;
+        if (!overlay_->setAtlas(image.Data(), width, height, specs, intOr(atlas, "lineHeight", 0), error)) {
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
+
+    static uint32_t firstCodepoint(const std::string& s) {
+        if (s.empty()) return 0;
+        unsigned char c = s[0];
+        int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+        uint32_t cp = extra == 0 ? c : (c & (0x3F >> extra));
+        for (int k = 1; k <= extra && k < (int)s.size(); k++) cp = (cp << 6) | (s[k] & 0x3F);
+        return cp;
+    }
+
+    // ({ texts?: [{ text, x, y, color?, opacity?, background?, backgroundColor?, backgroundOpacity?, padding? }],
+    //    boxes?: [{ x, y, w, h, color?, opacity?, thickness? }] })
+    Napi::Value SetItems(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected ({ texts?, boxes? })").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Object opts = info[0].As<Napi::Object>();
+
+        std::vector<OsdOverlay::TextItem> texts;
+        if (opts.Get("texts").IsArray()) {
+            Napi::Array arr = opts.Get("texts").As<Napi::Array>();
+            for (uint32_t i = 0; i < arr.Length(); i++) {
+                if (!arr.Get(i).IsObject()) continue;
+                Napi::Object t = arr.Get(i).As<Napi::Object>();
+                OsdOverlay::TextItem item;
+                item.text = t.Get("text").ToString().Utf8Value();
+                item.x = intOr(t, "x", item.x);
+                item.y = intOr(t, "y", item.y);
+                item.color = parseColor(t, "color", "opacity", item.color, 255, 255, 255, 1.0);
+                if (t.Get("background").IsBoolean()) item.background = t.Get("background").As<Napi::Boolean>().Value();
+                item.background_color = parseColor(t, "backgroundColor", "backgroundOpacity",
+                                                   item.background_color, 0, 0, 0, 0.5);
+                item.padding = std::max(0, intOr(t, "padding", item.padding));
+                texts.push_back(item);
+            }
+        }
+
+        std::vector<OsdOverlay::BoxItem> boxes;
+        if (opts.Get("boxes").IsArray()) {
+            Napi::Array arr = opts.Get("boxes").As<Napi::Array>();
+            for (uint32_t i = 0; i < arr.Length(); i++) {
+                if (!arr.Get(i).IsObject()) continue;
+                Napi::Object b = arr.Get(i).As<Napi::Object>();
+                OsdOverlay::BoxItem box;
+                box.x = intOr(b, "x", 0);
+                box.y = intOr(b, "y", 0);
+                box.w = intOr(b, "w", 0);
+                box.h = intOr(b, "h", 0);
+                box.color = parseColor(b, "color", "opacity", box.color, 255, 255, 255, 1.0);
+                box.thickness = std::max(0, intOr(b, "thickness", 0));
+                boxes.push_back(box);
+            }
+        }
+
+        overlay_->setItems(std::move(texts), std::move(boxes));
+        return env.Undefined();
+    }
+
+    Napi::Value SetEnabled(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        overlay_->setEnabled(info.Length() < 1 || info[0].ToBoolean().Value());
+        return env.Undefined();
+    }
+
+    // 叠加到 JS 持有的帧上: (buffer, width, height, { format?: 'nv12' | 'i420', pts?, frame?, fps? })
+    Napi::Value RenderInto(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 3 || !info[0].IsBuffer() || !info[1].IsNumber() || !info[2].IsNumber()) {
+            Napi::TypeError::New(env, "Expected (buffer, width, height, options?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+        int width = info[1].As<Napi::Number>().Int32Value();
+        int height = info[2].As<Napi::Number>().Int32Value();
+        if (width <= 0 || height <= 0 ||
+            buffer.Length() < (size_t)width * height + (size_t)((width + 1) / 2) * ((height + 1) / 2) * 2) {
+            Napi::RangeError::New(env, "Buffer smaller than one frame").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        bool i420 = false;
+        OsdOverlay::Context ctx;
+        if (info.Length() >= 4 && info[3].IsObject()) {
+            Napi::Object opts = info[3].As<Napi::Object>();
+            i420 = opts.Get("format").IsString() && opts.Get("format").As<Napi::String>().Utf8Value() == "i420";
+            if (opts.Get("pts").IsNumber()) ctx.pts = opts.Get("pts").As<Napi::Number>().DoubleValue();
+            if (opts.Get("frame").IsNumber()) ctx.frame_index = opts.Get("frame").As<Napi::Number>().Int64Value();
+            if (opts.Get("fps").IsNumber()) ctx.fps = opts.Get("fps").As<Napi::Number>().DoubleValue();
+        }
+        overlay_->render(i420 ? OsdFrame::i420(buffer.Data(), width, height, width)
+                              : OsdFrame::nv12(buffer.Data(), width, height, width), ctx);
+        return env.Undefined();
+    }
+
+    Napi::Value GetStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        OsdOverlay::Stats stats = overlay_->stats();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("frames", Napi::Number::New(env, (double)stats.frames));
+        result.Set("avgUs", Napi::Number::New(env, stats.avg_us));
+        result.Set("maxUs", Napi::Number::New(env, stats.max_us));
+        result.Set("hasAtlas", Napi::Boolean::New(env, stats.has_atlas));
+        result.Set("glyphs", Napi::Number::New(env, stats.glyphs));
+        return result;
+    }
+};
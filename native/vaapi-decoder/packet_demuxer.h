@@ -0,0 +1,656 @@
+/**
+ * 压缩数据包解复用
+ * 只解复用不解码，输出带 pts / 关键帧标志的 H.264/HEVC 数据包，按需在 Annex-B 与
+ * 长度前缀 (AVCC/HVCC) 之间转换，并提供 avcC/hvcC 解码器配置。
+ * 可将数据包发布到共享内存环，由渲染进程交给 WebCodecs VideoDecoder 解码
+ */
+#pragma once
+
+#include <napi.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#if __has_include(<libavcodec/bsf.h>)
+#include <libavcodec/bsf.h>
+#endif
+#include <libavformat/avformat.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shm_frame_ring.h"
+#include "fmp4_remuxer.h"
+
+class PacketDemuxer {
+public:
+    enum BitstreamFormat {
+        FORMAT_ANNEXB = 0,
+        FORMAT_LENGTH_PREFIXED,   // avc1/hvc1 样式，配合 description 使用
+    };
+
+    struct StreamConfig {
+        std::string codec;                 // RFC 6381 codecs 字符串
+        AVCodecID codec_id = AV_CODEC_ID_NONE;
+        BitstreamFormat format = FORMAT_LENGTH_PREFIXED;
+        int width = 0;
+        int height = 0;
+        double fps = 0;
+        double duration = 0;
+        std::vector<uint8_t> description;  // avcC/hvcC，Annex-B 输出时为空
+    };
+
+    // 数据指针在下一次 readPacket 之前有效
+    struct PacketView {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        double pts = 0;
+        double dts = 0;
+        double duration = 0;
+        bool keyframe = false;
+    };
+
+    PacketDemuxer() {
+        pkt_ = av_packet_alloc();
+    }
+
+    ~PacketDemuxer() {
+        close();
+        av_packet_free(&pkt_);
+    }
+
+    bool open(const std::string& path, BitstreamFormat format) {
+        close();
+
+        int ret = avformat_open_input(&fmt_ctx_, path.c_str(), nullptr, nullptr);
+        if (ret < 0) {
+            setError("Failed to open input: " + path, ret);
+            return false;
+        }
+        if (avformat_find_stream_info(fmt_ctx_, nullptr) < 0) {
+            last_error_ = "Failed to find stream info";
+            close();
+            return false;
+        }
+        stream_idx_ = av_find_best_stream(fmt_ctx_, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (stream_idx_ < 0) {
+            last_error_ = "No video stream found";
+            close();
+            return false;
+        }
+
+        AVStream* stream = fmt_ctx_->streams[stream_idx_];
+        AVCodecParameters* par = stream->codecpar;
+        if (par->codec_id != AV_CODEC_ID_H264 && par->codec_id != AV_CODEC_ID_HEVC) {
+            last_error_ = std::string("Unsupported codec for packet output: ") + avcodec_get_name(par->codec_id);
+            close();
+            return false;
+        }
+
+        source_annexb_ = !(par->extradata_size > 0 && par->extradata[0] == 1);
+        config_ = StreamConfig();
+        config_.codec_id = par->codec_id;
+        config_.format = format;
+        config_.width = par->width;
+        config_.height = par->height;
+        config_.fps = stream->avg_frame_rate.den > 0 ? av_q2d(stream->avg_frame_rate) : 0;
+        config_.duration = fmt_ctx_->duration != AV_NOPTS_VALUE ? (double)fmt_ctx_->duration / AV_TIME_BASE : 0;
+        start_time_ = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+        std::vector<uint8_t> length_prefixed_config;
+        if (!source_annexb_) {
+            length_prefixed_config.assign(par->extradata, par->extradata + par->extradata_size);
+        } else if (!buildCodecConfig(par, length_prefixed_config) && format == FORMAT_LENGTH_PREFIXED) {
+            close();
+            return false;
+        }
+        config_.codec = Fmp4Remuxer::codecString(par->codec_id, length_prefixed_config.data(),
+                                                 (int)length_prefixed_config.size(), par->profile, par->level);
+        if (format == FORMAT_LENGTH_PREFIXED) {
+            config_.description.swap(length_prefixed_config);
+        }
+
+        // AVCC 源输出 Annex-B 时使用 mp4toannexb（同时在关键帧前插入参数集）
+        if (format == FORMAT_ANNEXB && !source_annexb_) {
+            const char* name = par->codec_id == AV_CODEC_ID_H264 ? "h264_mp4toannexb" : "hevc_mp4toannexb";
+            const AVBitStreamFilter* filter = av_bsf_get_by_name(name);
+            bool ok = filter && av_bsf_alloc(filter, &bsf_) >= 0 &&
+                      avcodec_parameters_copy(bsf_->par_in, par) >= 0;
+            if (ok) {
+                bsf_->time_base_in = stream->time_base;
+                ok = av_bsf_init(bsf_) >= 0;
+            }
+            if (!ok) {
+                last_error_ = std::string("Failed to init bitstream filter ") + name;
+                close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 读取下一个视频数据包，文件结束返回 false
+    bool readPacket(PacketView* view) {
+        if (!fmt_ctx_) return false;
+        AVStream* stream = fmt_ctx_->streams[stream_idx_];
+
+        while (true) {
+            av_packet_unref(pkt_);
+
+            if (bsf_) {
+                int ret = av_bsf_receive_packet(bsf_, pkt_);
+                if (ret == 0) break;
+                if (ret != AVERROR(EAGAIN)) return false;
+            }
+
+            int ret = av_read_frame(fmt_ctx_, pkt_);
+            if (ret < 0) {
+                if (bsf_ && !bsf_flushed_) {
+                    av_bsf_send_packet(bsf_, nullptr);
+                    bsf_flushed_ = true;
+                    continue;
+                }
+                return false;
+            }
+            if (pkt_->stream_index != stream_idx_) continue;
+
+            if (!bsf_) break;
+            if (av_bsf_send_packet(bsf_, pkt_) < 0) {
+                av_packet_unref(pkt_);
+            }
+        }
+
+        double tb = av_q2d(stream->time_base);
+        view->pts = pkt_->pts != AV_NOPTS_VALUE ? (pkt_->pts - start_time_) * tb : last_pts_;
+        view->dts = pkt_->dts != AV_NOPTS_VALUE ? (pkt_->dts - start_time_) * tb : view->pts;
+        view->duration = pkt_->duration > 0 ? pkt_->duration * tb : (config_.fps > 0 ? 1.0 / config_.fps : 0);
+        view->keyframe = (pkt_->flags & AV_PKT_FLAG_KEY) != 0;
+        last_pts_ = view->pts;
+
+        if (config_.format == FORMAT_LENGTH_PREFIXED && source_annexb_) {
+            annexbToLengthPrefixed(pkt_->data, pkt_->size, convert_buffer_);
+            view->data = convert_buffer_.data();
+            view->size = convert_buffer_.size();
+        } else {
+            view->data = pkt_->data;
+            view->size = pkt_->size;
+        }
+        return true;
+    }
+
+    // 跳转到指定时间之前的关键帧
+    bool seek(double seconds) {
+        if (!fmt_ctx_) return false;
+        AVStream* stream = fmt_ctx_->streams[stream_idx_];
+        int64_t ts = (int64_t)(seconds / av_q2d(stream->time_base)) + start_time_;
+        int ret = av_seek_frame(fmt_ctx_, stream_idx_, ts, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            setError("Failed to seek", ret);
+            return false;
+        }
+        if (bsf_) {
+            av_bsf_flush(bsf_);
+            bsf_flushed_ = false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (bsf_) {
+            av_bsf_free(&bsf_);
+        }
+        bsf_flushed_ = false;
+        if (fmt_ctx_) {
+            avformat_close_input(&fmt_ctx_);
+        }
+        if (pkt_) av_packet_unref(pkt_);
+        stream_idx_ = -1;
+        last_pts_ = 0;
+    }
+
+    bool isOpen() const { return fmt_ctx_ != nullptr; }
+    const StreamConfig& config() const { return config_; }
+    const std::string& lastError() const { return last_error_; }
+
+    // 环中数据包的 format 取值
+    uint32_t shmFormat() const {
+        bool annexb = config_.format == FORMAT_ANNEXB;
+        if (config_.codec_id == AV_CODEC_ID_HEVC) {
+            return annexb ? SHM_PACKET_HEVC_ANNEXB : SHM_PACKET_HEVC_HVCC;
+        }
+        return annexb ? SHM_PACKET_H264_ANNEXB : SHM_PACKET_H264_AVCC;
+    }
+
+private:
+    AVFormatContext* fmt_ctx_ = nullptr;
+    AVBSFContext* bsf_ = nullptr;
+    AVPacket* pkt_ = nullptr;
+    int stream_idx_ = -1;
+    int64_t start_time_ = 0;
+    double last_pts_ = 0;
+    bool source_annexb_ = false;
+    bool bsf_flushed_ = false;
+    StreamConfig config_;
+    std::vector<uint8_t> convert_buffer_;
+    std::string last_error_;
+
+    void setError(const std::string& message, int ret) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        last_error_ = message + " - " + errbuf;
+    }
+
+    static bool isParameterSet(AVCodecID codec_id, uint8_t nal_header) {
+        if (codec_id == AV_CODEC_ID_H264) {
+            int type = nal_header & 0x1F;
+            return type == 7 || type == 8 || type == 9;      // SPS / PPS / AUD
+        }
+        int type = (nal_header >> 1) & 0x3F;
+        return type == 32 || type == 33 || type == 34 || type == 35; // VPS / SPS / PPS / AUD
+    }
+
+    // Annex-B 起始码转为 4 字节长度前缀，参数集已在 description 中，故从包内去掉
+    void annexbToLengthPrefixed(const uint8_t* data, int size, std::vector<uint8_t>& out) const {
+        out.clear();
+        int i = 0;
+        int nal_start = -1;
+        auto emit = [&](int begin, int end) {
+            // 去掉属于下一个起始码的尾部 0
+            while (end > begin && data[end - 1] == 0) end--;
+            if (end <= begin || isParameterSet(config_.codec_id, data[begin])) return;
+            uint32_t len = (uint32_t)(end - begin);
+            uint8_t prefix[4] = {(uint8_t)(len >> 24), (uint8_t)(len >> 16), (uint8_t)(len >> 8), (uint8_t)len};
+            out.insert(out.end(), prefix, prefix + 4);
+            out.insert(out.end(), data + begin, data + end);
+        };
+        while (i + 3 <= size) {
+            if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+                if (nal_start >= 0) emit(nal_start, i);
+                i += 3;
+                nal_start = i;
+            } else {
+                i++;
+            }
+        }
+        if (nal_start >= 0) emit(nal_start, size);
+    }
+
+    // Annex-B 源没有 avcC/hvcC：借助 mp4 muxer 生成 moov，再从中取出配置 box
+    bool buildCodecConfig(const AVCodecParameters* par, std::vector<uint8_t>& out) {
+        if (par->extradata_size <= 0) {
+            last_error_ = "Stream has no parameter sets, use annexb output";
+            return false;
+        }
+        AVFormatContext* oc = nullptr;
+        if (avformat_alloc_output_context2(&oc, nullptr, "mp4", nullptr) < 0 || !oc) {
+            last_error_ = "Failed to create MP4 muxer";
+            return false;
+        }
+        bool ok = false;
+        AVStream* st = avformat_new_stream(oc, nullptr);
+        if (st && avcodec_parameters_copy(st->codecpar, par) >= 0 && avio_open_dyn_buf(&oc->pb) >= 0) {
+            st->codecpar->codec_tag = par->codec_id == AV_CODEC_ID_HEVC ? MKTAG('h', 'v', 'c', '1') : 0;
+            st->time_base = AVRational{1, 90000};
+            AVDictionary* opts = nullptr;
+            av_dict_set(&opts, "movflags", "frag_custom+empty_moov", 0);
+            bool header_ok = avformat_write_header(oc, &opts) >= 0;
+            av_dict_free(&opts);
+            if (header_ok) av_write_trailer(oc);
+
+            uint8_t* buf = nullptr;
+            int size = avio_close_dyn_buf(oc->pb, &buf);
+            oc->pb = nullptr;
+            const char* box = par->codec_id == AV_CODEC_ID_HEVC ? "hvcC" : "avcC";
+            for (int i = 4; header_ok && i + 4 <= size; i++) {
+                if (memcmp(buf + i, box, 4) != 0) continue;
+                uint32_t box_size = ((uint32_t)buf[i - 4] << 24) | ((uint32_t)buf[i - 3] << 16) |
+                                    ((uint32_t)buf[i - 2] << 8) | buf[i - 1];
+                if (box_size > 8 && i - 4 + (int)box_size <= size) {
+                    out.assign(buf + i + 4, buf + i - 4 + box_size);
+                    ok = true;
+                }
+                break;
+            }
+            av_free(buf);
+        }
+        avformat_free_context(oc);
+        if (!ok) last_error_ = "Failed to build codec configuration record";
+        return ok;
+    }
+};
+
+/**
+ * 将数据包发布到共享内存环
+ * 每个关键帧前重新写入一次解码器配置，后加入或丢包的读者可从下一个关键帧恢复
+ */
+class PacketRingPublisher {
+public:
+    struct Options {
+        std::string ring_name;
+        uint32_t slot_count = 64;
+        uint32_t slot_size = 0;       // 0 表示按分辨率估算
+        bool realtime = true;         // 按时间戳节奏发布，否则尽快发布
+        double lead_sec = 0.5;        // 实时模式下领先播放时钟的时长
+        bool loop = false;
+    };
+
+    struct Stats {
+        bool running = false;
+        uint64_t packets = 0;
+        uint64_t keyframes = 0;
+        uint64_t bytes = 0;
+        uint64_t dropped = 0;         // 超过槽大小而丢弃的包
+        double bitrate_kbps = 0;
+        double elapsed_sec = 0;
+        uint64_t write_seq = 0;
+    };
+
+    ~PacketRingPublisher() { stop(); }
+
+    bool start(PacketDemuxer* demuxer, const Options& options, std::string& error) {
+        stop();
+        options_ = options;
+        const PacketDemuxer::StreamConfig& config = demuxer->config();
+        if (options_.slot_size == 0) {
+            // 压缩后的 I 帧通常远小于一帧 NV12 的一半
+            options_.slot_size = std::max<uint32_t>(512 * 1024, (uint32_t)(config.width * config.height / 2));
+        }
+        if (!ring_.create(options_.ring_name, options_.slot_count, options_.slot_size)) {
+            error = "Failed to create packet ring " + options_.ring_name;
+            return false;
+        }
+
+        demuxer_ = demuxer;
+        packets_ = 0;
+        keyframes_ = 0;
+        bytes_ = 0;
+        dropped_ = 0;
+        elapsed_ = 0;
+        start_time_ = std::chrono::steady_clock::now();
+        running_ = true;
+        thread_ = std::thread(&PacketRingPublisher::run, this);
+        return true;
+    }
+
+    void stop() {
+        running_ = false;
+        if (thread_.joinable()) thread_.join();
+        ring_.close();
+        demuxer_ = nullptr;
+    }
+
+    bool isRunning() const { return running_; }
+
+    Stats stats() const {
+        Stats s;
+        s.running = running_;
+        s.packets = packets_;
+        s.keyframes = keyframes_;
+        s.bytes = bytes_;
+        s.dropped = dropped_;
+        s.elapsed_sec = running_ ? secondsSinceStart() : elapsed_.load();
+        if (s.elapsed_sec > 0) s.bitrate_kbps = s.bytes * 8 / 1000.0 / s.elapsed_sec;
+        s.write_seq = ring_.isOpen() ? ring_.writeSeq() : 0;
+        return s;
+    }
+
+private:
+    Options options_;
+    ShmFrameRing ring_;
+    PacketDemuxer* demuxer_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> packets_{0};
+    std::atomic<uint64_t> keyframes_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<double> elapsed_{0};
+    std::chrono::steady_clock::time_point start_time_;
+
+    double secondsSinceStart() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    }
+
+    void run() {
+        const PacketDemuxer::StreamConfig& config = demuxer_->config();
+        uint32_t format = demuxer_->shmFormat();
+        PacketDemuxer::PacketView packet;
+        bool need_keyframe = true;
+        uint32_t pending_flags = SHM_FLAG_DISCONTINUITY;
+        double first_dts = -1;
+        double loop_offset = 0;
+        double last_end = 0;
+
+        while (running_) {
+            if (!demuxer_->readPacket(&packet)) {
+                if (!options_.loop || !demuxer_->seek(0)) break;
+                loop_offset = last_end;
+                continue;
+            }
+            packet.pts += loop_offset;
+            packet.dts += loop_offset;
+            last_end = std::max(last_end, packet.pts + packet.duration);
+
+            if (options_.realtime) {
+                if (first_dts < 0) first_dts = packet.dts;
+                double due = packet.dts - first_dts - options_.lead_sec;
+                while (running_ && secondsSinceStart() < due) {
+                    double wait = std::min(due - secondsSinceStart(), 0.02);
+                    std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+                }
+                if (!running_) break;
+            }
+
+            // 丢包后等到下一个关键帧再继续，避免读者解码出花屏
+            if (need_keyframe && !packet.keyframe) continue;
+            if (packet.size > options_.slot_size) {
+                dropped_++;
+                need_keyframe = true;
+                pending_flags |= SHM_FLAG_DISCONTINUITY;
+                continue;
+            }
+            need_keyframe = false;
+
+            if (packet.keyframe && !config.description.empty()) {
+                ring_.write(config.description.data(), (uint32_t)config.description.size(),
+                            config.width, config.height, format, 0, packet.pts, SHM_FLAG_CODEC_CONFIG);
+            }
+
+            uint32_t flags = pending_flags | (packet.keyframe ? SHM_FLAG_KEYFRAME : 0);
+            ring_.write(packet.data, (uint32_t)packet.size, config.width, config.height, format, 0,
+                        packet.pts, flags);
+            pending_flags = 0;
+            packets_++;
+            bytes_ += packet.size;
+            if (packet.keyframe) keyframes_++;
+        }
+
+        elapsed_ = secondsSinceStart();
+        running_ = false;
+    }
+};
+
+// ================ N-API 绑定 ================
+
+class PacketDemuxerWrapper : public Napi::ObjectWrap<PacketDemuxerWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "PacketDemuxer", {
+            InstanceMethod("open", &PacketDemuxerWrapper::Open),
+            InstanceMethod("getCodecConfig", &PacketDemuxerWrapper::GetCodecConfig),
+            InstanceMethod("readPacket", &PacketDemuxerWrapper::ReadPacket),
+            InstanceMethod("seek", &PacketDemuxerWrapper::Seek),
+            InstanceMethod("startPublishing", &PacketDemuxerWrapper::StartPublishing),
+            InstanceMethod("stopPublishing", &PacketDemuxerWrapper::StopPublishing),
+            InstanceMethod("getPublishStats", &PacketDemuxerWrapper::GetPublishStats),
+            InstanceMethod("close", &PacketDemuxerWrapper::Close),
+        });
+
+        exports.Set("PacketDemuxer", func);
+        return exports;
+    }
+
+    PacketDemuxerWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<PacketDemuxerWrapper>(info) {}
+
+    ~PacketDemuxerWrapper() {
+        publisher_.stop();
+    }
+
+private:
+    PacketDemuxer demuxer_;
+    PacketRingPublisher publisher_;
+
+    bool checkIdle(Napi::Env env) {
+        if (publisher_.isRunning()) {
+            Napi::Error::New(env, "Demuxer is publishing to a packet ring").ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+
+    // 打开输入: (path, { bitstream?: 'avcc' | 'annexb' })
+    Napi::Value Open(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected (path, options?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!checkIdle(env)) return env.Null();
+
+        PacketDemuxer::BitstreamFormat format = PacketDemuxer::FORMAT_LENGTH_PREFIXED;
+        if (info.Length() >= 2 && info[1].IsObject()) {
+            Napi::Value value = info[1].As<Napi::Object>().Get("bitstream");
+            if (value.IsString() && value.As<Napi::String>().Utf8Value() == "annexb") {
+                format = PacketDemuxer::FORMAT_ANNEXB;
+            }
+        }
+
+        if (!demuxer_.open(info[0].As<Napi::String>().Utf8Value(), format)) {
+            Napi::Error::New(env, demuxer_.lastError()).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
+
+    // 返回 { codec, codedWidth, codedHeight, bitstream, description, fps, duration }，可直接用于 VideoDecoder.configure
+    Napi::Value GetCodecConfig(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!demuxer_.isOpen()) return env.Null();
+
+        const PacketDemuxer::StreamConfig& config = demuxer_.config();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("codec", Napi::String::New(env, config.codec));
+        result.Set("codedWidth", Napi::Number::New(env, config.width));
+        result.Set("codedHeight", Napi::Number::New(env, config.height));
+        result.Set("bitstream", Napi::String::New(env,
+            config.format == PacketDemuxer::FORMAT_ANNEXB ? "annexb" : "avcc"));
+        if (!config.description.empty()) {
+            result.Set("description", Napi::Buffer<uint8_t>::Copy(env, config.description.data(),
+                                                                   config.description.size()));
+        }
+        result.Set("fps", Napi::Number::New(env, config.fps));
+        result.Set("duration", Napi::Number::New(env, config.duration));
+        return result;
+    }
+
+    // 读取下一个数据包 => { data, pts, dts, duration, keyframe } | null
+    Napi::Value ReadPacket(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!checkIdle(env)) return env.Null();
+
+        PacketDemuxer::PacketView packet;
+        if (!demuxer_.readPacket(&packet)) {
+            return env.Null();
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("data", Napi::Buffer<uint8_t>::Copy(env, packet.data, packet.size));
+        result.Set("pts", Napi::Number::New(env, packet.pts));
+        result.Set("dts", Napi::Number::New(env, packet.dts));
+        result.Set("duration", Napi::Number::New(env, packet.duration));
+        result.Set("keyframe", Napi::Boolean::New(env, packet.keyframe));
+        return result;
+    }
+
+    Napi::Value Seek(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected seconds number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!checkIdle(env)) return env.Null();
+        return Napi::Boolean::New(env, demuxer_.seek(info[0].As<Napi::Number>().DoubleValue()));
+    }
+
+    // 开始发布: (ringName, { slotCount?, slotSize?, realtime?, leadSeconds?, loop? })
+    Napi::Value StartPublishing(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected (ringName, options?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!demuxer_.isOpen()) {
+            Napi::Error::New(env, "Demuxer not opened").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!checkIdle(env)) return env.Null();
+
+        PacketRingPublisher::Options options;
+        options.ring_name = info[0].As<Napi::String>().Utf8Value();
+        if (info.Length() >= 2 && info[1].IsObject()) {
+            Napi::Object opts = info[1].As<Napi::Object>();
+            if (opts.Get("slotCount").IsNumber()) options.slot_count = opts.Get("slotCount").As<Napi::Number>().Uint32Value();
+            if (opts.Get("slotSize").IsNumber()) options.slot_size = opts.Get("slotSize").As<Napi::Number>().Uint32Value();
+            if (opts.Get("realtime").IsBoolean()) options.realtime = opts.Get("realtime").As<Napi::Boolean>().Value();
+            if (opts.Get("leadSeconds").IsNumber()) options.lead_sec = opts.Get("leadSeconds").As<Napi::Number>().DoubleValue();
+            if (opts.Get("loop").IsBoolean()) options.loop = opts.Get("loop").As<Napi::Boolean>().Value();
+        }
+        if (options.slot_count < 2) options.slot_count = 2;
+
+        std::string error;
+        if (!publisher_.start(&demuxer_, options, error)) {
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
+
+    Napi::Value StopPublishing(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        publisher_.stop();
+        return env.Undefined();
+    }
+
+    Napi::Value GetPublishStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        PacketRingPublisher::Stats stats = publisher_.stats();
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("running", Napi::Boolean::New(env, stats.running));
+        result.Set("packets", Napi::Number::New(env, (double)stats.packets));
+        result.Set("keyframes", Napi::Number::New(env, (double)stats.keyframes));
+        result.Set("bytes", Napi::Number::New(env, (double)stats.bytes));
+        result.Set("dropped", Napi::Number::New(env, (double)stats.dropped));
+        result.Set("bitrateKbps", Napi::Number::New(env, stats.bitrate_kbps));
+        result.Set("elapsed", Napi::Number::New(env, stats.elapsed_sec));
+        result.Set("writeSeq", Napi::Number::New(env, (double)stats.write_seq));
+        return result;
+    }
+
+    Napi::Value Close(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        publisher_.stop();
+        demuxer_.close();
+        return env.Undefined();
+    }
+};
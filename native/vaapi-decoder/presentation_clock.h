@@ -0,0 +1,453 @@
+/**
+ * 共享呈现时钟
+ * 多个帧源（MultiTrackDecoder 的各轨、RawVideoSource、JS 驱动的解码器）订阅同一个时钟，
+ * 用于 A/B 对比和多机位同屏：
+ * - 帧按所在的 tick（默认 1/60 秒，与显示刷新对齐）统一放行，同一 tick 内的各路帧在同一时刻发布
+ * - 早到的帧等待；迟到不超过 late_tolerance 的帧立即发布以追赶，超过则丢弃
+ * - 预滚：所有订阅者都交出第一帧（或等待超时）后才开始走时，慢启动的流不会一开始就落后
+ * - 每次发布记录各路当前显示帧的 pts，最大差值即为偏差（skew）
+ */
+#pragma once
+
+#include <napi.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class PresentationClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        double tick_interval = 1.0 / 60;   // 发布对齐的间隔（秒）
+        double late_tolerance = 2.0 / 60;  // 迟到超过该值的帧丢弃
+        double preroll_timeout = 2.0;      // 第一个订阅者就绪后最多等待其他订阅者的时间
+    };
+
+    enum Decision {
+        PRESENT = 0,
+        HOLD,       // 未到发布时间，wait_sec 后再试
+        DROP,
+    };
+
+    struct SubscriberStats {
+        int id = 0;
+        std::string name;
+        uint64_t presented = 0;
+        uint64_t dropped = 0;
+        double held_ms = 0;          // 早到帧累计等待时间
+        double last_pts = -1;
+        double offset_ms = 0;        // 最近一帧 pts 与发布时时钟的差，负值表示迟到
+    };
+
+    struct Stats {
+        bool started = false;
+        bool paused = false;
+        double media_time = 0;
+        double rate = 1;
+        double tick_interval = 0;
+        double skew_ms = 0;          // 各路当前显示帧 pts 的最大差值
+        double max_skew_ms = 0;
+        double avg_skew_ms = 0;
+        std::vector<SubscriberStats> subscribers;
+    };
+
+    explicit PresentationClock(const Config& config) : config_(config) {
+        if (config_.tick_interval <= 0) config_.tick_interval = 1.0 / 60;
+    }
+
+    int subscribe(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int id = ++next_id_;
+        Subscriber& sub = subscribers_[id];
+        sub.stats.id = id;
+        sub.stats.name = name;
+        return id;
+    }
+
+    // 结束的订阅者不再参与预滚和偏差统计
+    void unsubscribe(int id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        subscribers_.erase(id);
+        cond_.notify_all();
+    }
+
+    // 非阻塞：判断 pts 这一帧现在是否应发布。PRESENT 时记为已发布
+    Decision poll(int id, double pts, double* wait_sec) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pollLocked(id, pts, wait_sec);
+    }
+
+    // 阻塞到该帧的发布时刻，running 变为 false 时返回 DROP
+    Decision waitForPresentation(int id, double pts, const std::atomic<bool>& running) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto t0 = Clock::now();
+        while (running) {
+            double wait_sec = 0;
+            Decision decision = pollLocked(id, pts, &wait_sec);
+            if (decision != HOLD) {
+                auto it = subscribers_.find(id);
+                if (it != subscribers_.end()) {
+                    it->second.stats.held_ms += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+                }
+                return decision;
+            }
+            // 分段等待，暂停、seek 和停止都能及时响应
+            cond_.wait_for(lock, std::chrono::duration<double>(std::min(wait_sec, 0.02)));
+        }
+        return DROP;
+    }
+
+    double mediaTime() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return mediaTimeLocked(Clock::now());
+    }
+
+    void pause() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_ || paused_) return;
+        base_ = mediaTimeLocked(Clock::now());
+        paused_ = true;
+        cond_.notify_all();
+    }
+
+    void resume() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!paused_) return;
+        anchor_ = Clock::now();
+        paused_ = false;
+        cond_.notify_all();
+    }
+
+    // 跳到 t 秒：早于 t 的帧将被丢弃，生产者自行 seek 后从 t 附近继续
+    void seek(double t) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        base_ = t;
+        anchor_ = Clock::now();
+        started_ = true;
+        for (auto& item : subscribers_) item.second.stats.last_pts = -1;
+        cond_.notify_all();
+    }
+
+    void setRate(double rate) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rate <= 0) return;
+        auto now = Clock::now();
+        base_ = mediaTimeLocked(now);
+        anchor_ = now;
+        rate_ = rate;
+        cond_.notify_all();
+    }
+
+    // 回到预滚状态，下一批帧重新对齐起点
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        started_ = false;
+        paused_ = false;
+        preroll_started_ = false;
+        skew_samples_ = 0;
+        skew_sum_ = 0;
+        max_skew_ = 0;
+        for (auto& item : subscribers_) {
+            item.second.ready = false;
+            item.second.first_pts = 0;
+            item.second.stats.last_pts = -1;
+        }
+        cond_.notify_all();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats s;
+        s.started = started_;
+        s.paused = paused_;
+        s.media_time = started_ ? mediaTimeLocked(Clock::now()) : 0;
+        s.rate = rate_;
+        s.tick_interval = config_.tick_interval;
+        s.skew_ms = currentSkew() * 1000;
+        s.max_skew_ms = max_skew_ * 1000;
+        s.avg_skew_ms = skew_samples_ > 0 ? skew_sum_ / skew_samples_ * 1000 : 0;
+        for (const auto& item : subscribers_) s.subscribers.push_back(item.second.stats);
+        return s;
+    }
+
+private:
+    struct Subscriber {
+        bool ready = false;        // 已交出第一帧
+        double first_pts = 0;
+        SubscriberStats stats;
+    };
+
+    Config config_;
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::map<int, Subscriber> subscribers_;
+    int next_id_ = 0;
+
+    bool started_ = false;
+    bool paused_ = false;
+    bool preroll_started_ = false;
+    Clock::time_point preroll_begin_;
+    Clock::time_point anchor_;     // base_ 对应的墙钟时刻
+    double base_ = 0;
+    double rate_ = 1;
+
+    uint64_t skew_samples_ = 0;
+    double skew_sum_ = 0;
+    double max_skew_ = 0;
+
+    double mediaTimeLocked(Clock::time_point now) const {
+        if (!started_) return base_;
+        if (paused_) return base_;
+        return base_ + std::chrono::duration<double>(now - anchor_).count() * rate_;
+    }
+
+    // 该帧所在 tick 的起点：pts 之后（含）的第一个 tick 边界
+    double tickTime(double pts) const {
+        return std::ceil(pts / config_.tick_interval - 1e-6) * config_.tick_interval;
+    }
+
+    // 预滚结束条件：所有订阅者就绪，或第一个就绪后超时
+    void maybeStart(Clock::time_point now) {
+        bool all_ready = true;
+        double base = 0;
+        bool any = false;
+        for (const auto& item : subscribers_) {
+            if (!item.second.ready) {
+                all_ready = false;
+                continue;
+            }
+            base = any ? std::min(base, item.second.first_pts) : item.second.first_pts;
+            any = true;
+        }
+        if (!any) return;
+        if (!preroll_started_) {
+            preroll_started_ = true;
+            preroll_begin_ = now;
+        }
+        double waited = std::chrono::duration<double>(now - preroll_begin_).count();
+        if (!all_ready && waited < config_.preroll_timeout) return;
+
+        started_ = true;
+        base_ = tickTime(base);
+        anchor_ = now;
+        cond_.notify_all();
+    }
+
+    Decision pollLocked(int id, double pts, double* wait_sec) {
+        auto it = subscribers_.find(id);
+        if (it == subscribers_.end()) return DROP;
+        Subscriber& sub = it->second;
+        auto now = Clock::now();
+
+        if (!started_) {
+            if (!sub.ready) {
+                sub.ready = true;
+                sub.first_pts = pts;
+            }
+            maybeStart(now);
+            if (!started_) {
+                *wait_sec = 0.005;
+                return HOLD;
+            }
+        }
+        if (paused_) {
+            *wait_sec = 0.02;
+            return HOLD;
+        }
+
+        double media = mediaTimeLocked(now);
+        double due = tickTime(pts);
+        if (media < due) {
+            *wait_sec = (due - media) / rate_;
+            return HOLD;
+        }
+        if (media - due > config_.late_tolerance) {
+            sub.stats.dropped++;
+            return DROP;
+        }
+
+        sub.stats.presented++;
+        sub.stats.last_pts = pts;
+        sub.stats.offset_ms = (pts - media) * 1000;
+        double skew = currentSkew();
+        skew_samples_++;
+        skew_sum_ += skew;
+        max_skew_ = std::max(max_skew_, skew);
+        *wait_sec = 0;
+        return PRESENT;
+    }
+
+    double currentSkew() const {
+        double lo = 0, hi = 0;
+        bool any = false;
+        for (const auto& item : subscribers_) {
+            double pts = item.second.stats.last_pts;
+            if (pts < 0) continue;
+            lo = any ? std::min(lo, pts) : pts;
+            hi = any ? std::max(hi, pts) : pts;
+            any = true;
+        }
+        return any ? hi - lo : 0;
+    }
+};
+
+// ================ N-API 绑定 ================
+
+class PresentationClockWrapper : public Napi::ObjectWrap<PresentationClockWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "PresentationClock", {
+            InstanceMethod("subscribe", &PresentationClockWrapper::Subscribe),
+            InstanceMethod("unsubscribe", &PresentationClockWrapper::Unsubscribe),
+            InstanceMethod("schedule", &PresentationClockWrapper::Schedule),
+            InstanceMethod("pause", &PresentationClockWrapper::Pause),
+            InstanceMethod("resume", &PresentationClockWrapper::Resume),
+            InstanceMethod("seek", &PresentationClockWrapper::Seek),
+            InstanceMethod("setRate", &PresentationClockWrapper::SetRate),
+            InstanceMethod("reset", &PresentationClockWrapper::Reset),
+            InstanceMethod("getTime", &PresentationClockWrapper::GetTime),
+            InstanceMethod("getStats", &PresentationClockWrapper::GetStats),
+        });
+
+        exports.Set("PresentationClock", func);
+        return exports;
+    }
+
+    // ({ tickInterval?, lateToleranceMs?, prerollTimeoutMs? })
+    PresentationClockWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<PresentationClockWrapper>(info) {
+        PresentationClock::Config config;
+        if (info.Length() >= 1 && info[0].IsObject()) {
+            Napi::Object opts = info[0].As<Napi::Object>();
+            if (opts.Get("tickInterval").IsNumber()) config.tick_interval = opts.Get("tickInterval").As<Napi::Number>().DoubleValue();
+            config.late_tolerance = config.tick_interval * 2;
+            if (opts.Get("lateToleranceMs").IsNumber()) config.late_tolerance = opts.Get("lateToleranceMs").As<Napi::Number>().DoubleValue() / 1000;
+            if (opts.Get("prerollTimeoutMs").IsNumber()) config.preroll_timeout = opts.Get("prerollTimeoutMs").As<Napi::Number>().DoubleValue() / 1000;
+        }
+        clock_ = std::make_shared<PresentationClock>(config);
+        info.This().As<Napi::Object>().TypeTag(&kTypeTag);
+    }
+
+    // 其他原生对象的选项中传入的时钟，不是 PresentationClock 时返回空
+    static std::shared_ptr<PresentationClock> FromValue(Napi::Value value) {
+        if (!value.IsObject()) return nullptr;
+        Napi::Object obj = value.As<Napi::Object>();
+        if (!obj.CheckTypeTag(&kTypeTag)) return nullptr;
+        return Unwrap(obj)->clock_;
+    }
+
+private:
+    static constexpr napi_type_tag kTypeTag = {0x8d3a5c1e2f4b4a67ULL, 0x9e1c7b2d5a3f6e81ULL};
+    std::shared_ptr<PresentationClock> clock_;
+
+    Napi::Value Subscribe(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        std::string name = info.Length() >= 1 && info[0].IsString() ? info[0].As<Napi::String>().Utf8Value() : "js";
+        return Napi::Number::New(env, clock_->subscribe(name));
+    }
+
+    Napi::Value Unsubscribe(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (info.Length() >= 1 && info[0].IsNumber()) {
+            clock_->unsubscribe(info[0].As<Napi::Number>().Int32Value());
+        }
+        return env.Undefined();
+    }
+
+    // JS 驱动的帧源: (id, pts) => { action: 'present' | 'hold' | 'drop', waitMs }
+    Napi::Value Schedule(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+            Napi::TypeError::New(env, "Expected (subscriberId, pts)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        double wait_sec = 0;
+        PresentationClock::Decision decision = clock_->poll(info[0].As<Napi::Number>().Int32Value(),
+                                                            info[1].As<Napi::Number>().DoubleValue(), &wait_sec);
+        Napi::Object result = Napi::Object::New(env);
+        const char* action = decision == PresentationClock::PRESENT ? "present"
+                           : decision == PresentationClock::HOLD ? "hold" : "drop";
+        result.Set("action", Napi::String::New(env, action));
+        result.Set("waitMs", Napi::Number::New(env, wait_sec * 1000));
+        return result;
+    }
+
+    Napi::Value Pause(const Napi::CallbackInfo& info) {
+        clock_->pause();
+        return info.Env().Undefined();
+    }
+
+    Napi::Value Resume(const Napi::CallbackInfo& info) {
+        clock_->resume();
+        return info.Env().Undefined();
+    }
+
+    Napi::Value Seek(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected seconds number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        clock_->seek(info[0].As<Napi::Number>().DoubleValue());
+        return env.Undefined();
+    }
+
+    Napi::Value SetRate(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected rate number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        clock_->setRate(info[0].As<Napi::Number>().DoubleValue());
+        return env.Undefined();
+    }
+
+    Napi::Value Reset(const Napi::CallbackInfo& info) {
+        clock_->reset();
+        return info.Env().Undefined();
+    }
+
+    Napi::Value GetTime(const Napi::CallbackInfo& info) {
+        return Napi::Number::New(info.Env(), clock_->mediaTime());
+    }
+
+    Napi::Value GetStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        PresentationClock::Stats stats = clock_->stats();
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("started", Napi::Boolean::New(env, stats.started));
+        result.Set("paused", Napi::Boolean::New(env, stats.paused));
+        result.Set("mediaTime", Napi::Number::New(env, stats.media_time));
+        result.Set("rate", Napi::Number::New(env, stats.rate));
+        result.Set("tickInterval", Napi::Number::New(env, stats.tick_interval));
+        result.Set("skewMs", Napi::Number::New(env, stats.skew_ms));
+        result.Set("maxSkewMs", Napi::Number::New(env, stats.max_skew_ms));
+        result.Set("avgSkewMs", Napi::Number::New(env, stats.avg_skew_ms));
+
+        Napi::Array subscribers = Napi::Array::New(env, stats.subscribers.size());
+        for (size_t i = 0; i < stats.subscribers.size(); i++) {
+            const PresentationClock::SubscriberStats& sub = stats.subscribers[i];
+            Napi::Object item = Napi::Object::New(env);
+            item.Set("id", Napi::Number::New(env, sub.id));
+            item.Set("name", Napi::String::New(env, sub.name));
+            item.Set("presented", Napi::Number::New(env, (double)sub.presented));
+            item.Set("dropped", Napi::Number::New(env, (double)sub.dropped));
+            item.Set("heldMs", Napi::Number::New(env, sub.held_ms));
+            item.Set("lastPts", Napi::Number::New(env, sub.last_pts));
+            item.Set("offsetMs", Napi::Number::New(env, sub.offset_ms));
+            subscribers.Set((uint32_t)i, item);
+        }
+        result.Set("subscribers", subscribers);
+        return result;
+    }
+};
@@ -0,0 +1,424 @@
+/**
+ * 代理文件转码
+ * 在低优先级后台线程中解码原片、缩小分辨率，并用 x264 编码为关键帧密集的低分辨率 MP4
+ */
+#pragma once
+
+#include <napi.h>
+
+#include "vaapi_decoder.h"
+#include "x26x_encoder.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 转码进度
+struct ProxyProgress {
+    double progress = 0;      // 0-1
+    int64_t frames = 0;
+    double fps = 0;
+    double eta_sec = 0;
+    bool done = false;
+    bool cancelled = false;
+    std::string error;
+};
+
+class ProxyTranscoder {
+public:
+    struct Options {
+        std::string input_path;
+        std::string output_path;   // MP4
+        int height = 540;          // 代理高度，宽度按比例
+        int keyint = 10;           // 关键帧间隔，越小拖动越流畅
+        int bitrate_kbps = 2000;
+        int threads = 2;
+        int nice = 19;             // 后台线程的 nice 值
+    };
+
+    using ProgressCallback = std::function<void(const ProxyProgress&)>;
+
+    ProxyTranscoder() = default;
+    ~ProxyTranscoder() { cancel(); }
+
+    bool start(const Options& options, ProgressCallback callback, std::string& error) {
+        if (running_) {
+            error = "Transcode already running";
+            return false;
+        }
+        if (worker_.joinable()) worker_.join();
+
+        options_ = options;
+        callback_ = std::move(callback);
+        cancel_requested_ = false;
+        running_ = true;
+        worker_ = std::thread(&ProxyTranscoder::run, this);
+        return true;
+    }
+
+    void cancel() {
+        cancel_requested_ = true;
+        if (worker_.joinable()) worker_.join();
+    }
+
+    bool isRunning() const { return running_; }
+
+private:
+    // 将 Annex-B H.264 包写入 MP4
+    class Mp4Writer {
+    public:
+        ~Mp4Writer() { close(false); }
+
+        bool open(const std::string& path, int width, int height, AVRational frame_rate,
+                  const std::vector<uint8_t>& extradata, std::string& error) {
+            if (avformat_alloc_output_context2(&oc_, nullptr, "mp4", path.c_str()) < 0 || !oc_) {
+                error = "Failed to create MP4 muxer";
+                return false;
+            }
+            stream_ = avformat_new_stream(oc_, nullptr);
+            if (!stream_) {
+                error = "Failed to create output stream";
+                return false;
+            }
+            AVCodecParameters* par = stream_->codecpar;
+            par->codec_type = AVMEDIA_TYPE_VIDEO;
+            par->codec_id = AV_CODEC_ID_H264;
+            par->width = width;
+            par->height = height;
+            par->extradata = static_cast<uint8_t*>(av_mallocz(extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+            memcpy(par->extradata, extradata.data(), extradata.size());
+            par->extradata_size = (int)extradata.size();
+            stream_->time_base = kTimeBase;
+            stream_->avg_frame_rate = frame_rate;
+
+            if (avio_open(&oc_->pb, path.c_str(), AVIO_FLAG_WRITE) < 0) {
+                error = "Failed to open output file: " + path;
+                return false;
+            }
+            if (avformat_write_header(oc_, nullptr) < 0) {
+                error = "Failed to write MP4 header";
+                return false;
+            }
+            header_written_ = true;
+            pkt_ = av_packet_alloc();
+            return pkt_ != nullptr;
+        }
+
+        bool write(const std::vector<uint8_t>& data, const X26xEncoder::PacketInfo& info) {
+            if (av_new_packet(pkt_, (int)data.size()) < 0) return false;
+            memcpy(pkt_->data, data.data(), data.size());
+            pkt_->pts = info.pts;
+            pkt_->dts = info.dts;
+            pkt_->stream_index = stream_->index;
+            if (info.keyframe) pkt_->flags |= AV_PKT_FLAG_KEY;
+            av_packet_rescale_ts(pkt_, kTimeBase, stream_->time_base);
+            int ret = av_interleaved_write_frame(oc_, pkt_);
+            av_packet_unref(pkt_);
+            return ret >= 0;
+        }
+
+        void close(bool finish) {
+            if (oc_) {
+                if (header_written_ && finish) av_write_trailer(oc_);
+                if (oc_->pb) avio_closep(&oc_->pb);
+                avformat_free_context(oc_);
+                oc_ = nullptr;
+            }
+            if (pkt_) av_packet_free(&pkt_);
+            header_written_ = false;
+        }
+
+        static constexpr AVRational kTimeBase = {1, 90000};
+
+    private:
+        AVFormatContext* oc_ = nullptr;
+        AVStream* stream_ = nullptr;
+        AVPacket* pkt_ = nullptr;
+        bool header_written_ = false;
+    };
+
+    Options options_;
+    ProgressCallback callback_;
+    std::thread worker_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> cancel_requested_{false};
+
+    void report(const ProxyProgress& progress) {
+        if (callback_) callback_(progress);
+    }
+
+    void finish(ProxyProgress progress, const std::string& error) {
+        progress.done = true;
+        progress.error = error;
+        progress.cancelled = cancel_requested_;
+        running_ = false;
+        report(progress);
+    }
+
+    void run() {
+        // 降低本线程优先级，编码器线程在此之后创建，会继承该 nice 值
+        setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), options_.nice);
+
+        ProxyProgress progress;
+        VaapiDecoder decoder;
+        if (!decoder.initFromFile(options_.input_path)) {
+            finish(progress, "Failed to open input: " + decoder.getLastError());
+            return;
+        }
+
+        int src_width = 0, src_height = 0, fps_num = 0, fps_den = 0;
+        std::string codec_name;
+        decoder.getVideoInfo(&src_width, &src_height, &codec_name, &fps_num, &fps_den);
+        double duration = decoder.getDuration();
+        if (fps_num <= 0 || fps_den <= 0) {
+            fps_num = 30;
+            fps_den = 1;
+        }
+
+        if (src_width < 2 || src_height < 2) {
+            finish(progress, "Invalid source size: " + std::to_string(src_width) + "x" +
+                             std::to_string(src_height));
+            return;
+        }
+
+        // 4:2:0 要求宽高为偶数，最小 2x2
+        int dst_height = std::min(std::max(options_.height, 2), src_height) & ~1;
+        int dst_width = std::max(2, (int)((int64_t)src_width * dst_height / src_height) & ~1);
+
+        X26xEncoder encoder;
+        X26xEncoder::Config config;
+        config.codec = "h264";
+        config.latency = "realtime";
+        config.width = dst_width;
+        config.height = dst_height;
+        config.fps_num = fps_num;
+        config.fps_den = fps_den;
+        config.bitrate_kbps = options_.bitrate_kbps;
+        config.keyint = options_.keyint;
+        // 代理转码在后台进行，线程数不超过容器配额
+        config.threads = std::max(1, std::min(options_.threads, ResourceLimits::get().encode_threads));
+        config.low_priority = true;
+        config.repeat_headers = false;
+
+        std::string error;
+        std::vector<uint8_t> extradata;
+        Mp4Writer writer;
+        if (!encoder.open(config, error) || !encoder.headers(extradata) ||
+            !writer.open(options_.output_path, dst_width, dst_height, AVRational{fps_num, fps_den},
+                         extradata, error)) {
+            finish(progress, error.empty() ? "Failed to initialize proxy encoder" : error);
+            return;
+        }
+
+        std::vector<uint8_t> scaled((size_t)dst_width * dst_height * 3 / 2);
+        std::vector<uint8_t> bitstream;
+        SwsContext* sws = nullptr;
+        int sws_src_w = 0, sws_src_h = 0;
+        auto start_time = std::chrono::steady_clock::now();
+        auto last_report = start_time;
+        X26xEncoder::PacketInfo info;
+
+        uint8_t* data = nullptr;
+        int width = 0, height = 0;
+        size_t size = 0;
+        while (!cancel_requested_ && decoder.decodeFrame(&data, &width, &height, &size)) {
+            // 分辨率变化时重建缩放上下文
+            if (!sws || width != sws_src_w || height != sws_src_h) {
+                if (sws) sws_freeContext(sws);
+                sws = sws_getContext(width, height, AV_PIX_FMT_NV12, dst_width, dst_height,
+                                     AV_PIX_FMT_NV12, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+                sws_src_w = width;
+                sws_src_h = height;
+                if (!sws) {
+                    error = "Failed to create scaler";
+                    break;
+                }
+            }
+
+            const uint8_t* src_data[4] = { data, data + (size_t)width * height, nullptr, nullptr };
+            int src_linesize[4] = { width, width, 0, 0 };
+            uint8_t* dst_data[4] = { scaled.data(), scaled.data() + (size_t)dst_width * dst_height, nullptr, nullptr };
+            int dst_linesize[4] = { dst_width, dst_width, 0, 0 };
+            sws_scale(sws, src_data, src_linesize, 0, height, dst_data, dst_linesize);
+
+            // 沿用原片时间戳，代理与原片可以按同一时间点切换
+            int64_t pts = (int64_t)(decoder.getCurrentPts() * Mp4Writer::kTimeBase.den + 0.5);
+            bitstream.clear();
+            if (!encoder.encode(scaled.data(), dst_width, pts, bitstream, &info)) {
+                error = "Encode failed";
+                break;
+            }
+            if (!bitstream.empty() && !writer.write(bitstream, info)) {
+                error = "Failed to write proxy packet";
+                break;
+            }
+
+            progress.frames++;
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_report >= std::chrono::milliseconds(250)) {
+                last_report = now;
+                double elapsed = std::chrono::duration<double>(now - start_time).count();
+                progress.fps = elapsed > 0 ? progress.frames / elapsed : 0;
+                progress.progress = duration > 0 ? std::min(1.0, decoder.getCurrentPts() / duration) : 0;
+                progress.eta_sec = progress.progress > 0 ? elapsed * (1 - progress.progress) / progress.progress : 0;
+                report(progress);
+            }
+        }
+        if (sws) sws_freeContext(sws);
+
+        // 输出编码器缓存的帧
+        while (error.empty()) {
+            bitstream.clear();
+            if (!encoder.flushOne(bitstream, &info)) {
+                error = "Encode failed";
+                break;
+            }
+            if (bitstream.empty()) break;
+            if (!writer.write(bitstream, info)) {
+                error = "Failed to write proxy packet";
+            }
+        }
+        writer.close(error.empty() && !cancel_requested_);
+        encoder.close();
+
+        if (error.empty() && !cancel_requested_) {
+            progress.progress = 1;
+        }
+        finish(progress, error);
+    }
+};
+
+// ================ N-API 绑定 ================
+
+class ProxyTranscoderWrapper : public Napi::ObjectWrap<ProxyTranscoderWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "ProxyTranscoder", {
+            InstanceMethod("start", &ProxyTranscoderWrapper::Start),
+            InstanceMethod("cancel", &ProxyTranscoderWrapper::Cancel),
+            InstanceMethod("isRunning", &ProxyTranscoderWrapper::IsRunning),
+        });
+
+        exports.Set("ProxyTranscoder", func);
+        return exports;
+    }
+
+    ProxyTranscoderWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<ProxyTranscoderWrapper>(info) {
+        transcoder_ = std::make_unique<ProxyTranscoder>();
+    }
+
+    ~ProxyTranscoderWrapper() {
+        transcoder_->cancel();
+        releaseCallback();
+    }
+
+private:
+    std::unique_ptr<ProxyTranscoder> transcoder_;
+    Napi::ThreadSafeFunction tsfn_;
+    bool has_tsfn_ = false;
+
+    void releaseCallback() {
+        if (has_tsfn_) {
+            tsfn_.Release();
+            has_tsfn_ = false;
+        }
+    }
+
+    // 开始转码: ({ input, output, height?, keyint?, bitrate?, threads? }, onProgress)
+    Napi::Value Start(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+            Napi::TypeError::New(env, "Expected (options, onProgress)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Object opts = info[0].As<Napi::Object>();
+        if (!opts.Get("input").IsString() || !opts.Get("output").IsString()) {
+            Napi::TypeError::New(env, "input and output are required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        ProxyTranscoder::Options options;
+        options.input_path = opts.Get("input").As<Napi::String>().Utf8Value();
+        options.output_path = opts.Get("output").As<Napi::String>().Utf8Value();
+        if (opts.Get("height").IsNumber()) {
+            options.height = opts.Get("height").As<Napi::Number>().Int32Value();
+        }
+        if (opts.Get("keyint").IsNumber()) {
+            options.keyint = opts.Get("keyint").As<Napi::Number>().Int32Value();
+        }
+        if (opts.Get("bitrate").IsNumber()) {
+            options.bitrate_kbps = opts.Get("bitrate").As<Napi::Number>().Int32Value();
+        }
+        if (opts.Get("threads").IsNumber()) {
+            options.threads = opts.Get("threads").As<Napi::Number>().Int32Value();
+        }
+
+        // 上一次的转码结束后才能开始新的
+        if (transcoder_->isRunning()) {
+            Napi::Error::New(env, "Transcode already running").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        transcoder_->cancel();
+        releaseCallback();
+
+        tsfn_ = Napi::ThreadSafeFunction::New(env, info[1].As<Napi::Function>(), "ProxyProgress", 0, 1);
+        tsfn_.Unref(env);
+        has_tsfn_ = true;
+
+        Napi::ThreadSafeFunction tsfn = tsfn_;
+        std::string error;
+        bool ok = transcoder_->start(options, [tsfn](const ProxyProgress& progress) mutable {
+            ProxyProgress* data = new ProxyProgress(progress);
+            napi_status status = tsfn.NonBlockingCall(data,
+                [](Napi::Env env, Napi::Function callback, ProxyProgress* data) {
+                    Napi::Object result = Napi::Object::New(env);
+                    result.Set("progress", Napi::Number::New(env, data->progress));
+                    result.Set("frames", Napi::Number::New(env, (double)data->frames));
+                    result.Set("fps", Napi::Number::New(env, data->fps));
+                    result.Set("eta", Napi::Number::New(env, data->eta_sec));
+                    result.Set("done", Napi::Boolean::New(env, data->done));
+                    result.Set("cancelled", Napi::Boolean::New(env, data->cancelled));
+                    if (!data->error.empty()) {
+                        result.Set("error", Napi::String::New(env, data->error));
+                    }
+                    delete data;
+                    callback.Call({result});
+                });
+            if (status != napi_ok) {
+                delete data;
+            }
+        }, error);
+
+        if (!ok) {
+            releaseCallback();
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
+
+    Napi::Value Cancel(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        transcoder_->cancel();
+        return env.Undefined();
+    }
+
+    Napi::Value IsRunning(const Napi::CallbackInfo& info) {
+        return Napi::Boolean::New(info.Env(), transcoder_->isRunning());
+    }
+};
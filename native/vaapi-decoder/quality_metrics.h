@@ -0,0 +1,811 @@
+/**
+ * 客观画质指标（PSNR / SSIM）
+ * 用于评估代理转码、lowres、跳过环路滤波等提速手段损失了多少画质：
+ * - QualityMetrics: 单帧比较。PSNR 按 Y/U/V 平面分别统计平方误差；SSIM 为亮度平面，
+ *   4x4 块求和后按 8x8 窗口（步长 4）计算，与 x264 的做法一致。SSE2 内核，按行条分给共享线程池
+ * - QualityAccumulator: 汇总平均值、全局 PSNR（总误差）、最差帧
+ * - QualityAnalyzer: 后台线程中两个解码器同步推进（按 pts 配对），被测一路尺寸不同时缩放到参考尺寸
+ */
+#pragma once
+
+#include <napi.h>
+
+#include "vaapi_decoder.h"
+#include "work_pool.h"
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 待比较的一帧，NV12 时 v 为空、u 为交错的 UV 平面
+struct QualityFrame {
+    const uint8_t* y = nullptr;
+    const uint8_t* u = nullptr;
+    const uint8_t* v = nullptr;
+    int y_stride = 0;
+    int uv_stride = 0;
+    int width = 0;
+    int height = 0;
+
+    static QualityFrame nv12(const uint8_t* data, int width, int height) {
+        QualityFrame f;
+        f.y = data;
+        f.u = data + (size_t)width * height;
+        f.y_stride = width;
+        f.uv_stride = (width + 1) & ~1;
+        f.width = width;
+        f.height = height;
+        return f;
+    }
+
+    static QualityFrame i420(const uint8_t* data, int width, int height) {
+        QualityFrame f;
+        f.y = data;
+        f.u = data + (size_t)width * height;
+        f.v = f.u + (size_t)((width + 1) / 2) * ((height + 1) / 2);
+        f.y_stride = width;
+        f.uv_stride = (width + 1) / 2;
+        f.width = width;
+        f.height = height;
+        return f;
+    }
+};
+
+class QualityMetrics {
+public:
+    static constexpr double kMaxPsnr = 100.0;   // 完全相同时的上限
+
+    struct FrameScore {
+        double mse_y = 0, mse_u = 0, mse_v = 0;
+        double psnr_y = 0, psnr_u = 0, psnr_v = 0;
+        double psnr = 0;          // 三个平面合计误差
+        double ssim = 0;          // 亮度
+        uint64_t sse_total = 0;
+        uint64_t samples = 0;
+    };
+
+    static double psnrFromMse(double mse) {
+        return mse > 0 ? std::min(kMaxPsnr, 10.0 * std::log10(255.0 * 255.0 / mse)) : kMaxPsnr;
+    }
+
+    // 两帧尺寸和格式须一致
+    static FrameScore compare(const QualityFrame& a, const QualityFrame& b) {
+        int w = a.width, h = a.height;
+        int cw = (w + 1) / 2, ch = (h + 1) / 2;
+        int nbx = w / 4, nby = h / 4;
+        int windows_y = std::max(0, nby - 1);
+
+        // 行条数：每条至少 64 行，不超过线程池并发
+        int stripes = std::max(1, std::min(ResourceLimits::get().work_pool_concurrency, h / 64));
+        std::vector<Partial> parts(stripes);
+        {
+            WorkGroup group;
+            for (int i = 0; i < stripes; i++) {
+                group.run(WORK_BACKGROUND, [&, i] {
+                    Partial& p = parts[i];
+                    int y0 = (int)((int64_t)h * i / stripes) & ~1;
+                    int y1 = i == stripes - 1 ? h : (int)((int64_t)h * (i + 1) / stripes) & ~1;
+                    p.sse_y = sse(a.y + (size_t)y0 * a.y_stride, a.y_stride,
+                                  b.y + (size_t)y0 * b.y_stride, b.y_stride, w, y1 - y0);
+                    int c0 = y0 / 2, c1 = i == stripes - 1 ? ch : y1 / 2;
+                    if (a.v) {
+                        p.sse_u = sse(a.u + (size_t)c0 * a.uv_stride, a.uv_stride,
+                                      b.u + (size_t)c0 * b.uv_stride, b.uv_stride, cw, c1 - c0);
+                        p.sse_v = sse(a.v + (size_t)c0 * a.uv_stride, a.uv_stride,
+                                      b.v + (size_t)c0 * b.uv_stride, b.uv_stride, cw, c1 - c0);
+                    } else {
+                        sseInterleaved(a.u + (size_t)c0 * a.uv_stride, a.uv_stride,
+                                       b.u + (size_t)c0 * b.uv_stride, b.uv_stride, cw, c1 - c0,
+                                       &p.sse_u, &p.sse_v);
+                    }
+                    int r0 = (int)((int64_t)windows_y * i / stripes);
+                    int r1 = (int)((int64_t)windows_y * (i + 1) / stripes);
+                    p.ssim_sum = ssimRows(a, b, nbx, r0, r1);
+                });
+            }
+        }
+
+        uint64_t sse_y = 0, sse_u = 0, sse_v = 0;
+        double ssim_sum = 0;
+        for (const Partial& p : parts) {
+            sse_y += p.sse_y;
+            sse_u += p.sse_u;
+            sse_v += p.sse_v;
+            ssim_sum += p.ssim_sum;
+        }
+
+        FrameScore s;
+        uint64_t luma = (uint64_t)w * h, chroma = (uint64_t)cw * ch;
+        s.mse_y = luma > 0 ? (double)sse_y / luma : 0;
+        s.mse_u = chroma > 0 ? (double)sse_u / chroma : 0;
+        s.mse_v = chroma > 0 ? (double)sse_v / chroma : 0;
+        s.psnr_y = psnrFromMse(s.mse_y);
+        s.psnr_u = psnrFromMse(s.mse_u);
+        s.psnr_v = psnrFromMse(s.mse_v);
+        s.sse_total = sse_y + sse_u + sse_v;
+        s.samples = luma + chroma * 2;
+        s.psnr = psnrFromMse(s.samples > 0 ? (double)s.sse_total / s.samples : 0);
+        int64_t windows = (int64_t)std::max(0, nbx - 1) * windows_y;
+        s.ssim = windows > 0 ? ssim_sum / windows : 1.0;
+        return s;
+    }
+
+    // 平方误差和
+    static uint64_t sse(const uint8_t* a, int a_stride, const uint8_t* b, int b_stride, int width, int height) {
+        uint64_t total = 0;
+        for (int y = 0; y < height; y++) {
+            const uint8_t* pa = a + (size_t)y * a_stride;
+            const uint8_t* pb = b + (size_t)y * b_stride;
+            int x = 0;
+#if defined(__SSE2__)
+            // 每行在 32 位中累加，单行最多约 2^15 个 16 像素块不会溢出
+            const __m128i zero = _mm_setzero_si128();
+            __m128i acc = _mm_setzero_si128();
+            for (; x + 16 <= width; x += 16) {
+                __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pa + x));
+                __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + x));
+                __m128i d_lo = _mm_sub_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero));
+                __m128i d_hi = _mm_sub_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero));
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(d_lo, d_lo));
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(d_hi, d_hi));
+            }
+            alignas(16) uint32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+            total += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+            for (; x < width; x++) {
+                int d = pa[x] - pb[x];
+                total += (uint64_t)(d * d);
+            }
+        }
+        return total;
+    }
+
+    // NV12 交错 UV 平面，分别统计 U、V
+    static void sseInterleaved(const uint8_t* a, int a_stride, const uint8_t* b, int b_stride,
+                               int chroma_width, int height, uint64_t* sse_u, uint64_t* sse_v) {
+        uint64_t total_u = 0, total_v = 0;
+        int bytes = chroma_width * 2;
+        for (int y = 0; y < height; y++) {
+            const uint8_t* pa = a + (size_t)y * a_stride;
+            const uint8_t* pb = b + (size_t)y * b_stride;
+            int x = 0;
+#if defined(__SSE2__)
+            const __m128i low = _mm_set1_epi16(0x00FF);
+            __m128i acc_u = _mm_setzero_si128();
+            __m128i acc_v = _mm_setzero_si128();
+            for (; x + 16 <= bytes; x += 16) {
+                __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pa + x));
+                __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + x));
+                __m128i du = _mm_sub_epi16(_mm_and_si128(va, low), _mm_and_si128(vb, low));
+                __m128i dv = _mm_sub_epi16(_mm_srli_epi16(va, 8), _mm_srli_epi16(vb, 8));
+                acc_u = _mm_add_epi32(acc_u, _mm_madd_epi16(du, du));
+                acc_v = _mm_add_epi32(acc_v, _mm_madd_epi16(dv, dv));
+            }
+            alignas(16) uint32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc_u);
+            total_u += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc_v);
+            total_v += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+            for (; x + 1 < bytes; x += 2) {
+                int du = pa[x] - pb[x];
+                int dv = pa[x + 1] - pb[x + 1];
+                total_u += (uint64_t)(du * du);
+                total_v += (uint64_t)(dv * dv);
+            }
+        }
+        *sse_u = total_u;
+        *sse_v = total_v;
+    }
+
+private:
+    struct Partial {
+        uint64_t sse_y = 0, sse_u = 0, sse_v = 0;
+        double ssim_sum = 0;
+    };
+
+    // 一个 4x4 块的统计量
+    struct BlockSums {
+        int32_t s1, s2, ss, s12;
+    };
+
+    // 第 by 行块（4 像素行）的块统计
+    static void blockRow(const QualityFrame& a, const QualityFrame& b, int by, int nbx, BlockSums* out) {
+        const uint8_t* pa = a.y + (size_t)by * 4 * a.y_stride;
+        const uint8_t* pb = b.y + (size_t)by * 4 * b.y_stride;
+        int bx = 0;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_set1_epi16(1);
+        for (; bx + 4 <= nbx; bx += 4) {
+            __m128i s1[2] = {zero, zero}, s2[2] = {zero, zero}, ss[2] = {zero, zero}, s12[2] = {zero, zero};
+            for (int r = 0; r < 4; r++) {
+                __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pa + (size_t)r * a.y_stride + bx * 4));
+                __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + (size_t)r * b.y_stride + bx * 4));
+                __m128i half_a[2] = {_mm_unpacklo_epi8(va, zero), _mm_unpackhi_epi8(va, zero)};
+                __m128i half_b[2] = {_mm_unpacklo_epi8(vb, zero), _mm_unpackhi_epi8(vb, zero)};
+                for (int k = 0; k < 2; k++) {
+                    s1[k] = _mm_add_epi32(s1[k], _mm_madd_epi16(half_a[k], ones));
+                    s2[k] = _mm_add_epi32(s2[k], _mm_madd_epi16(half_b[k], ones));
+                    ss[k] = _mm_add_epi32(ss[k], _mm_add_epi32(_mm_madd_epi16(half_a[k], half_a[k]),
+                                                              _mm_madd_epi16(half_b[k], half_b[k])));
+                    s12[k] = _mm_add_epi32(s12[k], _mm_madd_epi16(half_a[k], half_b[k]));
+                }
+            }
+            // 每个 32 位通道是相邻两个像素列的和，两个通道合成一个块
+            alignas(16) int32_t l1[4], l2[4], lss[4], l12[4];
+            for (int k = 0; k < 2; k++) {
+                _mm_store_si128(reinterpret_cast<__m128i*>(l1), s1[k]);
+                _mm_store_si128(reinterpret_cast<__m128i*>(l2), s2[k]);
+                _mm_store_si128(reinterpret_cast<__m128i*>(lss), ss[k]);
+                _mm_store_si128(reinterpret_cast<__m128i*>(l12), s12[k]);
+                for (int j = 0; j < 2; j++) {
+                    BlockSums& o = out[bx + k * 2 + j];
+                    o.s1 = l1[j * 2] + l1[j * 2 + 1];
+                    o.s2 = l2[j * 2] + l2[j * 2 + 1];
+                    o.ss = lss[j * 2] + lss[j * 2 + 1];
+                    o.s12 = l12[j * 2] + l12[j * 2 + 1];
+                }
+            }
+        }
+#endif
+        for (; bx < nbx; bx++) {
+            BlockSums o = {0, 0, 0, 0};
+            for (int r = 0; r < 4; r++) {
+                const uint8_t* ra = pa + (size_t)r * a.y_stride + bx * 4;
+                const uint8_t* rb = pb + (size_t)r * b.y_stride + bx * 4;
+                for (int c = 0; c < 4; c++) {
+                    int va = ra[c], vb = rb[c];
+                    o.s1 += va;
+                    o.s2 += vb;
+                    o.ss += va * va + vb * vb;
+                    o.s12 += va * vb;
+                }
+            }
+            out[bx] = o;
+        }
+    }
+
+    // 8x8 窗口（4 个块）的 SSIM
+    static float ssimWindow(int s1, int s2, int ss, int s12) {
+        static const int c1 = (int)(.01 * .01 * 255 * 255 * 64 + .5);
+        static const int c2 = (int)(.03 * .03 * 255 * 255 * 64 * 63 + .5);
+        int vars = ss * 64 - s1 * s1 - s2 * s2;
+        int covar = s12 * 64 - s1 * s2;
+        return (float)(2 * s1 * s2 + c1) * (float)(2 * covar + c2) /
+               ((float)(s1 * s1 + s2 * s2 + c1) * (float)(vars + c2));
+    }
+
+    // 窗口行 [r0, r1) 的 SSIM 之和，窗口行 r 覆盖块行 r 和 r + 1
+    static double ssimRows(const QualityFrame& a, const QualityFrame& b, int nbx, int r0, int r1) {
+        if (r1 <= r0 || nbx < 2) return 0;
+        std::vector<BlockSums> rows[2] = {std::vector<BlockSums>(nbx), std::vector<BlockSums>(nbx)};
+        blockRow(a, b, r0, nbx, rows[0].data());
+        double sum = 0;
+        for (int r = r0; r < r1; r++) {
+            const BlockSums* top = rows[(r - r0) & 1].data();
+            BlockSums* bottom = rows[(r - r0 + 1) & 1].data();
+            blockRow(a, b, r + 1, nbx, bottom);
+            for (int x = 0; x + 1 < nbx; x++) {
+                sum += ssimWindow(top[x].s1 + top[x + 1].s1 + bottom[x].s1 + bottom[x + 1].s1,
+                                  top[x].s2 + top[x + 1].s2 + bottom[x].s2 + bottom[x + 1].s2,
+                                  top[x].ss + top[x + 1].ss + bottom[x].ss + bottom[x + 1].ss,
+                                  top[x].s12 + top[x + 1].s12 + bottom[x].s12 + bottom[x + 1].s12);
+            }
+        }
+        return sum;
+    }
+};
+
+/**
+ * 多帧汇总
+ */
+class QualityAccumulator {
+public:
+    // 每帧记录的字段
+    enum Field {
+        FIELD_PTS = 0,
+        FIELD_PSNR,
+        FIELD_PSNR_Y,
+        FIELD_PSNR_U,
+        FIELD_PSNR_V,
+        FIELD_SSIM,
+        FIELD_COUNT,
+    };
+
+    struct Worst {
+        int64_t frame = -1;
+        double pts = 0;
+        double value = 0;
+    };
+
+    struct Report {
+        int64_t frames = 0;
+        double avg_psnr = 0, avg_psnr_y = 0, avg_psnr_u = 0, avg_psnr_v = 0;
+        double global_psnr = 0;   // 全部帧的总误差
+        double avg_ssim = 0;
+        Worst min_psnr;
+        Worst min_ssim;
+    };
+
+    explicit QualityAccumulator(bool keep_frames = true) : keep_frames_(keep_frames) {}
+
+    void add(const QualityMetrics::FrameScore& s, double pts) {
+        if (frames_ == 0 || s.psnr < min_psnr_.value) min_psnr_ = Worst{frames_, pts, s.psnr};
+        if (frames_ == 0 || s.ssim < min_ssim_.value) min_ssim_ = Worst{frames_, pts, s.ssim};
+        sum_psnr_ += s.psnr;
+        sum_psnr_y_ += s.psnr_y;
+        sum_psnr_u_ += s.psnr_u;
+        sum_psnr_v_ += s.psnr_v;
+        sum_ssim_ += s.ssim;
+        sse_ += s.sse_total;
+        samples_ += s.samples;
+        frames_++;
+        if (keep_frames_) {
+            per_frame_.insert(per_frame_.end(), {pts, s.psnr, s.psnr_y, s.psnr_u, s.psnr_v, s.ssim});
+        }
+    }
+
+    Report report() const {
+        Report r;
+        r.frames = frames_;
+        if (frames_ > 0) {
+            r.avg_psnr = sum_psnr_ / frames_;
+            r.avg_psnr_y = sum_psnr_y_ / frames_;
+            r.avg_psnr_u = sum_psnr_u_ / frames_;
+            r.avg_psnr_v = sum_psnr_v_ / frames_;
+            r.avg_ssim = sum_ssim_ / frames_;
+            r.global_psnr = QualityMetrics::psnrFromMse(samples_ > 0 ? (double)sse_ / samples_ : 0);
+        }
+        r.min_psnr = min_psnr_;
+        r.min_ssim = min_ssim_;
+        return r;
+    }
+
+    const std::vector<double>& perFrame() const { return per_frame_; }
+
+    void reset() { *this = QualityAccumulator(keep_frames_); }
+
+private:
+    bool keep_frames_;
+    int64_t frames_ = 0;
+    double sum_psnr_ = 0, sum_psnr_y_ = 0, sum_psnr_u_ = 0, sum_psnr_v_ = 0, sum_ssim_ = 0;
+    uint64_t sse_ = 0, samples_ = 0;
+    Worst min_psnr_, min_ssim_;
+    std::vector<double> per_frame_;
+};
+
+// 分析进度
+struct QualityProgress {
+    double progress = 0;      // 0-1
+    int64_t frames = 0;
+    int64_t unmatched = 0;    // 找不到对应帧的参考帧
+    double fps = 0;
+    bool done = false;
+    bool cancelled = false;
+    std::string error;
+    QualityAccumulator::Report report;
+    std::vector<double> per_frame;   // 仅 done 时
+};
+
+/**
+ * 两个文件同步解码并逐帧比较
+ */
+class QualityAnalyzer {
+public:
+    struct Options {
+        std::string reference_path;
+        std::string distorted_path;
+        VaapiDecoder::DecodeProfile reference_profile;
+        VaapiDecoder::DecodeProfile distorted_profile;   // 如 lowres、跳过环路滤波
+        int64_t max_frames = 0;    // 0 表示全部
+    };
+
+    using ProgressCallback = std::function<void(const QualityProgress&)>;
+
+    QualityAnalyzer() = default;
+    ~QualityAnalyzer() { cancel(); }
+
+    bool start(const Options& options, ProgressCallback callback, std::string& error) {
+        if (running_) {
+            error = "Analysis already running";
+            return false;
+        }
+        if (worker_.joinable()) worker_.join();
+
+        options_ = options;
+        callback_ = std::move(callback);
+        cancel_requested_ = false;
+        running_ = true;
+        worker_ = std::thread(&QualityAnalyzer::run, this);
+        return true;
+    }
+
+    void cancel() {
+        cancel_requested_ = true;
+        if (worker_.joinable()) worker_.join();
+    }
+
+    bool isRunning() const { return running_; }
+
+private:
+    Options options_;
+    ProgressCallback callback_;
+    std::thread worker_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> cancel_requested_{false};
+
+    void report(const QualityProgress& progress) {
+        if (callback_) callback_(progress);
+    }
+
+    void finish(QualityProgress& progress, const std::string& error) {
+        progress.done = true;
+        progress.cancelled = cancel_requested_;
+        progress.error = error;
+        running_ = false;
+        report(progress);
+    }
+
+    void run() {
+        QualityProgress progress;
+        VaapiDecoder reference, distorted;
+        reference.setDecodeProfile(options_.reference_profile);
+        distorted.setDecodeProfile(options_.distorted_profile);
+        if (!reference.initFromFile(options_.reference_path)) {
+            finish(progress, "Failed to open reference: " + reference.getLastError());
+            return;
+        }
+        if (!distorted.initFromFile(options_.distorted_path)) {
+            finish(progress, "Failed to open distorted: " + distorted.getLastError());
+            return;
+        }
+
+        int w = 0, h = 0, fps_num = 0, fps_den = 0;
+        std::string codec;
+        reference.getVideoInfo(&w, &h, &codec, &fps_num, &fps_den);
+        double duration = reference.getDuration();
+        // 两路 pts 相差不超过半帧视为同一帧
+        double tolerance = fps_num > 0 && fps_den > 0 ? 0.5 * fps_den / fps_num : 0.001;
+
+        QualityAccumulator acc;
+        std::vector<uint8_t> dist_frame;
+        SwsContext* sws = nullptr;
+        int sws_w = 0, sws_h = 0, ref_w = 0, ref_h = 0;
+        double dist_pts = 0;
+        bool have_dist = false, dist_end = false;
+        std::string error;
+        auto start_time = std::chrono::steady_clock::now();
+        auto last_report = start_time;
+
+        uint8_t* ref_data = nullptr;
+        int width = 0, height = 0;
+        size_t size = 0;
+        while (!cancel_requested_ && reference.decodeFrame(&ref_data, &width, &height, &size)) {
+            double ref_pts = reference.getCurrentPts();
+
+            // 被测一路追到参考帧的时间
+            while (!dist_end && (!have_dist || dist_pts < ref_pts - tolerance)) {
+                uint8_t* data = nullptr;
+                int dw = 0, dh = 0;
+                size_t dsize = 0;
+                if (!distorted.decodeFrame(&data, &dw, &dh, &dsize)) {
+                    dist_end = true;
+                    break;
+                }
+                dist_pts = distorted.getCurrentPts();
+                have_dist = true;
+                dist_frame.resize((size_t)width * height * 3 / 2);
+                if (dw == width && dh == height) {
+                    memcpy(dist_frame.data(), data, dist_frame.size());
+                    continue;
+                }
+                // 尺寸不同（代理、lowres）时缩放到参考尺寸
+                if (!sws || dw != sws_w || dh != sws_h || width != ref_w || height != ref_h) {
+                    if (sws) sws_freeContext(sws);
+                    sws = sws_getContext(dw, dh, AV_PIX_FMT_NV12, width, height, AV_PIX_FMT_NV12,
+                                         SWS_BICUBIC, nullptr, nullptr, nullptr);
+                    sws_w = dw;
+                    sws_h = dh;
+                    ref_w = width;
+                    ref_h = height;
+                    if (!sws) {
+                        error = "Failed to create scaler";
+                        break;
+                    }
+                }
+                const uint8_t* src_data[4] = { data, data + (size_t)dw * dh, nullptr, nullptr };
+                int src_linesize[4] = { dw, dw, 0, 0 };
+                uint8_t* dst_data[4] = { dist_frame.data(), dist_frame.data() + (size_t)width * height, nullptr, nullptr };
+                int dst_linesize[4] = { width, width, 0, 0 };
+                sws_scale(sws, src_data, src_linesize, 0, dh, dst_data, dst_linesize);
+            }
+            if (!error.empty() || (dist_end && (!have_dist || dist_pts < ref_pts - tolerance))) break;
+            if (std::fabs(dist_pts - ref_pts) > tolerance) {
+                progress.unmatched++;
+                continue;
+            }
+
+            QualityMetrics::FrameScore score = QualityMetrics::compare(
+                QualityFrame::nv12(ref_data, width, height), QualityFrame::nv12(dist_frame.data(), width, height));
+            acc.add(score, ref_pts);
+            progress.frames++;
+            if (options_.max_frames > 0 && progress.frames >= options_.max_frames) break;
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_report >= std::chrono::milliseconds(250)) {
+                last_report = now;
+                double elapsed = std::chrono::duration<double>(now - start_time).count();
+                progress.fps = elapsed > 0 ? progress.frames / elapsed : 0;
+                progress.progress = duration > 0 ? std::min(1.0, ref_pts / duration) : 0;
+                progress.report = acc.report();
+                report(progress);
+            }
+        }
+        if (sws) sws_freeContext(sws);
+
+        if (error.empty() && !cancel_requested_) progress.progress = 1;
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        progress.fps = elapsed > 0 ? progress.frames / elapsed : 0;
+        progress.report = acc.report();
+        progress.per_frame = acc.perFrame();
+        finish(progress, error);
+    }
+};
+
+// ================ N-API 绑定 ================
+
+inline VaapiDecoder::DecodeProfile parseDecodeProfile(Napi::Object obj) {
+    VaapiDecoder::DecodeProfile profile;
+    if (obj.Get("lowres").IsNumber()) profile.lowres = obj.Get("lowres").As<Napi::Number>().Int32Value();
+    if (obj.Get("skipLoopFilter").IsBoolean()) profile.skip_loop_filter = obj.Get("skipLoopFilter").As<Napi::Boolean>().Value();
+    if (obj.Get("software").IsBoolean()) profile.software = obj.Get("software").As<Napi::Boolean>().Value();
+    return profile;
+}
+
+inline Napi::Object qualityReportToJs(Napi::Env env, const QualityAccumulator::Report& r) {
+    auto worst = [&](const QualityAccumulator::Worst& w) {
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("value", Napi::Number::New(env, w.value));
+        o.Set("frame", Napi::Number::New(env, (double)w.frame));
+        o.Set("pts", Napi::Number::New(env, w.pts));
+        return o;
+    };
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("frames", Napi::Number::New(env, (double)r.frames));
+    result.Set("psnr", Napi::Number::New(env, r.avg_psnr));
+    result.Set("psnrY", Napi::Number::New(env, r.avg_psnr_y));
+    result.Set("psnrU", Napi::Number::New(env, r.avg_psnr_u));
+    result.Set("psnrV", Napi::Number::New(env, r.avg_psnr_v));
+    result.Set("globalPsnr", Napi::Number::New(env, r.global_psnr));
+    result.Set("ssim", Napi::Number::New(env, r.avg_ssim));
+    result.Set("worstPsnr", worst(r.min_psnr));
+    result.Set("worstSsim", worst(r.min_ssim));
+    return result;
+}
+
+inline Napi::Float64Array perFrameToJs(Napi::Env env, const std::vector<double>& values) {
+    Napi::Float64Array array = Napi::Float64Array::New(env, values.size());
+    if (!values.empty()) memcpy(array.Data(), values.data(), values.size() * sizeof(double));
+    return array;
+}
+
+/**
+ * 逐帧比较 JS 持有的两帧，如两个帧环同步读取的帧
+ */
+class QualityMeterWrapper : public Napi::ObjectWrap<QualityMeterWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "QualityMeter", {
+            InstanceMethod("compare", &QualityMeterWrapper::Compare),
+            InstanceMethod("getReport", &QualityMeterWrapper::GetReport),
+            InstanceMethod("reset", &QualityMeterWrapper::Reset),
+        });
+
+        exports.Set("QualityMeter", func);
+        return exports;
+    }
+
+    QualityMeterWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<QualityMeterWrapper>(info) {}
+
+private:
+    QualityAccumulator acc_;
+
+    // (reference, distorted, width, height, { format?: 'nv12' | 'i420', pts? }) => 本帧得分
+    Napi::Value Compare(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 4 || !info[0].IsBuffer() || !info[1].IsBuffer() ||
+            !info[2].IsNumber() || !info[3].IsNumber()) {
+            Napi::TypeError::New(env, "Expected (reference, distorted, width, height, options?)")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Buffer<uint8_t> a = info[0].As<Napi::Buffer<uint8_t>>();
+        Napi::Buffer<uint8_t> b = info[1].As<Napi::Buffer<uint8_t>>();
+        int width = info[2].As<Napi::Number>().Int32Value();
+        int height = info[3].As<Napi::Number>().Int32Value();
+        size_t frame_size = (size_t)width * height + (size_t)((width + 1) / 2) * ((height + 1) / 2) * 2;
+        if (width <= 0 || height <= 0 || a.Length() < frame_size || b.Length() < frame_size) {
+            Napi::RangeError::New(env, "Buffers smaller than one frame").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        bool i420 = false;
+        double pts = (double)acc_.report().frames;
+        if (info.Length() >= 5 && info[4].IsObject()) {
+            Napi::Object opts = info[4].As<Napi::Object>();
+            i420 = opts.Get("format").IsString() && opts.Get("format").As<Napi::String>().Utf8Value() == "i420";
+            if (opts.Get("pts").IsNumber()) pts = opts.Get("pts").As<Napi::Number>().DoubleValue();
+        }
+
+        QualityMetrics::FrameScore s = i420
+            ? QualityMetrics::compare(QualityFrame::i420(a.Data(), width, height), QualityFrame::i420(b.Data(), width, height))
+            : QualityMetrics::compare(QualityFrame::nv12(a.Data(), width, height), QualityFrame::nv12(b.Data(), width, height));
+        acc_.add(s, pts);
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("psnr", Napi::Number::New(env, s.psnr));
+        result.Set("psnrY", Napi::Number::New(env, s.psnr_y));
+        result.Set("psnrU", Napi::Number::New(env, s.psnr_u));
+        result.Set("psnrV", Napi::Number::New(env, s.psnr_v));
+        result.Set("ssim", Napi::Number::New(env, s.ssim));
+        return result;
+    }
+
+    // ({ perFrame?: boolean }) => 汇总，perFrame 时附带每帧 6 个字段的 Float64Array
+    Napi::Value GetReport(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        Napi::Object result = qualityReportToJs(env, acc_.report());
+        if (info.Length() >= 1 && info[0].IsObject() && info[0].As<Napi::Object>().Get("perFrame").ToBoolean().Value()) {
+            result.Set("perFrame", perFrameToJs(env, acc_.perFrame()));
+        }
+        return result;
+    }
+
+    Napi::Value Reset(const Napi::CallbackInfo& info) {
+        acc_.reset();
+        return info.Env().Undefined();
+    }
+};
+
+class QualityAnalyzerWrapper : public Napi::ObjectWrap<QualityAnalyzerWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "QualityAnalyzer", {
+            InstanceMethod("start", &QualityAnalyzerWrapper::Start),
+            InstanceMethod("cancel", &QualityAnalyzerWrapper::Cancel),
+            InstanceMethod("isRunning", &QualityAnalyzerWrapper::IsRunning),
+        });
+
+        exports.Set("QualityAnalyzer", func);
+        return exports;
+    }
+
+    QualityAnalyzerWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<QualityAnalyzerWrapper>(info) {
+        analyzer_ = std::make_unique<QualityAnalyzer>();
+    }
+
+    ~QualityAnalyzerWrapper() {
+        analyzer_->cancel();
+        releaseCallback();
+    }
+
+private:
+    std::unique_ptr<QualityAnalyzer> analyzer_;
+    Napi::ThreadSafeFunction tsfn_;
+    bool has_tsfn_ = false;
+
+    void releaseCallback() {
+        if (has_tsfn_) {
+            tsfn_.Release();
+            has_tsfn_ = false;
+        }
+    }
+
+    // 开始分析: ({ reference, distorted, referenceProfile?, distortedProfile?, maxFrames? }, onProgress)
+    Napi::Value Start(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+            Napi::TypeError::New(env, "Expected (options, onProgress)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Object opts = info[0].As<Napi::Object>();
+        if (!opts.Get("reference").IsString() || !opts.Get("distorted").IsString()) {
+            Napi::TypeError::New(env, "reference and distorted are required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        QualityAnalyzer::Options options;
+        options.reference_path = opts.Get("reference").As<Napi::String>().Utf8Value();
+        options.distorted_path = opts.Get("distorted").As<Napi::String>().Utf8Value();
+        if (opts.Get("referenceProfile").IsObject()) {
+            options.reference_profile = parseDecodeProfile(opts.Get("referenceProfile").As<Napi::Object>());
+        }
+        if (opts.Get("distortedProfile").IsObject()) {
+            options.distorted_profile = parseDecodeProfile(opts.Get("distortedProfile").As<Napi::Object>());
+        }
+        if (opts.Get("maxFrames").IsNumber()) {
+            options.max_frames = opts.Get("maxFrames").As<Napi::Number>().Int64Value();
+        }
+
+        if (analyzer_->isRunning()) {
+            Napi::Error::New(env, "Analysis already running").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        analyzer_->cancel();
+        releaseCallback();
+
+        tsfn_ = Napi::ThreadSafeFunction::New(env, info[1].As<Napi::Function>(), "QualityProgress", 0, 1);
+        tsfn_.Unref(env);
+        has_tsfn_ = true;
+
+        Napi::ThreadSafeFunction tsfn = tsfn_;
+        std::string error;
+        bool ok = analyzer_->start(options, [tsfn](const QualityProgress& progress) mutable {
+            QualityProgress* data = new QualityProgress(progress);
+            // 最终结果不能丢，中间进度可以
+            napi_status status = data->done
+                ? tsfn.BlockingCall(data, &QualityAnalyzerWrapper::deliver)
+                : tsfn.NonBlockingCall(data, &QualityAnalyzerWrapper::deliver);
+            if (status != napi_ok) {
+                delete data;
+            }
+        }, error);
+
+        if (!ok) {
+            releaseCallback();
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
+
+    static void deliver(Napi::Env env, Napi::Function callback, QualityProgress* data) {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("progress", Napi::Number::New(env, data->progress));
+        result.Set("frames", Napi::Number::New(env, (double)data->frames));
+        result.Set("unmatched", Napi::Number::New(env, (double)data->unmatched));
+        result.Set("fps", Napi::Number::New(env, data->fps));
+        result.Set("done", Napi::Boolean::New(env, data->done));
+        result.Set("cancelled", Napi::Boolean::New(env, data->cancelled));
+        result.Set("report", qualityReportToJs(env, data->report));
+        if (data->done) {
+            result.Set("perFrame", perFrameToJs(env, data->per_frame));
+        }
+        if (!data->error.empty()) {
+            result.Set("error", Napi::String::New(env, data->error));
+        }
+        delete data;
+        callback.Call({result});
+    }
+
+    Napi::Value Cancel(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        analyzer_->cancel();
+        return env.Undefined();
+    }
+
+    Napi::Value IsRunning(const Napi::CallbackInfo& info) {
+        return Napi::Boolean::New(info.Env(), analyzer_->isRunning());
+    }
+};
@@ -0,0 +1,634 @@
+/**
+ * 未压缩视频源（.yuv / .y4m）
+ * 整个文件只读映射，Y4M 解析文件头并为每帧建立偏移索引，裸 .yuv 由调用者给出尺寸和像素格式。
+ * 发布到共享内存环时有两种方式：
+ * - copy: 从映射直接复制到环的槽中，只有这一次复制
+ * - reference: 槽中只写文件引用（SHM_FLAG_FILE_REF），读者自行映射文件读取，
+ *   8K 也只需很小的环；生产者提前对即将发布的帧发出 WILLNEED，读者读取时不等磁盘
+ * 传入 PresentationClock 时由共享时钟决定发布时刻，迟到的帧丢弃。不依赖任何媒体库
+ */
+#pragma once
+
+#include <napi.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "osd_overlay.h"
+#include "presentation_clock.h"
+#include "shm_file_ref.h"
+#include "shm_frame_ring.h"
+
+class RawVideoFile {
+public:
+    struct Format {
+        int width = 0;
+        int height = 0;
+        double fps = 0;                    // 0 表示 Y4M 文件头中的帧率，裸 .yuv 默认 30
+        uint32_t pixel_format = SHM_PIXEL_I420;
+    };
+
+    struct Info {
+        bool y4m = false;
+        int width = 0;
+        int height = 0;
+        double fps = 0;
+        uint32_t pixel_format = SHM_PIXEL_I420;
+        uint32_t stride = 0;               // Y 平面（或打包格式）行跨度
+        size_t frame_size = 0;
+        int64_t frame_count = 0;
+        double duration = 0;
+    };
+
+    ~RawVideoFile() { close(); }
+
+    // format 对 .y4m 只用其中的 fps 覆盖文件头帧率
+    bool open(const std::string& path, const Format& format) {
+        close();
+        info_ = Info();
+
+        // 文件引用由其他进程按路径重新打开，相对路径和符号链接先解析成绝对路径
+        char* resolved = realpath(path.c_str(), nullptr);
+        if (!resolved) {
+            last_error_ = "Failed to open file: " + path;
+            return false;
+        }
+        path_ = resolved;
+        std::free(resolved);
+
+        int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            last_error_ = "Failed to open file: " + path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            last_error_ = "Empty or unreadable file: " + path;
+            return false;
+        }
+        void* ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED) {
+            last_error_ = "Failed to map file: " + path;
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(ptr);
+        size_ = (size_t)st.st_size;
+        madvise(const_cast<uint8_t*>(data_), size_, MADV_SEQUENTIAL);
+
+        bool ok = size_ >= 10 && memcmp(data_, "YUV4MPEG2 ", 10) == 0
+                      ? parseY4m(format)
+                      : parseRaw(format);
+        if (!ok) {
+            close();
+            return false;
+        }
+        info_.frame_count = (int64_t)offsets_.size();
+        info_.duration = info_.fps > 0 ? info_.frame_count / info_.fps : 0;
+        return true;
+    }
+
+    void close() {
+        if (data_) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+            data_ = nullptr;
+        }
+        size_ = 0;
+        offsets_.clear();
+    }
+
+    bool isOpen() const { return data_ != nullptr; }
+    const Info& info() const { return info_; }
+    const std::string& path() const { return path_; }
+    uint64_t fileSize() const { return size_; }
+    const std::string& lastError() const { return last_error_; }
+
+    uint64_t frameOffset(int64_t index) const { return offsets_[index]; }
+    const uint8_t* frameData(int64_t index) const { return data_ + offsets_[index]; }
+    double framePts(int64_t index) const { return info_.fps > 0 ? index / info_.fps : 0; }
+
+    // 提示内核预读 [first, first + count) 帧
+    void prefetch(int64_t first, int64_t count) const {
+        if (first >= info_.frame_count || count <= 0) return;
+        int64_t last = std::min(first + count, info_.frame_count) - 1;
+        uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+        uintptr_t begin = (uintptr_t)frameData(first) & ~(page - 1);
+        uintptr_t end = (uintptr_t)frameData(last) + info_.frame_size;
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+    }
+
+    static size_t frameSize(uint32_t pixel_format, int width, int height, uint32_t* stride) {
+        size_t luma = (size_t)width * height;
+        size_t chroma = (size_t)((width + 1) / 2) * ((height + 1) / 2);
+        switch (pixel_format) {
+            case SHM_PIXEL_RGBA: *stride = width * 4; return luma * 4;
+            case SHM_PIXEL_RGB24: *stride = width * 3; return luma * 3;
+            case SHM_PIXEL_NV12:
+            case SHM_PIXEL_I420: *stride = width; return luma + chroma * 2;
+            default: return 0;
+        }
+    }
+
+private:
+    std::string path_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    Info info_;
+    std::vector<uint64_t> offsets_;
+    std::string last_error_;
+
+    bool setGeometry(int width, int height, uint32_t pixel_format) {
+        if (width <= 0 || height <= 0) {
+            last_error_ = "Raw video needs width and height";
+            return false;
+        }
+        info_.width = width;
+        info_.height = height;
+        info_.pixel_format = pixel_format;
+        info_.frame_size = frameSize(pixel_format, width, height, &info_.stride);
+        if (info_.frame_size == 0 || info_.frame_size > UINT32_MAX) {
+            last_error_ = "Unsupported raw pixel format or frame too large";
+            return false;
+        }
+        return true;
+    }
+
+    bool parseRaw(const Format& format) {
+        info_.y4m = false;
+        info_.fps = format.fps > 0 ? format.fps : 30;
+        if (!setGeometry(format.width, format.height, format.pixel_format)) return false;
+
+        size_t count = size_ / info_.frame_size;
+        if (count == 0) {
+            last_error_ = "File is smaller than one frame";
+            return false;
+        }
+        offsets_.resize(count);
+        for (size_t i = 0; i < count; i++) offsets_[i] = (uint64_t)i * info_.frame_size;
+        return true;
+    }
+
+    // YUV4MPEG2 W1920 H1080 F30000:1001 Ip A1:1 C420jpeg XYSCSS=420JPEG
+    bool parseY4m(const Format& format) {
+        info_.y4m = true;
+        const uint8_t* end = static_cast<const uint8_t*>(memchr(data_, '\n', std::min<size_t>(size_, 4096)));
+        if (!end) {
+            last_error_ = "Invalid Y4M header";
+            return false;
+        }
+        std::string header(reinterpret_cast<const char*>(data_), end - data_);
+
+        int width = 0, height = 0;
+        double fps = 0;
+        std::string colorspace = "420jpeg";
+        size_t pos = 10;
+        while (pos < header.size()) {
+            size_t next = header.find(' ', pos);
+            if (next == std::string::npos) next = header.size();
+            std::string token = header.substr(pos, next - pos);
+            if (!token.empty()) {
+                const char* value = token.c_str() + 1;
+                switch (token[0]) {
+                    case 'W': width = atoi(value); break;
+                    case 'H': height = atoi(value); break;
+                    case 'C': colorspace = value; break;
+                    case 'F': {
+                        int num = 0, den = 0;
+                        if (sscanf(value, "%d:%d", &num, &den) == 2 && num > 0 && den > 0) fps = (double)num / den;
+                        break;
+                    }
+                    case 'I':
+                        if (token != "Ip" && token != "I?") {
+                            last_error_ = "Interlaced Y4M is not supported";
+                            return false;
+                        }
+                        break;
+                    default: break;
+                }
+            }
+            pos = next + 1;
+        }
+
+        // 共享内存环只有 8 位 I420/NV12/RGB 格式
+        if (colorspace != "420jpeg" && colorspace != "420paldv" && colorspace != "420mpeg2" &&
+            colorspace != "420") {
+            last_error_ = "Unsupported Y4M colorspace: " + colorspace;
+            return false;
+        }
+        info_.fps = format.fps > 0 ? format.fps : (fps > 0 ? fps : 25);
+        if (!setGeometry(width, height, SHM_PIXEL_I420)) return false;
+
+        // 每帧: FRAME[ 参数]\n + 数据
+        size_t offset = (size_t)(end - data_) + 1;
+        while (offset + 5 <= size_) {
+            if (memcmp(data_ + offset, "FRAME", 5) != 0) {
+                last_error_ = "Corrupt Y4M frame header";
+                break;
+            }
+            const uint8_t* line_end = static_cast<const uint8_t*>(
+                memchr(data_ + offset, '\n', std::min<size_t>(size_ - offset, 1024)));
+            if (!line_end) break;
+            size_t frame_offset = (size_t)(line_end - data_) + 1;
+            if (frame_offset + info_.frame_size > size_) break;  // 末尾不完整的帧
+            offsets_.push_back(frame_offset);
+            offset = frame_offset + info_.frame_size;
+        }
+        if (offsets_.empty()) {
+            if (last_error_.empty()) last_error_ = "Y4M file has no complete frames";
+            return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * 将未压缩帧发布到共享内存环
+ */
+class RawRingPublisher {
+public:
+    enum Mode {
+        MODE_COPY = 0,
+        MODE_REFERENCE,
+    };
+
+    struct Options {
+        std::string ring_name;
+        Mode mode = MODE_COPY;
+        uint32_t slot_count = 4;
+        bool realtime = true;         // 按帧率节奏发布，否则尽快发布
+        bool loop = false;
+        int64_t start_frame = 0;
+        int prefetch_frames = 2;      // 提前 WILLNEED 的帧数
+        std::shared_ptr<PresentationClock> clock;  // 设置后忽略 realtime
+        std::shared_ptr<OsdOverlay> overlay;       // 仅 copy 模式的 NV12 / I420 源
+    };
+
+    struct Stats {
+        bool running = false;
+        uint64_t frames = 0;
+        uint64_t late_frames = 0;     // 实时模式下晚于节奏时间一帧以上；使用共享时钟时为丢弃的迟到帧
+        uint64_t bytes = 0;           // 复制到环中的帧数据（reference 模式为 0）
+        double fps = 0;
+        double avg_copy_ms = 0;
+        double elapsed_sec = 0;
+        uint64_t write_seq = 0;
+    };
+
+    ~RawRingPublisher() { stop(); }
+
+    bool start(RawVideoFile* file, const Options& options, std::string& error) {
+        stop();
+        options_ = options;
+        const RawVideoFile::Info& info = file->info();
+        if (options_.overlay && (options_.mode == MODE_REFERENCE ||
+                                 (info.pixel_format != SHM_PIXEL_NV12 && info.pixel_format != SHM_PIXEL_I420))) {
+            error = "Overlay requires copy mode and an NV12 or I420 source";
+            return false;
+        }
+        uint32_t slot_size = options_.mode == MODE_REFERENCE
+                                 ? (uint32_t)ShmFileRef::encodedSize(file->path())
+                                 : (uint32_t)info.frame_size;
+        if (!ring_.create(options_.ring_name, options_.slot_count, slot_size)) {
+            error = "Failed to create frame ring " + options_.ring_name;
+            return false;
+        }
+
+        file_ = file;
+        frames_ = 0;
+        late_frames_ = 0;
+        bytes_ = 0;
+        copy_ms_ = 0;
+        elapsed_ = 0;
+        start_time_ = std::chrono::steady_clock::now();
+        running_ = true;
+        thread_ = std::thread(&RawRingPublisher::run, this);
+        return true;
+    }
+
+    void stop() {
+        running_ = false;
+        if (thread_.joinable()) thread_.join();
+        ring_.close();
+        file_ = nullptr;
+    }
+
+    bool isRunning() const { return running_; }
+
+    Stats stats() const {
+        Stats s;
+        s.running = running_;
+        s.frames = frames_;
+        s.late_frames = late_frames_;
+        s.bytes = bytes_;
+        s.elapsed_sec = running_ ? secondsSinceStart() : elapsed_.load();
+        if (s.elapsed_sec > 0) s.fps = s.frames / s.elapsed_sec;
+        if (s.frames > 0 && options_.mode == MODE_COPY) s.avg_copy_ms = copy_ms_ / s.frames;
+        s.write_seq = ring_.isOpen() ? ring_.writeSeq() : 0;
+        return s;
+    }
+
+private:
+    Options options_;
+    ShmFrameRing ring_;
+    RawVideoFile* file_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> late_frames_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<double> copy_ms_{0};
+    std::atomic<double> elapsed_{0};
+    std::chrono::steady_clock::time_point start_time_;
+
+    double secondsSinceStart() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    }
+
+    void run() {
+        const RawVideoFile::Info& info = file_->info();
+        const std::string& path = file_->path();
+        double frame_duration = info.fps > 0 ? 1.0 / info.fps : 0;
+        double loop_duration = info.frame_count * frame_duration;
+        int64_t index = std::max<int64_t>(0, std::min(options_.start_frame, info.frame_count - 1));
+        int clock_id = options_.clock ? options_.clock->subscribe(path) : 0;
+        double start_pts = file_->framePts(index);
+        double loop_offset = 0;
+        uint32_t flags = SHM_FLAG_KEYFRAME | SHM_FLAG_DISCONTINUITY;
+
+        file_->prefetch(index, options_.prefetch_frames + 1);
+        while (running_) {
+            if (index >= info.frame_count) {
+                if (!options_.loop) break;
+                index = 0;
+                loop_offset += loop_duration;
+                file_->prefetch(0, options_.prefetch_frames + 1);
+            }
+            double pts = file_->framePts(index) + loop_offset;
+
+            if (options_.clock) {
+                PresentationClock::Decision decision = options_.clock->waitForPresentation(clock_id, pts, running_);
+                if (!running_) break;
+                if (decision == PresentationClock::DROP) {
+                    late_frames_++;
+                    index++;
+                    continue;
+                }
+            } else if (options_.realtime) {
+                double due = pts - start_pts;
+                double now = secondsSinceStart();
+                if (now > due + frame_duration) late_frames_++;
+                while (running_ && (now = secondsSinceStart()) < due) {
+                    std::this_thread::sleep_for(std::chrono::duration<double>(std::min(due - now, 0.02)));
+                }
+                if (!running_) break;
+            }
+
+            // 下一帧的页在本帧复制期间读入
+            file_->prefetch(index + 1, options_.prefetch_frames);
+
+            uint8_t* dst = ring_.beginWrite();
+            uint32_t size;
+            uint32_t slot_flags = flags;
+            if (options_.mode == MODE_REFERENCE) {
+                size = (uint32_t)ShmFileRef::encode(dst, ring_.slotSize(), path, file_->frameOffset(index),
+                                                    info.frame_size, file_->fileSize());
+                slot_flags |= SHM_FLAG_FILE_REF;
+            } else {
+                auto t0 = std::chrono::steady_clock::now();
+                memcpy(dst, file_->frameData(index), info.frame_size);
+                if (options_.overlay) {
+                    OsdOverlay::Context ctx;
+                    ctx.pts = pts;
+                    ctx.frame_index = index;
+                    ctx.fps = info.fps;
+                    options_.overlay->render(info.pixel_format == SHM_PIXEL_I420
+                                                 ? OsdFrame::i420(dst, info.width, info.height, info.stride)
+                                                 : OsdFrame::nv12(dst, info.width, info.height, info.stride), ctx);
+                }
+                copy_ms_ = copy_ms_ + std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - t0).count();
+                size = (uint32_t)info.frame_size;
+                bytes_ += size;
+            }
+            ring_.endWrite(info.width, info.height, info.pixel_format, size, info.stride, pts, slot_flags);
+
+            flags = SHM_FLAG_KEYFRAME;
+            frames_++;
+            index++;
+        }
+
+        if (options_.clock) options_.clock->unsubscribe(clock_id);
+        elapsed_ = secondsSinceStart();
+        running_ = false;
+    }
+};
+
+// ================ N-API 绑定 ================
+
+class RawVideoSourceWrapper : public Napi::ObjectWrap<RawVideoSourceWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "RawVideoSource", {
+            InstanceMethod("open", &RawVideoSourceWrapper::Open),
+            InstanceMethod("getInfo", &RawVideoSourceWrapper::GetInfo),
+            InstanceMethod("readFrame", &RawVideoSourceWrapper::ReadFrame),
+            InstanceMethod("startPublishing", &RawVideoSourceWrapper::StartPublishing),
+            InstanceMethod("stopPublishing", &RawVideoSourceWrapper::StopPublishing),
+            InstanceMethod("getPublishStats", &RawVideoSourceWrapper::GetPublishStats),
+            InstanceMethod("close", &RawVideoSourceWrapper::Close),
+        });
+
+        exports.Set("RawVideoSource", func);
+        return exports;
+    }
+
+    RawVideoSourceWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<RawVideoSourceWrapper>(info) {}
+
+    ~RawVideoSourceWrapper() {
+        publisher_.stop();
+    }
+
+private:
+    RawVideoFile file_;
+    RawRingPublisher publisher_;
+
+    bool checkIdle(Napi::Env env) {
+        if (publisher_.isRunning()) {
+            Napi::Error::New(env, "Source is publishing to a frame ring").ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+
+    static bool parsePixelFormat(const std::string& name, uint32_t* format) {
+        if (name == "i420" || name == "yuv420p") *format = SHM_PIXEL_I420;
+        else if (name == "nv12") *format = SHM_PIXEL_NV12;
+        else if (name == "rgba") *format = SHM_PIXEL_RGBA;
+        else if (name == "rgb24") *format = SHM_PIXEL_RGB24;
+        else return false;
+        return true;
+    }
+
+    // 打开: (path, { width?, height?, fps?, pixelFormat? })，.y4m 只需 path
+    Napi::Value Open(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected (path, options?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!checkIdle(env)) return env.Null();
+
+        RawVideoFile::Format format;
+        if (info.Length() >= 2 && info[1].IsObject()) {
+            Napi::Object opts = info[1].As<Napi::Object>();
+            if (opts.Get("width").IsNumber()) format.width = opts.Get("width").As<Napi::Number>().Int32Value();
+            if (opts.Get("height").IsNumber()) format.height = opts.Get("height").As<Napi::Number>().Int32Value();
+            if (opts.Get("fps").IsNumber()) format.fps = opts.Get("fps").As<Napi::Number>().DoubleValue();
+            if (opts.Get("pixelFormat").IsString() &&
+                !parsePixelFormat(opts.Get("pixelFormat").As<Napi::String>().Utf8Value(), &format.pixel_format)) {
+                Napi::Error::New(env, "Unsupported pixelFormat, expected i420 | nv12 | rgba | rgb24")
+                    .ThrowAsJavaScriptException();
+                return env.Null();
+            }
+        }
+
+        if (!file_.open(info[0].As<Napi::String>().Utf8Value(), format)) {
+            Napi::Error::New(env, file_.lastError()).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return GetInfo(info);
+    }
+
+    // { container, width, height, fps, format, stride, frameSize, frameCount, duration }
+    Napi::Value GetInfo(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!file_.isOpen()) return env.Null();
+
+        const RawVideoFile::Info& raw = file_.info();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("container", Napi::String::New(env, raw.y4m ? "y4m" : "yuv"));
+        result.Set("width", Napi::Number::New(env, raw.width));
+        result.Set("height", Napi::Number::New(env, raw.height));
+        result.Set("fps", Napi::Number::New(env, raw.fps));
+        result.Set("format", Napi::Number::New(env, raw.pixel_format));
+        result.Set("stride", Napi::Number::New(env, raw.stride));
+        result.Set("frameSize", Napi::Number::New(env, (double)raw.frame_size));
+        result.Set("frameCount", Napi::Number::New(env, (double)raw.frame_count));
+        result.Set("duration", Napi::Number::New(env, raw.duration));
+        return result;
+    }
+
+    // 读取第 index 帧: (index, target?) => { data?, pts, index } | null
+    // 传入 target 时复制到其中，不分配新 Buffer
+    Napi::Value ReadFrame(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected (index, target?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!file_.isOpen()) return env.Null();
+
+        int64_t index = info[0].As<Napi::Number>().Int64Value();
+        const RawVideoFile::Info& raw = file_.info();
+        if (index < 0 || index >= raw.frame_count) return env.Null();
+
+        Napi::Object result = Napi::Object::New(env);
+        if (info.Length() >= 2 && info[1].IsBuffer()) {
+            Napi::Buffer<uint8_t> target = info[1].As<Napi::Buffer<uint8_t>>();
+            if (target.Length() < raw.frame_size) {
+                Napi::RangeError::New(env, "Target buffer too small").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            memcpy(target.Data(), file_.frameData(index), raw.frame_size);
+        } else {
+            result.Set("data", Napi::Buffer<uint8_t>::Copy(env, file_.frameData(index), raw.frame_size));
+        }
+        result.Set("index", Napi::Number::New(env, (double)index));
+        result.Set("pts", Napi::Number::New(env, file_.framePts(index)));
+        return result;
+    }
+
+    // 开始发布: (ringName, { mode?: 'copy' | 'reference', slotCount?, realtime?, loop?, startFrame?, clock?, overlay? })
+    Napi::Value StartPublishing(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected (ringName, options?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!file_.isOpen()) {
+            Napi::Error::New(env, "Source not opened").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!checkIdle(env)) return env.Null();
+
+        RawRingPublisher::Options options;
+        options.ring_name = info[0].As<Napi::String>().Utf8Value();
+        if (info.Length() >= 2 && info[1].IsObject()) {
+            Napi::Object opts = info[1].As<Napi::Object>();
+            if (opts.Get("mode").IsString() && opts.Get("mode").As<Napi::String>().Utf8Value() == "reference") {
+                options.mode = RawRingPublisher::MODE_REFERENCE;
+            }
+            if (opts.Get("slotCount").IsNumber()) options.slot_count = opts.Get("slotCount").As<Napi::Number>().Uint32Value();
+            if (opts.Get("realtime").IsBoolean()) options.realtime = opts.Get("realtime").As<Napi::Boolean>().Value();
+            if (opts.Get("loop").IsBoolean()) options.loop = opts.Get("loop").As<Napi::Boolean>().Value();
+            if (opts.Get("startFrame").IsNumber()) options.start_frame = opts.Get("startFrame").As<Napi::Number>().Int64Value();
+            options.clock = PresentationClockWrapper::FromValue(opts.Get("clock"));
+            options.overlay = OsdOverlayWrapper::FromValue(opts.Get("overlay"));
+        }
+        if (options.slot_count < 2) options.slot_count = 2;
+
+        std::string error;
+        if (!publisher_.start(&file_, options, error)) {
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
+
+    Napi::Value StopPublishing(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        publisher_.stop();
+        return env.Undefined();
+    }
+
+    Napi::Value GetPublishStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        RawRingPublisher::Stats stats = publisher_.stats();
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("running", Napi::Boolean::New(env, stats.running));
+        result.Set("frames", Napi::Number::New(env, (double)stats.frames));
+        result.Set("lateFrames", Napi::Number::New(env, (double)stats.late_frames));
+        result.Set("bytes", Napi::Number::New(env, (double)stats.bytes));
+        result.Set("fps", Napi::Number::New(env, stats.fps));
+        result.Set("avgCopyMs", Napi::Number::New(env, stats.avg_copy_ms));
+        result.Set("elapsed", Napi::Number::New(env, stats.elapsed_sec));
+        result.Set("writeSeq", Napi::Number::New(env, (double)stats.write_seq));
+        return result;
+    }
+
+    Napi::Value Close(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        publisher_.stop();
+        file_.close();
+        return env.Undefined();
+    }
+};
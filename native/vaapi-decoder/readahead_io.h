@@ -0,0 +1,504 @@
+/**
+ * 预读 I/O 层
+ * 本地文件输入使用自定义 AVIOContext：后台线程按块（默认 1MB，页对齐缓冲、块边界对齐的 pread）
+ * 预读当前读位置之后的一个窗口，demuxer 的小块读取直接从内存中的块复制。
+ * NAS 或机械硬盘偶尔卡顿时，只要窗口内的数据已经读到，解码就不会停顿
+ *
+ * 预读线程是独立线程而不是共享线程池的任务：阻塞 I/O 会长时间占住工作线程
+ *
+ * openSegments 把多个分段文件（HLS 的 TS 分段，或 fMP4 初始化段 + 各分段）当作一个连续文件读取：
+ * 预读窗口跨过分段边界，下一个分段在读到之前就由预读线程打开并读入，demuxer 看不到边界
+ */
+#pragma once
+
+extern "C" {
+#include <libavformat/avio.h>
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+}
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ReadAheadFile {
+public:
+    struct Config {
+        bool enabled = true;
+        size_t chunk_size = 1 << 20;   // 单次读取大小，向上取整到页大小
+        int window_chunks = 16;        // 预读窗口（块数），含当前块
+    };
+
+    struct Stats {
+        uint64_t bytes_delivered = 0;  // 交给 demuxer 的字节数
+        uint64_t bytes_read = 0;       // 实际从磁盘读取的字节数
+        uint64_t reads = 0;            // pread 次数
+        uint64_t prefetch_hits = 0;    // 读到某块时它已经在内存中
+        uint64_t prefetch_misses = 0;  // 需要等待磁盘
+        uint64_t seeks = 0;
+        double io_wait_ms = 0;         // demuxer 等待磁盘的总时间
+        double avg_read_ms = 0;        // 单次 pread 平均耗时
+        double max_read_ms = 0;
+        size_t window_bytes = 0;
+        uint32_t segments = 0;         // 分段数，单个文件为 1
+        uint32_t segment_opens = 0;    // 预读线程打开分段文件的次数
+        int current_segment = 0;       // 读位置所在分段
+    };
+
+    // 读到末尾时调用，返回新增的分段路径（用于仍在录制的播放列表）
+    using GrowCallback = std::function<std::vector<std::string>()>;
+
+    ~ReadAheadFile() { close(); }
+
+    bool open(const std::string& path, const Config& config, std::string& error) {
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = "Failed to open file: " + path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            error = "Failed to stat file: " + path;
+            ::close(fd);
+            return false;
+        }
+        Part part;
+        part.path = path;
+        part.size = st.st_size;
+        part.fd = fd;
+        parts_.push_back(part);
+        file_size_ = part.size;
+        open_parts_.push_back(&parts_.back());
+        // 顺序读取提示：内核加大自身的预读，读过的页也更早回收
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        return start(config, error);
+    }
+
+    // 按顺序拼接的分段文件，只取大小，文件由预读线程在窗口到达时打开
+    bool openSegments(const std::vector<std::string>& paths, const Config& config, std::string& error) {
+        close();
+        if (paths.empty()) {
+            error = "Empty segment list";
+            return false;
+        }
+        for (const std::string& path : paths) {
+            if (!appendPart(path)) {
+                error = "Failed to stat segment: " + path;
+                close();
+                return false;
+            }
+        }
+        return start(config, error);
+    }
+
+    // 末尾追加分段（播放列表仍在增长时）
+    void appendSegments(const std::vector<std::string>& paths) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const std::string& path : paths) appendPart(path);
+        cond_.notify_all();
+    }
+
+    void setGrowCallback(GrowCallback callback) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        grow_ = std::move(callback);
+    }
+
+    // 分段 index 在拼接后文件中的起始偏移
+    int64_t segmentOffset(size_t index) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index < parts_.size() ? parts_[index].start : file_size_;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        if (thread_.joinable()) thread_.join();
+        for (Slot& slot : slots_) free(slot.data);
+        slots_.clear();
+        for (Part* part : open_parts_) {
+            ::close(part->fd);
+            part->fd = -1;
+        }
+        open_parts_.clear();
+        parts_.clear();
+        file_size_ = 0;
+        grow_ = nullptr;
+    }
+
+    // 返回读取字节数、0（文件结束）或负的 errno
+    int read(uint8_t* buf, int size) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        int total = 0;
+        while (total < size) {
+            if (pos_ >= file_size_ && !refreshSize()) break;
+
+            int64_t chunk = pos_ / (int64_t)chunk_size_;
+            if (chunk != want_chunk_) {
+                want_chunk_ = chunk;
+                cond_.notify_all();
+            }
+
+            Slot* slot = findReady(chunk);
+            if (chunk != last_chunk_) {
+                last_chunk_ = chunk;
+                if (slot) stats_.prefetch_hits++;
+                else stats_.prefetch_misses++;
+            }
+            if (!slot) {
+                auto t0 = std::chrono::steady_clock::now();
+                cond_.wait(lock, [&] {
+                    return stop_ || io_error_ != 0 || want_chunk_ != chunk || (slot = findReady(chunk)) != nullptr;
+                });
+                stats_.io_wait_ms += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - t0).count();
+                if (!slot) {
+                    if (io_error_ != 0) return total > 0 ? total : -io_error_;
+                    if (stop_) break;
+                    continue;
+                }
+            }
+
+            size_t offset = (size_t)(pos_ - chunk * (int64_t)chunk_size_);
+            if (offset >= slot->size) break;  // 块不完整：文件在读取后被截断
+            int n = (int)std::min<size_t>(slot->size - offset, (size_t)(size - total));
+            memcpy(buf + total, slot->data + offset, n);
+            total += n;
+            pos_ += n;
+        }
+        stats_.bytes_delivered += total;
+        return total;
+    }
+
+    // whence 为 SEEK_SET/SEEK_CUR/SEEK_END 或 AVSEEK_SIZE
+    int64_t seek(int64_t offset, int whence) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (whence & AVSEEK_SIZE) {
+            refreshSize();
+            return file_size_;
+        }
+        int64_t target;
+        switch (whence & ~AVSEEK_FORCE) {
+            case SEEK_SET: target = offset; break;
+            case SEEK_CUR: target = pos_ + offset; break;
+            case SEEK_END: refreshSize(); target = file_size_ + offset; break;
+            default: return AVERROR(EINVAL);
+        }
+        if (target < 0) return AVERROR(EINVAL);
+        if (target / (int64_t)chunk_size_ != pos_ / (int64_t)chunk_size_) stats_.seeks++;
+        pos_ = target;
+        return pos_;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats s = stats_;
+        if (s.reads > 0) s.avg_read_ms = read_time_ms_ / s.reads;
+        s.segments = (uint32_t)parts_.size();
+        s.current_segment = partAt(pos_);
+        return s;
+    }
+
+    // ---- AVIOContext 回调 ----
+
+    static int avioRead(void* opaque, uint8_t* buf, int size) {
+        int n = static_cast<ReadAheadFile*>(opaque)->read(buf, size);
+        if (n == 0) return AVERROR_EOF;
+        return n < 0 ? AVERROR(-n) : n;
+    }
+
+    static int64_t avioSeek(void* opaque, int64_t offset, int whence) {
+        return static_cast<ReadAheadFile*>(opaque)->seek(offset, whence);
+    }
+
+    // 创建绑定到本对象的 AVIOContext，释放见 freeAvio()
+    AVIOContext* createAvio(int buffer_size = 256 * 1024) {
+        uint8_t* buffer = static_cast<uint8_t*>(av_malloc(buffer_size));
+        if (!buffer) return nullptr;
+        AVIOContext* pb = avio_alloc_context(buffer, buffer_size, 0, this, &avioRead, nullptr, &avioSeek);
+        if (!pb) av_free(buffer);
+        return pb;
+    }
+
+    static void freeAvio(AVIOContext** pb) {
+        if (!*pb) return;
+        av_freep(&(*pb)->buffer);
+        avio_context_free(pb);
+    }
+
+private:
+    struct Slot {
+        uint8_t* data = nullptr;
+        int64_t chunk = -1;
+        size_t size = 0;
+        bool ready = false;
+        bool loading = false;
+    };
+
+    // 拼接成一个连续文件的各部分。deque 追加时已有元素的地址不变，
+    // 预读线程在锁内取得 Part* 后可以在锁外使用；fd 只由预读线程打开和关闭
+    struct Part {
+        std::string path;
+        int64_t start = 0;
+        int64_t size = 0;
+        int fd = -1;
+    };
+    static constexpr size_t kMaxOpenParts = 4;
+
+    std::deque<Part> parts_;
+    std::deque<Part*> open_parts_;  // 按打开顺序，超过 kMaxOpenParts 时关闭最早的
+    GrowCallback grow_;
+    std::chrono::steady_clock::time_point last_grow_;
+    int64_t file_size_ = 0;
+    size_t page_size_ = 4096;
+    size_t chunk_size_ = 1 << 20;
+    std::vector<Slot> slots_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread thread_;
+    bool stop_ = false;
+    int io_error_ = 0;
+    int64_t pos_ = 0;
+    int64_t want_chunk_ = 0;   // 读位置所在块，预读窗口从这里开始
+    int64_t last_chunk_ = -1;  // 上一次 read 所在块，用于统计命中
+    Stats stats_;
+    double read_time_ms_ = 0;
+
+    bool start(const Config& config, std::string& error) {
+        long page = sysconf(_SC_PAGESIZE);
+        page_size_ = page > 0 ? (size_t)page : 4096;
+        chunk_size_ = (std::max<size_t>(config.chunk_size, page_size_) + page_size_ - 1) / page_size_ * page_size_;
+        int window = std::max(2, config.window_chunks);
+
+        slots_.resize(window);
+        for (Slot& slot : slots_) {
+            void* buffer = nullptr;
+            if (posix_memalign(&buffer, page_size_, chunk_size_) != 0) {
+                error = "Failed to allocate read-ahead buffers";
+                close();
+                return false;
+            }
+            slot.data = static_cast<uint8_t*>(buffer);
+        }
+
+        pos_ = 0;
+        want_chunk_ = 0;
+        last_chunk_ = -1;
+        stop_ = false;
+        io_error_ = 0;
+        stats_ = Stats();
+        read_time_ms_ = 0;
+        stats_.window_bytes = chunk_size_ * slots_.size();
+        thread_ = std::thread(&ReadAheadFile::run, this);
+        return true;
+    }
+
+    bool appendPart(const std::string& path) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return false;
+        Part part;
+        part.path = path;
+        part.start = file_size_;
+        part.size = st.st_size;
+        parts_.push_back(part);
+        file_size_ += part.size;
+        return true;
+    }
+
+    // 偏移所在的分段（持有锁）
+    int partAt(int64_t offset) const {
+        if (parts_.empty()) return 0;
+        auto it = std::upper_bound(parts_.begin(), parts_.end(), offset,
+                                   [](int64_t v, const Part& p) { return v < p.start; });
+        return std::max(0, (int)(it - parts_.begin()) - 1);
+    }
+
+    // 正在录制的文件会变长，读到已知末尾时重新取一次大小；分段模式下还会询问是否有新分段（持有锁）
+    bool refreshSize() {
+        if (parts_.empty()) return false;
+        int64_t old_size = file_size_;
+        Part& last = parts_.back();
+        struct stat st;
+        if (stat(last.path.c_str(), &st) == 0 && st.st_size > last.size) {
+            last.size = st.st_size;
+            file_size_ = last.start + last.size;
+        }
+        // 播放列表至多每秒重新读取一次
+        auto now = std::chrono::steady_clock::now();
+        if (grow_ && now - last_grow_ >= std::chrono::seconds(1)) {
+            last_grow_ = now;
+            for (const std::string& path : grow_()) appendPart(path);
+        }
+        if (file_size_ > old_size) {
+            // 末尾不完整的块需要重新读取
+            for (Slot& slot : slots_) {
+                if (slot.ready && slot.size < chunk_size_) {
+                    slot.ready = false;
+                    slot.chunk = -1;
+                }
+            }
+            cond_.notify_all();
+            return pos_ < file_size_;
+        }
+        return false;
+    }
+
+    Slot* findReady(int64_t chunk) {
+        for (Slot& slot : slots_) {
+            if (slot.chunk == chunk && slot.ready) return &slot;
+        }
+        return nullptr;
+    }
+
+    bool inWindow(int64_t chunk) const {
+        return chunk >= want_chunk_ && chunk < want_chunk_ + (int64_t)slots_.size();
+    }
+
+    // 窗口内下一个尚未读取的块，以及可以复用的槽位（持有锁）
+    bool nextJob(int64_t* chunk, Slot** slot) {
+        int64_t last_chunk = (file_size_ + (int64_t)chunk_size_ - 1) / (int64_t)chunk_size_;
+        int64_t end = std::min<int64_t>(want_chunk_ + (int64_t)slots_.size(), last_chunk);
+        for (int64_t c = want_chunk_; c < end; c++) {
+            bool present = false;
+            for (Slot& s : slots_) {
+                if (s.chunk == c && (s.ready || s.loading)) {
+                    present = true;
+                    break;
+                }
+            }
+            if (present) continue;
+            for (Slot& s : slots_) {
+                if (!s.loading && (s.chunk < 0 || !inWindow(s.chunk))) {
+                    *chunk = c;
+                    *slot = &s;
+                    return true;
+                }
+            }
+            return false;
+        }
+        return false;
+    }
+
+    // 预读线程中打开分段并给内核读取提示；同时打开的分段数有上限
+    bool openPart(Part* part, int64_t part_offset, size_t window_bytes) {
+        if (part->fd < 0) {
+            part->fd = ::open(part->path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (part->fd < 0) return false;
+            posix_fadvise(part->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            open_parts_.push_back(part);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (parts_.size() > 1) stats_.segment_opens++;
+            }
+            while (open_parts_.size() > kMaxOpenParts) {
+                Part* oldest = open_parts_.front();
+                open_parts_.pop_front();
+                ::close(oldest->fd);
+                oldest->fd = -1;
+            }
+        }
+        // 告诉内核接下来要读的范围，与我们自己的 pread 并行
+        posix_fadvise(part->fd, part_offset, (off_t)window_bytes, POSIX_FADV_WILLNEED);
+        return true;
+    }
+
+    // 从 part 读取拼接后偏移 offset 处的数据，累加到 *got；分段读完返回 true
+    bool readPart(Part* part, int64_t offset, uint8_t* dst, size_t capacity, size_t window_bytes,
+                  size_t* got, int* error) {
+        int64_t part_offset = offset - part->start;
+        if (!openPart(part, part_offset, window_bytes)) {
+            *error = errno;
+            return false;
+        }
+        size_t n_total = 0;
+        while (n_total < capacity) {
+            ssize_t n = pread(part->fd, dst + n_total, capacity - n_total, part_offset + (off_t)n_total);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                *error = errno;
+                *got += n_total;
+                return false;
+            }
+            if (n == 0) break;
+            n_total += (size_t)n;
+        }
+        *got += n_total;
+        // 分段比登记的大小短（被截断）时块在此结束，不拼接后面的分段
+        std::lock_guard<std::mutex> lock(mutex_);
+        return part_offset + (int64_t)n_total >= part->size;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            int64_t chunk = -1;
+            Slot* slot = nullptr;
+            if (io_error_ != 0 || !nextJob(&chunk, &slot)) {
+                cond_.wait(lock);
+                continue;
+            }
+            slot->chunk = chunk;
+            slot->ready = false;
+            slot->loading = true;
+            int64_t offset = chunk * (int64_t)chunk_size_;
+            size_t window_bytes = chunk_size_ * slots_.size();
+
+            // 块覆盖的分段：Part 地址在追加时不变，可以在锁外使用
+            std::vector<Part*> parts;
+            for (int i = partAt(offset); i < (int)parts_.size() && parts_[i].start < offset + (int64_t)chunk_size_; i++) {
+                parts.push_back(&parts_[i]);
+            }
+            Part* ahead = nullptr;
+            int next = partAt(offset + (int64_t)window_bytes);
+            if (next < (int)parts_.size()) ahead = &parts_[next];
+            lock.unlock();
+
+            auto t0 = std::chrono::steady_clock::now();
+            size_t got = 0;
+            int error = 0;
+            for (Part* part : parts) {
+                if (!readPart(part, offset + (int64_t)got, slot->data + got, chunk_size_ - got, window_bytes,
+                              &got, &error) || got >= chunk_size_) {
+                    break;
+                }
+            }
+            // 窗口末尾落在之后的分段时提前打开，读到时不再有打开文件的延迟
+            if (ahead && error == 0 && (parts.empty() || ahead != parts.back())) openPart(ahead, 0, window_bytes);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+            lock.lock();
+            slot->loading = false;
+            stats_.reads++;
+            stats_.bytes_read += got;
+            read_time_ms_ += ms;
+            stats_.max_read_ms = std::max(stats_.max_read_ms, ms);
+            if (error != 0) {
+                io_error_ = error;
+                slot->chunk = -1;
+            } else {
+                slot->size = got;
+                slot->ready = true;
+            }
+            cond_.notify_all();
+        }
+    }
+};
@@ -0,0 +1,256 @@
+/**
+ * 场景切换检测
+ * 解码线程只做一次 SIMD 亮度降采样，比较与判定作为后台任务在共享线程池中串行执行，不阻塞出帧
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "work_pool.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 场景切换事件
+struct SceneCutEvent {
+    double pts;          // 切换后第一帧的时间戳（秒）
+    int64_t frame_index; // 切换后第一帧的序号
+    double score;        // 差异得分 (0-1)
+};
+
+class SceneDetector {
+public:
+    // 缩略图网格尺寸（每个格子是原图一个块的平均亮度）
+    static constexpr int kGridWidth = 64;
+    static constexpr int kGridHeight = 36;
+    static constexpr int kHistogramBins = 32;
+
+    using EventCallback = std::function<void(const SceneCutEvent&)>;
+
+    SceneDetector() = default;
+
+    ~SceneDetector() {
+        // 等待已提交的分析任务退出
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+        cond_.wait(lock, [this] { return !scheduled_; });
+    }
+
+    // threshold: 判定为切换的得分阈值; min_scene_frames: 两次切换之间的最少帧数
+    void configure(double threshold, int min_scene_frames) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threshold_ = threshold;
+        min_scene_frames_ = min_scene_frames;
+    }
+
+    void setCallback(EventCallback callback) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback_ = std::move(callback);
+    }
+
+    // 提交一帧 Y 平面（在解码线程调用），只做降采样后入队
+    void submit(const uint8_t* y_plane, int width, int height, int stride,
+                double pts, int64_t frame_index) {
+        if (width < kGridWidth || height < kGridHeight) return;
+
+        Thumbnail thumb;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_list_.empty()) {
+                thumb.luma = std::move(free_list_.back());
+                free_list_.pop_back();
+            }
+        }
+        thumb.luma.resize(kGridWidth * kGridHeight);
+        thumb.pts = pts;
+        thumb.frame_index = frame_index;
+        downsampleLuma(y_plane, width, height, stride, thumb.luma.data());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // 队列满时丢弃最旧的缩略图，保证解码线程永不等待
+            if (queue_.size() >= kMaxQueue) {
+                free_list_.push_back(std::move(queue_.front().luma));
+                queue_.pop_front();
+                dropped_++;
+            }
+            queue_.push_back(std::move(thumb));
+            if (scheduled_ || stopping_) return;
+            scheduled_ = true;
+        }
+        WorkPool::shared().submit(WORK_BACKGROUND, [this] { drain(); });
+    }
+
+    // 切换视频源时清空参考帧
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!queue_.empty()) {
+            free_list_.push_back(std::move(queue_.front().luma));
+            queue_.pop_front();
+        }
+        reset_pending_ = true;
+    }
+
+    uint64_t droppedCount() const { return dropped_.load(); }
+
+private:
+    struct Thumbnail {
+        std::vector<uint8_t> luma;
+        double pts = 0;
+        int64_t frame_index = 0;
+    };
+
+    static constexpr size_t kMaxQueue = 8;
+    // 每个块内只采样部分行，降低内存带宽
+    static constexpr int kRowStep = 4;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<Thumbnail> queue_;
+    std::vector<std::vector<uint8_t>> free_list_;
+    EventCallback callback_;
+    bool stopping_ = false;
+    bool scheduled_ = false;       // 线程池中已有一个 drain 任务
+    bool reset_pending_ = false;
+    double threshold_ = 0.35;
+    int min_scene_frames_ = 12;
+    std::atomic<uint64_t> dropped_{0};
+
+    // 只由 drain 访问，同一时刻最多一个 drain 任务
+    std::vector<uint8_t> prev_;
+    uint32_t prev_hist_[kHistogramBins];
+    int64_t frames_since_cut_ = 0;
+
+    // 按块求平均亮度，输出 kGridWidth x kGridHeight 的缩略图
+    static void downsampleLuma(const uint8_t* y_plane, int width, int height, int stride,
+                               uint8_t* out) {
+        // 格子按实际宽度铺满整行；每个格子内只对 16 对齐的部分做 SIMD 求和，按实际求和的像素数平均
+        int cell_w = width / kGridWidth;
+        int sum_w = cell_w >= 16 ? (cell_w & ~15) : cell_w;
+        int block_h = height / kGridHeight;
+
+        uint32_t sums[kGridWidth];
+        for (int gy = 0; gy < kGridHeight; gy++) {
+            memset(sums, 0, sizeof(sums));
+            int rows = 0;
+            for (int r = 0; r < block_h; r += kRowStep) {
+                const uint8_t* row = y_plane + (size_t)(gy * block_h + r) * stride;
+                for (int gx = 0; gx < kGridWidth; gx++) {
+                    sums[gx] += sumRow(row + gx * cell_w, sum_w);
+                }
+                rows++;
+            }
+            uint32_t count = (uint32_t)rows * sum_w;
+            for (int gx = 0; gx < kGridWidth; gx++) {
+                out[gy * kGridWidth + gx] = (uint8_t)(sums[gx] / count);
+            }
+        }
+    }
+
+    static uint32_t sumRow(const uint8_t* p, int n) {
+        uint32_t sum = 0;
+        int i = 0;
+#if defined(__SSE2__)
+        __m128i zero = _mm_setzero_si128();
+        __m128i acc = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+        }
+        sum = (uint32_t)(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#endif
+        for (; i < n; i++) sum += p[i];
+        return sum;
+    }
+
+    // 两张缩略图的平均绝对差 (0-255)
+    static double meanAbsDiff(const uint8_t* a, const uint8_t* b, int n) {
+        uint64_t sad = 0;
+        int i = 0;
+#if defined(__SSE2__)
+        __m128i acc = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+        }
+        sad = (uint64_t)_mm_cvtsi128_si32(acc) + (uint64_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#endif
+        for (; i < n; i++) sad += (uint64_t)std::abs((int)a[i] - (int)b[i]);
+        return (double)sad / n;
+    }
+
+    static void histogram(const uint8_t* luma, int n, uint32_t* bins) {
+        memset(bins, 0, sizeof(uint32_t) * kHistogramBins);
+        for (int i = 0; i < n; i++) {
+            bins[luma[i] * kHistogramBins / 256]++;
+        }
+    }
+
+    // 处理队列中的所有缩略图，队列为空时结束任务，下一次 submit 再重新提交
+    void drain() {
+        uint32_t cur_hist[kHistogramBins];
+        const int n = kGridWidth * kGridHeight;
+
+        while (true) {
+            Thumbnail thumb;
+            double threshold;
+            int min_scene_frames;
+            EventCallback callback;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stopping_ || queue_.empty()) {
+                    scheduled_ = false;
+                    cond_.notify_all();
+                    return;
+                }
+                thumb = std::move(queue_.front());
+                queue_.pop_front();
+                if (reset_pending_) {
+                    prev_.clear();
+                    reset_pending_ = false;
+                }
+                threshold = threshold_;
+                min_scene_frames = min_scene_frames_;
+                callback = callback_;
+            }
+
+            histogram(thumb.luma.data(), n, cur_hist);
+            if (!prev_.empty()) {
+                // 结构差异 (SAD) 与亮度分布差异 (直方图) 各占一半，平均差 64 即视为完全不同
+                double sad_score = std::min(1.0, meanAbsDiff(prev_.data(), thumb.luma.data(), n) / 64.0);
+                uint32_t hist_diff = 0;
+                for (int i = 0; i < kHistogramBins; i++) {
+                    hist_diff += (uint32_t)std::abs((int)cur_hist[i] - (int)prev_hist_[i]);
+                }
+                double hist_score = (double)hist_diff / (2.0 * n);
+                double score = 0.5 * sad_score + 0.5 * hist_score;
+
+                frames_since_cut_++;
+                if (score >= threshold && frames_since_cut_ >= min_scene_frames) {
+                    frames_since_cut_ = 0;
+                    if (callback) {
+                        callback(SceneCutEvent{thumb.pts, thumb.frame_index, score});
+                    }
+                }
+            }
+
+            memcpy(prev_hist_, cur_hist, sizeof(cur_hist));
+            prev_.swap(thumb.luma);
+            if (!thumb.luma.empty()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                free_list_.push_back(std::move(thumb.luma));
+            }
+        }
+    }
+};
@@ -0,0 +1,271 @@
+/**
+ * 本地分段播放列表（HLS m3u8）
+ * 录制程序把长时间的会话写成一串分段（MPEG-TS，或 fMP4 初始化段 + .m4s 分段）加一个 m3u8。
+ * FFmpeg 的 hls demuxer 每个分段重新打开一次输入，分段边界处会有停顿；这里只解析播放列表，
+ * 得到按顺序拼接的文件列表，由 ReadAheadFile::openSegments 当作一个连续文件交给同一个
+ * demuxer 和解码器，边界对 demuxer 不可见
+ *
+ * 支持：#EXTINF、#EXT-X-MAP、#EXT-X-ENDLIST，主播放列表取带宽最高的变体。
+ * 整个会话只有一个 demuxer，要求各分段属于同一次录制：中途更换 #EXT-X-MAP（mov demuxer 忽略
+ * 第二个 moov）和第一个分段之后的 #EXT-X-DISCONTINUITY（时间戳重新开始）都拒绝加载。
+ * 不支持远程 URI、#EXT-X-BYTERANGE 和加密分段
+ */
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class SegmentPlaylist {
+public:
+    struct Entry {
+        std::string path;
+        double start = 0;          // 播放列表时间轴上的起点（秒），初始化段与其后分段相同
+        double duration = 0;
+        bool init = false;         // fMP4 初始化段（#EXT-X-MAP），不含媒体数据
+    };
+
+    static bool isPlaylist(const std::string& path) {
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos) return false;
+        std::string ext = path.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return ext == "m3u8" || ext == "m3u";
+    }
+
+    bool load(const std::string& path, std::string& error) {
+        path_ = path;
+        entries_.clear();
+        ended_ = false;
+        duration_ = 0;
+        std::vector<Entry> entries;
+        bool ended = false;
+        if (!parse(path, &entries, &ended, error, 0)) return false;
+        if (std::none_of(entries.begin(), entries.end(), [](const Entry& e) { return !e.init; })) {
+            error = "Playlist has no segments: " + path;
+            return false;
+        }
+        entries_ = std::move(entries);
+        ended_ = ended;
+        updateDuration();
+        return true;
+    }
+
+    // 重新读取仍在增长的播放列表，返回新增的文件（顺序与 files() 一致）
+    // 新追加的部分出现不支持的标签（如录制重启后的 DISCONTINUITY）时不再追加，播放在已有分段末尾结束
+    std::vector<std::string> refresh() {
+        std::vector<std::string> added;
+        if (ended_ || entries_.empty()) return added;
+
+        std::vector<Entry> entries;
+        bool ended = false;
+        std::string error;
+        if (!parse(path_, &entries, &ended, error, 0)) return added;
+
+        // 滑动窗口的播放列表会删掉开头的分段，按已知的最后一个分段定位
+        const std::string& last = entries_.back().path;
+        auto it = std::find_if(entries.rbegin(), entries.rend(), [&](const Entry& e) { return e.path == last; });
+        if (it == entries.rend()) return added;
+        double start = entries_.back().start + entries_.back().duration;
+        for (auto next = it.base(); next != entries.end(); ++next) {
+            Entry entry = *next;
+            entry.start = start;
+            start += entry.duration;
+            entries_.push_back(entry);
+            added.push_back(entry.path);
+        }
+        ended_ = ended;
+        updateDuration();
+        return added;
+    }
+
+    const std::vector<Entry>& entries() const { return entries_; }
+    bool ended() const { return ended_; }
+    double duration() const { return duration_; }
+
+    std::vector<std::string> files() const {
+        std::vector<std::string> paths;
+        for (const Entry& e : entries_) paths.push_back(e.path);
+        return paths;
+    }
+
+    // 包含 seconds 的媒体分段下标（entries() 中的下标）；用于按分段定位 seek
+    size_t entryAt(double seconds) const {
+        size_t found = 0;
+        for (size_t i = 0; i < entries_.size(); i++) {
+            if (entries_[i].init) continue;
+            if (entries_[i].start > seconds) break;
+            found = i;
+        }
+        return found;
+    }
+
+    // entries() 下标对应的媒体分段序号（初始化段对应其后的分段）
+    size_t segmentIndex(size_t entry) const {
+        size_t n = 0;
+        for (size_t i = 0; i < entry && i < entries_.size(); i++) {
+            if (!entries_[i].init) n++;
+        }
+        return n;
+    }
+
+    size_t segmentCount() const {
+        return (size_t)std::count_if(entries_.begin(), entries_.end(), [](const Entry& e) { return !e.init; });
+    }
+
+private:
+    std::string path_;
+    std::vector<Entry> entries_;
+    bool ended_ = false;
+    double duration_ = 0;
+
+    void updateDuration() {
+        duration_ = entries_.empty() ? 0 : entries_.back().start + entries_.back().duration;
+    }
+
+    static std::string directoryOf(const std::string& path) {
+        size_t slash = path.find_last_of('/');
+        return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+    }
+
+    static std::string trim(const std::string& s) {
+        size_t b = s.find_first_not_of(" \t\r\n");
+        if (b == std::string::npos) return "";
+        size_t e = s.find_last_not_of(" \t\r\n");
+        return s.substr(b, e - b + 1);
+    }
+
+    // 属性列表中 NAME=value 或 NAME="value" 的值
+    static std::string attribute(const std::string& line, const std::string& name) {
+        size_t pos = 0;
+        while ((pos = line.find(name + "=", pos)) != std::string::npos) {
+            if (pos == 0 || line[pos - 1] == ',' || line[pos - 1] == ':') {
+                size_t v = pos + name.size() + 1;
+                if (v < line.size() && line[v] == '"') {
+                    size_t end = line.find('"', v + 1);
+                    return line.substr(v + 1, end == std::string::npos ? std::string::npos : end - v - 1);
+                }
+                size_t end = line.find(',', v);
+                return line.substr(v, end == std::string::npos ? std::string::npos : end - v);
+            }
+            pos += name.size();
+        }
+        return "";
+    }
+
+    static bool resolve(const std::string& dir, const std::string& uri, std::string* path, std::string& error) {
+        std::string u = uri;
+        if (u.compare(0, 7, "file://") == 0) {
+            u = u.substr(7);
+        } else if (u.find("://") != std::string::npos) {
+            error = "Remote segment not supported: " + uri;
+            return false;
+        }
+        *path = (!u.empty() && u[0] == '/') ? u : dir + "/" + u;
+        return true;
+    }
+
+    static bool parse(const std::string& path, std::vector<Entry>* entries, bool* ended,
+                      std::string& error, int depth) {
+        std::ifstream in(path);
+        if (!in) {
+            error = "Failed to open playlist: " + path;
+            return false;
+        }
+        std::string dir = directoryOf(path);
+        std::string line;
+        if (!std::getline(in, line) || trim(line).compare(0, 7, "#EXTM3U") != 0) {
+            error = "Not an M3U8 playlist: " + path;
+            return false;
+        }
+
+        std::string current_map;
+        double pending_duration = -1;
+        size_t media_segments = 0;
+        bool pending_variant = false;
+        double best_bandwidth = -1;
+        std::string best_variant;
+        double start = 0;
+
+        while (std::getline(in, line)) {
+            line = trim(line);
+            if (line.empty()) continue;
+            if (line[0] == '#') {
+                if (line.compare(0, 8, "#EXTINF:") == 0) {
+                    pending_duration = atof(line.c_str() + 8);
+                } else if (line.compare(0, 11, "#EXT-X-MAP:") == 0) {
+                    if (!attribute(line, "BYTERANGE").empty()) {
+                        error = "EXT-X-MAP with BYTERANGE not supported";
+                        return false;
+                    }
+                    std::string map;
+                    if (!resolve(dir, attribute(line, "URI"), &map, error)) return false;
+                    // 初始化段放在第一个分段之前；重复声明同一个初始化段时忽略
+                    if (map != current_map) {
+                        if (media_segments > 0) {
+                            error = "EXT-X-MAP changes mid-playlist, not supported: " + path;
+                            return false;
+                        }
+                        if (!current_map.empty()) entries->pop_back();
+                        current_map = map;
+                        Entry entry;
+                        entry.path = map;
+                        entry.start = start;
+                        entry.init = true;
+                        entries->push_back(entry);
+                    }
+                } else if (line.compare(0, 17, "#EXT-X-BYTERANGE:") == 0) {
+                    error = "EXT-X-BYTERANGE segments not supported";
+                    return false;
+                } else if (line.compare(0, 11, "#EXT-X-KEY:") == 0) {
+                    if (attribute(line, "METHOD") != "NONE") {
+                        error = "Encrypted segments not supported";
+                        return false;
+                    }
+                } else if (line == "#EXT-X-DISCONTINUITY") {
+                    if (media_segments > 0) {
+                        error = "EXT-X-DISCONTINUITY not supported (segments must come from one recording): " + path;
+                        return false;
+                    }
+                } else if (line == "#EXT-X-ENDLIST") {
+                    *ended = true;
+                } else if (line.compare(0, 18, "#EXT-X-STREAM-INF:") == 0) {
+                    double bandwidth = atof(attribute(line, "BANDWIDTH").c_str());
+                    pending_variant = bandwidth > best_bandwidth;
+                    if (pending_variant) best_bandwidth = bandwidth;
+                }
+                continue;
+            }
+
+            std::string uri;
+            if (!resolve(dir, line, &uri, error)) return false;
+            if (best_bandwidth >= 0) {
+                if (pending_variant) best_variant = uri;
+                pending_variant = false;
+                continue;
+            }
+            Entry entry;
+            entry.path = uri;
+            entry.start = start;
+            entry.duration = std::max(0.0, pending_duration);
+            entries->push_back(entry);
+            start += entry.duration;
+            pending_duration = -1;
+            media_segments++;
+        }
+
+        // 主播放列表：打开带宽最高的变体
+        if (best_bandwidth >= 0) {
+            if (best_variant.empty() || depth > 0) {
+                error = "Invalid master playlist: " + path;
+                return false;
+            }
+            return parse(best_variant, entries, ended, error, depth + 1);
+        }
+        return true;
+    }
+};
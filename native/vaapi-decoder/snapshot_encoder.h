@@ -0,0 +1,182 @@
+/**
+ * 帧快照导出
+ * 在工作线程中将 NV12 帧转换并编码为 PNG/JPEG，不占用 JS 主线程
+ */
+#pragma once
+
+#include <napi.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+class SnapshotEncoder {
+public:
+    // 编码一帧 NV12 数据，format 为 "png" 或 "jpeg"，quality 范围 1-100
+    static bool encode(const uint8_t* nv12, int width, int height,
+                       const std::string& format, int quality,
+                       std::vector<uint8_t>& out, std::string& error) {
+        bool is_png = (format == "png");
+        bool is_jpeg = (format == "jpeg" || format == "jpg");
+        if (!is_png && !is_jpeg) {
+            error = "Unsupported snapshot format: " + format;
+            return false;
+        }
+        if (quality < 1) quality = 1;
+        if (quality > 100) quality = 100;
+
+        const AVCodec* codec = avcodec_find_encoder(is_png ? AV_CODEC_ID_PNG : AV_CODEC_ID_MJPEG);
+        if (!codec) {
+            error = "Image encoder not available";
+            return false;
+        }
+
+        AVPixelFormat dst_fmt = is_png ? AV_PIX_FMT_RGB24 : AV_PIX_FMT_YUVJ420P;
+        AVCodecContext* ctx = avcodec_alloc_context3(codec);
+        AVFrame* dst = av_frame_alloc();
+        AVPacket* pkt = av_packet_alloc();
+        SwsContext* sws = nullptr;
+        bool ok = false;
+
+        do {
+            if (!ctx || !dst || !pkt) {
+                error = "Out of memory";
+                break;
+            }
+
+            ctx->width = width;
+            ctx->height = height;
+            ctx->pix_fmt = dst_fmt;
+            ctx->time_base = AVRational{1, 25};
+            if (is_jpeg) {
+                // quality 1-100 映射到 qscale 31-2
+                int qscale = 31 - (quality - 1) * 29 / 99;
+                ctx->flags |= AV_CODEC_FLAG_QSCALE;
+                ctx->global_quality = FF_QP2LAMBDA * qscale;
+                ctx->qmin = ctx->qmax = qscale;
+            } else {
+                // PNG 无损，quality 越低压缩等级越高
+                ctx->compression_level = (100 - quality) * 9 / 99;
+            }
+
+            if (avcodec_open2(ctx, codec, nullptr) < 0) {
+                error = "Failed to open image encoder";
+                break;
+            }
+
+            dst->format = dst_fmt;
+            dst->width = width;
+            dst->height = height;
+            if (av_frame_get_buffer(dst, 0) < 0) {
+                error = "Failed to allocate snapshot frame";
+                break;
+            }
+            if (is_jpeg) {
+                dst->quality = ctx->global_quality;
+            }
+
+            sws = sws_getContext(width, height, AV_PIX_FMT_NV12,
+                                 width, height, dst_fmt,
+                                 SWS_BILINEAR, nullptr, nullptr, nullptr);
+            if (!sws) {
+                error = "Failed to create color converter";
+                break;
+            }
+
+            const uint8_t* src_data[4] = { nv12, nv12 + (size_t)width * height, nullptr, nullptr };
+            int src_linesize[4] = { width, width, 0, 0 };
+            sws_scale(sws, src_data, src_linesize, 0, height, dst->data, dst->linesize);
+
+            if (avcodec_send_frame(ctx, dst) < 0 || avcodec_send_frame(ctx, nullptr) < 0) {
+                error = "Failed to encode snapshot";
+                break;
+            }
+
+            out.clear();
+            while (avcodec_receive_packet(ctx, pkt) == 0) {
+                out.insert(out.end(), pkt->data, pkt->data + pkt->size);
+                av_packet_unref(pkt);
+            }
+            if (out.empty()) {
+                error = "Encoder produced no output";
+                break;
+            }
+            ok = true;
+        } while (false);
+
+        if (sws) sws_freeContext(sws);
+        if (pkt) av_packet_free(&pkt);
+        if (dst) av_frame_free(&dst);
+        if (ctx) avcodec_free_context(&ctx);
+        return ok;
+    }
+};
+
+// 快照异步任务：在 libuv 线程池执行，完成后 resolve Promise
+class SnapshotWorker : public Napi::AsyncWorker {
+public:
+    // 帧数据总是复制一份：调用方的 Buffer（如 decodeFrameInto 复用的 target）在编码完成前
+    // 可能已被下一帧覆盖
+    SnapshotWorker(Napi::Env env, std::vector<uint8_t>&& nv12, int width, int height,
+                   const std::string& format, int quality, const std::string& output_path)
+        : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)),
+          nv12_(std::move(nv12)), width_(width), height_(height),
+          format_(format), quality_(quality), output_path_(output_path) {
+    }
+
+    Napi::Promise Promise() const {
+        return deferred_.Promise();
+    }
+
+protected:
+    void Execute() override {
+        std::string error;
+        if (!SnapshotEncoder::encode(nv12_.data(), width_, height_, format_, quality_, encoded_, error)) {
+            SetError(error);
+            return;
+        }
+
+        if (!output_path_.empty()) {
+            FILE* fp = fopen(output_path_.c_str(), "wb");
+            if (!fp) {
+                SetError("Failed to open output file: " + output_path_);
+                return;
+            }
+            size_t written = fwrite(encoded_.data(), 1, encoded_.size(), fp);
+            fclose(fp);
+            if (written != encoded_.size()) {
+                SetError("Failed to write output file: " + output_path_);
+            }
+        }
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        if (!output_path_.empty()) {
+            deferred_.Resolve(Napi::String::New(env, output_path_));
+        } else {
+            deferred_.Resolve(Napi::Buffer<uint8_t>::Copy(env, encoded_.data(), encoded_.size()));
+        }
+    }
+
+    void OnError(const Napi::Error& e) override {
+        deferred_.Reject(e.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::vector<uint8_t> nv12_;
+    int width_;
+    int height_;
+    std::string format_;
+    int quality_;
+    std::string output_path_;
+    std::vector<uint8_t> encoded_;
+};
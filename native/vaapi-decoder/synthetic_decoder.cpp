@@ -0,0 +1,239 @@
+/**
+ * Synthetic Video Decoder
+ * 与 VaapiDecoder 接口一致的空解码器，输出合成 NV12 帧，不链接任何媒体库
+ */
+#include <napi.h>
+
+#include <memory>
+#include <string>
+
+#include "frame_result.h"
+#include "synthetic_source.h"
+
+// ================ N-API 绑定 ================
+
+class SyntheticDecoderWrapper : public Napi::ObjectWrap<SyntheticDecoderWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "SyntheticDecoder", {
+            InstanceMethod("configure", &SyntheticDecoderWrapper::Configure),
+            InstanceMethod("initFromFile", &SyntheticDecoderWrapper::InitFromFile),
+            InstanceMethod("initFromBuffer", &SyntheticDecoderWrapper::InitFromBuffer),
+            InstanceMethod("decodeFrame", &SyntheticDecoderWrapper::DecodeFrame),
+            InstanceMethod("decodePacket", &SyntheticDecoderWrapper::DecodePacket),
+            InstanceMethod("decodeFrameInto", &SyntheticDecoderWrapper::DecodeFrameInto),
+            InstanceMethod("decodePacketInto", &SyntheticDecoderWrapper::DecodePacketInto),
+            InstanceMethod("getVideoInfo", &SyntheticDecoderWrapper::GetVideoInfo),
+            InstanceMethod("getLastError", &SyntheticDecoderWrapper::GetLastError),
+            InstanceMethod("seek", &SyntheticDecoderWrapper::Seek),
+            InstanceMethod("getDuration", &SyntheticDecoderWrapper::GetDuration),
+            InstanceMethod("getStats", &SyntheticDecoderWrapper::GetStats),
+            InstanceMethod("close", &SyntheticDecoderWrapper::Close),
+        });
+
+        exports.Set("SyntheticDecoder", func);
+        return exports;
+    }
+
+    SyntheticDecoderWrapper(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<SyntheticDecoderWrapper>(info) {
+        source_ = std::make_unique<SyntheticFrameSource>();
+    }
+
+private:
+    std::unique_ptr<SyntheticFrameSource> source_;
+    SyntheticFrameSource::Config config_;
+    std::unique_ptr<FrameResultWriter> writer_;
+
+    FrameResultWriter& writer(Napi::Env env) {
+        if (!writer_) {
+            writer_ = std::make_unique<FrameResultWriter>(env);
+        }
+        return *writer_;
+    }
+
+    void resetWriter() {
+        if (writer_) {
+            writer_->reset();
+        }
+    }
+
+    bool nextFrame(FrameResultWriter::Frame* frame) {
+        if (!source_->nextFrame(&frame->data, &frame->size, &frame->pts)) {
+            return false;
+        }
+        frame->width = source_->config().width;
+        frame->height = source_->config().height;
+        return true;
+    }
+
+    // 设置后续 init 使用的参数: { width, height, fps, costMs, costMode, frames, realtime }
+    Napi::Value Configure(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Object opts = info[0].As<Napi::Object>();
+        if (opts.Get("width").IsNumber()) config_.width = opts.Get("width").As<Napi::Number>().Int32Value();
+        if (opts.Get("height").IsNumber()) config_.height = opts.Get("height").As<Napi::Number>().Int32Value();
+        if (opts.Get("fps").IsNumber()) config_.fps = opts.Get("fps").As<Napi::Number>().DoubleValue();
+        if (opts.Get("costMs").IsNumber()) config_.cost_ms = opts.Get("costMs").As<Napi::Number>().DoubleValue();
+        if (opts.Get("costMode").IsString()) {
+            config_.cost_mode = opts.Get("costMode").As<Napi::String>().Utf8Value() == "sleep"
+                                    ? SyntheticFrameSource::COST_SLEEP
+                                    : SyntheticFrameSource::COST_SPIN;
+        }
+        if (opts.Get("frames").IsNumber()) config_.frame_count = opts.Get("frames").As<Napi::Number>().Int64Value();
+        if (opts.Get("realtime").IsBoolean()) config_.realtime = opts.Get("realtime").As<Napi::Boolean>().Value();
+
+        return Napi::Boolean::New(env, true);
+    }
+
+    // 文件名为 synthetic:// URI 时按 URI 参数生成，其他路径使用 configure() 的参数
+    Napi::Value InitFromFile(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected filename string").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        SyntheticFrameSource::Config config = config_;
+        SyntheticFrameSource::parseUri(info[0].As<Napi::String>().Utf8Value(), &config);
+        resetWriter();
+        return Napi::Boolean::New(env, source_->open(config));
+    }
+
+    // 忽略缓冲区内容，之后每个 decodePacket 输出一帧
+    Napi::Value InitFromBuffer(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsString()) {
+            Napi::TypeError::New(env, "Expected (buffer, codec_name)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        resetWriter();
+        return Napi::Boolean::New(env, source_->open(config_));
+    }
+
+    Napi::Value frameResult(Napi::Env env) {
+        FrameResultWriter::Frame frame;
+        if (!nextFrame(&frame)) {
+            return env.Null();
+        }
+        // 与 VaapiDecoder 相同，复制到 Node.js Buffer
+        return writer(env).toObject(env, frame, true);
+    }
+
+    Napi::Value frameInto(const Napi::CallbackInfo& info, size_t first) {
+        Napi::Env env = info.Env();
+
+        Napi::Uint8Array target;
+        Napi::Float64Array meta;
+        if (!FrameResultWriter::parseTargets(info, first, &target, &meta)) {
+            return env.Null();
+        }
+
+        FrameResultWriter& out = writer(env);
+        FrameResultWriter::Frame frame;
+        if (!out.takePending(&frame) && !nextFrame(&frame)) {
+            return Napi::Number::New(env, FRAME_INTO_END);
+        }
+        return Napi::Number::New(env, out.writeInto(frame, target, meta));
+    }
+
+    Napi::Value DecodeFrame(const Napi::CallbackInfo& info) {
+        return frameResult(info.Env());
+    }
+
+    Napi::Value DecodePacket(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsBuffer()) {
+            Napi::TypeError::New(env, "Expected packet buffer").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return frameResult(env);
+    }
+
+    // (target, meta)，返回写入字节数或 FrameIntoResult
+    Napi::Value DecodeFrameInto(const Napi::CallbackInfo& info) {
+        return frameInto(info, 0);
+    }
+
+    // (packet, target, meta)
+    Napi::Value DecodePacketInto(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsBuffer()) {
+            Napi::TypeError::New(env, "Expected packet buffer").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return frameInto(info, 1);
+    }
+
+    Napi::Value GetVideoInfo(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!source_->isOpen()) {
+            return env.Null();
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("width", Napi::Number::New(env, source_->config().width));
+        result.Set("height", Napi::Number::New(env, source_->config().height));
+        result.Set("codec", Napi::String::New(env, "synthetic"));
+        result.Set("fps", Napi::Number::New(env, source_->config().fps));
+        return result;
+    }
+
+    Napi::Value GetLastError(const Napi::CallbackInfo& info) {
+        return Napi::String::New(info.Env(), source_->lastError());
+    }
+
+    Napi::Value Seek(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected seconds number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        resetWriter();
+        return Napi::Boolean::New(env, source_->seek(info[0].As<Napi::Number>().DoubleValue()));
+    }
+
+    Napi::Value GetDuration(const Napi::CallbackInfo& info) {
+        return Napi::Number::New(info.Env(), source_->duration());
+    }
+
+    // { frames, lateFrames, avgGenerateMs, costMs, elapsed }
+    Napi::Value GetStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        SyntheticFrameSource::Stats stats = source_->stats();
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("frames", Napi::Number::New(env, (double)stats.frames));
+        result.Set("lateFrames", Napi::Number::New(env, (double)stats.late_frames));
+        result.Set("avgGenerateMs", Napi::Number::New(env, stats.avg_generate_ms));
+        result.Set("costMs", Napi::Number::New(env, source_->config().cost_ms));
+        result.Set("elapsed", Napi::Number::New(env, stats.elapsed_sec));
+        return result;
+    }
+
+    Napi::Value Close(const Napi::CallbackInfo& info) {
+        resetWriter();
+        source_->close();
+        return info.Env().Undefined();
+    }
+};
+
+// 模块初始化
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    SyntheticDecoderWrapper::Init(env, exports);
+    return exports;
+}
+
+NODE_API_MODULE(synthetic_decoder, Init)
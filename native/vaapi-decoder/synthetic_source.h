@@ -0,0 +1,289 @@
+/**
+ * 合成帧源
+ * 不依赖任何媒体库，按配置的分辨率、帧率和人为耗时生成 NV12 帧，
+ * 用于在没有解码器的机器上测量队列、拷贝、N-API、共享内存和渲染本身的开销
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+class SyntheticFrameSource {
+public:
+    enum CostMode {
+        COST_SPIN = 0,    // 占用 CPU，模拟软解
+        COST_SLEEP,       // 让出 CPU，模拟等待硬件
+    };
+
+    struct Config {
+        int width = 1920;
+        int height = 1080;
+        double fps = 30;
+        double cost_ms = 0;       // 每帧人为耗时
+        CostMode cost_mode = COST_SPIN;
+        int64_t frame_count = 0;  // 0 表示无限
+        bool realtime = true;     // 按帧率节奏输出，否则尽快输出
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t late_frames = 0;     // 输出晚于节奏时间的帧
+        double avg_generate_ms = 0;   // 不含人为耗时
+        double elapsed_sec = 0;
+    };
+
+    // 解析 synthetic://1920x1080@60?cost=2.5&frames=600&mode=sleep&realtime=0
+    static bool parseUri(const std::string& uri, Config* config) {
+        const std::string prefix = "synthetic://";
+        if (uri.compare(0, prefix.size(), prefix) != 0) return false;
+
+        std::string spec = uri.substr(prefix.size());
+        std::string query;
+        size_t q = spec.find('?');
+        if (q != std::string::npos) {
+            query = spec.substr(q + 1);
+            spec = spec.substr(0, q);
+        }
+
+        int w = 0, h = 0;
+        double fps = 0;
+        size_t at = spec.find('@');
+        if (sscanf(spec.c_str(), "%dx%d", &w, &h) == 2 && w > 0 && h > 0) {
+            config->width = w;
+            config->height = h;
+        }
+        if (at != std::string::npos && (fps = atof(spec.c_str() + at + 1)) > 0) {
+            config->fps = fps;
+        }
+
+        size_t pos = 0;
+        while (pos < query.size()) {
+            size_t end = query.find('&', pos);
+            if (end == std::string::npos) end = query.size();
+            std::string item = query.substr(pos, end - pos);
+            size_t eq = item.find('=');
+            if (eq != std::string::npos) {
+                std::string key = item.substr(0, eq);
+                std::string value = item.substr(eq + 1);
+                if (key == "cost") config->cost_ms = atof(value.c_str());
+                else if (key == "frames") config->frame_count = atoll(value.c_str());
+                else if (key == "mode") config->cost_mode = value == "sleep" ? COST_SLEEP : COST_SPIN;
+                else if (key == "realtime") config->realtime = value != "0" && value != "false";
+            }
+            pos = end + 1;
+        }
+        return true;
+    }
+
+    bool open(const Config& config) {
+        if (config.width <= 0 || config.height <= 0 || config.fps <= 0) {
+            last_error_ = "Invalid synthetic source configuration";
+            return false;
+        }
+        config_ = config;
+        // NV12 要求偶数尺寸
+        config_.width &= ~1;
+        config_.height &= ~1;
+        buildPattern();
+        last_block_x_ = -1;
+        last_block_y_ = -1;
+        frame_index_ = 0;
+        stats_ = Stats();
+        generate_time_us_ = 0;
+        start_time_ = std::chrono::steady_clock::now();
+        open_time_ = start_time_;
+        pace_base_index_ = 0;
+        opened_ = true;
+        return true;
+    }
+
+    // 生成下一帧，帧数用尽返回 false。数据在下一次调用前有效
+    bool nextFrame(const uint8_t** data, size_t* size, double* pts) {
+        if (!opened_) return false;
+        if (config_.frame_count > 0 && frame_index_ >= config_.frame_count) return false;
+
+        double frame_pts = frame_index_ / config_.fps;
+        if (config_.realtime) {
+            double due = (frame_index_ - pace_base_index_) / config_.fps;
+            double now = secondsSince(start_time_);
+            if (now < due) {
+                std::this_thread::sleep_for(std::chrono::duration<double>(due - now));
+            } else if (now - due > 1.0 / config_.fps) {
+                stats_.late_frames++;
+            }
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        renderFrame(frame_index_);
+        generate_time_us_ += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+
+        simulateCost();
+
+        *data = frame_.data();
+        *size = frame_.size();
+        *pts = frame_pts;
+        frame_index_++;
+        stats_.frames++;
+        return true;
+    }
+
+    // 跳转后从目标时间所在帧继续，节奏时钟重新计时
+    bool seek(double seconds) {
+        if (!opened_) return false;
+        int64_t index = (int64_t)(seconds * config_.fps + 0.5);
+        if (index < 0) index = 0;
+        if (config_.frame_count > 0 && index > config_.frame_count) index = config_.frame_count;
+        frame_index_ = index;
+        pace_base_index_ = index;
+        start_time_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void close() {
+        opened_ = false;
+        frame_.clear();
+        frame_.shrink_to_fit();
+        pattern_.clear();
+        pattern_.shrink_to_fit();
+    }
+
+    bool isOpen() const { return opened_; }
+    const Config& config() const { return config_; }
+    const std::string& lastError() const { return last_error_; }
+    double duration() const { return config_.frame_count > 0 ? config_.frame_count / config_.fps : 0; }
+    double currentPts() const { return frame_index_ > 0 ? (frame_index_ - 1) / config_.fps : 0; }
+
+    Stats stats() const {
+        Stats s = stats_;
+        s.elapsed_sec = opened_ ? secondsSince(open_time_) : 0;
+        if (s.frames > 0) s.avg_generate_ms = generate_time_us_ / 1000.0 / s.frames;
+        return s;
+    }
+
+private:
+    static constexpr int kBlock = 64;    // 移动方块边长
+
+    Config config_;
+    bool opened_ = false;
+    int64_t frame_index_ = 0;
+    int64_t pace_base_index_ = 0;
+    int last_block_x_ = -1;
+    int last_block_y_ = -1;
+    std::vector<uint8_t> pattern_;       // 静态背景，只生成一次
+    std::vector<uint8_t> frame_;
+    Stats stats_;
+    uint64_t generate_time_us_ = 0;
+    std::chrono::steady_clock::time_point start_time_;   // 节奏时钟起点，seek 后重置
+    std::chrono::steady_clock::time_point open_time_;
+    std::string last_error_;
+
+    static double secondsSince(std::chrono::steady_clock::time_point t) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+    }
+
+    // 背景：横向亮度渐变 + 竖向色彩条
+    void buildPattern() {
+        int w = config_.width, h = config_.height;
+        pattern_.resize((size_t)w * h * 3 / 2);
+        uint8_t* y = pattern_.data();
+        for (int row = 0; row < h; row++) {
+            for (int x = 0; x < w; x++) {
+                y[(size_t)row * w + x] = (uint8_t)(16 + x * 219 / w);
+            }
+        }
+        static const uint8_t kBars[8][2] = {
+            {128, 128}, {16, 146}, {166, 16}, {54, 34}, {202, 222}, {90, 240}, {240, 110}, {128, 128},
+        };
+        uint8_t* uv = y + (size_t)w * h;
+        for (int row = 0; row < h / 2; row++) {
+            for (int x = 0; x < w / 2; x++) {
+                const uint8_t* bar = kBars[x * 8 / (w / 2)];
+                uv[(size_t)row * w + x * 2] = bar[0];
+                uv[(size_t)row * w + x * 2 + 1] = bar[1];
+            }
+        }
+        frame_ = pattern_;
+    }
+
+    // 每帧只恢复上一帧方块位置并画新位置，生成成本与分辨率基本无关
+    void renderFrame(int64_t index) {
+        int w = config_.width, h = config_.height;
+        int block = std::min(kBlock, std::min(w, h)) & ~1;
+        if (last_block_x_ >= 0) restoreBlock(last_block_x_, last_block_y_, block);
+
+        int bx = blockX(index, block), by = blockY(index, block);
+        last_block_x_ = bx;
+        last_block_y_ = by;
+        uint8_t luma = (uint8_t)(235 - (index % 64) * 2);
+        for (int row = 0; row < block; row++) {
+            memset(&frame_[(size_t)(by + row) * w + bx], luma, block);
+        }
+        uint8_t* uv = frame_.data() + (size_t)w * h;
+        for (int row = 0; row < block / 2; row++) {
+            uint8_t* p = &uv[(size_t)(by / 2 + row) * w + bx];
+            for (int x = 0; x < block / 2; x++) {
+                p[x * 2] = 128;
+                p[x * 2 + 1] = 128;
+            }
+        }
+
+        // 左上角写入帧序号（32 位，每位 8 像素宽），供下游校验顺序和丢帧
+        uint32_t counter = (uint32_t)index;
+        int bit_w = std::min(8, w / 32);
+        for (int row = 0; row < std::min(8, h); row++) {
+            uint8_t* p = &frame_[(size_t)row * w];
+            for (int bit = 0; bit < 32; bit++) {
+                memset(p + bit * bit_w, (counter >> (31 - bit)) & 1 ? 235 : 16, bit_w);
+            }
+        }
+    }
+
+    int blockX(int64_t index, int block) const {
+        int range = config_.width - block;
+        if (range <= 0 || index < 0) return 0;
+        int64_t t = (index * 8) % (2 * range);
+        return ((int)(t < range ? t : 2 * range - t)) & ~1;
+    }
+
+    int blockY(int64_t index, int block) const {
+        int range = config_.height - block;
+        if (range <= 0 || index < 0) return 0;
+        int64_t t = (index * 4) % (2 * range);
+        return ((int)(t < range ? t : 2 * range - t)) & ~1;
+    }
+
+    void restoreBlock(int bx, int by, int block) {
+        int w = config_.width, h = config_.height;
+        for (int row = 0; row < block; row++) {
+            size_t offset = (size_t)(by + row) * w + bx;
+            memcpy(&frame_[offset], &pattern_[offset], block);
+        }
+        size_t uv_base = (size_t)w * h;
+        for (int row = 0; row < block / 2; row++) {
+            size_t offset = uv_base + (size_t)(by / 2 + row) * w + bx;
+            memcpy(&frame_[offset], &pattern_[offset], block);
+        }
+    }
+
+    void simulateCost() {
+        if (config_.cost_ms <= 0) return;
+        auto cost = std::chrono::duration<double, std::milli>(config_.cost_ms);
+        if (config_.cost_mode == COST_SLEEP) {
+            std::this_thread::sleep_for(cost);
+            return;
+        }
+        auto end = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::nanoseconds>(cost);
+        volatile uint32_t sink = 0;
+        while (std::chrono::steady_clock::now() < end) {
+            for (int i = 0; i < 256; i++) sink = sink * 1664525u + 1013904223u;
+        }
+    }
+};
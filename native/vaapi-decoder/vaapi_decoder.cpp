@@ -3,574 +3,888 @@
  * 支持 H264/H265 硬件解码，输出 NV12 格式
  */
 #include <napi.h>
-#include <va/va.h>
-#include <va/va_drm.h>
-#include <fcntl.h>
-#include <unistd.h>
-
-extern "C" {
-#include <libavcodec/avcodec.h>
-#include <libavformat/avformat.h>
-#include <libavutil/hwcontext.h>
-#include <libavutil/hwcontext_vaapi.h>
-#include <libavutil/pixdesc.h>
-}
 
 #include <memory>
 #include <string>
 #include <cstring>
 
-class VaapiDecoder {
-private:
-    AVFormatContext* fmt_ctx = nullptr;
-    AVCodecContext* codec_ctx = nullptr;
-    AVBufferRef* hw_device_ctx = nullptr;
-    AVFrame* frame = nullptr;
-    AVFrame* sw_frame = nullptr;
-    AVPacket* packet = nullptr;
-    
-    int video_stream_idx = -1;
-    int drm_fd = -1;
-    bool initialized = false;
-    bool use_hw_accel = true;  // 是否使用硬件加速
-    std::string last_error;     // 最后的错误信息
-    
-    // NV12 输出缓冲
-    std::unique_ptr<uint8_t[]> nv12_buffer;
-    size_t nv12_buffer_size = 0;
+#include "vaapi_decoder.h"
+#include "snapshot_encoder.h"
+#include "frame_recorder.h"
+#include "proxy_transcoder.h"
+#include "fmp4_remuxer.h"
+#include "packet_demuxer.h"
+#include "presentation_clock.h"
+#include "multi_track_decoder.h"
+#include "raw_video_source.h"
+#include "image_sequence_source.h"
+#include "quality_metrics.h"
+#include "clip_exporter.h"
+#include "frame_result.h"
+#include "work_pool_binding.h"
+
+// ================ N-API 绑定 ================
 
+class VaapiDecoderWrapper : public Napi::ObjectWrap<VaapiDecoderWrapper> {
 public:
-    VaapiDecoder() {
-        frame = av_frame_alloc();
-        sw_frame = av_frame_alloc();
-        packet = av_packet_alloc();
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "VaapiDecoder", {
+            InstanceMethod("initFromFile", &VaapiDecoderWrapper::InitFromFile),
+            InstanceMethod("initFromBuffer", &VaapiDecoderWrapper::InitFromBuffer),
+            InstanceMethod("decodeFrame", &VaapiDecoderWrapper::DecodeFrame),
+            InstanceMethod("decodePacket", &VaapiDecoderWrapper::DecodePacket),
+            InstanceMethod("decodeFrameInto", &VaapiDecoderWrapper::DecodeFrameInto),
+            InstanceMethod("decodePacketInto", &VaapiDecoderWrapper::DecodePacketInto),
+            InstanceMethod("getVideoInfo", &VaapiDecoderWrapper::GetVideoInfo),
+            InstanceMethod("getLastError", &VaapiDecoderWrapper::GetLastError),
+            InstanceMethod("enableSceneDetection", &VaapiDecoderWrapper::EnableSceneDetection),
+            InstanceMethod("disableSceneDetection", &VaapiDecoderWrapper::DisableSceneDetection),
+            InstanceMethod("enableBitstreamStats", &VaapiDecoderWrapper::EnableBitstreamStats),
+            InstanceMethod("disableBitstreamStats", &VaapiDecoderWrapper::DisableBitstreamStats),
+            InstanceMethod("flushBitstreamStats", &VaapiDecoderWrapper::FlushBitstreamStats),
+            InstanceMethod("enableMotionAnalysis", &VaapiDecoderWrapper::EnableMotionAnalysis),
+            InstanceMethod("disableMotionAnalysis", &VaapiDecoderWrapper::DisableMotionAnalysis),
+            InstanceMethod("analyzeMotion", &VaapiDecoderWrapper::AnalyzeMotion),
+            InstanceMethod("getMotionMap", &VaapiDecoderWrapper::GetMotionMap),
+            InstanceMethod("setOverlay", &VaapiDecoderWrapper::SetOverlay),
+            InstanceMethod("setDecodeProfile", &VaapiDecoderWrapper::SetDecodeProfile),
+            InstanceMethod("setFormatChangeCallback", &VaapiDecoderWrapper::SetFormatChangeCallback),
+            InstanceMethod("reserveOutput", &VaapiDecoderWrapper::ReserveOutput),
+            InstanceMethod("attachFrameCache", &VaapiDecoderWrapper::AttachFrameCache),
+            InstanceMethod("detachFrameCache", &VaapiDecoderWrapper::DetachFrameCache),
+            InstanceMethod("readCachedFrame", &VaapiDecoderWrapper::ReadCachedFrame),
+            InstanceMethod("snapshot", &VaapiDecoderWrapper::Snapshot),
+            InstanceMethod("seek", &VaapiDecoderWrapper::Seek),
+            InstanceMethod("getDuration", &VaapiDecoderWrapper::GetDuration),
+            InstanceMethod("configureIo", &VaapiDecoderWrapper::ConfigureIo),
+            InstanceMethod("getStats", &VaapiDecoderWrapper::GetStats),
+            InstanceMethod("close", &VaapiDecoderWrapper::Close),
+        });
+
+        Napi::FunctionReference* constructor = new Napi::FunctionReference();
+        *constructor = Napi::Persistent(func);
+        env.SetInstanceData(constructor);
+
+        exports.Set("VaapiDecoder", func);
+        return exports;
     }
 
-    ~VaapiDecoder() {
-        cleanup();
-        if (frame) av_frame_free(&frame);
-        if (sw_frame) av_frame_free(&sw_frame);
-        if (packet) av_packet_free(&packet);
+    VaapiDecoderWrapper(const Napi::CallbackInfo& info) 
+        : Napi::ObjectWrap<VaapiDecoderWrapper>(info) {
+        decoder_ = std::make_unique<VaapiDecoder>();
     }
 
-    void cleanup() {
-        if (codec_ctx) {
-            avcodec_free_context(&codec_ctx);
-            codec_ctx = nullptr;
-        }
-        if (fmt_ctx) {
-            avformat_close_input(&fmt_ctx);
-            fmt_ctx = nullptr;
-        }
-        if (hw_device_ctx) {
-            av_buffer_unref(&hw_device_ctx);
-            hw_device_ctx = nullptr;
-        }
-        if (drm_fd >= 0) {
-            close(drm_fd);
-            drm_fd = -1;
-        }
-        initialized = false;
+    ~VaapiDecoderWrapper() {
+        // 先停掉检测线程，再释放回调
+        decoder_->disableSceneDetection();
+        releaseSceneCallback();
     }
 
-    // 初始化 VA-API 设备
-    bool initVAAPI(const std::string& device_path = "/dev/dri/renderD128") {
-        // 打开 DRM 设备
-        drm_fd = open(device_path.c_str(), O_RDWR);
-        if (drm_fd < 0) {
-            last_error = "Failed to open DRM device: " + device_path + " (errno: " + std::to_string(errno) + ")";
+private:
+    std::unique_ptr<VaapiDecoder> decoder_;
+    Napi::ThreadSafeFunction scene_tsfn_;
+    bool has_scene_tsfn_ = false;
+    std::unique_ptr<FrameResultWriter> writer_;
+    Napi::FunctionReference stats_callback_;
+    Napi::FunctionReference motion_callback_;
+    Napi::FunctionReference format_callback_;
+    bool in_format_callback_ = false;
+
+    // 第一次输出帧时创建，缓存属性键
+    FrameResultWriter& writer(Napi::Env env) {
+        if (!writer_) {
+            writer_ = std::make_unique<FrameResultWriter>(env);
+        }
+        return *writer_;
+    }
+
+    bool decodeNextFrame(Napi::Env env, FrameResultWriter::Frame* frame) {
+        uint8_t* data = nullptr;
+        if (!decoder_->decodeFrame(&data, &frame->width, &frame->height, &frame->size)) {
             return false;
         }
+        frame->data = data;
+        frame->pts = decoder_->getCurrentPts();
+        notifyFormatChange(env, frame);
+        return true;
+    }
 
-        // 创建 VA-API 硬件设备上下文
-        int ret = av_hwdevice_ctx_create(&hw_device_ctx, AV_HWDEVICE_TYPE_VAAPI,
-                                         device_path.c_str(), nullptr, 0);
-        if (ret < 0) {
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            last_error = "Failed to create VA-API device context: " + std::string(errbuf);
-            close(drm_fd);
-            drm_fd = -1;
+    bool decodeNextPacket(Napi::Env env, const uint8_t* packet, size_t packet_size, FrameResultWriter::Frame* frame) {
+        uint8_t* data = nullptr;
+        if (!decoder_->decodePacket(packet, packet_size, &data, &frame->width, &frame->height, &frame->size)) {
             return false;
         }
+        frame->data = data;
+        frame->pts = decoder_->getCurrentPts();
+        notifyFormatChange(env, frame);
+        return true;
+    }
 
+    // 新分辨率的第一帧交给调用方之前同步回调，消费者可以先调整纹理、缓冲和共享内存；
+    // 每次变化只回调一次（target 太小而保留的帧重试时不再回调）
+    void notifyFormatChange(Napi::Env env, FrameResultWriter::Frame* frame) {
+        int prev_width = 0, prev_height = 0;
+        frame->format_changed = decoder_->formatChanged(&prev_width, &prev_height);
+        if (!frame->format_changed || format_callback_.IsEmpty()) return;
+
+        Napi::Object change = Napi::Object::New(env);
+        change.Set("width", Napi::Number::New(env, frame->width));
+        change.Set("height", Napi::Number::New(env, frame->height));
+        change.Set("previousWidth", Napi::Number::New(env, prev_width));
+        change.Set("previousHeight", Napi::Number::New(env, prev_height));
+        change.Set("size", Napi::Number::New(env, (double)frame->size));
+        change.Set("pts", Napi::Number::New(env, frame->pts));
+        in_format_callback_ = true;
+        format_callback_.Call({change});
+        in_format_callback_ = false;
+    }
+
+    // 分辨率变化回调运行时，帧还没有复制给调用方：解码、seek、close 和 reserveOutput
+    // 会覆盖或释放输出缓冲，在回调中调用时抛出异常
+    bool rejectInFormatCallback(Napi::Env env, const char* method) {
+        if (!in_format_callback_) return false;
+        Napi::Error::New(env, std::string(method) + " cannot be called from the format change callback")
+            .ThrowAsJavaScriptException();
         return true;
     }
 
-    // 初始化解码器（从文件）
-    bool initFromFile(const std::string& filename) {
-        cleanup();
+    // 把积累的码流统计作为一个 Float64Array 交给回调（在解码调用内同步执行）
+    void emitBitstreamStats(Napi::Env env, bool partial = false) {
+        BitstreamStats* stats = decoder_->bitstreamStats();
+        if (!stats || stats_callback_.IsEmpty()) return;
+        if (!(partial ? !stats->empty() : stats->ready())) return;
 
-        // 尝试初始化 VA-API
-        use_hw_accel = initVAAPI();
-        if (!use_hw_accel) {
-            // VA-API 初始化失败，使用软件解码
-            fprintf(stderr, "VA-API initialization failed: %s\n", last_error.c_str());
-            fprintf(stderr, "Falling back to software decoding...\n");
-        }
+        std::vector<double> records = stats->take();
+        Napi::Float64Array batch = Napi::Float64Array::New(env, records.size());
+        memcpy(batch.Data(), records.data(), records.size() * sizeof(double));
+        stats_callback_.Call({batch});
+    }
 
-        // 检查文件是否存在
-        if (access(filename.c_str(), F_OK) != 0) {
-            last_error = "File does not exist: " + filename;
-            fprintf(stderr, "Error: %s\n", last_error.c_str());
-            return false;
-        }
-        
-        if (access(filename.c_str(), R_OK) != 0) {
-            last_error = "File not readable (permission denied): " + filename;
-            fprintf(stderr, "Error: %s\n", last_error.c_str());
-            return false;
+    // 把积累的运动事件逐个交给回调（在解码调用内同步执行）
+    void emitMotionEvents(Napi::Env env) {
+        MotionAnalyzer* analyzer = decoder_->motionAnalyzer();
+        if (!analyzer || !analyzer->hasEvents()) return;
+
+        static const char* kTypes[] = {"start", "update", "end"};
+        std::vector<MotionEvent> events = analyzer->takeEvents();
+        if (motion_callback_.IsEmpty()) return;
+        for (const MotionEvent& e : events) {
+            Napi::Object event = Napi::Object::New(env);
+            event.Set("type", Napi::String::New(env, kTypes[e.type]));
+            event.Set("pts", Napi::Number::New(env, e.pts));
+            event.Set("frameIndex", Napi::Number::New(env, (double)e.frame_index));
+            event.Set("energy", Napi::Number::New(env, e.energy));
+            event.Set("area", Napi::Number::New(env, e.area));
+            Napi::Object box = Napi::Object::New(env);
+            box.Set("x", Napi::Number::New(env, e.x));
+            box.Set("y", Napi::Number::New(env, e.y));
+            box.Set("width", Napi::Number::New(env, e.w));
+            box.Set("height", Napi::Number::New(env, e.h));
+            event.Set("box", box);
+            motion_callback_.Call({event});
         }
+    }
 
-        // 打开输入文件 - 使用 nullptr options 来使用默认协议
-        AVDictionary* options = nullptr;
-        int ret = avformat_open_input(&fmt_ctx, filename.c_str(), nullptr, &options);
-        if (ret < 0) {
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            last_error = "Failed to open file: " + filename + " - " + std::string(errbuf);
-            fprintf(stderr, "Error opening file: %s (ret=%d)\n", last_error.c_str(), ret);
-            fprintf(stderr, "FFmpeg error: %s\n", errbuf);
-            
-            // 列出可用的协议
-            void* opaque = nullptr;
-            const char* protocol_name;
-            fprintf(stderr, "Available input protocols: ");
-            while ((protocol_name = avio_enum_protocols(&opaque, 0)) != nullptr) {
-                fprintf(stderr, "%s ", protocol_name);
-            }
-            fprintf(stderr, "\n");
-            
-            if (options) {
-                av_dict_free(&options);
-            }
-            return false;
-        }
-        
-        if (options) {
-            av_dict_free(&options);
+    // 输出缓冲失效时丢弃未取走的帧
+    void resetWriter() {
+        if (writer_) {
+            writer_->reset();
         }
+    }
 
-        // 查找流信息
-        if (avformat_find_stream_info(fmt_ctx, nullptr) < 0) {
-            last_error = "Failed to find stream info";
-            cleanup();
-            return false;
+    void releaseSceneCallback() {
+        if (has_scene_tsfn_) {
+            scene_tsfn_.Release();
+            has_scene_tsfn_ = false;
         }
+    }
 
-        // 查找视频流
-        const AVCodec* decoder = nullptr;
-        video_stream_idx = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, &decoder, 0);
-        if (video_stream_idx < 0) {
-            last_error = "No video stream found";
-            cleanup();
-            return false;
+    // 从文件初始化
+    Napi::Value InitFromFile(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (rejectInFormatCallback(env, "initFromFile")) {
+            return env.Null();
         }
 
-        // 创建解码器上下文
-        codec_ctx = avcodec_alloc_context3(decoder);
-        if (!codec_ctx) {
-            last_error = "Failed to allocate codec context";
-            cleanup();
-            return false;
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected filename string").ThrowAsJavaScriptException();
+            return env.Null();
         }
 
-        // 复制流参数到解码器上下文
-        if (avcodec_parameters_to_context(codec_ctx, fmt_ctx->streams[video_stream_idx]->codecpar) < 0) {
-            last_error = "Failed to copy codec parameters";
-            cleanup();
-            return false;
-        }
+        std::string filename = info[0].As<Napi::String>().Utf8Value();
+        resetWriter();
+        bool success = decoder_->initFromFile(filename);
 
-        // 如果使用硬件加速，设置硬件设备上下文
-        if (use_hw_accel && hw_device_ctx) {
-            codec_ctx->hw_device_ctx = av_buffer_ref(hw_device_ctx);
-            codec_ctx->get_format = get_hw_format;
+        return Napi::Boolean::New(env, success);
+    }
+
+    // 从缓冲区初始化
+    Napi::Value InitFromBuffer(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (rejectInFormatCallback(env, "initFromBuffer")) {
+            return env.Null();
         }
 
-        // 打开解码器
-        if (avcodec_open2(codec_ctx, decoder, nullptr) < 0) {
-            last_error = "Failed to open decoder";
-            cleanup();
-            return false;
+        if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsString()) {
+            Napi::TypeError::New(env, "Expected (buffer, codec_name)").ThrowAsJavaScriptException();
+            return env.Null();
         }
 
-        initialized = true;
-        fprintf(stderr, "Decoder initialized successfully (HW accel: %s)\n", use_hw_accel ? "YES" : "NO");
-        return true;
+        Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+        std::string codec_name = info[1].As<Napi::String>().Utf8Value();
+
+        resetWriter();
+        bool success = decoder_->initFromBuffer(buffer.Data(), buffer.Length(), codec_name);
+
+        return Napi::Boolean::New(env, success);
     }
 
-    // 初始化解码器（从内存数据）
-    bool initFromBuffer(const uint8_t* data, size_t size, const std::string& codec_name) {
-        cleanup();
+    // 解码一帧（从文件）
+    Napi::Value DecodeFrame(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (rejectInFormatCallback(env, "decodeFrame")) {
+            return env.Null();
+        }
 
-        // 初始化 VA-API
-        if (!initVAAPI()) {
-            return false;
+        FrameResultWriter::Frame frame;
+        if (!decodeNextFrame(env, &frame)) {
+            return env.Null();
         }
 
-        // 查找解码器
-        const AVCodec* decoder = avcodec_find_decoder_by_name(codec_name.c_str());
-        if (!decoder) {
-            cleanup();
-            return false;
+        // 复制数据到 Node.js Buffer
+        Napi::Object result = writer(env).toObject(env, frame, true);
+        emitBitstreamStats(env);
+        emitMotionEvents(env);
+        return result;
+    }
+
+    // 解码数据包（从内存）
+    Napi::Value DecodePacket(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (rejectInFormatCallback(env, "decodePacket")) {
+            return env.Null();
         }
 
-        // 创建解码器上下文
-        codec_ctx = avcodec_alloc_context3(decoder);
-        if (!codec_ctx) {
-            cleanup();
-            return false;
+        if (info.Length() < 1 || !info[0].IsBuffer()) {
+            Napi::TypeError::New(env, "Expected packet buffer").ThrowAsJavaScriptException();
+            return env.Null();
         }
 
-        // 设置硬件加速
-        codec_ctx->hw_device_ctx = av_buffer_ref(hw_device_ctx);
-        codec_ctx->get_format = get_hw_format;
+        Napi::Buffer<uint8_t> packet = info[0].As<Napi::Buffer<uint8_t>>();
 
-        // 打开解码器
-        if (avcodec_open2(codec_ctx, decoder, nullptr) < 0) {
-            cleanup();
-            return false;
+        FrameResultWriter::Frame frame;
+        if (!decodeNextPacket(env, packet.Data(), packet.Length(), &frame)) {
+            return env.Null();
         }
 
-        initialized = true;
-        return true;
+        Napi::Object result = writer(env).toObject(env, frame, false);
+        emitBitstreamStats(env);
+        emitMotionEvents(env);
+        return result;
     }
 
-    // 解码一帧（从文件）
-    bool decodeFrame(uint8_t** out_data, int* out_width, int* out_height, size_t* out_size) {
-        if (!initialized) return false;
-
-        while (true) {
-            // 读取数据包
-            int ret = av_read_frame(fmt_ctx, packet);
-            if (ret < 0) {
-                // 文件结束或错误
-                return false;
-            }
+    // 解码一帧到调用方的 Buffer (target, meta)，返回写入字节数或 FrameIntoResult
+    Napi::Value DecodeFrameInto(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (rejectInFormatCallback(env, "decodeFrameInto")) {
+            return env.Null();
+        }
 
-            if (packet->stream_index != video_stream_idx) {
-                av_packet_unref(packet);
-                continue;
-            }
+        Napi::Uint8Array target;
+        Napi::Float64Array meta;
+        if (!FrameResultWriter::parseTargets(info, 0, &target, &meta)) {
+            return env.Null();
+        }
 
-            // 发送数据包到解码器
-            ret = avcodec_send_packet(codec_ctx, packet);
-            av_packet_unref(packet);
+        FrameResultWriter& out = writer(env);
+        FrameResultWriter::Frame frame;
+        if (!out.takePending(&frame) && !decodeNextFrame(env, &frame)) {
+            return Napi::Number::New(env, FRAME_INTO_END);
+        }
+        int written = out.writeInto(frame, target, meta);
+        emitBitstreamStats(env);
+        emitMotionEvents(env);
+        return Napi::Number::New(env, written);
+    }
 
-            if (ret < 0) {
-                return false;
-            }
+    // (packet, target, meta)。返回 FRAME_INTO_TOO_SMALL 后用更大的 target 重试时，
+    // 该数据包已经送入解码器，不会重复送入
+    Napi::Value DecodePacketInto(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (rejectInFormatCallback(env, "decodePacketInto")) {
+            return env.Null();
+        }
 
-            // 接收解码后的帧
-            ret = avcodec_receive_frame(codec_ctx, frame);
-            if (ret == AVERROR(EAGAIN)) {
-                continue;
-            } else if (ret < 0) {
-                return false;
-            }
+        if (info.Length() < 1 || !info[0].IsBuffer()) {
+            Napi::TypeError::New(env, "Expected packet buffer").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Uint8Array target;
+        Napi::Float64Array meta;
+        if (!FrameResultWriter::parseTargets(info, 1, &target, &meta)) {
+            return env.Null();
+        }
 
-            // 成功解码一帧
-            return extractNV12Frame(out_data, out_width, out_height, out_size);
+        FrameResultWriter& out = writer(env);
+        FrameResultWriter::Frame frame;
+        if (!out.takePending(&frame)) {
+            Napi::Buffer<uint8_t> packet = info[0].As<Napi::Buffer<uint8_t>>();
+            if (!decodeNextPacket(env, packet.Data(), packet.Length(), &frame)) {
+                return Napi::Number::New(env, FRAME_INTO_END);
+            }
         }
+        int written = out.writeInto(frame, target, meta);
+        emitBitstreamStats(env);
+        emitMotionEvents(env);
+        return Napi::Number::New(env, written);
     }
 
-    // 解码数据包（从内存）
-    bool decodePacket(const uint8_t* packet_data, size_t packet_size,
-                     uint8_t** out_data, int* out_width, int* out_height, size_t* out_size) {
-        if (!initialized) return false;
+    // 获取视频信息
+    Napi::Value GetVideoInfo(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
 
-        // 设置数据包
-        packet->data = const_cast<uint8_t*>(packet_data);
-        packet->size = packet_size;
+        int width = 0, height = 0, fps_num = 0, fps_den = 0;
+        std::string codec_name;
 
-        // 发送数据包到解码器
-        int ret = avcodec_send_packet(codec_ctx, packet);
-        if (ret < 0) {
-            return false;
-        }
+        bool success = decoder_->getVideoInfo(&width, &height, &codec_name, &fps_num, &fps_den);
 
-        // 接收解码后的帧
-        ret = avcodec_receive_frame(codec_ctx, frame);
-        if (ret == AVERROR(EAGAIN)) {
-            // 需要更多数据
-            return false;
-        } else if (ret < 0) {
-            return false;
+        if (!success) {
+            return env.Null();
         }
 
-        // 成功解码一帧
-        return extractNV12Frame(out_data, out_width, out_height, out_size);
-    }
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("width", Napi::Number::New(env, width));
+        result.Set("height", Napi::Number::New(env, height));
+        result.Set("codec", Napi::String::New(env, codec_name));
+        result.Set("fps", Napi::Number::New(env, fps_den > 0 ? (double)fps_num / fps_den : 0));
 
-    // 获取视频信息
-    bool getVideoInfo(int* width, int* height, std::string* codec_name, int* fps_num, int* fps_den) {
-        if (!initialized || !fmt_ctx) return false;
+        return result;
+    }
 
-        AVStream* stream = fmt_ctx->streams[video_stream_idx];
-        *width = codec_ctx->width;
-        *height = codec_ctx->height;
-        *codec_name = avcodec_get_name(codec_ctx->codec_id);
-        *fps_num = stream->avg_frame_rate.num;
-        *fps_den = stream->avg_frame_rate.den;
+    // 跳转到指定时间（秒）
+    Napi::Value Seek(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (rejectInFormatCallback(env, "seek")) {
+            return env.Null();
+        }
 
-        return true;
-    }
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected seconds number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
 
-    // 获取最后的错误信息
-    std::string getLastError() const {
-        return last_error;
+        double seconds = info[0].As<Napi::Number>().DoubleValue();
+        resetWriter();
+        return Napi::Boolean::New(env, decoder_->seek(seconds));
     }
 
-private:
-    // 获取硬件像素格式
-    static enum AVPixelFormat get_hw_format(AVCodecContext* ctx, const enum AVPixelFormat* pix_fmts) {
-        for (const enum AVPixelFormat* p = pix_fmts; *p != AV_PIX_FMT_NONE; p++) {
-            if (*p == AV_PIX_FMT_VAAPI) {
-                return *p;
-            }
-        }
-        return AV_PIX_FMT_NONE;
+    // 获取时长（秒）
+    Napi::Value GetDuration(const Napi::CallbackInfo& info) {
+        return Napi::Number::New(info.Env(), decoder_->getDuration());
     }
 
-    // 提取 NV12 格式数据
-    bool extractNV12Frame(uint8_t** out_data, int* out_width, int* out_height, size_t* out_size) {
-        AVFrame* target_frame = frame;
+    // 预读 I/O 参数: { readAhead?, chunkSizeKB?, windowChunks? }，下一次 initFromFile 生效
+    Napi::Value ConfigureIo(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
 
-        // 如果是硬件帧，需要传输到系统内存
-        if (frame->format == AV_PIX_FMT_VAAPI) {
-            if (av_hwframe_transfer_data(sw_frame, frame, 0) < 0) {
-                return false;
-            }
-            target_frame = sw_frame;
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+            return env.Null();
         }
 
-        int width = target_frame->width;
-        int height = target_frame->height;
-        size_t nv12_size = width * height * 3 / 2;
-
-        // 分配输出缓冲
-        if (nv12_buffer_size < nv12_size) {
-            nv12_buffer = std::make_unique<uint8_t[]>(nv12_size);
-            nv12_buffer_size = nv12_size;
+        Napi::Object opts = info[0].As<Napi::Object>();
+        ReadAheadFile::Config config;
+        if (opts.Get("readAhead").IsBoolean()) {
+            config.enabled = opts.Get("readAhead").As<Napi::Boolean>().Value();
         }
-
-        // 转换为 NV12 格式（如果需要）
-        if (target_frame->format == AV_PIX_FMT_NV12) {
-            // 已经是 NV12，直接复制
-            copyNV12Data(target_frame, nv12_buffer.get(), width, height);
-        } else if (target_frame->format == AV_PIX_FMT_YUV420P) {
-            // 从 YUV420P 转换为 NV12
-            convertYUV420PtoNV12(target_frame, nv12_buffer.get(), width, height);
-        } else {
-            // 不支持的格式
-            return false;
+        if (opts.Get("chunkSizeKB").IsNumber()) {
+            config.chunk_size = (size_t)std::max(4, opts.Get("chunkSizeKB").As<Napi::Number>().Int32Value()) * 1024;
+        }
+        if (opts.Get("windowChunks").IsNumber()) {
+            config.window_chunks = opts.Get("windowChunks").As<Napi::Number>().Int32Value();
         }
+        decoder_->setReadAhead(config);
+        return Napi::Boolean::New(env, true);
+    }
 
-        *out_data = nv12_buffer.get();
-        *out_width = width;
-        *out_height = height;
-        *out_size = nv12_size;
+    // { hwAccel, frameIndex, io: { readAhead, hitRate, ioWaitMs, ... } }
+    Napi::Value GetStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
 
-        return true;
-    }
+        ReadAheadFile::Stats io = decoder_->readAheadStats();
+        uint64_t accesses = io.prefetch_hits + io.prefetch_misses;
+
+        Napi::Object io_stats = Napi::Object::New(env);
+        io_stats.Set("readAhead", Napi::Boolean::New(env, decoder_->usingReadAhead()));
+        io_stats.Set("bytesDelivered", Napi::Number::New(env, (double)io.bytes_delivered));
+        io_stats.Set("bytesRead", Napi::Number::New(env, (double)io.bytes_read));
+        io_stats.Set("reads", Napi::Number::New(env, (double)io.reads));
+        io_stats.Set("seeks", Napi::Number::New(env, (double)io.seeks));
+        io_stats.Set("prefetchHits", Napi::Number::New(env, (double)io.prefetch_hits));
+        io_stats.Set("prefetchMisses", Napi::Number::New(env, (double)io.prefetch_misses));
+        io_stats.Set("hitRate", Napi::Number::New(env, accesses > 0 ? (double)io.prefetch_hits / accesses : 0));
+        io_stats.Set("ioWaitMs", Napi::Number::New(env, io.io_wait_ms));
+        io_stats.Set("avgReadMs", Napi::Number::New(env, io.avg_read_ms));
+        io_stats.Set("maxReadMs", Napi::Number::New(env, io.max_read_ms));
+        io_stats.Set("windowBytes", Napi::Number::New(env, (double)io.window_bytes));
+        io_stats.Set("segmentOpens", Napi::Number::New(env, (double)io.segment_opens));
 
-    // 复制 NV12 数据
-    void copyNV12Data(AVFrame* frame, uint8_t* dst, int width, int height) {
-        // 复制 Y 平面
-        uint8_t* dst_y = dst;
-        for (int i = 0; i < height; i++) {
-            memcpy(dst_y + i * width, frame->data[0] + i * frame->linesize[0], width);
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("hwAccel", Napi::Boolean::New(env, decoder_->isHardwareAccelerated()));
+        result.Set("frameIndex", Napi::Number::New(env, (double)decoder_->currentFrameIndex()));
+        result.Set("formatChanges", Napi::Number::New(env, (double)decoder_->formatChangeCount()));
+        result.Set("io", io_stats);
+
+        const SegmentPlaylist* playlist = decoder_->segmentPlaylist();
+        if (playlist) {
+            Napi::Object pl = Napi::Object::New(env);
+            pl.Set("segments", Napi::Number::New(env, (double)playlist->segmentCount()));
+            pl.Set("currentSegment", Napi::Number::New(env, (double)playlist->segmentIndex(io.current_segment)));
+            pl.Set("ended", Napi::Boolean::New(env, playlist->ended()));
+            pl.Set("duration", Napi::Number::New(env, playlist->duration()));
+            result.Set("playlist", pl);
+        }
+
+        MotionAnalyzer* analyzer = decoder_->motionAnalyzer();
+        if (analyzer) {
+            const MotionAnalyzer::Stats& ms = analyzer->stats();
+            Napi::Object motion = Napi::Object::New(env);
+            motion.Set("vectorsAvailable", Napi::Boolean::New(env, decoder_->motionVectorsAvailable()));
+            motion.Set("frames", Napi::Number::New(env, (double)ms.frames));
+            motion.Set("framesWithVectors", Napi::Number::New(env, (double)ms.frames_with_vectors));
+            motion.Set("vectors", Napi::Number::New(env, (double)ms.vectors));
+            motion.Set("events", Napi::Number::New(env, (double)ms.events));
+            motion.Set("motion", Napi::Boolean::New(env, ms.motion));
+            motion.Set("area", Napi::Number::New(env, ms.area));
+            motion.Set("energy", Napi::Number::New(env, ms.energy));
+            result.Set("motion", motion);
+        }
+
+        ShmFrameCache* cache = decoder_->frameCache();
+        if (cache) {
+            ShmFrameCache::Stats cs = cache->stats();
+            uint64_t lookups = cs.hits + cs.misses;
+            Napi::Object cache_stats = Napi::Object::New(env);
+            cache_stats.Set("slotCount", Napi::Number::New(env, cs.slot_count));
+            cache_stats.Set("used", Napi::Number::New(env, cs.used));
+            cache_stats.Set("hits", Napi::Number::New(env, (double)cs.hits));
+            cache_stats.Set("misses", Napi::Number::New(env, (double)cs.misses));
+            cache_stats.Set("hitRate", Napi::Number::New(env, lookups > 0 ? (double)cs.hits / lookups : 0));
+            cache_stats.Set("inserts", Napi::Number::New(env, (double)cs.inserts));
+            cache_stats.Set("evictions", Napi::Number::New(env, (double)cs.evictions));
+            cache_stats.Set("cachedFrames", Napi::Number::New(env, (double)decoder_->cachedFrameCount()));
+            result.Set("frameCache", cache_stats);
         }
+        return result;
+    }
 
-        // 复制 UV 平面
-        uint8_t* dst_uv = dst + width * height;
-        for (int i = 0; i < height / 2; i++) {
-            memcpy(dst_uv + i * width, frame->data[1] + i * frame->linesize[1], width);
-        }
+    // 获取最后的错误信息
+    Napi::Value GetLastError(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        std::string error = decoder_->getLastError();
+        return Napi::String::New(env, error);
     }
 
-    // YUV420P 转 NV12
-    void convertYUV420PtoNV12(AVFrame* frame, uint8_t* dst, int width, int height) {
-        // 复制 Y 平面
-        uint8_t* dst_y = dst;
-        for (int i = 0; i < height; i++) {
-            memcpy(dst_y + i * width, frame->data[0] + i * frame->linesize[0], width);
+    // 开启场景切换检测: (callback, { threshold?, minSceneFrames? })
+    Napi::Value EnableSceneDetection(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Expected (callback, options?)").ThrowAsJavaScriptException();
+            return env.Null();
         }
 
-        // 交错 U 和 V 平面生成 UV 平面
-        uint8_t* dst_uv = dst + width * height;
-        uint8_t* src_u = frame->data[1];
-        uint8_t* src_v = frame->data[2];
-        
-        for (int i = 0; i < height / 2; i++) {
-            for (int j = 0; j < width / 2; j++) {
-                dst_uv[i * width + j * 2 + 0] = src_u[i * frame->linesize[1] + j];
-                dst_uv[i * width + j * 2 + 1] = src_v[i * frame->linesize[2] + j];
+        double threshold = 0.35;
+        int min_scene_frames = 12;
+        if (info.Length() >= 2 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            if (options.Get("threshold").IsNumber()) {
+                threshold = options.Get("threshold").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("minSceneFrames").IsNumber()) {
+                min_scene_frames = options.Get("minSceneFrames").As<Napi::Number>().Int32Value();
             }
         }
+
+        decoder_->disableSceneDetection();
+        releaseSceneCallback();
+
+        scene_tsfn_ = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(),
+                                                    "SceneCutCallback", 0, 1);
+        // 不阻止进程退出
+        scene_tsfn_.Unref(env);
+        has_scene_tsfn_ = true;
+
+        Napi::ThreadSafeFunction tsfn = scene_tsfn_;
+        decoder_->enableSceneDetection(threshold, min_scene_frames,
+            [tsfn](const SceneCutEvent& event) mutable {
+                SceneCutEvent* data = new SceneCutEvent(event);
+                napi_status status = tsfn.NonBlockingCall(data,
+                    [](Napi::Env env, Napi::Function callback, SceneCutEvent* data) {
+                        Napi::Object result = Napi::Object::New(env);
+                        result.Set("pts", Napi::Number::New(env, data->pts));
+                        result.Set("frameIndex", Napi::Number::New(env, (double)data->frame_index));
+                        result.Set("score", Napi::Number::New(env, data->score));
+                        delete data;
+                        callback.Call({result});
+                    });
+                if (status != napi_ok) {
+                    delete data;
+                }
+            });
+
+        return Napi::Boolean::New(env, true);
     }
-};
 
-// ================ N-API 绑定 ================
+    Napi::Value DisableSceneDetection(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        decoder_->disableSceneDetection();
+        releaseSceneCallback();
+        return env.Undefined();
+    }
 
-class VaapiDecoderWrapper : public Napi::ObjectWrap<VaapiDecoderWrapper> {
-public:
-    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
-        Napi::Function func = DefineClass(env, "VaapiDecoder", {
-            InstanceMethod("initFromFile", &VaapiDecoderWrapper::InitFromFile),
-            InstanceMethod("initFromBuffer", &VaapiDecoderWrapper::InitFromBuffer),
-            InstanceMethod("decodeFrame", &VaapiDecoderWrapper::DecodeFrame),
-            InstanceMethod("decodePacket", &VaapiDecoderWrapper::DecodePacket),
-            InstanceMethod("getVideoInfo", &VaapiDecoderWrapper::GetVideoInfo),
-            InstanceMethod("getLastError", &VaapiDecoderWrapper::GetLastError),
-            InstanceMethod("close", &VaapiDecoderWrapper::Close),
-        });
+    // 开启逐帧码流统计: (callback, { batchFrames? })
+    // 每解码 batchFrames 帧回调一次 Float64Array，每帧 8 个字段（见 bitstream_stats.h）
+    Napi::Value EnableBitstreamStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
 
-        Napi::FunctionReference* constructor = new Napi::FunctionReference();
-        *constructor = Napi::Persistent(func);
-        env.SetInstanceData(constructor);
+        if (info.Length() < 1 || !info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Expected (callback, options?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
 
-        exports.Set("VaapiDecoder", func);
-        return exports;
+        int batch_frames = 60;
+        if (info.Length() >= 2 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            if (options.Get("batchFrames").IsNumber()) {
+                batch_frames = options.Get("batchFrames").As<Napi::Number>().Int32Value();
+            }
+        }
+
+        stats_callback_ = Napi::Persistent(info[0].As<Napi::Function>());
+        decoder_->enableBitstreamStats(batch_frames);
+        return Napi::Boolean::New(env, true);
     }
 
-    VaapiDecoderWrapper(const Napi::CallbackInfo& info) 
-        : Napi::ObjectWrap<VaapiDecoderWrapper>(info) {
-        decoder_ = std::make_unique<VaapiDecoder>();
+    // 关闭前把不足一批的记录交给回调
+    Napi::Value DisableBitstreamStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        emitBitstreamStats(env, true);
+        decoder_->disableBitstreamStats();
+        stats_callback_.Reset();
+        return env.Undefined();
     }
 
-private:
-    std::unique_ptr<VaapiDecoder> decoder_;
+    // 立即回调不足一批的记录，如暂停或到达文件末尾时
+    Napi::Value FlushBitstreamStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        emitBitstreamStats(env, true);
+        return env.Undefined();
+    }
 
-    // 从文件初始化
-    Napi::Value InitFromFile(const Napi::CallbackInfo& info) {
+    // 开启运动矢量运动检测: (callback, { cellSize?, threshold?, minVector?, minArea?, smoothing?,
+    // startFrames?, holdFrames?, updateFrames? })。回调参数为 { type, pts, frameIndex, energy, area, box }，
+    // 在解码调用内同步执行。在 initFromFile 之前开启才会使用软解导出矢量
+    Napi::Value EnableMotionAnalysis(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
 
-        if (info.Length() < 1 || !info[0].IsString()) {
-            Napi::TypeError::New(env, "Expected filename string").ThrowAsJavaScriptException();
+        if (info.Length() < 1 || !info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Expected (callback, options?)").ThrowAsJavaScriptException();
             return env.Null();
         }
 
-        std::string filename = info[0].As<Napi::String>().Utf8Value();
-        bool success = decoder_->initFromFile(filename);
+        MotionAnalyzer::Options options;
+        if (info.Length() >= 2 && info[1].IsObject()) {
+            Napi::Object opts = info[1].As<Napi::Object>();
+            if (opts.Get("cellSize").IsNumber()) {
+                options.cell_size = opts.Get("cellSize").As<Napi::Number>().Int32Value();
+            }
+            if (opts.Get("threshold").IsNumber()) {
+                options.threshold = opts.Get("threshold").As<Napi::Number>().DoubleValue();
+            }
+            if (opts.Get("minVector").IsNumber()) {
+                options.min_vector = opts.Get("minVector").As<Napi::Number>().DoubleValue();
+            }
+            if (opts.Get("minArea").IsNumber()) {
+                options.min_area = opts.Get("minArea").As<Napi::Number>().DoubleValue();
+            }
+            if (opts.Get("smoothing").IsNumber()) {
+                options.smoothing = opts.Get("smoothing").As<Napi::Number>().DoubleValue();
+            }
+            if (opts.Get("startFrames").IsNumber()) {
+                options.start_frames = opts.Get("startFrames").As<Napi::Number>().Int32Value();
+            }
+            if (opts.Get("holdFrames").IsNumber()) {
+                options.hold_frames = opts.Get("holdFrames").As<Napi::Number>().Int32Value();
+            }
+            if (opts.Get("updateFrames").IsNumber()) {
+                options.update_frames = opts.Get("updateFrames").As<Napi::Number>().Int32Value();
+            }
+        }
 
-        return Napi::Boolean::New(env, success);
+        motion_callback_ = Napi::Persistent(info[0].As<Napi::Function>());
+        decoder_->enableMotionAnalysis(options);
+        return Napi::Boolean::New(env, true);
     }
 
-    // 从缓冲区初始化
-    Napi::Value InitFromBuffer(const Napi::CallbackInfo& info) {
+    Napi::Value DisableMotionAnalysis(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
+        emitMotionEvents(env);
+        decoder_->disableMotionAnalysis();
+        motion_callback_.Reset();
+        return env.Undefined();
+    }
 
-        if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsString()) {
-            Napi::TypeError::New(env, "Expected (buffer, codec_name)").ThrowAsJavaScriptException();
+    // 解码一帧但不输出像素，只更新运动检测: 返回 { pts, frameIndex, motion, area, energy, vectors }，
+    // 文件结束返回 null
+    Napi::Value AnalyzeMotion(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (rejectInFormatCallback(env, "analyzeMotion")) {
             return env.Null();
         }
 
-        Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
-        std::string codec_name = info[1].As<Napi::String>().Utf8Value();
-
-        bool success = decoder_->initFromBuffer(buffer.Data(), buffer.Length(), codec_name);
+        resetWriter();
+        if (!decoder_->analyzeFrame()) {
+            return env.Null();
+        }
 
-        return Napi::Boolean::New(env, success);
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("pts", Napi::Number::New(env, decoder_->getCurrentPts()));
+        result.Set("frameIndex", Napi::Number::New(env, (double)decoder_->currentFrameIndex() - 1));
+        MotionAnalyzer* analyzer = decoder_->motionAnalyzer();
+        if (analyzer) {
+            const MotionAnalyzer::Stats& ms = analyzer->stats();
+            result.Set("motion", Napi::Boolean::New(env, ms.motion));
+            result.Set("area", Napi::Number::New(env, ms.area));
+            result.Set("energy", Napi::Number::New(env, ms.energy));
+            result.Set("vectors", Napi::Number::New(env, (double)ms.vectors));
+        }
+        emitBitstreamStats(env);
+        emitMotionEvents(env);
+        return result;
     }
 
-    // 解码一帧（从文件）
-    Napi::Value DecodeFrame(const Napi::CallbackInfo& info) {
+    // 平滑后的运动能量图: { cols, rows, data: Float32Array }（按行排列，单位像素/帧），未开启时返回 null
+    Napi::Value GetMotionMap(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
 
-        uint8_t* data = nullptr;
-        int width = 0, height = 0;
-        size_t size = 0;
-
-        bool success = decoder_->decodeFrame(&data, &width, &height, &size);
-
-        if (!success) {
+        MotionAnalyzer* analyzer = decoder_->motionAnalyzer();
+        if (!analyzer) {
             return env.Null();
         }
+        const std::vector<float>& map = analyzer->map();
+        Napi::Float32Array data = Napi::Float32Array::New(env, map.size());
+        if (!map.empty()) {
+            memcpy(data.Data(), map.data(), map.size() * sizeof(float));
+        }
 
-        // 创建返回对象
         Napi::Object result = Napi::Object::New(env);
-        
-        // 复制数据到 Node.js Buffer
-        Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::Copy(env, data, size);
-        
-        result.Set("data", buffer);
-        result.Set("width", Napi::Number::New(env, width));
-        result.Set("height", Napi::Number::New(env, height));
-        result.Set("format", Napi::String::New(env, "nv12"));
-
+        result.Set("cols", Napi::Number::New(env, analyzer->cols()));
+        result.Set("rows", Napi::Number::New(env, analyzer->rows()));
+        result.Set("data", data);
         return result;
     }
 
-    // 解码数据包（从内存）
-    Napi::Value DecodePacket(const Napi::CallbackInfo& info) {
+    // 降质解码配置: ({ lowres?, skipLoopFilter?, software? })，下一次 initFromFile 生效
+    Napi::Value SetDecodeProfile(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
 
-        if (info.Length() < 1 || !info[0].IsBuffer()) {
-            Napi::TypeError::New(env, "Expected packet buffer").ThrowAsJavaScriptException();
-            return env.Null();
+        VaapiDecoder::DecodeProfile profile;
+        if (info.Length() >= 1 && info[0].IsObject()) {
+            profile = parseDecodeProfile(info[0].As<Napi::Object>());
         }
+        decoder_->setDecodeProfile(profile);
+        return env.Undefined();
+    }
 
-        Napi::Buffer<uint8_t> packet = info[0].As<Napi::Buffer<uint8_t>>();
+    // 分辨率变化回调: (callback | null)，在新尺寸的第一帧返回之前同步调用，
+    // 参数为 { width, height, previousWidth, previousHeight, size, pts }
+    Napi::Value SetFormatChangeCallback(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
 
-        uint8_t* data = nullptr;
-        int width = 0, height = 0;
-        size_t size = 0;
+        if (info.Length() >= 1 && info[0].IsFunction()) {
+            format_callback_ = Napi::Persistent(info[0].As<Napi::Function>());
+        } else if (info.Length() >= 1 && (info[0].IsNull() || info[0].IsUndefined())) {
+            format_callback_.Reset();
+        } else {
+            Napi::TypeError::New(env, "Expected (callback | null)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return env.Undefined();
+    }
 
-        bool success = decoder_->decodePacket(packet.Data(), packet.Length(), 
-                                             &data, &width, &height, &size);
+    // 按最大分辨率预先分配输出缓冲: (maxWidth, maxHeight)
+    Napi::Value ReserveOutput(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (rejectInFormatCallback(env, "reserveOutput")) {
+            return env.Null();
+        }
 
-        if (!success) {
+        if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+            Napi::TypeError::New(env, "Expected (maxWidth, maxHeight)").ThrowAsJavaScriptException();
             return env.Null();
         }
+        // TOO_SMALL 后保留的帧指向输出缓冲，重新分配前必须先取走
+        if (writer_ && writer_->hasPending()) {
+            Napi::Error::New(env, "reserveOutput cannot be called while a frame is pending; retry decodeFrameInto first")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        resetWriter();
+        decoder_->reserveOutput(info[0].As<Napi::Number>().Int32Value(), info[1].As<Napi::Number>().Int32Value());
+        return env.Undefined();
+    }
 
-        // 创建返回对象
-        Napi::Object result = Napi::Object::New(env);
-        
-        // 复制数据到 Node.js Buffer
-        Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::Copy(env, data, size);
-        
-        result.Set("data", buffer);
-        result.Set("width", Napi::Number::New(env, width));
-        result.Set("height", Napi::Number::New(env, height));
-        result.Set("format", Napi::String::New(env, "nv12"));
+    // 设置 OSD 叠加: (overlay | null)，之后输出的帧都带有叠加内容
+    Napi::Value SetOverlay(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
 
-        return result;
+        if (info.Length() < 1 || info[0].IsNull() || info[0].IsUndefined()) {
+            decoder_->setOverlay(nullptr);
+            return env.Undefined();
+        }
+        std::shared_ptr<OsdOverlay> overlay = OsdOverlayWrapper::FromValue(info[0]);
+        if (!overlay) {
+            Napi::TypeError::New(env, "Expected OsdOverlay or null").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        decoder_->setOverlay(std::move(overlay));
+        return env.Undefined();
     }
 
-    // 获取视频信息
-    Napi::Value GetVideoInfo(const Napi::CallbackInfo& info) {
+    // 接入跨窗口帧缓存: (name, contentId, { budgetBytes? })，之后解码的帧都写入缓存，
+    // decodeFrame / decodeFrameInto 先从缓存取下一帧
+    Napi::Value AttachFrameCache(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
 
-        int width = 0, height = 0, fps_num = 0, fps_den = 0;
-        std::string codec_name;
+        if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+            Napi::TypeError::New(env, "Expected (name, contentId, options?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        uint64_t budget = 0;
+        if (info.Length() >= 3 && info[2].IsObject()) {
+            Napi::Value v = info[2].As<Napi::Object>().Get("budgetBytes");
+            if (v.IsNumber()) budget = (uint64_t)std::max<int64_t>(0, v.As<Napi::Number>().Int64Value());
+        }
+        if (!decoder_->attachFrameCache(info[0].As<Napi::String>().Utf8Value(),
+                                        info[1].As<Napi::String>().Utf8Value(), budget)) {
+            Napi::Error::New(env, decoder_->getLastError()).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, true);
+    }
 
-        bool success = decoder_->getVideoInfo(&width, &height, &codec_name, &fps_num, &fps_den);
+    Napi::Value DetachFrameCache(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        decoder_->detachFrameCache();
+        return env.Undefined();
+    }
 
-        if (!success) {
+    // 从缓存读取 pts 处的帧（可能由其他窗口解码）: (pts, target?) => { data?, width, height, pts, format } | null
+    // 不改变解码位置
+    Napi::Value ReadCachedFrame(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected (pts, target?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        ShmFrameCache* cache = decoder_->frameCache();
+        if (!cache) {
             return env.Null();
         }
 
+        double pts = info[0].As<Napi::Number>().DoubleValue();
+        ShmFrameCache::FrameInfo frame;
         Napi::Object result = Napi::Object::New(env);
-        result.Set("width", Napi::Number::New(env, width));
-        result.Set("height", Napi::Number::New(env, height));
-        result.Set("codec", Napi::String::New(env, codec_name));
-        result.Set("fps", Napi::Number::New(env, fps_den > 0 ? (double)fps_num / fps_den : 0));
+        bool hit;
+        if (info.Length() >= 2 && info[1].IsBuffer()) {
+            Napi::Buffer<uint8_t> target = info[1].As<Napi::Buffer<uint8_t>>();
+            hit = cache->getWith(decoder_->frameCacheContent(), pts, &frame, [&](const uint8_t* src) {
+                if (target.Length() >= frame.size) memcpy(target.Data(), src, frame.size);
+            });
+            if (hit && target.Length() < frame.size) {
+                Napi::RangeError::New(env, "Target buffer too small").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+        } else {
+            hit = cache->getWith(decoder_->frameCacheContent(), pts, &frame, [&](const uint8_t* src) {
+                result.Set("data", Napi::Buffer<uint8_t>::Copy(env, src, frame.size));
+            });
+        }
+        if (!hit) {
+            return env.Null();
+        }
 
+        result.Set("width", Napi::Number::New(env, frame.width));
+        result.Set("height", Napi::Number::New(env, frame.height));
+        result.Set("pts", Napi::Number::New(env, frame.pts));
+        result.Set("format", Napi::String::New(env, "nv12"));
         return result;
     }
 
-    // 获取最后的错误信息
-    Napi::Value GetLastError(const Napi::CallbackInfo& info) {
+    // 导出快照: (frameRef, format, quality, outputPath?) => Promise<Buffer | string>
+    // frameRef 为 null 时使用当前帧，否则为 { data, width, height }
+    Napi::Value Snapshot(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
-        std::string error = decoder_->getLastError();
-        return Napi::String::New(env, error);
+
+        if (info.Length() < 2 || !info[1].IsString()) {
+            Napi::TypeError::New(env, "Expected (frameRef, format, quality?, outputPath?)")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        std::string format = info[1].As<Napi::String>().Utf8Value();
+        int quality = 90;
+        if (info.Length() >= 3 && info[2].IsNumber()) {
+            quality = info[2].As<Napi::Number>().Int32Value();
+        }
+        std::string output_path;
+        if (info.Length() >= 4 && info[3].IsString()) {
+            output_path = info[3].As<Napi::String>().Utf8Value();
+        }
+
+        SnapshotWorker* worker = nullptr;
+        if (info[0].IsObject()) {
+            Napi::Object frame_ref = info[0].As<Napi::Object>();
+            if (!frame_ref.Get("data").IsBuffer() || !frame_ref.Get("width").IsNumber() ||
+                !frame_ref.Get("height").IsNumber()) {
+                Napi::TypeError::New(env, "frameRef must be { data: Buffer, width, height }")
+                    .ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            Napi::Buffer<uint8_t> data = frame_ref.Get("data").As<Napi::Buffer<uint8_t>>();
+            int width = frame_ref.Get("width").As<Napi::Number>().Int32Value();
+            int height = frame_ref.Get("height").As<Napi::Number>().Int32Value();
+            if (width <= 0 || height <= 0 || data.Length() < (size_t)width * height * 3 / 2) {
+                Napi::Error::New(env, "Frame buffer too small for given dimensions")
+                    .ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            std::vector<uint8_t> copy(data.Data(), data.Data() + (size_t)width * height * 3 / 2);
+            worker = new SnapshotWorker(env, std::move(copy), width, height, format, quality, output_path);
+        } else {
+            std::vector<uint8_t> copy;
+            int width = 0, height = 0;
+            if (!decoder_->copyCurrentFrame(copy, &width, &height)) {
+                Napi::Error::New(env, "No decoded frame available").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            worker = new SnapshotWorker(env, std::move(copy), width, height, format, quality, output_path);
+        }
+
+        Napi::Promise promise = worker->Promise();
+        worker->Queue();
+        return promise;
     }
 
     // 关闭解码器
     Napi::Value Close(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
+        if (rejectInFormatCallback(env, "close")) {
+            return env.Null();
+        }
+        resetWriter();
         decoder_->cleanup();
         return env.Undefined();
     }
@@ -578,7 +892,22 @@ private:
 
 // 模块初始化
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
-    return VaapiDecoderWrapper::Init(env, exports);
+    // 先绑定共享线程池，之后的模块才会用到它
+    exportWorkPool(env, exports);
+    VaapiDecoderWrapper::Init(env, exports);
+    FrameRecorderWrapper::Init(env, exports);
+    ProxyTranscoderWrapper::Init(env, exports);
+    Fmp4RemuxerWrapper::Init(env, exports);
+    PacketDemuxerWrapper::Init(env, exports);
+    PresentationClockWrapper::Init(env, exports);
+    OsdOverlayWrapper::Init(env, exports);
+    MultiTrackDecoderWrapper::Init(env, exports);
+    RawVideoSourceWrapper::Init(env, exports);
+    ImageSequenceSourceWrapper::Init(env, exports);
+    QualityMeterWrapper::Init(env, exports);
+    QualityAnalyzerWrapper::Init(env, exports);
+    ClipExporterWrapper::Init(env, exports);
+    return exports;
 }
 
 NODE_API_MODULE(vaapi_decoder, Init)
@@ -0,0 +1,1017 @@
+/**
+ * VA-API 硬件视频解码器核心
+ * 支持 H264/H265 硬件解码，输出 NV12 格式，VA-API 不可用时回退到软件解码
+ */
+#pragma once
+
+#include <va/va.h>
+#include <va/va_drm.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/hwcontext_vaapi.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <memory>
+#include <string>
+#include <cstring>
+#include <vector>
+
+#include "bitstream_stats.h"
+#include "motion_analyzer.h"
+#include "osd_overlay.h"
+#include "readahead_io.h"
+#include "resource_limits.h"
+#include "scene_detector.h"
+#include "segment_playlist.h"
+#include "shm_frame_cache.h"
+#include "shm_frame_ring.h"
+
+class VaapiDecoder {
+public:
+    // 降质解码配置（lowres / 跳过环路滤波），只对软解有效，设置后不使用 VA-API
+    struct DecodeProfile {
+        int lowres = 0;               // 0-3，按 2 的幂缩小输出
+        bool skip_loop_filter = false;
+        bool software = false;
+    };
+
+private:
+    AVFormatContext* fmt_ctx = nullptr;
+    AVCodecContext* codec_ctx = nullptr;
+    AVBufferRef* hw_device_ctx = nullptr;
+    AVFrame* frame = nullptr;
+    AVFrame* sw_frame = nullptr;
+    AVPacket* packet = nullptr;
+    
+    int video_stream_idx = -1;
+    int drm_fd = -1;
+    bool initialized = false;
+    bool use_hw_accel = true;  // 是否使用硬件加速
+    std::string last_error;     // 最后的错误信息
+    
+    // NV12 输出缓冲
+    std::unique_ptr<uint8_t[]> nv12_buffer;
+    size_t nv12_buffer_size = 0;
+
+    // 当前帧时间戳（秒）与序号
+    double current_pts = 0;
+    int64_t frame_index = 0;
+
+    // 最近一次输出帧的尺寸（用于快照）
+    int last_width = 0;
+    int last_height = 0;
+
+    // 流中途的分辨率变化：当前帧与上一帧尺寸不同时置位，previous_* 为变化前的尺寸
+    bool format_changed = false;
+    int previous_width = 0;
+    int previous_height = 0;
+    uint64_t format_changes = 0;
+
+    // seek 之后需要丢弃的帧：时间戳早于该值的帧不输出（< 0 表示无）
+    double seek_target = -1;
+
+    // 可选的场景切换检测
+    std::unique_ptr<SceneDetector> scene_detector;
+
+    // 可选的逐帧码流统计
+    std::unique_ptr<BitstreamStats> bitstream_stats;
+
+    // 可选的运动矢量运动检测（分析模式），开启后 initFromFile 使用软解
+    std::unique_ptr<MotionAnalyzer> motion_analyzer;
+
+    // 可选的跨窗口帧缓存：解码出的帧写入共享内存，其他窗口命中时不必再解码
+    // 接入后 decodeFrame 先按下一帧的时间戳查缓存，命中时不读数据包；demuxer 停在最后一次解码的位置，
+    // cache_lag 为之后从缓存输出的帧数，未命中时据此追上（见 catchUpAfterCache）
+    std::unique_ptr<ShmFrameCache> frame_cache;
+    uint64_t frame_cache_content = 0;
+    int64_t next_ts = AV_NOPTS_VALUE;   // 下一帧的预期时间戳（流时间基），仅恒定帧率时可知
+    int64_t cache_lag = 0;
+    uint64_t cache_frames = 0;          // 本解码器从缓存输出的帧数
+    static constexpr int64_t kCacheDecodeAhead = 60;  // 落后不超过该帧数时向前解码追上，否则 seek
+
+    // 可选的 OSD 叠加，烧录进输出帧（快照、录像中可见）
+    std::shared_ptr<OsdOverlay> osd_overlay;
+
+    // 降质解码配置，见 setDecodeProfile
+    DecodeProfile profile;
+
+    // 本地文件的预读 I/O，AVFMT_FLAG_CUSTOM_IO 时 fmt_ctx 不负责释放 io_ctx
+    ReadAheadFile::Config io_config;
+    std::unique_ptr<ReadAheadFile> io_file;
+    AVIOContext* io_ctx = nullptr;
+
+    // 本地分段播放列表：各分段经 io_file 拼接成一个输入，整个会话共用一个 demuxer 和解码器
+    std::unique_ptr<SegmentPlaylist> playlist;
+
+public:
+    VaapiDecoder() {
+        frame = av_frame_alloc();
+        sw_frame = av_frame_alloc();
+        packet = av_packet_alloc();
+    }
+
+    ~VaapiDecoder() {
+        cleanup();
+        if (frame) av_frame_free(&frame);
+        if (sw_frame) av_frame_free(&sw_frame);
+        if (packet) av_packet_free(&packet);
+    }
+
+    void cleanup() {
+        if (codec_ctx) {
+            avcodec_free_context(&codec_ctx);
+            codec_ctx = nullptr;
+        }
+        if (fmt_ctx) {
+            avformat_close_input(&fmt_ctx);
+            fmt_ctx = nullptr;
+        }
+        ReadAheadFile::freeAvio(&io_ctx);
+        io_file.reset();
+        playlist.reset();
+        if (hw_device_ctx) {
+            av_buffer_unref(&hw_device_ctx);
+            hw_device_ctx = nullptr;
+        }
+        if (drm_fd >= 0) {
+            close(drm_fd);
+            drm_fd = -1;
+        }
+        current_pts = 0;
+        frame_index = 0;
+        last_width = 0;
+        last_height = 0;
+        format_changed = false;
+        format_changes = 0;
+        seek_target = -1;
+        if (scene_detector) {
+            scene_detector->reset();
+        }
+        if (bitstream_stats) {
+            bitstream_stats->resetGop();
+        }
+        if (motion_analyzer) {
+            motion_analyzer->reset(0, 0);
+        }
+        // 帧缓存绑定的是上一个内容
+        frame_cache.reset();
+        next_ts = AV_NOPTS_VALUE;
+        cache_lag = 0;
+        cache_frames = 0;
+        initialized = false;
+    }
+
+    // 初始化 VA-API 设备
+    bool initVAAPI(const std::string& device_path = "/dev/dri/renderD128") {
+        // 打开 DRM 设备
+        drm_fd = open(device_path.c_str(), O_RDWR);
+        if (drm_fd < 0) {
+            last_error = "Failed to open DRM device: " + device_path + " (errno: " + std::to_string(errno) + ")";
+            return false;
+        }
+
+        // 创建 VA-API 硬件设备上下文
+        int ret = av_hwdevice_ctx_create(&hw_device_ctx, AV_HWDEVICE_TYPE_VAAPI,
+                                         device_path.c_str(), nullptr, 0);
+        if (ret < 0) {
+            char errbuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            last_error = "Failed to create VA-API device context: " + std::string(errbuf);
+            close(drm_fd);
+            drm_fd = -1;
+            return false;
+        }
+
+        return true;
+    }
+
+    // 初始化解码器（从文件）
+    bool initFromFile(const std::string& filename) {
+        cleanup();
+
+        // 尝试初始化 VA-API，降质解码配置和运动矢量导出只对软解有效
+        bool want_hw = !profile.software && profile.lowres == 0 && !profile.skip_loop_filter && !motion_analyzer;
+        use_hw_accel = want_hw && initVAAPI();
+        if (want_hw && !use_hw_accel) {
+            // VA-API 初始化失败，使用软件解码
+            fprintf(stderr, "VA-API initialization failed: %s\n", last_error.c_str());
+            fprintf(stderr, "Falling back to software decoding...\n");
+        }
+
+        // 检查文件是否存在
+        if (access(filename.c_str(), F_OK) != 0) {
+            last_error = "File does not exist: " + filename;
+            fprintf(stderr, "Error: %s\n", last_error.c_str());
+            return false;
+        }
+        
+        if (access(filename.c_str(), R_OK) != 0) {
+            last_error = "File not readable (permission denied): " + filename;
+            fprintf(stderr, "Error: %s\n", last_error.c_str());
+            return false;
+        }
+
+        // 本地播放列表按分段拼接读取；其他本地文件走预读 I/O，URL 和打开失败时使用 FFmpeg 默认协议
+        std::string input = filename;
+        if (SegmentPlaylist::isPlaylist(filename) && filename.find("://") == std::string::npos) {
+            if (!openPlaylist(filename, &input)) {
+                fprintf(stderr, "Error: %s\n", last_error.c_str());
+                return false;
+            }
+        } else {
+            openReadAhead(filename);
+        }
+
+        // 打开输入文件 - 使用 nullptr options 来使用默认协议
+        AVDictionary* options = nullptr;
+        int ret = avformat_open_input(&fmt_ctx, input.c_str(), nullptr, &options);
+        if (ret < 0) {
+            char errbuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            last_error = "Failed to open file: " + filename + " - " + std::string(errbuf);
+            fprintf(stderr, "Error opening file: %s (ret=%d)\n", last_error.c_str(), ret);
+            fprintf(stderr, "FFmpeg error: %s\n", errbuf);
+            
+            // 列出可用的协议
+            void* opaque = nullptr;
+            const char* protocol_name;
+            fprintf(stderr, "Available input protocols: ");
+            while ((protocol_name = avio_enum_protocols(&opaque, 0)) != nullptr) {
+                fprintf(stderr, "%s ", protocol_name);
+            }
+            fprintf(stderr, "\n");
+            
+            if (options) {
+                av_dict_free(&options);
+            }
+            // 失败时 fmt_ctx 已被释放，自定义 I/O 需要单独释放
+            ReadAheadFile::freeAvio(&io_ctx);
+            io_file.reset();
+            playlist.reset();
+            return false;
+        }
+        
+        if (options) {
+            av_dict_free(&options);
+        }
+
+        // 查找流信息
+        if (avformat_find_stream_info(fmt_ctx, nullptr) < 0) {
+            last_error = "Failed to find stream info";
+            cleanup();
+            return false;
+        }
+
+        // 查找视频流
+        const AVCodec* decoder = nullptr;
+        video_stream_idx = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, &decoder, 0);
+        if (video_stream_idx < 0) {
+            last_error = "No video stream found";
+            cleanup();
+            return false;
+        }
+
+        // 创建解码器上下文
+        codec_ctx = avcodec_alloc_context3(decoder);
+        if (!codec_ctx) {
+            last_error = "Failed to allocate codec context";
+            cleanup();
+            return false;
+        }
+
+        // 复制流参数到解码器上下文
+        if (avcodec_parameters_to_context(codec_ctx, fmt_ctx->streams[video_stream_idx]->codecpar) < 0) {
+            last_error = "Failed to copy codec parameters";
+            cleanup();
+            return false;
+        }
+
+        // 如果使用硬件加速，设置硬件设备上下文
+        if (use_hw_accel && hw_device_ctx) {
+            codec_ctx->hw_device_ctx = av_buffer_ref(hw_device_ctx);
+            codec_ctx->get_format = get_hw_format;
+        } else {
+            // 软解默认只用 1 个线程，按容器可用核数开启帧/切片多线程
+            codec_ctx->thread_count = ResourceLimits::get().decode_threads;
+        }
+        if (bitstream_stats) {
+            BitstreamStats::configureContext(codec_ctx);
+        }
+        if (motion_analyzer) {
+            MotionAnalyzer::configureContext(codec_ctx);
+        }
+        if (profile.lowres > 0) {
+            codec_ctx->lowres = std::min(profile.lowres, (int)decoder->max_lowres);
+        }
+        if (profile.skip_loop_filter) {
+            codec_ctx->skip_loop_filter = AVDISCARD_ALL;
+        }
+
+        // 打开解码器
+        if (avcodec_open2(codec_ctx, decoder, nullptr) < 0) {
+            last_error = "Failed to open decoder";
+            cleanup();
+            return false;
+        }
+
+        initialized = true;
+        fprintf(stderr, "Decoder initialized successfully (HW accel: %s)\n", use_hw_accel ? "YES" : "NO");
+        return true;
+    }
+
+    // 初始化解码器（从内存数据）
+    bool initFromBuffer(const uint8_t* data, size_t size, const std::string& codec_name) {
+        cleanup();
+
+        // 初始化 VA-API
+        if (!initVAAPI()) {
+            return false;
+        }
+
+        // 查找解码器
+        const AVCodec* decoder = avcodec_find_decoder_by_name(codec_name.c_str());
+        if (!decoder) {
+            cleanup();
+            return false;
+        }
+
+        // 创建解码器上下文
+        codec_ctx = avcodec_alloc_context3(decoder);
+        if (!codec_ctx) {
+            cleanup();
+            return false;
+        }
+
+        // 设置硬件加速
+        codec_ctx->hw_device_ctx = av_buffer_ref(hw_device_ctx);
+        codec_ctx->get_format = get_hw_format;
+        if (bitstream_stats) {
+            BitstreamStats::configureContext(codec_ctx);
+        }
+
+        // 打开解码器
+        if (avcodec_open2(codec_ctx, decoder, nullptr) < 0) {
+            cleanup();
+            return false;
+        }
+
+        initialized = true;
+        return true;
+    }
+
+    // 解码一帧（从文件）。接入帧缓存时先取缓存中的下一帧，其他窗口已解码过的部分不再解码
+    bool decodeFrame(uint8_t** out_data, int* out_width, int* out_height, size_t* out_size) {
+        if (readNextCachedFrame(out_data, out_width, out_height, out_size)) return true;
+        if (cache_lag > 0 && !catchUpAfterCache()) return false;
+        if (!receiveFrame()) return false;
+        return extractNV12Frame(out_data, out_width, out_height, out_size);
+    }
+
+    // 分析模式：解码一帧但不输出像素（硬解帧不传回系统内存，也不转换 NV12），
+    // 只更新运动检测和码流统计。用于不在显示中、只需要运动事件的通道
+    bool analyzeFrame() {
+        if (cache_lag > 0 && !catchUpAfterCache()) return false;
+        if (!receiveFrame()) return false;
+        updateTimestamp();
+        if (bitstream_stats) {
+            bitstream_stats->add(frame, current_pts, frame_index);
+        }
+        if (motion_analyzer) {
+            motion_analyzer->add(frame, current_pts, frame_index);
+        }
+        frame_index++;
+        return true;
+    }
+
+    // 跳转到指定时间（秒），之后第一次 decodeFrame 返回不早于该时间的帧
+    bool seek(double seconds) {
+        if (!initialized || !fmt_ctx) return false;
+        if (!seekDemuxer(seconds)) return false;
+
+        AVStream* stream = fmt_ctx->streams[video_stream_idx];
+        double fps = av_q2d(stream->avg_frame_rate);
+        frame_index = fps > 0 ? (int64_t)(seconds * fps + 0.5) : 0;
+        if (scene_detector) {
+            scene_detector->reset();
+        }
+        if (bitstream_stats) {
+            bitstream_stats->resetGop();
+        }
+        if (motion_analyzer) {
+            motion_analyzer->reset(seconds, frame_index);
+        }
+        return true;
+    }
+
+    // 获取时长（秒），未知时返回 0
+    double getDuration() const {
+        if (!initialized || !fmt_ctx) return 0;
+        // 播放列表的 EXTINF 之和比 demuxer 按码率估计的准确，仍在录制时随之增长
+        if (playlist) {
+            return playlist->duration();
+        }
+        if (fmt_ctx->duration != AV_NOPTS_VALUE) {
+            return (double)fmt_ctx->duration / AV_TIME_BASE;
+        }
+        AVStream* stream = fmt_ctx->streams[video_stream_idx];
+        if (stream->duration != AV_NOPTS_VALUE) {
+            return stream->duration * av_q2d(stream->time_base);
+        }
+        return 0;
+    }
+
+    // 解码数据包（从内存）
+    bool decodePacket(const uint8_t* packet_data, size_t packet_size,
+                     uint8_t** out_data, int* out_width, int* out_height, size_t* out_size) {
+        if (!initialized) return false;
+
+        // 设置数据包
+        packet->data = const_cast<uint8_t*>(packet_data);
+        packet->size = packet_size;
+        if (bitstream_stats) {
+            BitstreamStats::tagPacket(packet);
+        }
+
+        // 发送数据包到解码器
+        int ret = avcodec_send_packet(codec_ctx, packet);
+        if (ret < 0) {
+            return false;
+        }
+
+        // 接收解码后的帧
+        ret = avcodec_receive_frame(codec_ctx, frame);
+        if (ret == AVERROR(EAGAIN)) {
+            // 需要更多数据
+            return false;
+        } else if (ret < 0) {
+            return false;
+        }
+
+        // 成功解码一帧
+        return extractNV12Frame(out_data, out_width, out_height, out_size);
+    }
+
+    // 获取视频信息
+    bool getVideoInfo(int* width, int* height, std::string* codec_name, int* fps_num, int* fps_den) {
+        if (!initialized || !fmt_ctx) return false;
+
+        AVStream* stream = fmt_ctx->streams[video_stream_idx];
+        *width = codec_ctx->width;
+        *height = codec_ctx->height;
+        *codec_name = avcodec_get_name(codec_ctx->codec_id);
+        *fps_num = stream->avg_frame_rate.num;
+        *fps_den = stream->avg_frame_rate.den;
+
+        return true;
+    }
+
+    // 获取最后的错误信息
+    std::string getLastError() const {
+        return last_error;
+    }
+
+    double getCurrentPts() const {
+        return current_pts;
+    }
+
+    // 复制最近一次输出的 NV12 帧
+    bool copyCurrentFrame(std::vector<uint8_t>& out, int* width, int* height) const {
+        if (!nv12_buffer || last_width <= 0 || last_height <= 0) return false;
+        size_t size = (size_t)last_width * last_height * 3 / 2;
+        out.assign(nv12_buffer.get(), nv12_buffer.get() + size);
+        *width = last_width;
+        *height = last_height;
+        return true;
+    }
+
+    // 开启场景切换检测，事件在后台线程回调
+    void enableSceneDetection(double threshold, int min_scene_frames,
+                              SceneDetector::EventCallback callback) {
+        if (!scene_detector) {
+            scene_detector = std::make_unique<SceneDetector>();
+        }
+        scene_detector->configure(threshold, min_scene_frames);
+        scene_detector->setCallback(std::move(callback));
+    }
+
+    void disableSceneDetection() {
+        scene_detector.reset();
+    }
+
+    // 开启逐帧码流统计，每 batch_frames 帧可取出一批记录（见 BitstreamStatsField）
+    void enableBitstreamStats(int batch_frames) {
+        bitstream_stats = std::make_unique<BitstreamStats>(batch_frames);
+        if (codec_ctx) {
+            BitstreamStats::configureContext(codec_ctx);
+        }
+    }
+
+    // 预读 I/O 参数，下一次 initFromFile 生效
+    void setReadAhead(const ReadAheadFile::Config& config) {
+        io_config = config;
+    }
+
+    bool usingReadAhead() const {
+        return io_file != nullptr;
+    }
+
+    ReadAheadFile::Stats readAheadStats() const {
+        return io_file ? io_file->stats() : ReadAheadFile::Stats();
+    }
+
+    const SegmentPlaylist* segmentPlaylist() const {
+        return playlist.get();
+    }
+
+    bool isHardwareAccelerated() const {
+        return initialized && use_hw_accel;
+    }
+
+    int64_t currentFrameIndex() const {
+        return frame_index;
+    }
+
+    // 最近输出的帧是否是新分辨率的第一帧
+    bool formatChanged(int* prev_width, int* prev_height) const {
+        if (!format_changed) return false;
+        *prev_width = previous_width;
+        *prev_height = previous_height;
+        return true;
+    }
+
+    uint64_t formatChangeCount() const {
+        return format_changes;
+    }
+
+    // 按可能出现的最大分辨率预先分配输出缓冲，流中途变大时不再重新分配
+    void reserveOutput(int max_width, int max_height) {
+        size_t size = (size_t)std::max(0, max_width) * std::max(0, max_height) * 3 / 2;
+        if (nv12_buffer_size < size) {
+            nv12_buffer = std::make_unique<uint8_t[]>(size);
+            nv12_buffer_size = size;
+        }
+    }
+
+    void disableBitstreamStats() {
+        bitstream_stats.reset();
+        if (codec_ctx) {
+            BitstreamStats::unconfigureContext(codec_ctx);
+        }
+    }
+
+    BitstreamStats* bitstreamStats() {
+        return bitstream_stats.get();
+    }
+
+    // 开启运动矢量运动检测；已用 VA-API 打开的输入要重新 initFromFile 才会改为软解导出矢量
+    void enableMotionAnalysis(const MotionAnalyzer::Options& options) {
+        motion_analyzer = std::make_unique<MotionAnalyzer>(options);
+        if (codec_ctx) {
+            MotionAnalyzer::configureContext(codec_ctx);
+        }
+    }
+
+    void disableMotionAnalysis() {
+        motion_analyzer.reset();
+        if (codec_ctx) {
+            MotionAnalyzer::unconfigureContext(codec_ctx);
+        }
+    }
+
+    MotionAnalyzer* motionAnalyzer() {
+        return motion_analyzer.get();
+    }
+
+    // 当前解码器能否导出运动矢量：软解且为基于宏块运动补偿的编码
+    bool motionVectorsAvailable() const {
+        if (!initialized || use_hw_accel || !codec_ctx) return false;
+        switch (codec_ctx->codec_id) {
+            case AV_CODEC_ID_H264:
+            case AV_CODEC_ID_MPEG1VIDEO:
+            case AV_CODEC_ID_MPEG2VIDEO:
+            case AV_CODEC_ID_MPEG4:
+            case AV_CODEC_ID_H263:
+            case AV_CODEC_ID_H263P:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // 打开（不存在时创建）跨窗口帧缓存，content_id 标识当前内容（如路径 + 修改时间）
+    // 槽大小为当前视频一帧 NV12（reserveOutput 预留更大时取预留大小），
+    // budget 为 0 时取容器资源限制的 cache_budget
+    bool attachFrameCache(const std::string& name, const std::string& content_id, uint64_t budget) {
+        if (!codec_ctx || codec_ctx->width <= 0 || codec_ctx->height <= 0) {
+            last_error = "Decoder not initialized";
+            return false;
+        }
+        uint32_t slot_size = (uint32_t)std::max<size_t>(codec_ctx->width * codec_ctx->height * 3 / 2,
+                                                        nv12_buffer_size);
+        if (budget == 0) budget = ResourceLimits::get().cache_budget;
+
+        auto cache = std::make_unique<ShmFrameCache>();
+        if (!cache->openOrCreate(name, ShmFrameCache::slotsForBudget(budget, slot_size), slot_size)) {
+            last_error = "Failed to open frame cache " + name;
+            return false;
+        }
+        frame_cache = std::move(cache);
+        frame_cache_content = ShmFrameCache::contentKey(content_id);
+        return true;
+    }
+
+    // 下一次 initFromFile 生效
+    void setDecodeProfile(const DecodeProfile& p) {
+        profile = p;
+        profile.lowres = std::max(0, std::min(3, profile.lowres));
+    }
+
+    // 从缓存输出过的帧 demuxer 尚未经过，下一次解码前需要追上
+    void detachFrameCache() {
+        frame_cache.reset();
+        if (cache_lag > 0) catchUpAfterCache();
+        next_ts = AV_NOPTS_VALUE;
+    }
+
+    ShmFrameCache* frameCache() {
+        return frame_cache.get();
+    }
+
+    uint64_t cachedFrameCount() const {
+        return cache_frames;
+    }
+
+    uint64_t frameCacheContent() const {
+        return frame_cache_content;
+    }
+
+    void setOverlay(std::shared_ptr<OsdOverlay> overlay) {
+        osd_overlay = std::move(overlay);
+    }
+
+private:
+    // 解析播放列表并把各分段拼接成一个输入；input 为用于探测格式的名字（第一个分段），
+    // 不能用 .m3u8，否则会被 FFmpeg 的 hls demuxer 接管
+    bool openPlaylist(const std::string& filename, std::string* input) {
+        std::string path = filename.compare(0, 5, "file:") == 0 ? filename.substr(5) : filename;
+        auto list = std::make_unique<SegmentPlaylist>();
+        std::string error;
+        if (!list->load(path, error)) {
+            last_error = error;
+            return false;
+        }
+        io_file = std::make_unique<ReadAheadFile>();
+        if (!io_file->openSegments(list->files(), io_config, error)) {
+            last_error = error;
+            io_file.reset();
+            return false;
+        }
+        io_ctx = io_file->createAvio();
+        fmt_ctx = io_ctx ? avformat_alloc_context() : nullptr;
+        if (!fmt_ctx) {
+            last_error = "Failed to allocate playlist input";
+            ReadAheadFile::freeAvio(&io_ctx);
+            io_file.reset();
+            return false;
+        }
+        fmt_ctx->pb = io_ctx;
+        fmt_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+        // 仍在录制的播放列表：读到末尾时追加新分段（在解码调用的线程中）
+        playlist = std::move(list);
+        if (!playlist->ended()) {
+            SegmentPlaylist* pl = playlist.get();
+            io_file->setGrowCallback([pl] { return pl->refresh(); });
+        }
+        *input = playlist->entries().front().path;
+        return true;
+    }
+
+    // 预先创建 fmt_ctx 并挂上自定义 AVIOContext，失败时保持 fmt_ctx 为空
+    void openReadAhead(const std::string& filename) {
+        if (!io_config.enabled) return;
+        std::string path = filename;
+        if (path.compare(0, 5, "file:") == 0) {
+            path = path.substr(5);
+        } else if (path.find("://") != std::string::npos) {
+            return;
+        }
+
+        io_file = std::make_unique<ReadAheadFile>();
+        std::string error;
+        if (!io_file->open(path, io_config, error)) {
+            fprintf(stderr, "Read-ahead disabled: %s\n", error.c_str());
+            io_file.reset();
+            return;
+        }
+        io_ctx = io_file->createAvio();
+        fmt_ctx = io_ctx ? avformat_alloc_context() : nullptr;
+        if (!fmt_ctx) {
+            ReadAheadFile::freeAvio(&io_ctx);
+            io_file.reset();
+            return;
+        }
+        fmt_ctx->pb = io_ctx;
+        fmt_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
+
+    // 只移动 demuxer 并清空解码器，之后 receiveFrame 丢弃 seconds 之前的帧
+    bool seekDemuxer(double seconds) {
+        AVStream* stream = fmt_ctx->streams[video_stream_idx];
+        int ret;
+        if (playlist && strcmp(fmt_ctx->iformat->name, "mpegts") == 0) {
+            // TS 分段以关键帧开头：直接定位到目标所在分段的起始字节，不必在整个会话中二分查找时间戳
+            size_t entry = playlist->entryAt(seconds);
+            ret = av_seek_frame(fmt_ctx, -1, io_file->segmentOffset(entry), AVSEEK_FLAG_BYTE);
+        } else {
+            int64_t ts = (int64_t)(seconds / av_q2d(stream->time_base));
+            if (stream->start_time != AV_NOPTS_VALUE) {
+                ts += stream->start_time;
+            }
+            ret = av_seek_frame(fmt_ctx, video_stream_idx, ts, AVSEEK_FLAG_BACKWARD);
+        }
+        if (ret < 0) {
+            char errbuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            last_error = "Failed to seek: " + std::string(errbuf);
+            return false;
+        }
+        avcodec_flush_buffers(codec_ctx);
+        seek_target = seconds;
+        next_ts = AV_NOPTS_VALUE;
+        cache_lag = 0;
+        return true;
+    }
+
+    // 从文件读取数据包直到解码出一帧（在 frame 中），seek 后丢弃目标时间之前的帧
+    bool receiveFrame() {
+        if (!initialized) return false;
+
+        while (true) {
+            // 读取数据包
+            int ret = av_read_frame(fmt_ctx, packet);
+            if (ret < 0) {
+                // 文件结束或错误
+                return false;
+            }
+
+            if (packet->stream_index != video_stream_idx) {
+                av_packet_unref(packet);
+                continue;
+            }
+            if (bitstream_stats) {
+                BitstreamStats::tagPacket(packet);
+            }
+
+            // 发送数据包到解码器
+            ret = avcodec_send_packet(codec_ctx, packet);
+            av_packet_unref(packet);
+
+            if (ret < 0) {
+                return false;
+            }
+
+            // 接收解码后的帧
+            ret = avcodec_receive_frame(codec_ctx, frame);
+            if (ret == AVERROR(EAGAIN)) {
+                continue;
+            } else if (ret < 0) {
+                return false;
+            }
+
+            // seek 后从关键帧开始解码，丢弃目标时间之前的帧
+            if (seek_target >= 0) {
+                updateTimestamp();
+                if (current_pts + 0.001 < seek_target) {
+                    av_frame_unref(frame);
+                    continue;
+                }
+                seek_target = -1;
+            }
+
+            return true;
+        }
+    }
+
+    // 获取硬件像素格式
+    static enum AVPixelFormat get_hw_format(AVCodecContext* ctx, const enum AVPixelFormat* pix_fmts) {
+        for (const enum AVPixelFormat* p = pix_fmts; *p != AV_PIX_FMT_NONE; p++) {
+            if (*p == AV_PIX_FMT_VAAPI) {
+                return *p;
+            }
+        }
+        return AV_PIX_FMT_NONE;
+    }
+
+    // 提取 NV12 格式数据
+    bool extractNV12Frame(uint8_t** out_data, int* out_width, int* out_height, size_t* out_size) {
+        AVFrame* target_frame = frame;
+
+        // 如果是硬件帧，需要传输到系统内存
+        if (frame->format == AV_PIX_FMT_VAAPI) {
+            if (av_hwframe_transfer_data(sw_frame, frame, 0) < 0) {
+                return false;
+            }
+            target_frame = sw_frame;
+        }
+
+        int width = target_frame->width;
+        int height = target_frame->height;
+        size_t nv12_size = width * height * 3 / 2;
+
+        updateTimestamp();
+
+        // 只有变大时才重新分配；预先 reserveOutput 过则不会发生
+        if (nv12_buffer_size < nv12_size) {
+            nv12_buffer = std::make_unique<uint8_t[]>(nv12_size);
+            nv12_buffer_size = nv12_size;
+        }
+
+        // 转换为 NV12 格式（如果需要）
+        if (target_frame->format == AV_PIX_FMT_NV12) {
+            // 已经是 NV12，直接复制
+            copyNV12Data(target_frame, nv12_buffer.get(), width, height);
+        } else if (target_frame->format == AV_PIX_FMT_YUV420P) {
+            // 从 YUV420P 转换为 NV12
+            convertYUV420PtoNV12(target_frame, nv12_buffer.get(), width, height);
+        } else {
+            // 不支持的格式
+            return false;
+        }
+
+        if (bitstream_stats) {
+            bitstream_stats->add(frame, current_pts, frame_index);
+        }
+        if (motion_analyzer) {
+            motion_analyzer->add(frame, current_pts, frame_index);
+        }
+        if (scene_detector) {
+            scene_detector->submit(nv12_buffer.get(), width, height, width,
+                                   current_pts, frame_index);
+        }
+        // 缓存叠加前的帧，各窗口的 OSD 设置可以不同
+        if (frame_cache) {
+            frame_cache->put(frame_cache_content, current_pts, nv12_buffer.get(), (uint32_t)nv12_size,
+                             width, height, SHM_PIXEL_NV12, width);
+            next_ts = expectedNextTimestamp();
+        }
+        return finishOutputFrame(width, height, nv12_size, out_data, out_width, out_height, out_size);
+    }
+
+    // 解码帧和缓存帧共用：叠加 OSD，更新帧序号和分辨率变化状态
+    bool finishOutputFrame(int width, int height, size_t nv12_size,
+                           uint8_t** out_data, int* out_width, int* out_height, size_t* out_size) {
+        // 场景检测之后叠加，文字和框不影响检测结果
+        if (osd_overlay) {
+            OsdOverlay::Context ctx;
+            ctx.pts = current_pts;
+            ctx.frame_index = frame_index;
+            if (fmt_ctx && video_stream_idx >= 0) {
+                ctx.fps = av_q2d(fmt_ctx->streams[video_stream_idx]->avg_frame_rate);
+            }
+            osd_overlay->render(OsdFrame::nv12(nv12_buffer.get(), width, height, width), ctx);
+        }
+        frame_index++;
+        format_changed = last_width > 0 && (width != last_width || height != last_height);
+        if (format_changed) {
+            previous_width = last_width;
+            previous_height = last_height;
+            format_changes++;
+        }
+        last_width = width;
+        last_height = height;
+
+        *out_data = nv12_buffer.get();
+        *out_width = width;
+        *out_height = height;
+        *out_size = nv12_size;
+
+        return true;
+    }
+
+    // 下一帧的时间戳（流时间基）按 r_frame_rate 推算为当前帧加一帧时长；可变帧率时可能猜错，
+    // 只是查不到缓存而照常解码。无时间戳时返回 AV_NOPTS_VALUE，不查缓存
+    int64_t expectedNextTimestamp() const {
+        if (!fmt_ctx || video_stream_idx < 0 || frame->best_effort_timestamp == AV_NOPTS_VALUE) {
+            return AV_NOPTS_VALUE;
+        }
+        int64_t step = frameStep();
+        return step > 0 ? frame->best_effort_timestamp + step : AV_NOPTS_VALUE;
+    }
+
+    int64_t frameStep() const {
+        AVStream* stream = fmt_ctx->streams[video_stream_idx];
+        if (stream->r_frame_rate.num <= 0 || stream->r_frame_rate.den <= 0) return 0;
+        return av_rescale_q(1, av_inv_q(stream->r_frame_rate), stream->time_base);
+    }
+
+    // 缓存优先：其他窗口（领先者）已解码出下一帧时直接复制，不读数据包也不解码。
+    // 码流统计和运动检测需要解码器输出，开启时不走缓存；seek 后第一帧之前下一帧未知
+    bool readNextCachedFrame(uint8_t** out_data, int* out_width, int* out_height, size_t* out_size) {
+        if (!frame_cache || next_ts == AV_NOPTS_VALUE || seek_target >= 0 ||
+            bitstream_stats || motion_analyzer || !nv12_buffer) {
+            return false;
+        }
+        AVStream* stream = fmt_ctx->streams[video_stream_idx];
+        int64_t start_time = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+        double pts = (next_ts - start_time) * av_q2d(stream->time_base);
+
+        ShmFrameCache::FrameInfo info;
+        bool fits = true;
+        bool hit = frame_cache->getWith(frame_cache_content, pts, &info, [&](const uint8_t* src) {
+            fits = info.format == SHM_PIXEL_NV12 && info.size <= nv12_buffer_size &&
+                   info.size == (size_t)info.width * info.height * 3 / 2;
+            if (fits) memcpy(nv12_buffer.get(), src, info.size);
+        });
+        if (!hit || !fits) return false;
+
+        current_pts = pts;
+        next_ts += frameStep();
+        cache_lag++;
+        cache_frames++;
+        if (scene_detector) {
+            scene_detector->submit(nv12_buffer.get(), info.width, info.height, info.width,
+                                   current_pts, frame_index);
+        }
+        return finishOutputFrame(info.width, info.height, info.size, out_data, out_width, out_height, out_size);
+    }
+
+    // 缓存未命中：demuxer 仍停在最后一次解码的位置。落后不多时向前解码并丢弃已从缓存输出的帧，
+    // 否则 seek 到下一帧（从之前的关键帧解码）。两种方式下一次 receiveFrame 都返回下一帧
+    bool catchUpAfterCache() {
+        AVStream* stream = fmt_ctx->streams[video_stream_idx];
+        int64_t start_time = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+        double target = (next_ts - start_time) * av_q2d(stream->time_base);
+        bool far = cache_lag > kCacheDecodeAhead;
+        cache_lag = 0;
+        if (far) return seekDemuxer(target);
+        seek_target = target;
+        return true;
+    }
+
+    // 根据流时间基计算当前帧时间戳（相对流起始时间），无时间戳时按帧率推算
+    void updateTimestamp() {
+        AVRational time_base = {0, 1};
+        AVRational frame_rate = {0, 1};
+        int64_t start_time = 0;
+        if (fmt_ctx && video_stream_idx >= 0) {
+            AVStream* stream = fmt_ctx->streams[video_stream_idx];
+            time_base = stream->time_base;
+            frame_rate = stream->avg_frame_rate;
+            if (stream->start_time != AV_NOPTS_VALUE) {
+                start_time = stream->start_time;
+            }
+        }
+
+        int64_t ts = frame->best_effort_timestamp;
+        if (ts != AV_NOPTS_VALUE && time_base.num > 0) {
+            current_pts = (ts - start_time) * av_q2d(time_base);
+        } else if (frame_rate.num > 0 && frame_rate.den > 0) {
+            current_pts = frame_index / av_q2d(frame_rate);
+        } else {
+            current_pts = (double)frame_index;
+        }
+    }
+
+    // 复制 NV12 数据
+    void copyNV12Data(AVFrame* frame, uint8_t* dst, int width, int height) {
+        // 复制 Y 平面
+        uint8_t* dst_y = dst;
+        for (int i = 0; i < height; i++) {
+            memcpy(dst_y + i * width, frame->data[0] + i * frame->linesize[0], width);
+        }
+
+        // 复制 UV 平面
+        uint8_t* dst_uv = dst + width * height;
+        for (int i = 0; i < height / 2; i++) {
+            memcpy(dst_uv + i * width, frame->data[1] + i * frame->linesize[1], width);
+        }
+    }
+
+    // YUV420P 转 NV12
+    void convertYUV420PtoNV12(AVFrame* frame, uint8_t* dst, int width, int height) {
+        // 复制 Y 平面
+        uint8_t* dst_y = dst;
+        for (int i = 0; i < height; i++) {
+            memcpy(dst_y + i * width, frame->data[0] + i * frame->linesize[0], width);
+        }
+
+        // 交错 U 和 V 平面生成 UV 平面
+        uint8_t* dst_uv = dst + width * height;
+        uint8_t* src_u = frame->data[1];
+        uint8_t* src_v = frame->data[2];
+        
+        for (int i = 0; i < height / 2; i++) {
+            for (int j = 0; j < width / 2; j++) {
+                dst_uv[i * width + j * 2 + 0] = src_u[i * frame->linesize[1] + j];
+                dst_uv[i * width + j * 2 + 1] = src_v[i * frame->linesize[2] + j];
+            }
+        }
+    }
+};
@@ -0,0 +1,352 @@
+/**
+ * x264/x265 编码器封装
+ * 输入 NV12，输出 Annex-B 码流
+ */
+#pragma once
+
+#include <x264.h>
+#include <x265.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "resource_limits.h"
+
+class X26xEncoder {
+public:
+    struct Config {
+        std::string codec = "h264";        // h264 / hevc
+        std::string latency = "zerolatency"; // zerolatency / realtime / offline
+        int width = 0;
+        int height = 0;
+        int fps_num = 30;
+        int fps_den = 1;
+        int bitrate_kbps = 4000;
+        int keyint = 0;                    // 0 表示编码器默认
+        int threads = 0;                   // 0 表示自动
+        bool low_priority = false;         // 后台任务：使用更少线程
+        bool repeat_headers = true;        // 每个关键帧前重复 SPS/PPS（裸流需要，封装时关闭）
+    };
+
+    // 输出包的时间戳与关键帧标记（encode 产生数据时有效）
+    struct PacketInfo {
+        int64_t pts = 0;
+        int64_t dts = 0;
+        bool keyframe = false;
+    };
+
+    X26xEncoder() = default;
+    ~X26xEncoder() { close(); }
+
+    X26xEncoder(const X26xEncoder&) = delete;
+    X26xEncoder& operator=(const X26xEncoder&) = delete;
+
+    bool open(const Config& config, std::string& error) {
+        close();
+        config_ = config;
+        if (config.width <= 0 || config.height <= 0 || (config.width & 1) || (config.height & 1)) {
+            error = "Invalid encoder size";
+            return false;
+        }
+        if (config.codec == "h264") {
+            return openX264(error);
+        } else if (config.codec == "hevc" || config.codec == "h265") {
+            return openX265(error);
+        }
+        error = "Unsupported encoder codec: " + config.codec;
+        return false;
+    }
+
+    bool isOpen() const { return x264_ != nullptr || x265_ != nullptr; }
+    const Config& config() const { return config_; }
+
+    // 编码一帧 NV12（stride 为 Y/UV 平面行跨度），码流追加到 out
+    bool encode(const uint8_t* nv12, int stride, int64_t pts, std::vector<uint8_t>& out,
+                PacketInfo* info = nullptr) {
+        if (x264_) {
+            x264_picture_t pic_in;
+            x264_picture_t pic_out;
+            x264_picture_init(&pic_in);
+            pic_in.img.i_csp = X264_CSP_NV12;
+            pic_in.img.i_plane = 2;
+            pic_in.img.plane[0] = const_cast<uint8_t*>(nv12);
+            pic_in.img.i_stride[0] = stride;
+            pic_in.img.plane[1] = const_cast<uint8_t*>(nv12) + (size_t)stride * config_.height;
+            pic_in.img.i_stride[1] = stride;
+            pic_in.i_pts = pts;
+            return encodeX264(&pic_in, &pic_out, out, info);
+        }
+        if (x265_) {
+            splitNV12(nv12, stride);
+            x265_pic_->pts = pts;
+            return encodeX265(x265_pic_, out, info);
+        }
+        return false;
+    }
+
+    // 取出一个编码器缓存的帧，没有更多数据时 out 不变
+    bool flushOne(std::vector<uint8_t>& out, PacketInfo* info = nullptr) {
+        if (x264_) {
+            x264_picture_t pic_out;
+            if (x264_encoder_delayed_frames(x264_) <= 0) return true;
+            return encodeX264(nullptr, &pic_out, out, info);
+        }
+        if (x265_) {
+            return encodeX265(nullptr, out, info);
+        }
+        return false;
+    }
+
+    // 输出编码器内部缓存的所有帧
+    bool flush(std::vector<uint8_t>& out) {
+        size_t before;
+        do {
+            before = out.size();
+            if (!flushOne(out)) return false;
+        } while (out.size() != before);
+        return true;
+    }
+
+    // 获取 SPS/PPS(/VPS) 头（Annex-B），用于封装格式的 extradata
+    bool headers(std::vector<uint8_t>& out) {
+        if (x264_) {
+            x264_nal_t* nals = nullptr;
+            int nal_count = 0;
+            int size = x264_encoder_headers(x264_, &nals, &nal_count);
+            if (size < 0) return false;
+            out.assign(nals[0].p_payload, nals[0].p_payload + size);
+            return true;
+        }
+        if (x265_) {
+            x265_nal* nals = nullptr;
+            uint32_t nal_count = 0;
+            if (x265_encoder_headers(x265_, &nals, &nal_count) < 0) return false;
+            out.clear();
+            for (uint32_t i = 0; i < nal_count; i++) {
+                out.insert(out.end(), nals[i].payload, nals[i].payload + nals[i].sizeBytes);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void close() {
+        if (x264_) {
+            x264_encoder_close(x264_);
+            x264_ = nullptr;
+        }
+        if (x265_) {
+            x265_encoder_close(x265_);
+            x265_ = nullptr;
+        }
+        if (x265_pic_) {
+            x265_picture_free(x265_pic_);
+            x265_pic_ = nullptr;
+        }
+        if (x265_pic_out_) {
+            x265_picture_free(x265_pic_out_);
+            x265_pic_out_ = nullptr;
+        }
+        if (x265_param_) {
+            x265_param_free(x265_param_);
+            x265_param_ = nullptr;
+        }
+        i420_.clear();
+    }
+
+private:
+    Config config_;
+    x264_t* x264_ = nullptr;
+    x265_encoder* x265_ = nullptr;
+    x265_param* x265_param_ = nullptr;
+    x265_picture* x265_pic_ = nullptr;
+    x265_picture* x265_pic_out_ = nullptr;
+    std::vector<uint8_t> i420_; // x265 不支持 NV12 输入，需要拆分 UV
+
+    // 延迟模式对应的 preset/tune
+    void presetFor(const char** preset, const char** tune) const {
+        if (config_.latency == "zerolatency") {
+            *preset = "ultrafast";
+            *tune = "zerolatency";
+        } else if (config_.latency == "realtime") {
+            *preset = "veryfast";
+            *tune = "zerolatency";
+        } else {
+            *preset = "faster";
+            *tune = nullptr;
+        }
+    }
+
+    bool openX264(std::string& error) {
+        const char* preset;
+        const char* tune;
+        presetFor(&preset, &tune);
+
+        x264_param_t param;
+        if (x264_param_default_preset(&param, preset, tune) < 0) {
+            error = "Failed to apply x264 preset";
+            return false;
+        }
+        param.i_csp = X264_CSP_NV12;
+        param.i_width = config_.width;
+        param.i_height = config_.height;
+        param.i_fps_num = config_.fps_num;
+        param.i_fps_den = config_.fps_den;
+        param.i_timebase_num = config_.fps_den;
+        param.i_timebase_den = config_.fps_num;
+        param.b_vfr_input = 0;
+        param.b_repeat_headers = config_.repeat_headers ? 1 : 0;
+        param.b_annexb = 1;
+        param.i_log_level = X264_LOG_WARNING;
+        param.rc.i_rc_method = X264_RC_ABR;
+        param.rc.i_bitrate = config_.bitrate_kbps;
+        param.rc.i_vbv_max_bitrate = config_.bitrate_kbps;
+        param.rc.i_vbv_buffer_size = config_.bitrate_kbps;
+        if (config_.keyint > 0) {
+            param.i_keyint_max = config_.keyint;
+            param.i_keyint_min = config_.keyint;
+        }
+        // 自动模式下 x264 按宿主机核数开线程，容器内改用配额核数
+        int encode_threads = ResourceLimits::get().encode_threads;
+        if (config_.threads > 0) {
+            param.i_threads = config_.threads;
+        } else if (config_.low_priority) {
+            param.i_threads = std::min(2, encode_threads);
+        } else {
+            param.i_threads = encode_threads;
+        }
+        if (config_.latency == "realtime") {
+            param.i_bframe = 0;
+            param.rc.i_lookahead = 0;
+            param.b_sliced_threads = 0;
+        }
+
+        if (x264_param_apply_profile(&param, "high") < 0) {
+            error = "Failed to apply x264 profile";
+            return false;
+        }
+
+        x264_ = x264_encoder_open(&param);
+        if (!x264_) {
+            error = "Failed to open x264 encoder";
+            return false;
+        }
+        return true;
+    }
+
+    bool openX265(std::string& error) {
+        const char* preset;
+        const char* tune;
+        presetFor(&preset, &tune);
+
+        x265_param_ = x265_param_alloc();
+        if (!x265_param_ || x265_param_default_preset(x265_param_, preset, tune) < 0) {
+            error = "Failed to apply x265 preset";
+            return false;
+        }
+        x265_param_->sourceWidth = config_.width;
+        x265_param_->sourceHeight = config_.height;
+        x265_param_->fpsNum = config_.fps_num;
+        x265_param_->fpsDenom = config_.fps_den;
+        x265_param_->internalCsp = X265_CSP_I420;
+        x265_param_->bRepeatHeaders = config_.repeat_headers ? 1 : 0;
+        x265_param_->bAnnexB = 1;
+        x265_param_->logLevel = X265_LOG_WARNING;
+        x265_param_->rc.rateControlMode = X265_RC_ABR;
+        x265_param_->rc.bitrate = config_.bitrate_kbps;
+        x265_param_->rc.vbvMaxBitrate = config_.bitrate_kbps;
+        x265_param_->rc.vbvBufferSize = config_.bitrate_kbps;
+        if (config_.keyint > 0) {
+            x265_param_->keyframeMax = config_.keyint;
+            x265_param_->keyframeMin = config_.keyint;
+        }
+        int encode_threads = ResourceLimits::get().encode_threads;
+        int threads = config_.threads > 0 ? config_.threads
+                                          : (config_.low_priority ? std::min(2, encode_threads) : encode_threads);
+        if (threads > 0) {
+            std::string pools = std::to_string(threads);
+            x265_param_parse(x265_param_, "pools", pools.c_str());
+            x265_param_->frameNumThreads = 1;
+        }
+
+        x265_ = x265_encoder_open(x265_param_);
+        if (!x265_) {
+            error = "Failed to open x265 encoder";
+            return false;
+        }
+
+        x265_pic_ = x265_picture_alloc();
+        x265_picture_init(x265_param_, x265_pic_);
+        x265_pic_out_ = x265_picture_alloc();
+        x265_picture_init(x265_param_, x265_pic_out_);
+        size_t luma = (size_t)config_.width * config_.height;
+        i420_.resize(luma * 3 / 2);
+        x265_pic_->planes[0] = i420_.data();
+        x265_pic_->planes[1] = i420_.data() + luma;
+        x265_pic_->planes[2] = i420_.data() + luma + luma / 4;
+        x265_pic_->stride[0] = config_.width;
+        x265_pic_->stride[1] = config_.width / 2;
+        x265_pic_->stride[2] = config_.width / 2;
+        return true;
+    }
+
+    bool encodeX264(x264_picture_t* pic_in, x264_picture_t* pic_out, std::vector<uint8_t>& out,
+                    PacketInfo* info) {
+        x264_nal_t* nals = nullptr;
+        int nal_count = 0;
+        int size = x264_encoder_encode(x264_, &nals, &nal_count, pic_in, pic_out);
+        if (size < 0) return false;
+        if (size > 0) {
+            // x264 保证所有 NAL 负载在内存中连续
+            out.insert(out.end(), nals[0].p_payload, nals[0].p_payload + size);
+            if (info) {
+                info->pts = pic_out->i_pts;
+                info->dts = pic_out->i_dts;
+                info->keyframe = pic_out->b_keyframe != 0;
+            }
+        }
+        return true;
+    }
+
+    bool encodeX265(x265_picture* pic_in, std::vector<uint8_t>& out, PacketInfo* info) {
+        x265_nal* nals = nullptr;
+        uint32_t nal_count = 0;
+        int ret = x265_encoder_encode(x265_, &nals, &nal_count, pic_in, x265_pic_out_);
+        if (ret < 0) return false;
+        for (uint32_t i = 0; i < nal_count; i++) {
+            out.insert(out.end(), nals[i].payload, nals[i].payload + nals[i].sizeBytes);
+        }
+        if (nal_count > 0 && info) {
+            info->pts = x265_pic_out_->pts;
+            info->dts = x265_pic_out_->dts;
+            info->keyframe = x265_pic_out_->sliceType == X265_TYPE_IDR ||
+                             x265_pic_out_->sliceType == X265_TYPE_I;
+        }
+        return true;
+    }
+
+    // NV12 -> I420
+    void splitNV12(const uint8_t* nv12, int stride) {
+        int w = config_.width;
+        int h = config_.height;
+        uint8_t* y = static_cast<uint8_t*>(x265_pic_->planes[0]);
+        uint8_t* u = static_cast<uint8_t*>(x265_pic_->planes[1]);
+        uint8_t* v = static_cast<uint8_t*>(x265_pic_->planes[2]);
+        for (int row = 0; row < h; row++) {
+            memcpy(y + (size_t)row * w, nv12 + (size_t)row * stride, w);
+        }
+        const uint8_t* uv = nv12 + (size_t)stride * h;
+        for (int row = 0; row < h / 2; row++) {
+            const uint8_t* src = uv + (size_t)row * stride;
+            uint8_t* du = u + (size_t)row * (w / 2);
+            uint8_t* dv = v + (size_t)row * (w / 2);
+            for (int x = 0; x < w / 2; x++) {
+                du[x] = src[x * 2];
+                dv[x] = src[x * 2 + 1];
+            }
+        }
+    }
+};
@@ -0,0 +1,114 @@
+#!/bin/bash
+# Native addon PGO + LTO 优化构建
+#
+# 1. 默认参数构建，跑一次基准作为对照
+# 2. 插桩构建 (-fprofile-generate)，用 scripts/native-bench.mjs 的合成负载训练
+# 3. 用采集到的 profile 以 -O3 + LTO + -fprofile-use 重新构建，可选多个 -march 变体
+# 4. 每个变体跑同样的基准，输出对比报告
+#
+# 环境变量:
+#   NATIVE_MARCH="x86-64-v3 native"  额外构建的 -march 变体（空格分隔），默认不构建
+#   NATIVE_PGO_INSTALL=pgo           最后安装到 build/Release 的变体，默认 pgo
+#   BENCH_FRAMES=300                 基准帧数
+#
+# 只对 shared_memory、vaapi_decoder、synthetic_decoder 生效；pure_vaapi_decoder 固定 -std=c++14，
+# 仍使用默认参数构建
+
+set -e
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+OUT="$ROOT/build/native-pgo"
+PROFILE_DIR="$OUT/profiles"
+BENCH="$ROOT/scripts/native-bench.mjs"
+ADDONS=(shared-memory vaapi-decoder)
+MARCH_VARIANTS=(${NATIVE_MARCH:-})
+INSTALL_VARIANT="${NATIVE_PGO_INSTALL:-pgo}"
+FRAMES="${BENCH_FRAMES:-300}"
+
+CXX_BIN="${CXX:-c++}"
+if "$CXX_BIN" --version 2>/dev/null | grep -qi clang; then
+    COMPILER=clang
+    LTO_FLAG="-flto=thin"
+else
+    COMPILER=gcc
+    LTO_FLAG="-flto=auto"
+fi
+
+echo "=== Native PGO build ($COMPILER) ==="
+
+rm -rf "$OUT"
+mkdir -p "$OUT/results"
+
+# build_variant <名称> <native_opt> [march]
+build_variant() {
+    local name="$1" opt="$2" march="$3"
+    local variant_dir="$OUT/$name"
+    mkdir -p "$variant_dir"
+
+    for addon in "${ADDONS[@]}"; do
+        local profile="$PROFILE_DIR/$addon"
+        if [ "$opt" = "pgo-use" ] && [ "$COMPILER" = "clang" ]; then
+            profile="$PROFILE_DIR/$addon.profdata"
+        fi
+        echo ""
+        echo "--- [$name] $addon ---"
+        (cd "$ROOT/native/$addon" && npx node-gyp rebuild -- \
+            "-Dnative_opt=$opt" \
+            "-Dnative_march=$march" \
+            "-Dnative_profile=$profile" \
+            "-Dnative_lto=$LTO_FLAG")
+        cp "$ROOT/native/$addon"/build/Release/*.node "$variant_dir/"
+    done
+}
+
+run_bench() {
+    local name="$1"
+    echo ""
+    echo "--- 基准: $name ---"
+    node "$BENCH" --addons "$OUT/$name" --label "$name" --frames "$FRAMES" \
+        --out "$OUT/results/$name.json"
+}
+
+# 1. 对照组
+build_variant default default
+run_bench default
+
+# 2. 插桩 + 训练
+build_variant instrumented pgo-gen
+echo ""
+echo "--- 训练 ---"
+node "$BENCH" --addons "$OUT/instrumented" --train --frames "$FRAMES"
+
+if [ "$COMPILER" = "clang" ]; then
+    for addon in "${ADDONS[@]}"; do
+        llvm-profdata merge -output="$PROFILE_DIR/$addon.profdata" "$PROFILE_DIR/$addon"/*.profraw
+    done
+fi
+
+# 3. PGO + LTO 及 -march 变体
+build_variant pgo pgo-use
+run_bench pgo
+RESULTS=("$OUT/results/default.json" "$OUT/results/pgo.json")
+
+for march in "${MARCH_VARIANTS[@]}"; do
+    build_variant "pgo-$march" pgo-use "$march"
+    run_bench "pgo-$march"
+    RESULTS+=("$OUT/results/pgo-$march.json")
+done
+
+# 4. 对比报告
+node "$BENCH" --compare "${RESULTS[@]}" --report "$OUT/report.md"
+
+# 最后一次 rebuild 的产物不一定是要用的变体，按配置安装
+if [ -d "$OUT/$INSTALL_VARIANT" ]; then
+    for addon in "${ADDONS[@]}"; do
+        for file in "$ROOT/native/$addon"/build/Release/*.node; do
+            cp "$OUT/$INSTALL_VARIANT/$(basename "$file")" "$file"
+        done
+    done
+    echo "已安装变体: $INSTALL_VARIANT"
+fi
+
+echo ""
+echo "=== 完成 ==="
+echo "报告: $OUT/report.md"
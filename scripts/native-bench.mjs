@@ -0,0 +1,353 @@
+/**
+ * @file native addon 基准测试，同时作为 PGO 的训练负载
+ *
+ * 全部输入由合成解码器生成，不依赖外部视频文件：
+ *   合成帧 -> decodeFrameInto -> 共享内存帧环写入/读取 -> FrameRecorder (x264)
+ *   -> VaapiDecoder 解码 + 场景检测 -> ProxyTranscoder 生成 MP4 -> Fmp4Remuxer / PacketDemuxer
+ *
+ * 用法:
+ *   node scripts/native-bench.mjs [--addons <目录>] [--label 名称] [--out 结果.json]
+ *                                 [--frames 300] [--repeat 3] [--train]
+ *   node scripts/native-bench.mjs --compare default.json pgo.json ... [--report report.md]
+ *
+ * --addons 指向包含 shared_memory.node / vaapi_decoder.node / synthetic_decoder.node 的目录，
+ * 缺省使用 native/<addon>/build/Release。缺少的 addon 对应的测试项会被跳过
+ */
+
+/* eslint-disable */
+import path from "path";
+import fs from "fs";
+import os from "os";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+const NATIVE_DIR = path.join(__dirname, "../native");
+const ADDON_FILES = {
+  sharedMemory: "shared_memory.node",
+  vaapi: "vaapi_decoder.node",
+  synthetic: "synthetic_decoder.node",
+};
+const DEFAULT_ADDON_PATHS = {
+  sharedMemory: path.join(NATIVE_DIR, "shared-memory/build/Release", ADDON_FILES.sharedMemory),
+  vaapi: path.join(NATIVE_DIR, "vaapi-decoder/build/Release", ADDON_FILES.vaapi),
+  synthetic: path.join(NATIVE_DIR, "vaapi-decoder/build/Release", ADDON_FILES.synthetic),
+};
+
+// FrameMeta / FrameIntoResult，与 frame_result.h 一致
+const META_SIZE = 3;
+const META_LENGTH = 8;
+const FRAME_INTO_TOO_SMALL = -2;
+
+function parseArgs(argv){
+  const args = { frames: 300, repeat: 3, label: "default", compare: [] };
+  for (let i = 0; i < argv.length; i++){
+    const arg = argv[i];
+    if (arg === "--addons") args.addons = argv[++i];
+    else if (arg === "--label") args.label = argv[++i];
+    else if (arg === "--out") args.out = argv[++i];
+    else if (arg === "--report") args.report = argv[++i];
+    else if (arg === "--frames") args.frames = parseInt(argv[++i], 10);
+    else if (arg === "--repeat") args.repeat = parseInt(argv[++i], 10);
+    else if (arg === "--train") args.train = true;
+    else if (arg === "--compare"){
+      while (i + 1 < argv.length && !argv[i + 1].startsWith("--")) args.compare.push(argv[++i]);
+    }
+  }
+  // 训练只需要覆盖热点路径，不需要重复计时
+  if (args.train) args.repeat = 1;
+  return args;
+}
+
+function loadAddons(dir){
+  const addons = {};
+  const files = {};
+  for (const [key, file] of Object.entries(ADDON_FILES)){
+    const addonPath = dir ? path.join(dir, file) : DEFAULT_ADDON_PATHS[key];
+    try {
+      addons[key] = require(addonPath);
+      files[key] = { path: addonPath, size: fs.statSync(addonPath).size };
+    } catch (err){
+      console.warn(`跳过 ${file}: ${err.message.split("\n")[0]}`);
+    }
+  }
+  return { addons, files };
+}
+
+function median(values){
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+function sleep(ms){
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+// 合成帧逐帧读入复用的缓冲区，回调每一帧
+function forEachSyntheticFrame(addon, width, height, frames, onFrame){
+  const decoder = new addon.SyntheticDecoder();
+  decoder.initFromFile(`synthetic://${width}x${height}@30?frames=${frames}&realtime=0`);
+  let buffer = new Uint8Array(width * height * 3 / 2);
+  const meta = new Float64Array(META_LENGTH);
+  let count = 0;
+  for (;;){
+    let result = decoder.decodeFrameInto(buffer, meta);
+    if (result === FRAME_INTO_TOO_SMALL){
+      buffer = new Uint8Array(meta[META_SIZE]);
+      result = decoder.decodeFrameInto(buffer, meta);
+    }
+    if (result < 0) break;
+    onFrame(buffer, meta, count++);
+  }
+  decoder.close();
+  return count;
+}
+
+// ================ 测试项 ================
+// 每项返回 { frames, ms }，或返回 null 表示跳过
+
+const workloads = [
+  {
+    name: "synthetic-1080p-into",
+    needs: ["synthetic"],
+    run: async ({ synthetic }, ctx) => {
+      const start = performance.now();
+      const frames = forEachSyntheticFrame(synthetic, 1920, 1080, ctx.frames, () => {});
+      return { frames, ms: performance.now() - start };
+    },
+  },
+  {
+    name: "shm-ring-1080p",
+    needs: ["synthetic", "sharedMemory"],
+    run: async ({ synthetic, sharedMemory }, ctx) => {
+      const name = `bench-ring-${process.pid}`;
+      const frameSize = 1920 * 1080 * 3 / 2;
+      sharedMemory.createFrameRing(name, 8, frameSize);
+      const target = Buffer.alloc(frameSize);
+      const source = Buffer.alloc(frameSize);
+      let frames = 0;
+      const start = performance.now();
+      forEachSyntheticFrame(synthetic, 1920, 1080, ctx.frames, (buffer, meta, index) => {
+        source.set(buffer);
+        const seq = sharedMemory.writeFrame(name, source, 1920, 1080, index / 30);
+        sharedMemory.readFrame(name, seq, target);
+        frames++;
+      });
+      const ms = performance.now() - start;
+      sharedMemory.closeFrameRing(name);
+      return { frames, ms };
+    },
+  },
+  {
+    name: "record-x264-720p",
+    needs: ["synthetic", "sharedMemory", "vaapi"],
+    run: async ({ synthetic, sharedMemory, vaapi }, ctx) => {
+      const name = `bench-rec-${process.pid}`;
+      const frameSize = 1280 * 720 * 3 / 2;
+      sharedMemory.createFrameRing(name, 16, frameSize);
+      const recorder = new vaapi.FrameRecorder();
+      recorder.start({ ringName: name, outputPath: ctx.elementaryPath, codec: "h264", fps: 30, keyint: 30 });
+      const source = Buffer.alloc(frameSize);
+      const start = performance.now();
+      const frames = forEachSyntheticFrame(synthetic, 1280, 720, ctx.frames, (buffer, meta, index) => {
+        source.set(buffer);
+        sharedMemory.writeFrame(name, source, 1280, 720, index / 30);
+      });
+      // 给编码线程时间取走环中剩余的帧
+      await sleep(200);
+      const stats = recorder.stop();
+      const ms = performance.now() - start;
+      sharedMemory.closeFrameRing(name);
+      return { frames: stats.framesEncoded || frames, ms };
+    },
+  },
+  {
+    name: "decode-720p-into",
+    needs: ["vaapi"],
+    after: "record-x264-720p",
+    run: async ({ vaapi }, ctx) => {
+      const decoder = new vaapi.VaapiDecoder();
+      if (!decoder.initFromFile(ctx.elementaryPath)) return null;
+      decoder.enableSceneDetection(() => {}, { threshold: 0.4 });
+      let buffer = new Uint8Array(1280 * 720 * 3 / 2);
+      const meta = new Float64Array(META_LENGTH);
+      let frames = 0;
+      const start = performance.now();
+      for (;;){
+        let result = decoder.decodeFrameInto(buffer, meta);
+        if (result === FRAME_INTO_TOO_SMALL){
+          buffer = new Uint8Array(meta[META_SIZE]);
+          result = decoder.decodeFrameInto(buffer, meta);
+        }
+        if (result < 0) break;
+        frames++;
+      }
+      const ms = performance.now() - start;
+      decoder.disableSceneDetection();
+      decoder.close();
+      return { frames, ms };
+    },
+  },
+  {
+    name: "proxy-transcode-720p",
+    needs: ["vaapi"],
+    after: "record-x264-720p",
+    run: async ({ vaapi }, ctx) => {
+      const transcoder = new vaapi.ProxyTranscoder();
+      const start = performance.now();
+      // 进度回调不会让事件循环保持运行，等待期间需要一个定时器
+      const keepAlive = setInterval(() => {}, 1000);
+      const result = await new Promise((resolve) => {
+        transcoder.start({ input: ctx.elementaryPath, output: ctx.mp4Path, height: 360, keyint: 10 }, (progress) => {
+          if (progress.done) resolve(progress);
+        });
+      });
+      clearInterval(keepAlive);
+      if (result.error) return null;
+      return { frames: result.frames, ms: performance.now() - start };
+    },
+  },
+  {
+    name: "fmp4-remux",
+    needs: ["vaapi"],
+    after: "proxy-transcode-720p",
+    run: async ({ vaapi }, ctx) => {
+      const remuxer = new vaapi.Fmp4Remuxer();
+      const start = performance.now();
+      await remuxer.open(ctx.mp4Path, { segmentDuration: 1 });
+      let segments = 0;
+      while (await remuxer.readSegment()) segments++;
+      remuxer.close();
+      return { frames: segments, ms: performance.now() - start, unit: "segments" };
+    },
+  },
+  {
+    name: "packet-demux",
+    needs: ["vaapi"],
+    after: "proxy-transcode-720p",
+    run: async ({ vaapi }, ctx) => {
+      let packets = 0;
+      const start = performance.now();
+      for (const bitstream of ["avcc", "annexb"]){
+        const demuxer = new vaapi.PacketDemuxer();
+        if (!demuxer.open(ctx.mp4Path, { bitstream })) return null;
+        demuxer.getCodecConfig();
+        while (demuxer.readPacket()) packets++;
+        demuxer.close();
+      }
+      return { frames: packets, ms: performance.now() - start, unit: "packets" };
+    },
+  },
+];
+
+async function runBench(args){
+  const { addons, files } = loadAddons(args.addons);
+  const tmpDir = fs.mkdtempSync(path.join(os.tmpdir(), "native-bench-"));
+  const ctx = {
+    frames: args.frames,
+    elementaryPath: path.join(tmpDir, "bench.h264"),
+    mp4Path: path.join(tmpDir, "bench.mp4"),
+  };
+
+  const results = {};
+  const done = new Set();
+  for (const workload of workloads){
+    if (!workload.needs.every((key) => addons[key]) || (workload.after && !done.has(workload.after))){
+      console.log(`- ${workload.name}: 跳过`);
+      continue;
+    }
+    const samples = [];
+    let last = null;
+    try {
+      for (let i = 0; i < args.repeat; i++){
+        last = await workload.run(addons, ctx);
+        if (!last) break;
+        samples.push(last.ms);
+      }
+    } catch (err){
+      console.log(`- ${workload.name}: 失败 ${err.message}`);
+      continue;
+    }
+    if (!last || samples.length === 0){
+      console.log(`- ${workload.name}: 跳过`);
+      continue;
+    }
+    const ms = median(samples);
+    const rate = last.frames / (ms / 1000);
+    results[workload.name] = { ms, count: last.frames, unit: last.unit || "frames", rate };
+    done.add(workload.name);
+    console.log(`- ${workload.name}: ${ms.toFixed(1)} ms, ${rate.toFixed(1)} ${last.unit || "frames"}/s`);
+  }
+
+  fs.rmSync(tmpDir, { recursive: true, force: true });
+
+  const output = {
+    label: args.label,
+    date: new Date().toISOString(),
+    host: { cpus: os.cpus().length, model: os.cpus()[0]?.model, node: process.version },
+    frames: args.frames,
+    repeat: args.repeat,
+    addons: files,
+    results,
+  };
+  if (args.out){
+    fs.mkdirSync(path.dirname(args.out), { recursive: true });
+    fs.writeFileSync(args.out, JSON.stringify(output, null, 2));
+  }
+  return output;
+}
+
+// 以第一个结果为基准，输出 Markdown 对比表
+function compare(files, reportPath){
+  const runs = files.map((file) => JSON.parse(fs.readFileSync(file, "utf8")));
+  const base = runs[0];
+  const names = [...new Set(runs.flatMap((run) => Object.keys(run.results)))];
+
+  const lines = [];
+  lines.push(`# Native build comparison`);
+  lines.push("");
+  lines.push(`基准: ${base.label}，${base.host.model} x${base.host.cpus}，${base.frames} 帧，取 ${base.repeat} 次中位数`);
+  lines.push("");
+  lines.push(`| 测试项 | ${runs.map((run) => run.label).join(" | ")} |`);
+  lines.push(`|---|${runs.map(() => "---:").join("|")}|`);
+  for (const name of names){
+    const baseResult = base.results[name];
+    const cells = runs.map((run) => {
+      const result = run.results[name];
+      if (!result) return "-";
+      const text = `${result.rate.toFixed(1)}/s`;
+      if (run === base || !baseResult) return text;
+      const delta = (result.rate / baseResult.rate - 1) * 100;
+      return `${text} (${delta >= 0 ? "+" : ""}${delta.toFixed(1)}%)`;
+    });
+    lines.push(`| ${name} | ${cells.join(" | ")} |`);
+  }
+
+  lines.push("");
+  lines.push(`| 二进制大小 (KB) | ${runs.map((run) => run.label).join(" | ")} |`);
+  lines.push(`|---|${runs.map(() => "---:").join("|")}|`);
+  for (const file of Object.values(ADDON_FILES)){
+    const cells = runs.map((run) => {
+      const entry = Object.values(run.addons).find((addon) => path.basename(addon.path) === file);
+      return entry ? (entry.size / 1024).toFixed(0) : "-";
+    });
+    lines.push(`| ${file} | ${cells.join(" | ")} |`);
+  }
+
+  const report = lines.join("\n") + "\n";
+  if (reportPath){
+    fs.mkdirSync(path.dirname(reportPath), { recursive: true });
+    fs.writeFileSync(reportPath, report);
+  }
+  console.log(report);
+}
+
+const args = parseArgs(process.argv.slice(2));
+if (args.compare.length > 0){
+  compare(args.compare, args.report);
+} else {
+  await runBench(args);
+}
@@ -168,6 +168,16 @@ try {
     }
   },
   
+  // NV12 转 RGBA 并缩放到画布尺寸（WebGL 不可用时的 CPU 呈现路径）
+  convertToRgba: (src: Uint8Array, width: number, height: number, target: Uint8ClampedArray,
+                  dstWidth: number, dstHeight: number): boolean => {
+    if (!sharedMemory) {
+      return false;
+    }
+    const buffer = Buffer.isBuffer(src) ? src : Buffer.from(src.buffer, src.byteOffset, src.byteLength);
+    return sharedMemory.convertToRgba(buffer, width, height, target, dstWidth, dstHeight);
+  },
+
   // 读取帧数据
   readFrameData: async (shmName?: string): Promise<number> => {
     if (shmName && sharedMemory) {
@@ -0,0 +1,98 @@
+/**
+ * Canvas 2D NV12 渲染器（WebGL 不可用或为 SwiftShader 软件实现时的回退）
+ * NV12 -> RGBA 转换和缩放由 native addon 在工作线程中一遍完成，直接写入 ImageData，
+ * 画布保持显示尺寸，开销只与显示尺寸有关
+ */
+
+/**
+ * native 转换函数，由 preload 暴露（shared-memory addon 的 convertToRgba）
+ */
+export type Nv12ToRgbaConverter = (
+  src: Uint8Array,
+  width: number,
+  height: number,
+  target: Uint8ClampedArray,
+  dstWidth: number,
+  dstHeight: number,
+) => boolean;
+
+export class CanvasNV12Renderer {
+  private ctx: CanvasRenderingContext2D;
+  private imageData: ImageData | null = null;
+
+  constructor(private canvas: HTMLCanvasElement, private convert: Nv12ToRgbaConverter) {
+    const ctx = canvas.getContext("2d", { alpha: false });
+    if (!ctx) {
+      throw new Error("Canvas 2D not supported");
+    }
+    this.ctx = ctx;
+    console.log("Canvas NV12 Renderer initialized");
+  }
+
+  /**
+   * WebGL 是否不可用或运行在软件光栅器上
+   */
+  static isWebGLSoftware(): boolean {
+    const gl = document.createElement("canvas").getContext("webgl");
+    if (!gl) {
+      return true;
+    }
+    const debugInfo = gl.getExtension("WEBGL_debug_renderer_info");
+    const name = debugInfo ? String(gl.getParameter(debugInfo.UNMASKED_RENDERER_WEBGL)) : "";
+    gl.getExtension("WEBGL_lose_context")?.loseContext();
+    return /swiftshader|llvmpipe|software/i.test(name);
+  }
+
+  /**
+   * 目标尺寸：画布显示尺寸（乘以设备像素比），不超过源尺寸
+   */
+  private targetSize(width: number, height: number): [number, number] {
+    const ratio = window.devicePixelRatio || 1;
+    const displayWidth = Math.round((this.canvas.clientWidth || width) * ratio);
+    const displayHeight = Math.round((this.canvas.clientHeight || height) * ratio);
+    const scale = Math.min(1, displayWidth / width, displayHeight / height);
+    return [Math.max(1, Math.round(width * scale)), Math.max(1, Math.round(height * scale))];
+  }
+
+  /**
+   * 在取得帧后调用，返回可写入的 ImageData（可用于 presentFrame 直接从帧环转换）
+   */
+  public prepare(width: number, height: number): ImageData {
+    const [dstWidth, dstHeight] = this.targetSize(width, height);
+    if (!this.imageData || this.imageData.width !== dstWidth || this.imageData.height !== dstHeight) {
+      this.imageData = new ImageData(dstWidth, dstHeight);
+      this.canvas.width = dstWidth;
+      this.canvas.height = dstHeight;
+      console.log(`Canvas resized to ${dstWidth}x${dstHeight} for ${width}x${height} source`);
+    }
+    return this.imageData;
+  }
+
+  /**
+   * 显示 prepare() 返回的 ImageData
+   */
+  public present(): void {
+    if (this.imageData) {
+      this.ctx.putImageData(this.imageData, 0, 0);
+    }
+  }
+
+  /**
+   * 渲染 NV12 图像，接口与 WebGLNV12Renderer 一致
+   */
+  public renderFrame(nv12Data: Uint8Array, width: number, height: number): void {
+    const image = this.prepare(width, height);
+    if (this.convert(nv12Data, width, height, image.data, image.width, image.height)) {
+      this.present();
+    }
+  }
+
+  public clear(): void {
+    this.ctx.fillStyle = "#000";
+    this.ctx.fillRect(0, 0, this.canvas.width, this.canvas.height);
+  }
+
+  public dispose(): void {
+    this.imageData = null;
+  }
+}
@@ -7,8 +7,39 @@ export interface DecodedFrame {
   width: number;     // 宽度
   height: number;    // 高度
   format: 'nv12';    // 像素格式
+  formatChanged?: boolean;  // 流中途分辨率变化后的第一帧
+  pts?: number;      // 时间戳（秒）
 }
 
+/**
+ * decodeFrameInto/decodePacketInto 的 Float64Array 元数据块下标
+ */
+export const FrameMeta = {
+  WIDTH: 0,
+  HEIGHT: 1,
+  PTS: 2,
+  SIZE: 3,        // 帧数据字节数
+  FORMAT: 4,      // ShmPixelFormat，NV12 = 0
+  SEQUENCE: 5,    // 本解码器输出的帧序号
+  FLAGS: 6,       // FrameMetaFlags 位组合
+  LENGTH: 8,
+} as const;
+
+/**
+ * FrameMeta.FLAGS 的各位
+ */
+export const FrameMetaFlags = {
+  FORMAT_CHANGE: 1 << 0,   // 新分辨率的第一帧
+} as const;
+
+/**
+ * decodeFrameInto/decodePacketInto 的负返回值（>= 0 为写入字节数）
+ */
+export const FrameIntoResult = {
+  END: -1,        // 没有帧（文件结束或需要更多数据）
+  TOO_SMALL: -2,  // target 太小，meta[SIZE] 为所需大小，帧保留到下次调用
+} as const;
+
 export interface VideoInfo {
   width: number;     // 视频宽度
   height: number;    // 视频高度
@@ -16,22 +47,663 @@ export interface VideoInfo {
   fps: number;       // 帧率
 }
 
-export class VaapiDecoder {
+/**
+ * 解码后端的公共接口，VaapiDecoder 与 SyntheticDecoder 都实现它
+ */
+export interface VideoFrameDecoder {
+  initFromFile(filename: string): boolean;
+  initFromBuffer(buffer: Buffer, codecName: string): boolean;
+  decodeFrame(): DecodedFrame | null;
+  decodePacket(packet: Buffer): DecodedFrame | null;
+  decodeFrameInto(target: Uint8Array, meta: Float64Array): number;
+  decodePacketInto(packet: Buffer, target: Uint8Array, meta: Float64Array): number;
+  seek(seconds: number): boolean;
+  getDuration(): number;
+  getVideoInfo(): VideoInfo | null;
+  close(): void;
+}
+
+export interface SyntheticDecoderOptions {
+  width?: number;               // 默认 1920
+  height?: number;              // 默认 1080
+  fps?: number;                 // 默认 30
+  costMs?: number;              // 每帧人为耗时，默认 0
+  costMode?: 'spin' | 'sleep';  // spin 占用 CPU（模拟软解），sleep 让出 CPU（模拟硬解等待）
+  frames?: number;              // 总帧数，0 表示无限
+  realtime?: boolean;           // 按帧率节奏输出，默认 true
+}
+
+export interface SyntheticDecoderStats {
+  frames: number;
+  lateFrames: number;     // 晚于节奏时间输出的帧
+  avgGenerateMs: number;  // 生成一帧的耗时（不含人为耗时）
+  costMs: number;
+  elapsed: number;        // 秒
+}
+
+export interface WorkPoolClassStats {
+  queued: number;
+  running: number;
+  completed: number;
+  avgWaitMs: number;   // 入队到开始执行的平均等待
+}
+
+export interface WorkPoolStats {
+  threads: number;
+  concurrencyLimit: number;
+  active: number;
+  steals: number;
+  utilization: number; // 距上次调用的忙碌比例 (0-1)
+  classes: {
+    realtime: WorkPoolClassStats;
+    decode: WorkPoolClassStats;
+    background: WorkPoolClassStats;
+  };
+}
+
+export interface ResourceLimitsInfo {
+  source: 'cgroup2' | 'cgroup1' | 'env' | 'host';
+  hostCpus: number;
+  affinityCpus: number;        // CPU 亲和性允许的核数
+  cpuQuota: number;            // cgroup CPU 配额（核），0 表示不限
+  hostMemory: number;
+  memoryLimit: number;         // cgroup 内存上限（字节），0 表示不限
+  cpus: number;                // 实际按此核数分配线程
+  workPoolConcurrency: number;
+  decodeThreads: number;       // 软解线程数
+  encodeThreads: number;       // x264/x265 线程数
+  copyWorkers: number;
+  effectiveMemory: number;
+  cacheBudget: number;         // 帧缓存预算（字节）
+  decodeAheadBudget: number;   // 预解码预算（字节）
+}
+
+export interface SceneCutEvent {
+  pts: number;        // 新场景第一帧的时间戳（秒）
+  frameIndex: number; // 新场景第一帧的序号
+  score: number;      // 差异得分 (0-1)
+}
+
+export interface SceneDetectionOptions {
+  threshold?: number;      // 判定阈值，默认 0.35
+  minSceneFrames?: number; // 两次切换之间的最少帧数，默认 12
+}
+
+/**
+ * 码流统计批次中每帧记录的字段下标，每帧 BitstreamStatsField.STRIDE 个 double
+ */
+export const BitstreamStatsField = {
+  FRAME_INDEX: 0,
+  PTS: 1,
+  PICT_TYPE: 2,     // 1=I 2=P 3=B，0 未知
+  KEYFRAME: 3,      // 1 为关键帧
+  PACKET_SIZE: 4,   // 压缩大小（字节），未知为 -1
+  AVG_QP: 5,        // 平均 QP，硬解/HEVC 为 -1
+  GOP_POSITION: 6,  // 距上一个关键帧的帧数，关键帧为 0
+  GOP_LENGTH: 7,    // 关键帧上为上一个 GOP 的帧数，其他帧为 0
+  STRIDE: 8,
+} as const;
+
+export interface DecoderIoOptions {
+  readAhead?: boolean;     // 本地文件使用预读 I/O，默认 true
+  chunkSizeKB?: number;    // 单次读取大小，默认 1024
+  windowChunks?: number;   // 预读窗口块数，默认 16
+}
+
+export interface DecoderIoStats {
+  readAhead: boolean;      // 当前输入是否使用预读 I/O
+  bytesDelivered: number;
+  bytesRead: number;
+  reads: number;
+  seeks: number;
+  prefetchHits: number;
+  prefetchMisses: number;
+  hitRate: number;         // 0-1
+  ioWaitMs: number;        // demuxer 等待磁盘的总时间
+  avgReadMs: number;
+  maxReadMs: number;
+  windowBytes: number;
+  segmentOpens: number;    // 分段播放列表：预读线程打开分段文件的次数
+}
+
+export interface PlaylistStats {
+  segments: number;
+  currentSegment: number;  // 读位置所在分段（demuxer 读取位置，略超前于显示）
+  ended: boolean;          // 播放列表已有 #EXT-X-ENDLIST，否则读到末尾时会追加新分段
+  duration: number;        // EXTINF 之和（秒）
+}
+
+export interface FrameCacheStats {
+  slotCount: number;
+  used: number;
+  hits: number;            // 所有窗口合计
+  misses: number;
+  hitRate: number;         // 0-1
+  inserts: number;
+  evictions: number;
+  cachedFrames: number;    // 本解码器直接从缓存输出（未解码）的帧数
+}
+
+export interface DecoderStats {
+  hwAccel: boolean;
+  frameIndex: number;
+  formatChanges: number;   // 流中途分辨率变化次数
+  io: DecoderIoStats;
+  playlist?: PlaylistStats;      // 打开本地 .m3u8 时才有
+  motion?: MotionStats;          // 开启运动检测后才有
+  frameCache?: FrameCacheStats;  // 接入跨窗口帧缓存后才有
+}
+
+/**
+ * 分辨率变化通知，在新尺寸的第一帧返回之前同步回调
+ */
+export interface FormatChangeEvent {
+  width: number;
+  height: number;
+  previousWidth: number;
+  previousHeight: number;
+  size: number;            // 新尺寸一帧 NV12 的字节数
+  pts: number;
+}
+
+export interface CachedFrame {
+  data?: Buffer;           // 未传 target 时返回
+  width: number;
+  height: number;
+  pts: number;
+  format: 'nv12';
+}
+
+export interface BitstreamStatsOptions {
+  batchFrames?: number;    // 每批帧数，默认 60
+}
+
+export interface MotionAnalysisOptions {
+  cellSize?: number;       // 能量图格子边长（像素，按 16 对齐到宏块），默认 32
+  threshold?: number;      // 格子平滑能量达到该值视为活动（像素/帧），默认 1
+  minVector?: number;      // 短于该长度的矢量视为编码噪声（像素），默认 0.5
+  minArea?: number;        // 活动格子占比达到该值视为有运动，默认 0.002
+  smoothing?: number;      // 指数平滑系数 0-0.95，默认 0.5
+  startFrames?: number;    // 连续多少帧有运动才发出 start，默认 3
+  holdFrames?: number;     // 连续多少帧无运动才发出 end，默认 25
+  updateFrames?: number;   // 运动期间每隔多少帧发出 update，0 不发，默认 15
+}
+
+export interface MotionEvent {
+  type: 'start' | 'update' | 'end';
+  pts: number;
+  frameIndex: number;
+  energy: number;          // 活动格子的平均平滑能量（像素/帧）
+  area: number;            // 活动格子占比 0-1
+  box: { x: number; y: number; width: number; height: number };  // 活动区域外接矩形，归一化 0-1
+}
+
+export interface MotionFrameResult {
+  pts: number;
+  frameIndex: number;
+  motion?: boolean;        // 以下字段在开启运动检测后才有
+  area?: number;
+  energy?: number;
+  vectors?: number;        // 本帧运动矢量数，I 帧沿用上一帧
+}
+
+export interface MotionMap {
+  cols: number;
+  rows: number;
+  data: Float32Array;      // cols * rows，按行排列，平滑后的能量（像素/帧）
+}
+
+export interface MotionStats {
+  vectorsAvailable: boolean;  // 软解且为 H.264 / MPEG-1/2/4 / H.263；硬解和 HEVC 不导出矢量
+  frames: number;
+  framesWithVectors: number;
+  vectors: number;
+  events: number;
+  motion: boolean;
+  area: number;
+  energy: number;
+}
+
+export interface RecorderOptions {
+  ringName: string;    // 帧环名称（shared-memory addon 的 createFrameRing 创建）
+  outputPath: string;  // 输出文件 (.h264 / .h265 裸流)
+  codec?: 'h264' | 'hevc';
+  preset?: 'zerolatency' | 'realtime';
+  bitrate?: number;    // kbps
+  fps?: number;        // 可为小数，29.97 等按 30000/1001 编码
+  keyint?: number;     // 关键帧间隔
+  threads?: number;    // 编码线程数，默认自动
+  queueDepth?: number; // 采集与编码之间的最大排队帧数
+}
+
+export interface RecorderStats {
+  running: boolean;
+  framesCaptured: number;
+  framesEncoded: number;
+  framesDropped: number;
+  framesDuplicated: number;  // 生产者时间戳跳跃时重复上一帧补齐的帧数
+  formatChanges: number;     // 分辨率变化后重新打开编码器的次数
+  bytesWritten: number;
+  queueDepth: number;
+  maxQueueDepth: number;
+  encodeFps: number;
+  avgEncodeMs: number;
+  elapsed: number;     // 秒
+}
+
+export interface ProxyTranscodeOptions {
+  input: string;     // 原片路径
+  output: string;    // 代理文件路径 (.mp4)
+  height?: number;   // 代理高度，默认 540
+  keyint?: number;   // 关键帧间隔，默认 10
+  bitrate?: number;  // kbps，默认 2000
+  threads?: number;  // 编码线程数，默认 2
+}
+
+export interface ProxyProgress {
+  progress: number;  // 0-1
+  frames: number;
+  fps: number;
+  eta: number;       // 预计剩余秒数
+  done: boolean;
+  cancelled: boolean;
+  error?: string;
+}
+
+export interface Fmp4StreamInfo {
+  mimeType: string;      // 直接用于 MediaSource.addSourceBuffer()
+  codec: string;         // RFC 6381 codecs 字符串，如 avc1.64001f
+  width: number;
+  height: number;
+  duration: number;      // 秒
+  initSegment: Buffer;   // ftyp + moov
+}
+
+export interface Fmp4Segment {
+  data: Buffer;          // moof + mdat
+  start: number;         // 秒
+  duration: number;      // 秒
+}
+
+export interface PacketCodecConfig {
+  codec: string;                  // 如 avc1.64001f / hvc1.1.6.L120.90
+  codedWidth: number;
+  codedHeight: number;
+  bitstream: 'avcc' | 'annexb';
+  description?: Buffer;           // avcC/hvcC，仅 avcc 输出时提供
+  fps: number;
+  duration: number;
+}
+
+export interface DemuxedPacket {
+  data: Buffer;
+  pts: number;       // 秒，相对流起始时间
+  dts: number;
+  duration: number;
+  keyframe: boolean;
+}
+
+export interface PacketPublishOptions {
+  slotCount?: number;    // 默认 64
+  slotSize?: number;     // 字节，默认按分辨率估算（不小于 512KB）
+  realtime?: boolean;    // 按时间戳节奏发布，默认 true；false 时尽快发布
+  leadSeconds?: number;  // 实时模式下领先播放时钟的时长，默认 0.5
+  loop?: boolean;        // 文件结束后从头循环
+}
+
+export interface PacketPublishStats {
+  running: boolean;
+  packets: number;
+  keyframes: number;
+  bytes: number;
+  dropped: number;       // 超过槽大小而丢弃的包
+  bitrateKbps: number;
+  elapsed: number;       // 秒
+  writeSeq: number;
+}
+
+/**
+ * 共享内存环中数据包的 format 取值（与 native/common/shm_frame_ring.h 一致）
+ */
+export const ShmPacketFormat = {
+  H264_ANNEXB: 0x100,
+  H264_AVCC: 0x101,
+  HEVC_ANNEXB: 0x102,
+  HEVC_HVCC: 0x103,
+} as const;
+
+/**
+ * 共享内存环槽标志
+ */
+export const ShmSlotFlags = {
+  KEYFRAME: 1 << 0,
+  CODEC_CONFIG: 1 << 1,    // 数据为 avcC/hvcC，用于 VideoDecoder.configure 的 description
+  DISCONTINUITY: 1 << 2,   // seek 或丢包之后的第一个包
+  FILE_REF: 1 << 3,        // 槽中为文件引用，readFrame 自动从映射的文件读取
+  FORMAT_CHANGE: 1 << 4,   // 宽高或格式与上一帧不同，处理该帧之前先调整纹理和缓冲
+} as const;
+
+/**
+ * 共享内存环中原始帧的 format 取值（与 native/common/shm_frame_ring.h 一致）
+ */
+export const ShmPixelFormat = {
+  NV12: 0,
+  RGB24: 1,
+  RGBA: 2,
+  I420: 3,
+} as const;
+
+export interface PresentationClockOptions {
+  tickInterval?: number;       // 发布对齐间隔（秒），默认 1/60，应与显示刷新一致
+  lateToleranceMs?: number;    // 迟到超过该值的帧丢弃，默认两个 tick
+  prerollTimeoutMs?: number;   // 第一路就绪后等待其他路的最长时间，默认 2000
+}
+
+export interface ClockSubscriberStats {
+  id: number;
+  name: string;
+  presented: number;
+  dropped: number;
+  heldMs: number;        // 早到帧累计等待时间
+  lastPts: number;
+  offsetMs: number;      // 最近一帧 pts 与发布时时钟的差，负值表示迟到
+}
+
+export interface PresentationClockStats {
+  started: boolean;
+  paused: boolean;
+  mediaTime: number;
+  rate: number;
+  tickInterval: number;
+  skewMs: number;        // 各路当前显示帧 pts 的最大差值
+  maxSkewMs: number;
+  avgSkewMs: number;
+  subscribers: ClockSubscriberStats[];
+}
+
+export interface OsdGlyph {
+  code: number | string;  // Unicode 码点或单个字符
+  x: number;             // 在图集中的位置
+  y: number;
+  w: number;
+  h: number;
+  advance?: number;      // 默认 w，取偶数
+  offsetX?: number;      // 相对笔位置和行顶的偏移
+  offsetY?: number;
+}
+
+export interface OsdAtlas {
+  image: Buffer;         // 8 位 alpha，width * height 字节
+  width: number;
+  height: number;
+  glyphs: OsdGlyph[];
+  lineHeight?: number;   // 默认为最高字形的高度
+}
+
+export interface OsdTextItem {
+  text: string;          // 可含 {time} {pts} {timecode} {frame}
+  x: number;
+  y: number;
+  color?: [number, number, number];   // RGB，默认白色
+  opacity?: number;      // 0-1，默认 1
+  background?: boolean;  // 文字背后的底框，默认 true
+  backgroundColor?: [number, number, number];  // 默认黑色
+  backgroundOpacity?: number;  // 默认 0.5
+  padding?: number;      // 底框内边距，默认 4
+}
+
+export interface OsdBoxItem {
+  x: number;
+  y: number;
+  w: number;
+  h: number;
+  color?: [number, number, number];
+  opacity?: number;
+  thickness?: number;    // 0（默认）为实心，否则为边框宽度
+}
+
+export interface OsdOverlayStats {
+  frames: number;
+  avgUs: number;         // 每帧叠加耗时（微秒）
+  maxUs: number;
+  hasAtlas: boolean;
+  glyphs: number;
+}
+
+export interface MultiTrackStreamInfo {
+  index: number;         // 容器中的 stream index
+  codec: string;
+  width: number;
+  height: number;
+  fps: number;
+  duration: number;
+}
+
+export interface MultiTrackStartOptions {
+  rings: string[];       // 每轨一个 NV12 帧环
+  streams?: number[];    // 与 rings 一一对应，默认按顺序取前 rings.length 路视频流
+  slotCount?: number;    // 每个环的槽数，默认 4
+  hwAccel?: boolean;     // 默认 true，不可用时回退软解
+  realtime?: boolean;    // 各轨按同一起点的时间戳节奏输出，默认 true
+  queuePackets?: number; // 每轨数据包队列上限，默认 64
+  clock?: PresentationClock;  // 共享呈现时钟，设置后忽略 realtime
+  overlays?: (OsdOverlay | null)[];  // 与 rings 对应的 OSD 叠加
+  maxWidth?: number;     // 环的槽按此尺寸预留，流中途变大时不必重建环；默认流的初始尺寸
+  maxHeight?: number;
+}
+
+export interface MultiTrackTrackStats {
+  stream: number;
+  ring: string;
+  hwAccel: boolean;
+  finished: boolean;
+  packets: number;
+  frames: number;
+  dropped: number;
+  lateDropped: number;   // 共享时钟判定迟到而丢弃的帧
+  scaled: number;        // 超过槽大小而按比例缩小发布的帧
+  resolutionChanges: number;
+  width: number;         // 最近发布的帧尺寸
+  height: number;
+  queued: number;
+  avgDecodeMs: number;
+  lastPts: number;
+}
+
+export interface MultiTrackStats {
+  running: boolean;
+  packetsRead: number;
+  packetsDiscarded: number;   // 未选择的流
+  demuxWaitMs: number;        // 因某轨队列已满而等待的时间
+  elapsed: number;
+  tracks: MultiTrackTrackStats[];
+}
+
+export interface RawVideoOpenOptions {
+  width?: number;        // 裸 .yuv 必填，.y4m 取文件头
+  height?: number;
+  fps?: number;          // 覆盖文件帧率，裸 .yuv 默认 30
+  pixelFormat?: 'i420' | 'nv12' | 'rgba' | 'rgb24';  // 裸 .yuv 的像素格式，默认 i420
+}
+
+export interface RawVideoInfo {
+  container: 'y4m' | 'yuv';
+  width: number;
+  height: number;
+  fps: number;
+  format: number;        // ShmPixelFormat
+  stride: number;
+  frameSize: number;
+  frameCount: number;
+  duration: number;
+}
+
+export interface RawPublishOptions {
+  mode?: 'copy' | 'reference';  // copy: 复制进环（一次复制）；reference: 只写文件引用，默认 copy
+  slotCount?: number;    // 默认 4
+  realtime?: boolean;    // 按帧率节奏发布，默认 true；false 时尽快发布
+  loop?: boolean;
+  startFrame?: number;
+  clock?: PresentationClock;  // 共享呈现时钟，设置后忽略 realtime
+  overlay?: OsdOverlay;  // 仅 copy 模式的 NV12 / I420 源
+}
+
+export interface RawPublishStats {
+  running: boolean;
+  frames: number;
+  lateFrames: number;    // 使用共享时钟时为丢弃的迟到帧
+  bytes: number;         // 复制进环的字节数，reference 模式为 0
+  fps: number;
+  avgCopyMs: number;
+  elapsed: number;       // 秒
+  writeSeq: number;
+}
+
+export interface ImageSequenceOpenOptions {
+  fps?: number;          // 默认 25
+  startNumber?: number;  // printf 模式的起始编号，默认依次尝试 0 和 1
+}
+
+export interface ImageSequenceInfo {
+  width: number;
+  height: number;
+  fps: number;
+  frameCount: number;
+  duration: number;
+  codec: string;         // 首帧的解码器，如 png / exr
+  pixelFormat: string;   // 首帧解码出的像素格式
+  firstFile: string;
+}
+
+export interface ImageSequencePublishOptions {
+  format?: 'nv12' | 'rgba';   // 默认 nv12
+  slotCount?: number;    // 默认 4
+  realtime?: boolean;    // 默认 true
+  loop?: boolean;
+  startFrame?: number;
+  prefetchBytes?: number;     // 预取窗口内存上限，默认按容器资源限制
+  workers?: number;      // 解码线程数，默认为软解线程数
+  clock?: PresentationClock;
+}
+
+export interface ImageSequencePublishStats {
+  running: boolean;
+  frames: number;
+  lateFrames: number;
+  failedFrames: number;  // 解码失败跳过的帧
+  underruns: number;     // 发布时尚未解码完成的帧
+  decoded: number;
+  avgDecodeMs: number;
+  window: number;        // 预取窗口帧数
+  buffered: number;      // 已解码待发布
+  workers: number;
+  fps: number;
+  elapsed: number;
+  writeSeq: number;
+}
+
+export interface DecodeProfile {
+  lowres?: number;           // 0-3，输出缩小为 1/2^lowres
+  skipLoopFilter?: boolean;  // 跳过环路（去块）滤波
+  software?: boolean;        // 强制软解；lowres / skipLoopFilter 也会走软解
+}
+
+export interface QualityScore {
+  psnr: number;     // dB，三个平面合计误差，完全相同时为 100
+  psnrY: number;
+  psnrU: number;
+  psnrV: number;
+  ssim: number;     // 亮度 SSIM
+}
+
+export interface QualityWorstFrame {
+  value: number;
+  frame: number;    // 比较序号
+  pts: number;
+}
+
+export interface QualityReport {
+  frames: number;
+  psnr: number;         // 各帧 PSNR 的平均
+  psnrY: number;
+  psnrU: number;
+  psnrV: number;
+  globalPsnr: number;   // 按全部帧总误差计算
+  ssim: number;
+  worstPsnr: QualityWorstFrame;
+  worstSsim: QualityWorstFrame;
+  perFrame?: Float64Array;  // 每帧 6 个值: pts, psnr, psnrY, psnrU, psnrV, ssim
+}
+
+export interface QualityAnalyzeOptions {
+  reference: string;
+  distorted: string;            // 尺寸不同时缩放到参考尺寸后比较
+  referenceProfile?: DecodeProfile;
+  distortedProfile?: DecodeProfile;
+  maxFrames?: number;
+}
+
+export interface QualityProgress {
+  progress: number;     // 0-1
+  frames: number;
+  unmatched: number;    // 被测文件中找不到对应 pts 的参考帧
+  fps: number;
+  done: boolean;
+  cancelled: boolean;
+  report: QualityReport;
+  perFrame?: Float64Array;  // 仅 done 时
+  error?: string;
+}
+
+export interface ClipExportOptions {
+  input: string;                // 媒体文件或本地 .m3u8 分段播放列表
+  output: string;               // .mp4 / .mov / .mkv
+  start: number;                // 秒，相对输入起始
+  end?: number;                 // 省略或不大于 start 时到文件末尾
+  mode?: 'keyframe' | 'exact';  // exact 用编辑列表从 start 精确开始，仅 MP4/MOV，默认 keyframe
+  format?: string;              // 覆盖按扩展名推断的封装
+  audio?: boolean;              // 默认 true
+  faststart?: boolean;          // MP4 把 moov 移到文件头
+}
+
+export interface ClipExportProgress {
+  progress: number;       // 0-1
+  packets: number;
+  bytes: number;
+  mbPerSec: number;
+  actualStart: number;    // 片段实际起点（秒）；keyframe 模式为起点前最近的关键帧
+  preroll: number;        // exact 模式下编辑列表隐藏的时长
+  actualEnd: number;
+  exact: boolean;         // 是否以 exact 模式导出（封装不支持时回退为 false）
+  streams: number;
+  skippedStreams: number; // 输出封装不支持而跳过的音频流
+  done: boolean;
+  cancelled: boolean;
+  error?: string;
+}
+
+/**
+ * 加载编译好的 native addon
+ */
+function loadAddon(): any {
+  try {
+    return require('../../../native/vaapi-decoder/build/Release/vaapi_decoder.node');
+  } catch (err) {
+    throw new Error(`Failed to load VA-API decoder: ${err}`);
+  }
+}
+
+export class VaapiDecoder implements VideoFrameDecoder {
   private decoder: any;
 
   constructor() {
-    try {
-      // 尝试加载编译好的 native addon
-      const addon = require('../../../native/vaapi-decoder/build/Release/vaapi_decoder.node');
-      this.decoder = new addon.VaapiDecoder();
-    } catch (err) {
-      throw new Error(`Failed to load VA-API decoder: ${err}`);
-    }
+    const addon = loadAddon();
+    this.decoder = new addon.VaapiDecoder();
   }
 
   /**
    * 从文件初始化解码器
-   * @param filename 视频文件路径
+   * @param filename 视频文件路径；本地 .m3u8 播放列表的各分段拼接为一个输入连续播放
    * @returns 是否成功
    */
   initFromFile(filename: string): boolean {
@@ -65,6 +737,53 @@ export class VaapiDecoder {
     return this.decoder.decodePacket(packet);
   }
 
+  /**
+   * 解码一帧到复用的缓冲区，不创建任何 JS 对象，适合高帧率逐帧调用
+   * @param target 接收 NV12 数据的缓冲区
+   * @param meta 长度至少 FrameMeta.LENGTH 的元数据块
+   * @returns 写入字节数，或 FrameIntoResult
+   */
+  decodeFrameInto(target: Uint8Array, meta: Float64Array): number {
+    return this.decoder.decodeFrameInto(target, meta);
+  }
+
+  /**
+   * 解码数据包到复用的缓冲区；返回 TOO_SMALL 后用更大的 target 重试，数据包不会重复送入解码器
+   */
+  decodePacketInto(packet: Buffer, target: Uint8Array, meta: Float64Array): number {
+    return this.decoder.decodePacketInto(packet, target, meta);
+  }
+
+  /**
+   * 跳转到指定时间，之后解码出的第一帧不早于该时间
+   * @param seconds 目标时间（秒）
+   * @returns 是否成功
+   */
+  seek(seconds: number): boolean {
+    return this.decoder.seek(seconds);
+  }
+
+  /**
+   * 获取时长（秒），未知时返回 0
+   */
+  getDuration(): number {
+    return this.decoder.getDuration();
+  }
+
+  /**
+   * 设置预读 I/O 参数，下一次 initFromFile 生效
+   */
+  configureIo(options: DecoderIoOptions): void {
+    this.decoder.configureIo(options);
+  }
+
+  /**
+   * 解码器统计，包括预读命中率和 I/O 等待时间
+   */
+  getStats(): DecoderStats {
+    return this.decoder.getStats();
+  }
+
   /**
    * 获取视频信息
    * @returns 视频信息
@@ -73,6 +792,135 @@ export class VaapiDecoder {
     return this.decoder.getVideoInfo();
   }
 
+  /**
+   * 开启场景切换检测，在解码过程中异步回调切换点
+   * @param onSceneCut 场景切换回调
+   * @param options 检测参数
+   */
+  enableSceneDetection(onSceneCut: (event: SceneCutEvent) => void, options?: SceneDetectionOptions): boolean {
+    return this.decoder.enableSceneDetection(onSceneCut, options);
+  }
+
+  /**
+   * 关闭场景切换检测
+   */
+  disableSceneDetection(): void {
+    this.decoder.disableSceneDetection();
+  }
+
+  /**
+   * 开启逐帧码流统计（帧类型、压缩大小、平均 QP、GOP 间隔），在解码调用内同步回调
+   * @param onBatch 每 batchFrames 帧回调一次，字段见 BitstreamStatsField
+   */
+  enableBitstreamStats(onBatch: (batch: Float64Array) => void, options?: BitstreamStatsOptions): boolean {
+    return this.decoder.enableBitstreamStats(onBatch, options);
+  }
+
+  /**
+   * 关闭码流统计，不足一批的记录会先回调
+   */
+  disableBitstreamStats(): void {
+    this.decoder.disableBitstreamStats();
+  }
+
+  /**
+   * 立即回调不足一批的记录（暂停或文件结束时）
+   */
+  flushBitstreamStats(): void {
+    this.decoder.flushBitstreamStats();
+  }
+
+  /**
+   * 开启运动矢量运动检测（分析模式）：解码器导出运动矢量，在 native 中聚合成能量图并判定运动事件，
+   * 不需要读取像素。在 initFromFile 之前调用，打开时改用软解（硬解不导出矢量）
+   * @param onEvent 运动开始 / 持续 / 结束时在解码调用内同步回调
+   */
+  enableMotionAnalysis(onEvent: (event: MotionEvent) => void, options?: MotionAnalysisOptions): boolean {
+    return this.decoder.enableMotionAnalysis(onEvent, options);
+  }
+
+  /**
+   * 关闭运动检测，已产生的事件先回调
+   */
+  disableMotionAnalysis(): void {
+    this.decoder.disableMotionAnalysis();
+  }
+
+  /**
+   * 解码一帧但不输出像素，只更新运动检测（和码流统计），用于不在显示中的通道
+   * @returns 文件结束返回 null
+   */
+  analyzeMotion(): MotionFrameResult | null {
+    return this.decoder.analyzeMotion();
+  }
+
+  /**
+   * 当前平滑后的运动能量图，未开启运动检测时返回 null
+   */
+  getMotionMap(): MotionMap | null {
+    return this.decoder.getMotionMap();
+  }
+
+  /**
+   * 接入跨窗口共享的已解码帧缓存（不存在时创建），之后解码的每一帧都写入缓存，
+   * decodeFrame 先从缓存取下一帧，其他窗口解码过的帧不再解码。
+   * 同一片段在多个窗口打开时使用相同的 contentId（如路径 + 修改时间），需在 initFromFile 之后调用
+   */
+  attachFrameCache(name: string, contentId: string, options: { budgetBytes?: number } = {}): boolean {
+    return this.decoder.attachFrameCache(name, contentId, options);
+  }
+
+  detachFrameCache(): void {
+    this.decoder.detachFrameCache();
+  }
+
+  /**
+   * 从帧缓存读取 pts 处的帧（可能由其他窗口解码），未命中返回 null，不改变解码位置
+   */
+  readCachedFrame(pts: number, target?: Buffer): CachedFrame | null {
+    return this.decoder.readCachedFrame(pts, target);
+  }
+
+  /**
+   * 设置 OSD 叠加，之后输出的帧（含快照和录像）都烧录叠加内容；传 null 取消
+   */
+  setOverlay(overlay: OsdOverlay | null): void {
+    this.decoder.setOverlay(overlay ? overlay.native : null);
+  }
+
+  /**
+   * 流中途分辨率变化时，在新尺寸的第一帧返回之前同步回调，传 null 取消
+   */
+  setFormatChangeCallback(onChange: ((event: FormatChangeEvent) => void) | null): void {
+    this.decoder.setFormatChangeCallback(onChange);
+  }
+
+  /**
+   * 按可能出现的最大分辨率预先分配输出缓冲，流中途变大时不再重新分配
+   */
+  reserveOutput(maxWidth: number, maxHeight: number): void {
+    this.decoder.reserveOutput(maxWidth, maxHeight);
+  }
+
+  /**
+   * 设置降质解码配置（lowres、跳过环路滤波），下一次 initFromFile 生效
+   */
+  setDecodeProfile(profile: DecodeProfile): void {
+    this.decoder.setDecodeProfile(profile);
+  }
+
+  /**
+   * 导出帧快照，在工作线程中完成转换和编码
+   * @param frameRef 要导出的帧（调用时复制，返回后 data 可复用），传 null 表示最近解码的一帧
+   * @param format 图片格式
+   * @param quality 图片质量 (1-100)
+   * @param outputPath 输出文件路径，不传时返回编码后的数据
+   * @returns 编码后的图片数据或输出文件路径
+   */
+  snapshot(frameRef: Pick<DecodedFrame, 'data' | 'width' | 'height'> | null, format: 'png' | 'jpeg', quality = 90, outputPath?: string): Promise<Buffer | string> {
+    return this.decoder.snapshot(frameRef, format, quality, outputPath);
+  }
+
   /**
    * 关闭解码器，释放资源
    */
@@ -81,6 +929,28 @@ export class VaapiDecoder {
   }
 }
 
+/**
+ * 共享线程池指标（shared-memory 与 vaapi-decoder 两个 addon 共用同一个线程池）
+ */
+export function getWorkPoolStats(): WorkPoolStats {
+  return loadAddon().getWorkPoolStats();
+}
+
+/**
+ * 设置共享线程池的全局并发上限
+ * @returns 实际生效的上限（不超过线程数）
+ */
+export function setWorkPoolConcurrency(limit: number): number {
+  return loadAddon().setWorkPoolConcurrency(limit);
+}
+
+/**
+ * 启动时检测到的容器资源限制，以及据此派生的线程数和内存预算
+ */
+export function getResourceLimits(): ResourceLimitsInfo {
+  return loadAddon().getResourceLimits();
+}
+
 /**
  * 辅助函数：解码整个视频文件
  */
@@ -146,3 +1016,699 @@ export class StreamDecoder {
     this.decoder.close();
   }
 }
+
+/**
+ * 录制共享内存帧环中的帧（x264/x265 编码）
+ */
+export class FrameRecorder {
+  private recorder: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.recorder = new addon.FrameRecorder();
+  }
+
+  /**
+   * 开始录制，失败时抛出异常
+   */
+  start(options: RecorderOptions): boolean {
+    return this.recorder.start(options);
+  }
+
+  /**
+   * 停止录制，输出剩余帧并关闭文件
+   * @returns 最终统计
+   */
+  stop(): RecorderStats {
+    return this.recorder.stop();
+  }
+
+  /**
+   * 获取吞吐量、队列深度和丢帧统计
+   */
+  getStats(): RecorderStats {
+    return this.recorder.getStats();
+  }
+}
+
+/**
+ * 后台生成低分辨率代理文件（低优先级线程，x264 关键帧密集编码）
+ */
+export class ProxyTranscoder {
+  private transcoder: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.transcoder = new addon.ProxyTranscoder();
+  }
+
+  /**
+   * 开始转码
+   * @param options 转码参数
+   * @param onProgress 进度回调，结束时 done 为 true
+   */
+  start(options: ProxyTranscodeOptions, onProgress: (progress: ProxyProgress) => void): boolean {
+    return this.transcoder.start(options, onProgress);
+  }
+
+  /**
+   * 取消转码（等待后台线程退出）
+   */
+  cancel(): void {
+    this.transcoder.cancel();
+  }
+
+  isRunning(): boolean {
+    return this.transcoder.isRunning();
+  }
+}
+
+/**
+ * 代理/原片切换播放：代理与原片时间戳一致，切换时在新源上 seek 到当前位置
+ */
+export class ProxyAwareDecoder {
+  private decoder: VaapiDecoder | null = null;
+  private usingProxy = false;
+  private lastPts = 0;
+
+  constructor(private masterPath: string, private proxyPath: string | null = null) {}
+
+  /**
+   * 打开原片或代理
+   */
+  open(useProxy: boolean): boolean {
+    return this.switchTo(useProxy && !!this.proxyPath);
+  }
+
+  /**
+   * 代理生成完成后设置代理路径
+   */
+  setProxyPath(proxyPath: string | null): void {
+    this.proxyPath = proxyPath;
+    if (!proxyPath && this.usingProxy) {
+      this.switchTo(false);
+    }
+  }
+
+  /**
+   * 切换到代理（拖动时）或原片（停止拖动后），保持当前播放位置
+   */
+  useProxy(enabled: boolean): boolean {
+    const target = enabled && !!this.proxyPath;
+    if (this.decoder && target === this.usingProxy) {
+      return true;
+    }
+    return this.switchTo(target);
+  }
+
+  isUsingProxy(): boolean {
+    return this.usingProxy;
+  }
+
+  decodeFrame(): DecodedFrame | null {
+    const frame = this.decoder ? this.decoder.decodeFrame() : null;
+    if (frame && frame.pts !== undefined) {
+      this.lastPts = frame.pts;
+    }
+    return frame;
+  }
+
+  seek(seconds: number): boolean {
+    this.lastPts = seconds;
+    return this.decoder ? this.decoder.seek(seconds) : false;
+  }
+
+  close(): void {
+    if (this.decoder) {
+      this.decoder.close();
+      this.decoder = null;
+    }
+  }
+
+  private switchTo(proxy: boolean): boolean {
+    const next = new VaapiDecoder();
+    if (!next.initFromFile(proxy ? this.proxyPath! : this.masterPath)) {
+      return false;
+    }
+    if (this.decoder && this.lastPts > 0) {
+      next.seek(this.lastPts);
+    }
+    this.close();
+    this.decoder = next;
+    this.usingProxy = proxy;
+    return true;
+  }
+}
+
+/**
+ * 重封装为分片 MP4，供渲染进程 MediaSource 播放（不解码、不重编码）
+ */
+export class Fmp4Remuxer {
+  private remuxer: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.remuxer = new addon.Fmp4Remuxer();
+  }
+
+  /**
+   * 打开输入文件（仅支持 H.264 / HEVC 视频流）
+   * @param segmentDuration 分片目标时长（秒），实际在其后的首个关键帧处切分
+   */
+  open(filePath: string, segmentDuration: number = 2): Promise<Fmp4StreamInfo> {
+    return this.remuxer.open(filePath, { segmentDuration });
+  }
+
+  /**
+   * 在工作线程中生成下一个媒体分片
+   * @returns 分片，文件结束时为 null；写分片失败时 Promise 被拒绝
+   */
+  readSegment(): Promise<Fmp4Segment | null> {
+    return this.remuxer.readSegment();
+  }
+
+  /**
+   * 跳转到指定时间之前的关键帧
+   */
+  seek(seconds: number): boolean {
+    return this.remuxer.seek(seconds);
+  }
+
+  close(): void {
+    this.remuxer.close();
+  }
+}
+
+/**
+ * 只解复用不解码的数据包源，供渲染进程 WebCodecs 解码
+ */
+export class PacketDemuxer {
+  private demuxer: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.demuxer = new addon.PacketDemuxer();
+  }
+
+  /**
+   * 打开输入文件（H.264 / HEVC），失败时抛出异常
+   * @param bitstream 输出码流格式，avcc 为长度前缀并提供 description
+   */
+  open(filePath: string, bitstream: 'avcc' | 'annexb' = 'avcc'): boolean {
+    return this.demuxer.open(filePath, { bitstream });
+  }
+
+  /**
+   * 解码器配置，可直接传给 VideoDecoder.configure()
+   */
+  getCodecConfig(): PacketCodecConfig | null {
+    return this.demuxer.getCodecConfig();
+  }
+
+  /**
+   * 读取下一个数据包，文件结束返回 null（发布期间不可调用）
+   */
+  readPacket(): DemuxedPacket | null {
+    return this.demuxer.readPacket();
+  }
+
+  seek(seconds: number): boolean {
+    return this.demuxer.seek(seconds);
+  }
+
+  /**
+   * 在后台线程中把数据包发布到共享内存环
+   */
+  startPublishing(ringName: string, options: PacketPublishOptions = {}): boolean {
+    return this.demuxer.startPublishing(ringName, options);
+  }
+
+  stopPublishing(): void {
+    this.demuxer.stopPublishing();
+  }
+
+  getPublishStats(): PacketPublishStats {
+    return this.demuxer.getPublishStats();
+  }
+
+  close(): void {
+    this.demuxer.close();
+  }
+}
+
+/**
+ * 共享呈现时钟：传给 MultiTrackDecoder.start / RawVideoSource.startPublishing 的 clock 选项，
+ * 多路帧源按同一 tick 对齐发布。JS 驱动的解码器通过 subscribe + schedule 参与同步
+ */
+export class PresentationClock {
+  private clock: any;
+
+  constructor(options: PresentationClockOptions = {}) {
+    const addon = loadAddon();
+    this.clock = new addon.PresentationClock(options);
+  }
+
+  /** 原生对象，供 addon 识别 */
+  get native(): any {
+    return this.clock;
+  }
+
+  subscribe(name: string = 'js'): number {
+    return this.clock.subscribe(name);
+  }
+
+  unsubscribe(id: number): void {
+    this.clock.unsubscribe(id);
+  }
+
+  /**
+   * pts 这一帧现在是否应显示：present 立即显示，hold 在 waitMs 后再问，drop 丢弃
+   */
+  schedule(id: number, pts: number): { action: 'present' | 'hold' | 'drop'; waitMs: number } {
+    return this.clock.schedule(id, pts);
+  }
+
+  pause(): void {
+    this.clock.pause();
+  }
+
+  resume(): void {
+    this.clock.resume();
+  }
+
+  /**
+   * 跳到 t 秒，各帧源自行 seek 后早于 t 的帧会被丢弃
+   */
+  seek(seconds: number): void {
+    this.clock.seek(seconds);
+  }
+
+  setRate(rate: number): void {
+    this.clock.setRate(rate);
+  }
+
+  /**
+   * 回到预滚状态，下一批帧重新对齐起点
+   */
+  reset(): void {
+    this.clock.reset();
+  }
+
+  getTime(): number {
+    return this.clock.getTime();
+  }
+
+  getStats(): PresentationClockStats {
+    return this.clock.getStats();
+  }
+}
+
+/**
+ * OSD 叠加：把时间码、摄像机名称等文字和框直接混合进 NV12 / I420 帧，
+ * 传给 VaapiDecoder.setOverlay、MultiTrackDecoder / RawVideoSource 的选项，或用 renderInto 叠加到已有帧。
+ * 字形图集由调用者预先栅格化（如在渲染进程用 canvas 绘制后取 alpha 通道）
+ */
+export class OsdOverlay {
+  private overlay: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.overlay = new addon.OsdOverlay();
+  }
+
+  /** 原生对象，供 addon 识别 */
+  get native(): any {
+    return this.overlay;
+  }
+
+  /**
+   * 加载字形图集，失败时抛出异常
+   */
+  setAtlas(atlas: OsdAtlas): boolean {
+    return this.overlay.setAtlas(atlas);
+  }
+
+  /**
+   * 替换全部文字和框，正在运行的管线从下一帧起生效
+   */
+  setItems(items: { texts?: OsdTextItem[]; boxes?: OsdBoxItem[] }): void {
+    this.overlay.setItems(items);
+  }
+
+  setEnabled(enabled: boolean): void {
+    this.overlay.setEnabled(enabled);
+  }
+
+  /**
+   * 叠加到 JS 持有的帧上（原地修改）
+   */
+  renderInto(data: Buffer, width: number, height: number,
+             options: { format?: 'nv12' | 'i420'; pts?: number; frame?: number; fps?: number } = {}): void {
+    this.overlay.renderInto(data, width, height, options);
+  }
+
+  getStats(): OsdOverlayStats {
+    return this.overlay.getStats();
+  }
+}
+
+/**
+ * 多轨解码：一次解复用，每路视频流一个解码上下文和解码线程，各自输出到一个帧环
+ */
+export class MultiTrackDecoder {
+  private decoder: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.decoder = new addon.MultiTrackDecoder();
+  }
+
+  /**
+   * 打开文件，返回其中的视频流，失败时抛出异常
+   */
+  open(filePath: string): MultiTrackStreamInfo[] {
+    return this.decoder.open(filePath);
+  }
+
+  getStreams(): MultiTrackStreamInfo[] {
+    return this.decoder.getStreams();
+  }
+
+  /**
+   * 在后台线程中开始解码，每轨输出到 options.rings 中对应的帧环
+   */
+  start(options: MultiTrackStartOptions): boolean {
+    return this.decoder.start({
+      ...options,
+      clock: options.clock?.native,
+      overlays: options.overlays?.map((overlay) => overlay?.native ?? null),
+    });
+  }
+
+  /**
+   * 停止解码并关闭各轨的帧环，下一次 start 从头开始
+   */
+  stop(): void {
+    this.decoder.stop();
+  }
+
+  getStats(): MultiTrackStats {
+    return this.decoder.getStats();
+  }
+
+  close(): void {
+    this.decoder.close();
+  }
+}
+
+/**
+ * 未压缩 .yuv / .y4m 视频源：映射整个文件，按帧发布到共享内存环
+ */
+export class RawVideoSource {
+  private source: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.source = new addon.RawVideoSource();
+  }
+
+  /**
+   * 打开文件，失败时抛出异常。.y4m 只需路径，裸 .yuv 需给出 width / height
+   */
+  open(filePath: string, options: RawVideoOpenOptions = {}): RawVideoInfo {
+    return this.source.open(filePath, options);
+  }
+
+  getInfo(): RawVideoInfo | null {
+    return this.source.getInfo();
+  }
+
+  /**
+   * 读取第 index 帧；传入 target 时复制到其中，返回值不含 data（发布期间也可调用）
+   */
+  readFrame(index: number, target?: Buffer): { data?: Buffer; pts: number; index: number } | null {
+    return this.source.readFrame(index, target);
+  }
+
+  /**
+   * 在后台线程中把帧发布到共享内存环
+   */
+  startPublishing(ringName: string, options: RawPublishOptions = {}): boolean {
+    return this.source.startPublishing(ringName, {
+      ...options,
+      clock: options.clock?.native,
+      overlay: options.overlay?.native,
+    });
+  }
+
+  stopPublishing(): void {
+    this.source.stopPublishing();
+  }
+
+  getPublishStats(): RawPublishStats {
+    return this.source.getPublishStats();
+  }
+
+  close(): void {
+    this.source.close();
+  }
+}
+
+/**
+ * 图片序列视频源：多线程预解码，按序发布到共享内存环
+ */
+export class ImageSequenceSource {
+  private source: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.source = new addon.ImageSequenceSource();
+  }
+
+  /**
+   * 打开目录、printf 模式（shot.%04d.exr）或序列中的一个文件，失败时抛出异常
+   */
+  open(path: string, options: ImageSequenceOpenOptions = {}): ImageSequenceInfo {
+    return this.source.open(path, options);
+  }
+
+  getInfo(): ImageSequenceInfo | null {
+    return this.source.getInfo();
+  }
+
+  startPublishing(ringName: string, options: ImageSequencePublishOptions = {}): boolean {
+    return this.source.startPublishing(ringName, { ...options, clock: options.clock?.native });
+  }
+
+  stopPublishing(): void {
+    this.source.stopPublishing();
+  }
+
+  getPublishStats(): ImageSequencePublishStats {
+    return this.source.getPublishStats();
+  }
+
+  close(): void {
+    this.source.close();
+  }
+}
+
+/**
+ * 逐帧比较两路同尺寸帧（如两个帧环同步读取的帧），累计 PSNR / SSIM
+ */
+export class QualityMeter {
+  private meter: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.meter = new addon.QualityMeter();
+  }
+
+  compare(reference: Buffer, distorted: Buffer, width: number, height: number,
+          options: { format?: 'nv12' | 'i420'; pts?: number } = {}): QualityScore {
+    return this.meter.compare(reference, distorted, width, height, options);
+  }
+
+  getReport(options: { perFrame?: boolean } = {}): QualityReport {
+    return this.meter.getReport(options);
+  }
+
+  reset(): void {
+    this.meter.reset();
+  }
+}
+
+/**
+ * 后台比较两个文件的画质：参考与被测（代理、降质解码配置）同步解码，按 pts 配对
+ */
+export class QualityAnalyzer {
+  private analyzer: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.analyzer = new addon.QualityAnalyzer();
+  }
+
+  /**
+   * @param onProgress 进度回调，结束时 done 为 true 并带每帧数据
+   */
+  start(options: QualityAnalyzeOptions, onProgress: (progress: QualityProgress) => void): boolean {
+    return this.analyzer.start(options, onProgress);
+  }
+
+  cancel(): void {
+    this.analyzer.cancel();
+  }
+
+  isRunning(): boolean {
+    return this.analyzer.isRunning();
+  }
+}
+
+/**
+ * 无损片段导出：按数据包复制 [start, end) 到新文件，不重新编码
+ */
+export class ClipExporter {
+  private exporter: any;
+
+  constructor() {
+    const addon = loadAddon();
+    this.exporter = new addon.ClipExporter();
+  }
+
+  /**
+   * @param onProgress 进度回调，结束时 done 为 true；失败或取消时不留下输出文件
+   */
+  start(options: ClipExportOptions, onProgress: (progress: ClipExportProgress) => void): boolean {
+    return this.exporter.start(options, onProgress);
+  }
+
+  cancel(): void {
+    this.exporter.cancel();
+  }
+
+  isRunning(): boolean {
+    return this.exporter.isRunning();
+  }
+}
+
+/**
+ * 合成帧解码器：接口与 VaapiDecoder 一致，输出带移动方块和帧序号的 NV12 帧。
+ * 用于测量队列、拷贝、N-API、共享内存、渲染等与解码无关的管线开销，
+ * 也可在没有 FFmpeg / VA-API 的机器上验证传输路径
+ */
+export class SyntheticDecoder implements VideoFrameDecoder {
+  private decoder: any;
+
+  constructor(options?: SyntheticDecoderOptions) {
+    let addon: any;
+    try {
+      addon = require('../../../native/vaapi-decoder/build/Release/synthetic_decoder.node');
+    } catch (err) {
+      throw new Error(`Failed to load synthetic decoder: ${err}`);
+    }
+    this.decoder = new addon.SyntheticDecoder();
+    if (options) {
+      this.decoder.configure(options);
+    }
+  }
+
+  /**
+   * 修改参数，下一次 init 时生效
+   */
+  configure(options: SyntheticDecoderOptions): void {
+    this.decoder.configure(options);
+  }
+
+  /**
+   * @param filename synthetic://宽x高@帧率?cost=毫秒&mode=spin|sleep&frames=N&realtime=0|1，
+   *                 其他路径按 configure() 的参数生成
+   */
+  initFromFile(filename: string): boolean {
+    return this.decoder.initFromFile(filename);
+  }
+
+  /**
+   * 忽略数据内容，之后每次 decodePacket 输出一帧
+   */
+  initFromBuffer(buffer: Buffer, codecName: string): boolean {
+    return this.decoder.initFromBuffer(buffer, codecName);
+  }
+
+  decodeFrame(): DecodedFrame | null {
+    return this.decoder.decodeFrame();
+  }
+
+  decodePacket(packet: Buffer): DecodedFrame | null {
+    return this.decoder.decodePacket(packet);
+  }
+
+  decodeFrameInto(target: Uint8Array, meta: Float64Array): number {
+    return this.decoder.decodeFrameInto(target, meta);
+  }
+
+  decodePacketInto(packet: Buffer, target: Uint8Array, meta: Float64Array): number {
+    return this.decoder.decodePacketInto(packet, target, meta);
+  }
+
+  seek(seconds: number): boolean {
+    return this.decoder.seek(seconds);
+  }
+
+  getDuration(): number {
+    return this.decoder.getDuration();
+  }
+
+  getVideoInfo(): VideoInfo | null {
+    return this.decoder.getVideoInfo();
+  }
+
+  getStats(): SyntheticDecoderStats {
+    return this.decoder.getStats();
+  }
+
+  close(): void {
+    this.decoder.close();
+  }
+}
+
+/**
+ * 按文件名或环境变量选择解码后端：synthetic:// 路径或 VIDEO_DECODER_BACKEND=synthetic 时使用合成解码器
+ */
+export function createDecoder(filename?: string): VideoFrameDecoder {
+  if ((filename && filename.startsWith('synthetic://')) || process.env.VIDEO_DECODER_BACKEND === 'synthetic') {
+    return new SyntheticDecoder();
+  }
+  return new VaapiDecoder();
+}
+
+/**
+ * 复用同一块帧缓冲和元数据块逐帧读取，帧尺寸变大时自动扩容
+ * 每次 read() 之后 buffer 的前 size 字节为当前帧，下一次 read() 会覆盖
+ */
+export class FrameReader {
+  buffer: Uint8Array;
+  readonly meta = new Float64Array(FrameMeta.LENGTH);
+
+  constructor(private decoder: VideoFrameDecoder, initialSize = 0) {
+    this.buffer = new Uint8Array(initialSize);
+  }
+
+  get width(): number { return this.meta[FrameMeta.WIDTH]; }
+  get height(): number { return this.meta[FrameMeta.HEIGHT]; }
+  get pts(): number { return this.meta[FrameMeta.PTS]; }
+  get size(): number { return this.meta[FrameMeta.SIZE]; }
+  get formatChanged(): boolean { return (this.meta[FrameMeta.FLAGS] & FrameMetaFlags.FORMAT_CHANGE) !== 0; }
+
+  /**
+   * @returns 是否读到一帧
+   */
+  read(): boolean {
+    let result = this.decoder.decodeFrameInto(this.buffer, this.meta);
+    if (result === FrameIntoResult.TOO_SMALL) {
+      this.buffer = new Uint8Array(this.meta[FrameMeta.SIZE]);
+      result = this.decoder.decodeFrameInto(this.buffer, this.meta);
+    }
+    return result >= 0;
+  }
+}
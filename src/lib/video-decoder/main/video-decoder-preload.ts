@@ -4,7 +4,16 @@
  */
 
 import { ipcRenderer } from 'electron';
-import { VaapiDecoder, DecodedFrame, VideoInfo } from './vaapi-decoder';
+import { createDecoder, DecodedFrame, VideoInfo, VideoFrameDecoder } from './vaapi-decoder';
+
+// 共享内存 addon，用于读取主进程发布的数据包环
+let sharedMemory: any = null;
+try {
+  const path = require('path');
+  sharedMemory = require(path.join(__dirname, '../../../../native/shared-memory/build/Release/shared_memory.node'));
+} catch (err) {
+  console.error('Failed to load shared memory addon:', err);
+}
 
 // 暴露到渲染进程的 API
 (window as any).videoDecoderAPI = {
@@ -13,7 +22,7 @@ import { VaapiDecoder, DecodedFrame, VideoInfo } from './vaapi-decoder';
    */
   initFromFile: async (filename: string): Promise<boolean> => {
     try {
-      const decoder = new VaapiDecoder();
+      const decoder = createDecoder(filename);
       const result = decoder.initFromFile(filename);
       // 将解码器实例保存到全局
       (global as any).__currentDecoder = decoder;
@@ -29,7 +38,7 @@ import { VaapiDecoder, DecodedFrame, VideoInfo } from './vaapi-decoder';
    */
   decodeFrame: async (): Promise<DecodedFrame | null> => {
     try {
-      const decoder = (global as any).__currentDecoder as VaapiDecoder;
+      const decoder = (global as any).__currentDecoder as VideoFrameDecoder;
       if (!decoder) {
         throw new Error('Decoder not initialized');
       }
@@ -45,7 +54,7 @@ import { VaapiDecoder, DecodedFrame, VideoInfo } from './vaapi-decoder';
    */
   getVideoInfo: async (): Promise<VideoInfo | null> => {
     try {
-      const decoder = (global as any).__currentDecoder as VaapiDecoder;
+      const decoder = (global as any).__currentDecoder as VideoFrameDecoder;
       if (!decoder) {
         throw new Error('Decoder not initialized');
       }
@@ -61,7 +70,7 @@ import { VaapiDecoder, DecodedFrame, VideoInfo } from './vaapi-decoder';
    */
   close: (): void => {
     try {
-      const decoder = (global as any).__currentDecoder as VaapiDecoder;
+      const decoder = (global as any).__currentDecoder as VideoFrameDecoder;
       if (decoder) {
         decoder.close();
         (global as any).__currentDecoder = null;
@@ -76,7 +85,7 @@ import { VaapiDecoder, DecodedFrame, VideoInfo } from './vaapi-decoder';
    */
   initFromBuffer: async (buffer: Buffer, codecName: string): Promise<boolean> => {
     try {
-      const decoder = new VaapiDecoder();
+      const decoder = createDecoder();
       const result = decoder.initFromBuffer(buffer, codecName);
       (global as any).__currentDecoder = decoder;
       return result;
@@ -91,7 +100,7 @@ import { VaapiDecoder, DecodedFrame, VideoInfo } from './vaapi-decoder';
    */
   decodePacket: async (packet: Buffer): Promise<DecodedFrame | null> => {
     try {
-      const decoder = (global as any).__currentDecoder as VaapiDecoder;
+      const decoder = (global as any).__currentDecoder as VideoFrameDecoder;
       if (!decoder) {
         throw new Error('Decoder not initialized');
       }
@@ -101,6 +110,73 @@ import { VaapiDecoder, DecodedFrame, VideoInfo } from './vaapi-decoder';
       return null;
     }
   },
+
+  /**
+   * 打开主进程发布的数据包环
+   */
+  openPacketRing: (ringName: string): { writeSeq: number; oldestSeq: number } | null => {
+    try {
+      return sharedMemory ? sharedMemory.openFrameRing(ringName) : null;
+    } catch (err) {
+      console.error('openPacketRing error:', err);
+      return null;
+    }
+  },
+
+  /**
+   * 读取数据包环中第 seq 项，status 为 overwritten 时应跳到 oldestSeq 并等待下一个关键帧
+   */
+  readRingPacket: (ringName: string, seq: number, target?: Buffer): any => {
+    return sharedMemory ? sharedMemory.readFrame(ringName, seq, target) : null;
+  },
+
+  /**
+   * 把帧环中第 seq 帧（NV12 / I420）直接转换为 RGBA 并缩放到 target（ImageData.data），
+   * 不复制原始帧；WebGL 不可用时用 putImageData 显示
+   */
+  presentRingFrame: (ringName: string, seq: number, target: Uint8ClampedArray, dstWidth: number, dstHeight: number,
+                     options?: { matrix?: 'bt601' | 'bt709' }): any => {
+    return sharedMemory ? sharedMemory.presentFrame(ringName, seq, target, dstWidth, dstHeight, options) : null;
+  },
+
+  closePacketRing: (ringName: string): void => {
+    if (sharedMemory) {
+      sharedMemory.closeFrameRing(ringName);
+    }
+  },
+
+  /**
+   * 打开跨窗口共享的已解码帧缓存（不存在时创建），各窗口使用同一名称
+   */
+  openFrameCache: (name: string, slotSize: number, budgetBytes?: number): any => {
+    try {
+      return sharedMemory ? sharedMemory.openFrameCache(name, slotSize, budgetBytes) : null;
+    } catch (err) {
+      console.error('openFrameCache error:', err);
+      return null;
+    }
+  },
+
+  /**
+   * 查找其他窗口已解码的帧，未命中返回 null
+   */
+  getCachedFrame: (name: string, contentId: string, pts: number, target?: Buffer): any => {
+    return sharedMemory ? sharedMemory.getCachedFrame(name, contentId, pts, target) : null;
+  },
+
+  putCachedFrame: (name: string, contentId: string, pts: number, data: Buffer, width: number, height: number): string | null => {
+    return sharedMemory ? sharedMemory.putCachedFrame(name, contentId, pts, data, width, height) : null;
+  },
+
+  getFrameCacheStats: (name: string): any => {
+    return sharedMemory ? sharedMemory.getFrameCacheStats(name) : null;
+  },
+
+  closeFrameCache: (name: string): void => {
+    if (sharedMemory) {
+      sharedMemory.closeFrameCache(name);
+    }
+  },
 };
 
 console.log('Video Decoder API initialized');
@@ -0,0 +1,205 @@
+/**
+ * 共享内存并发测试脚本
+ * 两个进程同时读写跨窗口帧缓存 (ShmFrameCache) 和帧环 (ShmFrameRing)，
+ * 每次命中/读取都校验帧内容，检查引用计数和 seqlock 不会交出写到一半的帧
+ */
+
+const { fork } = require('child_process');
+
+const CACHE_NAME = '/test_shm_frame_cache';
+const RING_NAME = '/test_shm_frame_ring';
+const CONTENT_IDS = ['clip-a', 'clip-b', 'clip-c'];
+const WIDTH = 64;
+const HEIGHT = 36;
+const FRAME_SIZE = WIDTH * HEIGHT * 3 / 2;
+const CACHE_SLOTS_BUDGET = 256 * (FRAME_SIZE + 128);   // 约 256 槽，少于 720 个键，持续淘汰
+const PTS_RANGE = 240;
+const RING_SLOTS = 4;
+const DURATION_MS = Number(process.env.TEST_DURATION_MS || 3000);
+const START_DELAY_MS = 200;   // 消息送达子进程后两边同时开始
+
+// 两个进程约定同一个开始时间，各自忙等到该时间
+function waitUntil(startAt) {
+    while (Date.now() < startAt) {}
+    return startAt + DURATION_MS;
+}
+
+// 帧内容由种子决定：[种子 u32][序号 u32][填充...][校验和 u32]
+function fillFrame(buffer, seed, serial) {
+    let x = (seed * 2654435761) >>> 0 || 1;
+    for (let i = 8; i < buffer.length - 4; i++) {
+        x ^= x << 13; x >>>= 0;
+        x ^= x >>> 17;
+        x ^= x << 5; x >>>= 0;
+        buffer[i] = x & 0xff;
+    }
+    buffer.writeUInt32LE(seed >>> 0, 0);
+    buffer.writeUInt32LE(serial >>> 0, 4);
+    buffer.writeUInt32LE(checksum(buffer), buffer.length - 4);
+}
+
+// FNV-1a，覆盖校验和之前的全部字节
+function checksum(buffer) {
+    let h = 0x811c9dc5;
+    for (let i = 0; i < buffer.length - 4; i++) {
+        h ^= buffer[i];
+        h = Math.imul(h, 0x01000193) >>> 0;
+    }
+    return h;
+}
+
+function frameIntact(buffer, size) {
+    const frame = buffer.subarray(0, size);
+    return size === FRAME_SIZE && checksum(frame) === frame.readUInt32LE(size - 4);
+}
+
+function cacheSeed(content, pts) {
+    return content * 100000 + pts + 1;
+}
+
+// 随机存取缓存：命中时校验内容与键一致，未命中时写入，偶尔整体失效一个内容
+function runCache(shm, startAt) {
+    shm.openFrameCache(CACHE_NAME, FRAME_SIZE, CACHE_SLOTS_BUDGET);
+    const frame = Buffer.alloc(FRAME_SIZE);
+    const target = Buffer.alloc(FRAME_SIZE);
+    const stats = { gets: 0, hits: 0, puts: 0, busy: 0, invalidated: 0, corrupt: 0 };
+    const deadline = waitUntil(startAt);
+
+    while (Date.now() < deadline) {
+        const content = Math.floor(Math.random() * CONTENT_IDS.length);
+        const pts = Math.floor(Math.random() * PTS_RANGE);
+        const contentId = CONTENT_IDS[content];
+
+        stats.gets++;
+        const hit = shm.getCachedFrame(CACHE_NAME, contentId, pts / 25, target);
+        if (hit) {
+            stats.hits++;
+            if (!frameIntact(target, hit.size) || target.readUInt32LE(0) !== cacheSeed(content, pts) ||
+                hit.width !== WIDTH || hit.height !== HEIGHT) {
+                stats.corrupt++;
+            }
+        } else {
+            fillFrame(frame, cacheSeed(content, pts), process.pid);
+            const status = shm.putCachedFrame(CACHE_NAME, contentId, pts / 25, frame, WIDTH, HEIGHT);
+            if (status === 'ok') stats.puts++;
+            if (status === 'busy') stats.busy++;
+        }
+
+        if (stats.gets % 5000 === 0) {
+            stats.invalidated += shm.invalidateCachedFrames(CACHE_NAME, contentId);
+        }
+    }
+    stats.cache = shm.getFrameCacheStats(CACHE_NAME);
+    shm.closeFrameCache(CACHE_NAME);
+    return stats;
+}
+
+// 生产者：尽快写入，槽数很少，读者经常读到正在被覆盖的槽
+function runRingWriter(shm, startAt) {
+    const frame = Buffer.alloc(FRAME_SIZE);
+    const deadline = waitUntil(startAt);
+    let written = 0;
+    while (Date.now() < deadline) {
+        fillFrame(frame, written + 1, written);
+        shm.writeFrame(RING_NAME, frame, WIDTH, HEIGHT, written / 25);
+        written++;
+    }
+    return { written };
+}
+
+// 消费者：按序号读取，'ok' 的帧必须完整且序号一致，被覆盖时跳到最旧的可读帧
+function runRingReader(shm, startAt) {
+    const ring = shm.openFrameRing(RING_NAME);
+    const target = Buffer.alloc(ring.slotSize);
+    const stats = { ok: 0, empty: 0, overwritten: 0, corrupt: 0, outOfOrder: 0 };
+    const deadline = waitUntil(startAt);
+    let seq = ring.writeSeq;
+    let last = -1;
+
+    while (Date.now() < deadline) {
+        const item = shm.readFrame(RING_NAME, seq, target);
+        if (item.status === 'empty') { stats.empty++; continue; }
+        if (item.status === 'overwritten') {
+            stats.overwritten++;
+            seq = Math.max(seq + 1, item.oldestSeq);
+            continue;
+        }
+        stats.ok++;
+        const serial = target.readUInt32LE(4);
+        if (!frameIntact(target, item.size) || serial !== (seq >>> 0) || item.seq !== seq) {
+            stats.corrupt++;
+        }
+        if (serial <= last) stats.outOfOrder++;
+        last = serial;
+        seq++;
+    }
+    shm.closeFrameRing(RING_NAME);
+    return stats;
+}
+
+function loadAddon() {
+    return require('./native/shared-memory/build/Release/shared_memory.node');
+}
+
+// 子进程：按父进程的指令运行一个阶段并回报结果
+if (process.argv[2] === '--child') {
+    const shm = loadAddon();
+    process.on('message', ({ phase, startAt }) => {
+        const result = phase === 'cache' ? runCache(shm, startAt) : runRingReader(shm, startAt);
+        process.send({ phase, result });
+        if (phase === 'ring') process.exit(0);
+    });
+    process.send({ phase: 'ready' });
+} else {
+    let shm;
+    try {
+        shm = loadAddon();
+        console.log('✓ Shared memory addon loaded successfully');
+    } catch (err) {
+        console.error('✗ Error:', err.message);
+        console.error('  Build the addon first: cd native/shared-memory && node-gyp rebuild');
+        process.exit(1);
+    }
+
+    shm.createFrameRing(RING_NAME, RING_SLOTS, FRAME_SIZE);
+    const child = fork(__filename, ['--child']);
+    let failed = false;
+
+    const report = (label, stats, bad) => {
+        console.log(`  ${bad ? '✗' : '✓'} ${label}: ${JSON.stringify(stats)}`);
+        if (bad) failed = true;
+    };
+
+    // 先让事件循环把消息发出去，再进入同步的测试循环
+    const startPhase = (phase, run) => {
+        const startAt = Date.now() + START_DELAY_MS;
+        child.send({ phase, startAt });
+        setTimeout(() => run(startAt), 0);
+    };
+
+    child.on('message', ({ phase, result }) => {
+        if (phase === 'ready') {
+            console.log(`\nFrame cache: two processes, ${DURATION_MS} ms`);
+            startPhase('cache', (startAt) => {
+                const own = runCache(shm, startAt);
+                report('parent', own, own.corrupt > 0);
+            });
+        } else if (phase === 'cache') {
+            report('child', result, result.corrupt > 0 || result.hits === 0);
+            console.log(`\nFrame ring: parent writes, child reads, ${RING_SLOTS} slots, ${DURATION_MS} ms`);
+            startPhase('ring', (startAt) => report('writer', runRingWriter(shm, startAt), false));
+        } else if (phase === 'ring') {
+            report('reader', result, result.corrupt > 0 || result.outOfOrder > 0 || result.ok === 0);
+            shm.closeFrameRing(RING_NAME);
+            console.log(failed ? '\n✗ Shared memory test failed' : '\n✓ Shared memory test passed');
+            process.exitCode = failed ? 1 : 0;
+        }
+    });
+
+    child.on('exit', (code) => {
+        if (code !== 0) {
+            console.error(`✗ Child process exited with code ${code}`);
+            process.exitCode = 1;
+        }
+    });
+}